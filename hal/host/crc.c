@@ -4,6 +4,26 @@
 
 //------------------------------------------------------------------------------------------------- Internal
 
+/**
+ * @brief Slicing-by-8 tables of one algorithm.
+ * Reflected algorithms keep register right-aligned and shift right (no per-byte bit reversal),
+ * others keep it left-aligned in 32 bits and shift left, so one loop serves all widths.
+ * @param width CRC width in bits
+ * @param polynomial Generator polynomial
+ * @param reflect Input bytes are reflected
+ * @param table `table[0]` is classic byte table, `table[k]` advances it by `k` more zero bytes
+ */
+typedef struct {
+  uint8_t width;
+  uint32_t polynomial;
+  bool reflect;
+  uint32_t table[8][256];
+} CRC_Slice_t;
+
+static CRC_Slice_t crc_cache[CRC_CACHE];
+static uint8_t crc_cache_count;
+static uint8_t crc_cache_next;
+
 static uint32_t get_crc_mask(uint8_t width)
 {
   switch(width) {
@@ -24,46 +44,137 @@ static uint32_t reflect_bits(uint32_t data, uint8_t width)
   return reflection;
 }
 
-//-------------------------------------------------------------------------------------------------
-
-void CRC_Init(CRC_t *crc)
+static void CRC_Build(CRC_Slice_t *slice)
 {
-  uint32_t topbit = 1u << (crc->width - 1);
-  uint32_t mask = get_crc_mask(crc->width);
-  for(uint16_t i = 0; i < 256; i++) {
-    uint32_t remainder = (uint32_t)i << (crc->width - 8);
-    for(uint8_t bit = 0; bit < 8; bit++) {
-      if(remainder & topbit) remainder = (remainder << 1) ^ crc->polynomial;
-      else remainder <<= 1;
+  if(slice->reflect) {
+    uint32_t polynomial = reflect_bits(slice->polynomial, slice->width);
+    for(uint16_t i = 0; i < 256; i++) {
+      uint32_t remainder = i;
+      for(uint8_t bit = 0; bit < 8; bit++) {
+        remainder = (remainder & 1) ? (remainder >> 1) ^ polynomial : remainder >> 1;
+      }
+      slice->table[0][i] = remainder;
+    }
+    for(uint16_t i = 0; i < 256; i++) {
+      for(uint8_t k = 1; k < 8; k++) {
+        uint32_t prev = slice->table[k - 1][i];
+        slice->table[k][i] = (prev >> 8) ^ slice->table[0][prev & 0xFF];
+      }
+    }
+  }
+  else {
+    uint32_t polynomial = slice->polynomial << (32 - slice->width);
+    for(uint16_t i = 0; i < 256; i++) {
+      uint32_t remainder = (uint32_t)i << 24;
+      for(uint8_t bit = 0; bit < 8; bit++) {
+        remainder = (remainder & 0x80000000) ? (remainder << 1) ^ polynomial : remainder << 1;
+      }
+      slice->table[0][i] = remainder;
+    }
+    for(uint16_t i = 0; i < 256; i++) {
+      for(uint8_t k = 1; k < 8; k++) {
+        uint32_t prev = slice->table[k - 1][i];
+        slice->table[k][i] = (prev << 8) ^ slice->table[0][prev >> 24];
+      }
     }
-    crc->table[i] = remainder & mask;
   }
 }
 
-uint32_t CRC_Run(const CRC_t *crc, void *data, uint16_t count)
+// Tables of algorithm from cache, built on first use (oldest entry is replaced when cache is full)
+static const CRC_Slice_t *CRC_Slice(const CRC_t *crc)
+{
+  bool reflect = crc->reflect_data_in;
+  for(uint8_t i = 0; i < crc_cache_count; i++) {
+    CRC_Slice_t *slice = &crc_cache[i];
+    if(slice->width == crc->width && slice->polynomial == crc->polynomial && slice->reflect == reflect) return slice;
+  }
+  CRC_Slice_t *slice = &crc_cache[crc_cache_next];
+  crc_cache_next = (crc_cache_next + 1) % CRC_CACHE;
+  if(crc_cache_count < CRC_CACHE) crc_cache_count++;
+  slice->width = crc->width;
+  slice->polynomial = crc->polynomial;
+  slice->reflect = reflect;
+  CRC_Build(slice);
+  return slice;
+}
+
+static uint32_t CRC_Reflected(const CRC_Slice_t *slice, uint32_t remainder, const uint8_t *bytes, uint16_t count)
+{
+  const uint32_t (*t)[256] = slice->table;
+  while(count >= 8) {
+    uint32_t one = remainder ^ ((uint32_t)bytes[0] | (uint32_t)bytes[1] << 8 | (uint32_t)bytes[2] << 16 | (uint32_t)bytes[3] << 24);
+    uint32_t two = (uint32_t)bytes[4] | (uint32_t)bytes[5] << 8 | (uint32_t)bytes[6] << 16 | (uint32_t)bytes[7] << 24;
+    remainder = t[7][one & 0xFF] ^ t[6][(one >> 8) & 0xFF] ^ t[5][(one >> 16) & 0xFF] ^ t[4][one >> 24] ^
+      t[3][two & 0xFF] ^ t[2][(two >> 8) & 0xFF] ^ t[1][(two >> 16) & 0xFF] ^ t[0][two >> 24];
+    bytes += 8;
+    count -= 8;
+  }
+  while(count--) remainder = t[0][(remainder ^ *bytes++) & 0xFF] ^ (remainder >> 8);
+  return remainder;
+}
+
+static uint32_t CRC_Normal(const CRC_Slice_t *slice, uint32_t remainder, const uint8_t *bytes, uint16_t count)
+{
+  const uint32_t (*t)[256] = slice->table;
+  while(count >= 8) {
+    uint32_t one = remainder ^ ((uint32_t)bytes[0] << 24 | (uint32_t)bytes[1] << 16 | (uint32_t)bytes[2] << 8 | bytes[3]);
+    uint32_t two = (uint32_t)bytes[4] << 24 | (uint32_t)bytes[5] << 16 | (uint32_t)bytes[6] << 8 | bytes[7];
+    remainder = t[7][one >> 24] ^ t[6][(one >> 16) & 0xFF] ^ t[5][(one >> 8) & 0xFF] ^ t[4][one & 0xFF] ^
+      t[3][two >> 24] ^ t[2][(two >> 16) & 0xFF] ^ t[1][(two >> 8) & 0xFF] ^ t[0][two & 0xFF];
+    bytes += 8;
+    count -= 8;
+  }
+  while(count--) remainder = t[0][(remainder >> 24) ^ *bytes++] ^ (remainder << 8);
+  return remainder;
+}
+
+//-------------------------------------------------------------------------------------------------
+
+void CRC_Init(const CRC_t *crc)
+{
+  CRC_Slice(crc);
+}
+
+uint32_t CRC_Begin(const CRC_t *crc)
+{
+  if(crc->reflect_data_in) return reflect_bits(crc->initial, crc->width);
+  return crc->initial << (32 - crc->width);
+}
+
+uint32_t CRC_Update(const CRC_t *crc, uint32_t state, const void *data, uint16_t count)
+{
+  const CRC_Slice_t *slice = CRC_Slice(crc);
+  if(slice->reflect) return CRC_Reflected(slice, state, (const uint8_t *)data, count);
+  return CRC_Normal(slice, state, (const uint8_t *)data, count);
+}
+
+uint32_t CRC_End(const CRC_t *crc, uint32_t state)
 {
   uint32_t mask = get_crc_mask(crc->width);
-  uint32_t remainder = crc->initial;
-  uint8_t *bytes = (uint8_t *)data;
-  for(uint16_t i = 0; i < count; i++) {
-    uint8_t byte = bytes[i];
-    if(crc->reflect_data_in) byte = (uint8_t)reflect_bits(byte, 8);
-    uint8_t idx = (uint8_t)((byte ^ (remainder >> (crc->width - 8))) & 0xFF);
-    remainder = crc->table[idx] ^ (remainder << 8);
-    remainder &= mask;
+  uint32_t remainder = state;
+  if(crc->reflect_data_in) {
+    // Register already holds reflected value
+    if(!crc->reflect_data_out) remainder = reflect_bits(remainder, crc->width);
   }
-  if(crc->reflect_data_out) remainder = reflect_bits(remainder, crc->width);
-  remainder ^= crc->final_xor;
+  else {
+    remainder >>= 32 - crc->width;
+    if(crc->reflect_data_out) remainder = reflect_bits(remainder, crc->width);
+  }
+  remainder = (remainder ^ crc->final_xor) & mask;
   if(crc->invert_out) {
-    uint8_t *p = (uint8_t *)&remainder;
     switch(crc->width) {
-      case 32: return ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) | ((uint32_t)p[2] << 8) | p[3];
-      case 16: return ((uint32_t)p[0] << 8) | p[1];
+      case 32: return __builtin_bswap32(remainder);
+      case 16: return __builtin_bswap16((uint16_t)remainder);
     }
   }
   return remainder;
 }
 
+uint32_t CRC_Run(const CRC_t *crc, void *data, uint16_t count)
+{
+  return CRC_End(crc, CRC_Update(crc, CRC_Begin(crc), data, count));
+}
+
 //-------------------------------------------------------------------------------------------------
 
 uint16_t CRC_Append(const CRC_t *crc, uint8_t *data, uint16_t count)
@@ -109,7 +220,7 @@ status_t CRC_Ok(const CRC_t *crc, uint8_t *data, uint16_t count)
 //-------------------------------------------------------------------------------------------------
 #if(CRC_PRESETS)
 
-CRC_t crc32_iso = {
+const CRC_t crc32_iso = {
   .width = 32,
   .polynomial = 0x04C11DB7,
   .initial = 0xFFFFFFFF,
@@ -119,7 +230,7 @@ CRC_t crc32_iso = {
   .invert_out = false
 };
 
-CRC_t crc32_aixm = {
+const CRC_t crc32_aixm = {
   .width = 32,
   .polynomial = 0x814141AB,
   .initial = 0x00000000,
@@ -129,7 +240,7 @@ CRC_t crc32_aixm = {
   .invert_out = false
 };
 
-CRC_t crc32_autosar = {
+const CRC_t crc32_autosar = {
   .width = 32,
   .polynomial = 0xF4ACFB13,
   .initial = 0xFFFFFFFF,
@@ -139,7 +250,7 @@ CRC_t crc32_autosar = {
   .invert_out = false
 };
 
-CRC_t crc32_cksum = {
+const CRC_t crc32_cksum = {
   .width = 32,
   .polynomial = 0x04C11DB7,
   .initial = 0x00000000,
@@ -149,7 +260,7 @@ CRC_t crc32_cksum = {
   .invert_out = false
 };
 
-CRC_t crc16_kermit = {
+const CRC_t crc16_kermit = {
   .width = 16,
   .polynomial = 0x1021,
   .initial = 0x0000,
@@ -159,7 +270,7 @@ CRC_t crc16_kermit = {
   .invert_out = false
 };
 
-CRC_t crc16_modbus = {
+const CRC_t crc16_modbus = {
   .width = 16,
   .polynomial = 0x8005,
   .initial = 0xFFFF,
@@ -169,7 +280,7 @@ CRC_t crc16_modbus = {
   .invert_out = true
 };
 
-CRC_t crc16_buypass = {
+const CRC_t crc16_buypass = {
   .width = 16,
   .polynomial = 0x8005,
   .initial = 0x0000,
@@ -179,7 +290,7 @@ CRC_t crc16_buypass = {
   .invert_out = false
 };
 
-CRC_t crc8_maxim = {
+const CRC_t crc8_maxim = {
   .width = 8,
   .polynomial = 0x31,
   .initial = 0x00,
@@ -189,7 +300,7 @@ CRC_t crc8_maxim = {
   .invert_out = false
 };
 
-CRC_t crc8_smbus = {
+const CRC_t crc8_smbus = {
   .width = 8,
   .polynomial = 0x07,
   .initial = 0x00,
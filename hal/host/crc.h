@@ -14,6 +14,11 @@
   #define CRC_PRESETS ON
 #endif
 
+#ifndef CRC_CACHE
+  // Algorithms with slicing-by-8 tables kept in memory (8 KB each, built on first use)
+  #define CRC_CACHE 8
+#endif
+
 //------------------------------------------------------------------------------------------------- Types
 
 /**
@@ -25,7 +30,6 @@
  * @param[in] reflect_data_out Bit-reflect final CRC
  * @param[in] final_xor XOR mask applied to final CRC
  * @param[in] invert_out Invert final CRC byte order
- * @param[in,out] table Pointer to 256-entry lookup table buffer
  */
 typedef struct {
   uint8_t width;
@@ -35,16 +39,15 @@ typedef struct {
   bool reflect_data_out;
   uint32_t final_xor;
   bool invert_out;
-  uint32_t *table;
 } CRC_t;
 
 //------------------------------------------------------------------------------------------------- API
 
 /**
- * @brief Build lookup table for CRC instance. Must be called before `CRC_Run`.
- * @param[in,out] crc CRC instance with `table` pointing to 256-entry buffer
+ * @brief Build lookup tables for CRC algorithm in advance (optional, `CRC_Run` builds them on first use).
+ * @param[in] crc CRC algorithm configuration
  */
-void CRC_Init(CRC_t *crc);
+void CRC_Init(const CRC_t *crc);
 
 /**
  * @brief Calculate CRC checksum.
@@ -55,6 +58,32 @@ void CRC_Init(CRC_t *crc);
  */
 uint32_t CRC_Run(const CRC_t *crc, void *data, uint16_t count);
 
+/**
+ * @brief Start incremental CRC (`CRC_Begin`, `CRC_Update` for each part, `CRC_End`).
+ * Result equals `CRC_Run` over all parts joined.
+ * @param[in] crc CRC algorithm configuration
+ * @return Initial state
+ */
+uint32_t CRC_Begin(const CRC_t *crc);
+
+/**
+ * @brief Add data to incremental CRC.
+ * @param[in] crc CRC algorithm configuration
+ * @param[in] state State from `CRC_Begin` or previous `CRC_Update`
+ * @param[in] data Pointer to input data
+ * @param[in] count Data length in bytes
+ * @return New state
+ */
+uint32_t CRC_Update(const CRC_t *crc, uint32_t state, const void *data, uint16_t count);
+
+/**
+ * @brief Finish incremental CRC.
+ * @param[in] crc CRC algorithm configuration
+ * @param[in] state State from last `CRC_Update`
+ * @return CRC checksum
+ */
+uint32_t CRC_End(const CRC_t *crc, uint32_t state);
+
 /**
  * @brief Calculate CRC and append to data (big-endian).
  * @param[in] crc CRC algorithm configuration
@@ -85,15 +114,15 @@ status_t CRC_Ok(const CRC_t *crc, uint8_t *data, uint16_t count);
 //------------------------------------------------------------------------------------------------- Presets
 #if(CRC_PRESETS)
 
-  extern CRC_t crc32_iso;
-  extern CRC_t crc32_aixm;
-  extern CRC_t crc32_autosar;
-  extern CRC_t crc32_cksum;
-  extern CRC_t crc16_kermit;
-  extern CRC_t crc16_modbus;
-  extern CRC_t crc16_buypass;
-  extern CRC_t crc8_maxim;
-  extern CRC_t crc8_smbus;
+  extern const CRC_t crc32_iso;
+  extern const CRC_t crc32_aixm;
+  extern const CRC_t crc32_autosar;
+  extern const CRC_t crc32_cksum;
+  extern const CRC_t crc16_kermit;
+  extern const CRC_t crc16_modbus;
+  extern const CRC_t crc16_buypass;
+  extern const CRC_t crc8_maxim;
+  extern const CRC_t crc8_smbus;
 
 #endif
 //-------------------------------------------------------------------------------------------------
@@ -0,0 +1,188 @@
+// hal/host/test/crc.c
+// Host check of slicing-by-8 `CRC_Run` and incremental `CRC_Update` against byte-table
+// implementation it replaced (check values and randomized input, exit code `1` on mismatch),
+// followed by throughput benchmark [MB/s].
+//   gcc -std=gnu11 -O2 -Ihal/host -Ilib/ext hal/host/test/crc.c hal/host/crc.c -o crc && ./crc
+
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include "crc.h"
+
+#define CRC_CASES 20000
+#define CRC_LEN_MAX 4096
+
+static const CRC_t *presets[] = {
+  &crc32_iso, &crc32_aixm, &crc32_autosar, &crc32_cksum,
+  &crc16_kermit, &crc16_modbus, &crc16_buypass, &crc8_maxim, &crc8_smbus
+};
+
+static const char *names[] = {
+  "crc32_iso", "crc32_aixm", "crc32_autosar", "crc32_cksum",
+  "crc16_kermit", "crc16_modbus", "crc16_buypass", "crc8_maxim", "crc8_smbus"
+};
+
+// CRC of ASCII "123456789" (catalogue check values, `crc16_modbus` byte-swapped by `invert_out`)
+static const uint32_t checks[] = {
+  0xCBF43926, 0x3010BF7F, 0x1697D06A, 0x765E7680,
+  0x2189, 0x374B, 0xFEE8, 0xA1, 0xF4
+};
+
+#define PRESETS (sizeof(presets) / sizeof(presets[0]))
+
+//------------------------------------------------------------------------------------------------- Reference
+
+// Previous `CRC_Run`: one byte per iteration, input bits reflected in loop
+static uint32_t old_table[PRESETS][256];
+
+static uint32_t old_mask(uint8_t width)
+{
+  return width == 32 ? 0xFFFFFFFF : (1u << width) - 1;
+}
+
+static uint32_t old_reflect(uint32_t data, uint8_t width)
+{
+  uint32_t reflection = 0;
+  for(uint8_t bit = 0; bit < width; bit++) {
+    if(data & 1) reflection |= (1u << ((width - 1) - bit));
+    data >>= 1;
+  }
+  return reflection;
+}
+
+static void old_init(const CRC_t *crc, uint32_t *table)
+{
+  uint32_t topbit = 1u << (crc->width - 1);
+  uint32_t mask = old_mask(crc->width);
+  for(uint16_t i = 0; i < 256; i++) {
+    uint32_t remainder = (uint32_t)i << (crc->width - 8);
+    for(uint8_t bit = 0; bit < 8; bit++) {
+      if(remainder & topbit) remainder = (remainder << 1) ^ crc->polynomial;
+      else remainder <<= 1;
+    }
+    table[i] = remainder & mask;
+  }
+}
+
+static uint32_t old_run(const CRC_t *crc, const uint32_t *table, const uint8_t *bytes, uint16_t count)
+{
+  uint32_t mask = old_mask(crc->width);
+  uint32_t remainder = crc->initial;
+  for(uint16_t i = 0; i < count; i++) {
+    uint8_t byte = bytes[i];
+    if(crc->reflect_data_in) byte = (uint8_t)old_reflect(byte, 8);
+    uint8_t idx = (uint8_t)((byte ^ (remainder >> (crc->width - 8))) & 0xFF);
+    remainder = table[idx] ^ (remainder << 8);
+    remainder &= mask;
+  }
+  if(crc->reflect_data_out) remainder = old_reflect(remainder, crc->width);
+  remainder ^= crc->final_xor;
+  if(crc->invert_out) {
+    switch(crc->width) {
+      case 32: return __builtin_bswap32(remainder);
+      case 16: return __builtin_bswap16((uint16_t)remainder);
+    }
+  }
+  return remainder;
+}
+
+//------------------------------------------------------------------------------------------------- Input
+
+static uint32_t rng_state = 0x12345678;
+
+static uint32_t rng(void)
+{
+  rng_state ^= rng_state << 13;
+  rng_state ^= rng_state >> 17;
+  rng_state ^= rng_state << 5;
+  return rng_state;
+}
+
+//------------------------------------------------------------------------------------------------- Check
+
+static uint32_t fails;
+
+#define CHECK(cond, what, len) do { \
+  if(!(cond)) { \
+    if(fails++ < 10) printf("FAIL %s %s len:%u\n", names[p], what, (unsigned)(len)); \
+  } \
+} while(0)
+
+static void check(void)
+{
+  static uint8_t data[CRC_LEN_MAX + 4];
+  for(uint8_t p = 0; p < PRESETS; p++) {
+    old_init(presets[p], old_table[p]);
+    CHECK(CRC_Run(presets[p], "123456789", 9) == checks[p], "check value", 9);
+    CHECK(old_run(presets[p], old_table[p], (const uint8_t *)"123456789", 9) == checks[p], "old check value", 9);
+  }
+  for(uint32_t n = 0; n < CRC_CASES; n++) {
+    // Mostly frame sizes (Modbus, PDB records), some up to limit
+    uint16_t len = n % 8 ? rng() % 300 : rng() % CRC_LEN_MAX;
+    // Unaligned start exercises byte assembly of 8-byte steps
+    uint8_t *bytes = data + (n % 4);
+    for(uint16_t i = 0; i < len; i++) bytes[i] = (uint8_t)rng();
+    uint8_t p = n % PRESETS;
+    const CRC_t *crc = presets[p];
+    uint32_t expect = old_run(crc, old_table[p], bytes, len);
+    CHECK(CRC_Run(crc, bytes, len) == expect, "CRC_Run", len);
+    uint16_t split = len ? rng() % (len + 1) : 0;
+    uint32_t state = CRC_Begin(crc);
+    state = CRC_Update(crc, state, bytes, split);
+    state = CRC_Update(crc, state, bytes + split, len - split);
+    CHECK(CRC_End(crc, state) == expect, "CRC_Update", len);
+    uint16_t size = CRC_Append(crc, bytes, len);
+    CHECK(size == len + crc->width / 8 && CRC_Ok(crc, bytes, size), "CRC_Append", len);
+    bytes[rng() % size] ^= 1u << (rng() % 8);
+    CHECK(CRC_Error(crc, bytes, size), "CRC_Error", len);
+  }
+}
+
+//------------------------------------------------------------------------------------------------- Benchmark
+
+static double now_ns(void)
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+static volatile uint32_t sink;
+
+// Throughput [MB/s] of `reps` runs over `len` bytes, `old` selects previous implementation
+static double bench(uint8_t p, bool old, const uint8_t *bytes, uint16_t len)
+{
+  uint32_t reps = 64000000 / (len + 16);
+  double start = now_ns();
+  for(uint32_t r = 0; r < reps; r++) {
+    sink = old ? old_run(presets[p], old_table[p], bytes, len) : CRC_Run(presets[p], (void *)bytes, len);
+  }
+  double ns = now_ns() - start;
+  return (double)reps * len / ns * 1e3;
+}
+
+static void benchmark(void)
+{
+  static const uint16_t lens[] = { 8, 64, 256, 4096 };
+  static uint8_t data[CRC_LEN_MAX];
+  for(uint16_t i = 0; i < CRC_LEN_MAX; i++) data[i] = (uint8_t)rng();
+  printf("%-14s %6s %10s %10s %8s   [MB/s]\n", "preset", "len", "byte", "slice8", "speedup");
+  for(uint8_t p = 0; p < PRESETS; p++) {
+    for(uint8_t l = 0; l < sizeof(lens) / sizeof(lens[0]); l++) {
+      double old = bench(p, true, data, lens[l]);
+      double now = bench(p, false, data, lens[l]);
+      printf("%-14s %6u %10.1f %10.1f %7.1fx\n", names[p], lens[l], old, now, now / old);
+    }
+  }
+}
+
+//-------------------------------------------------------------------------------------------------
+
+int main(void)
+{
+  check();
+  printf("check: %u cases, %u fails\n", CRC_CASES, fails);
+  if(fails) return 1;
+  benchmark();
+  return 0;
+}
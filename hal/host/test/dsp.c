@@ -0,0 +1,254 @@
+// hal/host/test/dsp.c
+// Host check of `xdsp` Q15 block kernels against per-sample floating-point filters
+// they replace (randomized signals, filters, strides and block splits; exit code `1`
+// on error above limit), followed by benchmark.
+//   gcc -std=gnu11 -O2 -Ilib/ext hal/host/test/dsp.c lib/ext/xdsp.c -lm -o dsp && ./dsp
+
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#include "xdsp.h"
+
+#define DSP_CASES 400
+#define DSP_LEN_MAX 2048
+#define DSP_CHANNELS_MAX 4
+
+// Max error `[LSB]` against reference with same (quantized) coefficients,
+// biquad rounding noise grows with stages (up to 3, `fc` down to `fs / 100`)
+#define DSP_LIMIT_BIQUAD 8.0
+#define DSP_LIMIT_FIR 1.0
+#define DSP_LIMIT_MAVG 1.0
+#define DSP_LIMIT_DECIM 1.0
+
+//------------------------------------------------------------------------------------------------- Input
+
+static uint32_t rng_state = 0x2468ACE1;
+
+static uint32_t rng(void)
+{
+  rng_state ^= rng_state << 13;
+  rng_state ^= rng_state >> 17;
+  rng_state ^= rng_state << 5;
+  return rng_state;
+}
+
+static double rng_range(double min, double max)
+{
+  return min + (max - min) * (rng() / 4294967296.0);
+}
+
+static uint16_t adc[DSP_LEN_MAX * DSP_CHANNELS_MAX];
+
+// Interleaved ADC block: each channel is sum of two tones and noise around mid-scale
+static void input(uint16_t channels, uint16_t len, double amplitude)
+{
+  for(uint16_t c = 0; c < channels; c++) {
+    double f1 = rng_range(0.001, 0.05), f2 = rng_range(0.05, 0.45);
+    double a1 = rng_range(0.2, 0.7) * amplitude, a2 = rng_range(0.0, 0.2) * amplitude;
+    double noise = 0.1 * amplitude;
+    for(uint16_t i = 0; i < len; i++) {
+      double value = 32768 + a1 * sin(2 * M_PI * f1 * i) + a2 * sin(2 * M_PI * f2 * i) + rng_range(-noise, noise);
+      adc[i * channels + c] = (uint16_t)value;
+    }
+  }
+}
+
+// Random split of `len` samples into blocks, state must carry over between them
+static uint16_t split(uint16_t *blocks, uint16_t len)
+{
+  uint16_t count = 0;
+  while(len) {
+    uint16_t size = count == 4 ? len : 1 + rng() % len;
+    blocks[count++] = size;
+    len -= size;
+  }
+  return count;
+}
+
+//------------------------------------------------------------------------------------------------- Check
+
+static uint32_t fails;
+static double error_max[4];
+
+static void check_error(uint8_t kernel, const char *name, double error, double limit, uint16_t len)
+{
+  if(error > error_max[kernel]) error_max[kernel] = error;
+  if(error > limit && fails++ < 10) printf("FAIL %s error:%.2f LSB len:%u\n", name, error, len);
+}
+
+static void check_biquad(const int16_t *q, uint16_t stride, uint16_t len)
+{
+  static const DSP_BiquadType_t types[] = { DSP_Biquad_Lowpass, DSP_Biquad_Highpass, DSP_Biquad_Bandpass, DSP_Biquad_Notch };
+  DSP_BiquadCoef_t coef[3];
+  DSP_BiquadState_t state[3];
+  DSP_Biquad_t filter = { .coef = coef, .state = state, .stages = 1 + rng() % 3 };
+  for(uint8_t s = 0; s < filter.stages; s++) {
+    DSP_BiquadType_t type = types[rng() % 4];
+    if(!DSP_BiquadDesign(&coef[s], type, rng_range(10, 200), 1000, rng_range(0.5, 1.0))) s--;
+  }
+  DSP_BiquadInit(&filter);
+  static int16_t out[DSP_LEN_MAX];
+  uint16_t blocks[5], n = split(blocks, len), pos = 0;
+  for(uint16_t b = 0; b < n; b++) {
+    DSP_BiquadQ15(&filter, &q[pos * stride], stride, &out[pos], blocks[b]);
+    pos += blocks[b];
+  }
+  double x1[3] = { 0 }, x2[3] = { 0 }, y1[3] = { 0 }, y2[3] = { 0 }, error = 0;
+  for(uint16_t i = 0; i < len; i++) {
+    double x = q[i * stride];
+    for(uint8_t s = 0; s < filter.stages; s++) {
+      const DSP_BiquadCoef_t *c = &coef[s];
+      double y = (c->b0 * x + c->b1 * x1[s] + c->b2 * x2[s] - c->a1 * y1[s] - c->a2 * y2[s]) / (1 << DSP_BIQUAD_SHIFT);
+      x2[s] = x1[s];
+      x1[s] = x;
+      y2[s] = y1[s];
+      y1[s] = y;
+      x = y;
+    }
+    if(fabs(out[i] - x) > error) error = fabs(out[i] - x);
+  }
+  check_error(0, "DSP_BiquadQ15", error, DSP_LIMIT_BIQUAD, len);
+}
+
+static void check_fir(const int16_t *q, uint16_t stride, uint16_t len)
+{
+  static int16_t coef[64], state[128], out[DSP_LEN_MAX];
+  DSP_Fir_t filter = { .coef = coef, .state = state, .taps = 1 + rng() % 64, .decim = rng() % 8 };
+  // Sum of |coef| up to 1.0, output cannot saturate
+  double sum = 0, weight[64];
+  for(uint16_t k = 0; k < filter.taps; k++) sum += fabs(weight[k] = rng_range(-1, 1));
+  for(uint16_t k = 0; k < filter.taps; k++) coef[k] = (int16_t)(32767 * weight[k] / sum);
+  DSP_FirInit(&filter);
+  uint16_t blocks[5], n = split(blocks, len), pos = 0, count = 0;
+  for(uint16_t b = 0; b < n; b++) {
+    count += DSP_FirQ15(&filter, &q[pos * stride], stride, &out[count], blocks[b]);
+    pos += blocks[b];
+  }
+  uint16_t decim = filter.decim > 1 ? filter.decim : 1, j = 0;
+  double error = 0;
+  for(uint16_t i = decim - 1; i < len; i += decim) {
+    double y = 0;
+    for(uint16_t k = 0; k < filter.taps && k <= i; k++) y += coef[k] * (double)q[(i - k) * stride];
+    y /= 32768;
+    if(j < count && fabs(out[j] - y) > error) error = fabs(out[j] - y);
+    j++;
+  }
+  if(j != count && fails++ < 10) printf("FAIL DSP_FirQ15 outputs:%u expected:%u\n", count, j);
+  check_error(1, "DSP_FirQ15", error, DSP_LIMIT_FIR, len);
+}
+
+static void check_mavg(const int16_t *q, uint16_t stride, uint16_t len)
+{
+  static int16_t window[256], out[DSP_LEN_MAX];
+  DSP_Mavg_t filter = { .window = window, .order = rng() % 9 };
+  DSP_MavgInit(&filter);
+  uint16_t blocks[5], n = split(blocks, len), pos = 0;
+  for(uint16_t b = 0; b < n; b++) {
+    DSP_MavgQ15(&filter, &q[pos * stride], stride, &out[pos], blocks[b]);
+    pos += blocks[b];
+  }
+  uint16_t size = 1 << filter.order;
+  double error = 0, sum = 0;
+  for(uint16_t i = 0; i < len; i++) {
+    sum += q[i * stride];
+    if(i >= size) sum -= q[(i - size) * stride];
+    if(fabs(out[i] - sum / size) > error) error = fabs(out[i] - sum / size);
+  }
+  if(filter.sum != (int32_t)sum && fails++ < 10) printf("FAIL DSP_MavgQ15 sum\n");
+  check_error(2, "DSP_MavgQ15", error, DSP_LIMIT_MAVG, len);
+}
+
+static void check_decim(const int16_t *q, uint16_t stride, uint16_t len)
+{
+  static int16_t out[DSP_LEN_MAX];
+  DSP_Decim_t filter = { .factor = 1 + rng() % 32 };
+  uint16_t blocks[5], n = split(blocks, len), pos = 0, count = 0;
+  for(uint16_t b = 0; b < n; b++) {
+    count += DSP_DecimQ15(&filter, &q[pos * stride], stride, &out[count], blocks[b]);
+    pos += blocks[b];
+  }
+  double error = 0;
+  if(count != len / filter.factor && fails++ < 10) printf("FAIL DSP_DecimQ15 outputs:%u\n", count);
+  for(uint16_t j = 0; j < count; j++) {
+    double y = 0;
+    for(uint16_t k = 0; k < filter.factor; k++) y += q[(j * filter.factor + k) * stride];
+    y /= filter.factor;
+    if(fabs(out[j] - y) > error) error = fabs(out[j] - y);
+  }
+  check_error(3, "DSP_DecimQ15", error, DSP_LIMIT_DECIM, len);
+}
+
+static void check(void)
+{
+  static uint16_t copy[DSP_LEN_MAX * DSP_CHANNELS_MAX];
+  for(uint32_t n = 0; n < DSP_CASES; n++) {
+    uint16_t channels = 1 + rng() % DSP_CHANNELS_MAX;
+    uint16_t len = 16 + rng() % (DSP_LEN_MAX - 16);
+    uint32_t total = (uint32_t)len * channels;
+    // Biquad input is kept lower, resonant stages have gain above 1
+    input(channels, len, n % 2 ? 6000 : 24000);
+    memcpy(copy, adc, total * sizeof(uint16_t));
+    DSP_U16ToQ15(adc, total);
+    const int16_t *q = (const int16_t *)adc;
+    uint16_t c = rng() % channels;
+    if(n % 2) check_biquad(&q[c], channels, len);
+    check_fir(&q[c], channels, len);
+    check_mavg(&q[c], channels, len);
+    check_decim(&q[c], channels, len);
+    DSP_Q15ToU16((int16_t *)adc, total);
+    if(memcmp(copy, adc, total * sizeof(uint16_t)) && fails++ < 10) printf("FAIL DSP_U16ToQ15 round trip\n");
+  }
+}
+
+//------------------------------------------------------------------------------------------------- Benchmark
+
+static double now_ns(void)
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+#define BENCH(name, call) do { \
+  double start = now_ns(); \
+  for(uint16_t r = 0; r < 200; r++) call; \
+  printf("%-24s %8.1f\n", name, (now_ns() - start) / 200 / DSP_LEN_MAX); \
+} while(0)
+
+static void benchmark(void)
+{
+  input(1, DSP_LEN_MAX, 24000);
+  DSP_U16ToQ15(adc, DSP_LEN_MAX);
+  const int16_t *q = (const int16_t *)adc;
+  static int16_t out[DSP_LEN_MAX], fir_coef[31], fir_state[62], window[64];
+  DSP_BiquadCoef_t coef[2];
+  DSP_BiquadState_t state[2];
+  DSP_BiquadDesign(&coef[0], DSP_Biquad_Lowpass, 20, 1000, 0.5412f);
+  DSP_BiquadDesign(&coef[1], DSP_Biquad_Lowpass, 20, 1000, 1.3066f);
+  DSP_Biquad_t biquad = { .coef = coef, .state = state, .stages = 2 };
+  DSP_BiquadInit(&biquad);
+  for(uint16_t k = 0; k < 31; k++) fir_coef[k] = 1000;
+  DSP_Fir_t fir = { .coef = fir_coef, .state = fir_state, .taps = 31 };
+  DSP_FirInit(&fir);
+  DSP_Mavg_t mavg = { .window = window, .order = 6 };
+  DSP_MavgInit(&mavg);
+  DSP_Decim_t decim = { .factor = 10 };
+  printf("%-24s %8s\n", "kernel", "ns/sample");
+  BENCH("biquad 2 stages", DSP_BiquadQ15(&biquad, q, 1, out, DSP_LEN_MAX));
+  BENCH("fir 31 taps", DSP_FirQ15(&fir, q, 1, out, DSP_LEN_MAX));
+  BENCH("moving average 64", DSP_MavgQ15(&mavg, q, 1, out, DSP_LEN_MAX));
+  BENCH("decimator 10", DSP_DecimQ15(&decim, q, 1, out, DSP_LEN_MAX));
+}
+
+//-------------------------------------------------------------------------------------------------
+
+int main(void)
+{
+  check();
+  printf("check: %u cases, %u fails, max error [LSB] biquad:%.2f fir:%.2f mavg:%.2f decim:%.2f\n",
+    DSP_CASES, fails, error_max[0], error_max[1], error_max[2], error_max[3]);
+  if(fails) return 1;
+  benchmark();
+  return 0;
+}
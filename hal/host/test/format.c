@@ -0,0 +1,224 @@
+// hal/host/test/format.c
+// Host check of `xstring` number formatting (`str_format_int`, `str_format_float`) against
+// `itoa_encode` and `snprintf` (randomized values over whole range, exit code `1` on mismatch),
+// followed by throughput benchmark against previous `MBB_Int`/`MBB_Float` path [ns, MB/s].
+//   touch main.h && gcc -std=gnu11 -O2 -I. -Ilib/ext -Ilib/sys hal/host/test/format.c lib/ext/xstring.c -lm -o format && ./format
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#include "xstring.h"
+
+#define FORMAT_CASES 1000000
+
+// Only `str_from_int` and friends allocate, not linked in firmware path tested here
+void *heap_new(size_t size)
+{
+  return malloc(size);
+}
+
+//------------------------------------------------------------------------------------------------- Reference
+
+// Previous `MBB_Int`: reversed digits in shared `StrTempMem`, copied back to front
+static uint8_t old_int(char *str, int64_t nbr, uint8_t base, bool sign, uint8_t fill_zero)
+{
+  uint8_t len = itoa_encode(nbr, StrTempMem, base, sign, fill_zero, 0);
+  for(uint8_t i = 0; i < len; i++) str[i] = StrTempMem[len - 1 - i];
+  return len;
+}
+
+// Previous `MBB_Float`: multiply loop and `int32_t` cast (valid below 2^31 after scaling)
+static uint8_t old_float(char *str, float nbr, uint8_t accuracy)
+{
+  for(uint16_t i = 0; i < accuracy; i++) nbr *= 10;
+  int32_t length = (int32_t)itoa_encode((int32_t)nbr, StrTempMem, 10, true, nbr < 0 ? accuracy + 2 : accuracy + 1, 0);
+  uint8_t n = 0;
+  while(length) {
+    if(accuracy && length == accuracy) str[n++] = '.';
+    str[n++] = StrTempMem[--length];
+  }
+  return n;
+}
+
+//------------------------------------------------------------------------------------------------- Input
+
+static uint32_t rng_state = 0x12345678;
+
+static uint32_t rng(void)
+{
+  rng_state ^= rng_state << 13;
+  rng_state ^= rng_state >> 17;
+  rng_state ^= rng_state << 5;
+  return rng_state;
+}
+
+static uint64_t rng64(void)
+{
+  uint64_t value = (uint64_t)rng() << 32 | rng();
+  // Spread over magnitudes, not only 20-digit numbers
+  return value >> (rng() % 64);
+}
+
+// Any finite float (uniform bit patterns cover subnormals up to `FLT_MAX`)
+static float rng_float(void)
+{
+  union { float f; uint32_t u; } bits;
+  do bits.u = rng();
+  while(((bits.u >> 23) & 0xFF) == 0xFF);
+  return bits.f;
+}
+
+//------------------------------------------------------------------------------------------------- Check
+
+static uint32_t fails;
+
+#define CHECK(cond, what, got, expect) do { \
+  if(!(cond)) { \
+    if(fails++ < 10) printf("FAIL %s got:'%s' expect:'%s'\n", what, got, expect); \
+  } \
+} while(0)
+
+// `snprintf` rounds half to even on exact binary value, `str_format_float` half away from zero
+static bool exact_tie(float nbr, uint8_t accuracy)
+{
+  long double scaled = fabsl((long double)nbr * powl(10, accuracy));
+  return scaled - floorl(scaled) == 0.5L;
+}
+
+static void check(void)
+{
+  char got[STR_NUMBER_SIZE], expect[80];
+  static const uint8_t bases[] = { 2, 7, 8, 10, 16, 36 };
+  for(uint32_t n = 0; n < FORMAT_CASES; n++) {
+    int64_t nbr = (int64_t)rng64();
+    if(rng() & 1) nbr = -nbr;
+    uint8_t base = bases[n % sizeof(bases)];
+    bool sign = rng() & 1;
+    uint8_t fill_zero = rng() % 4 ? 0 : rng() % 24;
+    uint8_t len = str_format_int(got, nbr, base, sign, fill_zero);
+    got[len] = 0;
+    uint8_t old_len = old_int(expect, nbr, base, sign, fill_zero);
+    expect[old_len] = 0;
+    CHECK(!strcmp(got, expect), "str_format_int", got, expect);
+    if(base == 10 && !sign) {
+      snprintf(expect, sizeof(expect), "%llu", (unsigned long long)nbr);
+      len = str_format_int(got, nbr, 10, false, 0);
+      got[len] = 0;
+      CHECK(!strcmp(got, expect), "str_format_int snprintf", got, expect);
+    }
+  }
+  for(uint32_t n = 0; n < FORMAT_CASES; n++) {
+    float nbr = rng_float();
+    uint8_t accuracy = rng() % (STR_FLOAT_ACCURACY_MAX + 1);
+    uint8_t len = str_format_float(got, nbr, accuracy);
+    got[len] = 0;
+    CHECK(len && len <= 31, "str_format_float length", got, "");
+    if(fabsf(nbr) < 0x1p64f) {
+      // `-0.000` from `snprintf` is printed as `0.000`
+      snprintf(expect, sizeof(expect), "%.*f", accuracy, (double)nbr);
+      bool zero = expect[0] == '-' && strspn(&expect[1], "0.") == strlen(&expect[1]);
+      const char *cmp = zero ? &expect[1] : expect;
+      CHECK(!strcmp(got, cmp) || exact_tie(nbr, accuracy), "str_format_float", got, expect);
+    }
+    else {
+      snprintf(expect, sizeof(expect), "%.*e", accuracy, (double)nbr);
+      CHECK(!strcmp(got, expect), "str_format_float exp", got, expect);
+    }
+  }
+  // Values that used to fall out of 64-bit fixed point and print as `Inf`
+  static const struct { float nbr; uint8_t accuracy; const char *text; } cases[] = {
+    { 1e18f, 3, "999999984306749440.000" },
+    { -1e19f, 0, "-9999999980506447872" },
+    { 0x1p63f, 9, "9223372036854775808.000000000" },
+    { 0x1p64f, 3, "1.845e+19" },
+    { -3.4028235e38f, 3, "-3.403e+38" },
+    { 1e30f, 0, "1e+30" },
+    { 9.9999e37f, 2, "1.00e+38" }
+  };
+  for(uint8_t i = 0; i < sizeof(cases) / sizeof(cases[0]); i++) {
+    uint8_t len = str_format_float(got, cases[i].nbr, cases[i].accuracy);
+    got[len] = 0;
+    CHECK(!strcmp(got, cases[i].text), "str_format_float case", got, cases[i].text);
+  }
+}
+
+//------------------------------------------------------------------------------------------------- Benchmark
+
+static double now_ns(void)
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+#define BENCH_COUNT 4096
+#define BENCH_REPS 500
+
+static int64_t ints[BENCH_COUNT];
+static float floats[BENCH_COUNT];
+static volatile uint32_t sink;
+
+typedef enum {
+  FN_OldInt,
+  FN_Int,
+  FN_SnprintfInt,
+  FN_OldFloat,
+  FN_Float,
+  FN_SnprintfFloat
+} FN_t;
+
+// Time per number [ns], output bytes in `bytes`
+static double bench(FN_t fn, double *bytes)
+{
+  char str[80];
+  uint64_t total = 0;
+  double start = now_ns();
+  for(uint32_t r = 0; r < BENCH_REPS; r++) {
+    for(uint32_t i = 0; i < BENCH_COUNT; i++) {
+      uint8_t len = 0;
+      switch(fn) {
+        case FN_OldInt: len = old_int(str, ints[i], 10, true, 0); break;
+        case FN_Int: len = str_format_int(str, ints[i], 10, true, 0); break;
+        case FN_SnprintfInt: len = (uint8_t)snprintf(str, sizeof(str), "%lld", (long long)ints[i]); break;
+        case FN_OldFloat: len = old_float(str, floats[i], 3); break;
+        case FN_Float: len = str_format_float(str, floats[i], 3); break;
+        case FN_SnprintfFloat: len = (uint8_t)snprintf(str, sizeof(str), "%.3f", (double)floats[i]); break;
+      }
+      total += len;
+      sink += (uint8_t)str[0];
+    }
+  }
+  double ns = now_ns() - start;
+  *bytes = (double)total;
+  return ns / ((double)BENCH_REPS * BENCH_COUNT);
+}
+
+static void benchmark(void)
+{
+  // Log-like values: counters and readings in range of previous float path
+  for(uint32_t i = 0; i < BENCH_COUNT; i++) {
+    ints[i] = (int32_t)rng() >> (rng() % 24);
+    floats[i] = (float)((int32_t)rng() >> 8) / 256.0f;
+  }
+  static const char *names[] = { "int old", "int", "int snprintf", "float.3 old", "float.3", "float.3 snprintf" };
+  printf("%-18s %10s %10s   [random, accuracy 3]\n", "format", "ns/number", "MB/s");
+  for(FN_t fn = FN_OldInt; fn <= FN_SnprintfFloat; fn++) {
+    double bytes;
+    double ns = bench(fn, &bytes);
+    double mbs = bytes / (ns * BENCH_REPS * BENCH_COUNT) * 1e3;
+    printf("%-18s %10.1f %10.1f\n", names[fn], ns, mbs);
+  }
+}
+
+//-------------------------------------------------------------------------------------------------
+
+int main(void)
+{
+  check();
+  printf("check: %u cases, %u fails\n", 2 * FORMAT_CASES, fails);
+  if(fails) return 1;
+  benchmark();
+  return 0;
+}
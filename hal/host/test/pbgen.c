@@ -0,0 +1,246 @@
+// hal/host/test/pbgen.c
+// Host check of `pbgen.py` codecs against generic (descriptor-driven) nanopb on sample
+// `pbgen.proto` (randomized messages, exit code `1` on mismatch), followed by benchmark [msg/s].
+//   python3 lib/pb/pbgen.py hal/host/test/pbgen.proto . &&
+//   gcc -std=gnu11 -Os -I. -Ilib/pb hal/host/test/pbgen.c pbgen.pb.c lib/pb/pb_*.c -o pbgen && ./pbgen
+// Code size: build with `-DPBGEN_SIZE=1` (generic) and `-DPBGEN_SIZE=2` (generated),
+// add `-ffunction-sections -fdata-sections -Wl,--gc-sections` and compare `size` of both.
+
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include "pbgen.pb.h"
+
+#define PBGEN_CASES 100000
+#define PBGEN_BUFF_SIZE 512
+
+#if(PBGEN_SIZE)
+
+//------------------------------------------------------------------------------------------------- Size
+
+static ParamSet msg;
+static uint8_t buff[PBGEN_BUFF_SIZE];
+
+// Only encode and decode of `ParamSet` is linked in
+int main(void)
+{
+  pb_ostream_t os = pb_ostream_from_buffer(buff, sizeof(buff));
+  pb_istream_t is = pb_istream_from_buffer(buff, sizeof(buff));
+  #if(PBGEN_SIZE == 2)
+    return ParamSet_Encode(&os, &msg) + ParamSet_Decode(&is, &msg);
+  #else
+    return pb_encode(&os, ParamSet_fields, &msg) + pb_decode(&is, ParamSet_fields, &msg);
+  #endif
+}
+
+#else
+
+//------------------------------------------------------------------------------------------------- Input
+
+static uint32_t rng_state = 0x12345678;
+
+static uint32_t rng(void)
+{
+  rng_state ^= rng_state << 13;
+  rng_state ^= rng_state >> 17;
+  rng_state ^= rng_state << 5;
+  return rng_state;
+}
+
+// Mix of zero (skipped by proto3), small, negative and full-range values
+static int32_t rng_value(void)
+{
+  switch(rng() % 5) {
+    case 0: return 0;
+    case 1: return (int8_t)rng();
+    case 2: return (int16_t)rng();
+    default: return (int32_t)rng();
+  }
+}
+
+static void random_message(ParamSet *msg)
+{
+  memset(msg, 0, sizeof(*msg));
+  msg->version = rng_value();
+  uint8_t len = rng() % sizeof(msg->name);
+  for(uint8_t i = 0; i < len; i++) msg->name[i] = 'a' + rng() % 26;
+  msg->period_ms = rng_value();
+  msg->trim = rng_value();
+  msg->autostart = rng() & 1;
+  msg->kp = (float)rng_value() / 1000;
+  msg->ki = rng() % 4 ? (float)rng_value() / 7 : -0.0f;
+  msg->kd = (float)rng_value();
+  msg->channels_count = rng() % 9;
+  for(uint8_t i = 0; i < msg->channels_count; i++) {
+    Channel *channel = &msg->channels[i];
+    channel->id = rng_value();
+    channel->gain = (float)rng_value() / 3;
+    channel->offset = (float)rng_value() / 5;
+    channel->min = rng_value();
+    channel->max = rng_value();
+    channel->enabled = rng() & 1;
+    channel->unit = (Unit)(rng() % 4);
+  }
+  msg->limits_count = rng() % 9;
+  for(uint8_t i = 0; i < msg->limits_count; i++) msg->limits[i] = rng_value();
+  msg->has_serial = rng() & 1;
+  if(msg->has_serial) msg->serial = (uint64_t)rng() << 32 | rng();
+  msg->key.size = rng() % 17;
+  for(uint8_t i = 0; i < msg->key.size; i++) msg->key.bytes[i] = (uint8_t)rng();
+}
+
+// Representative message for benchmark: all channels and limits in use
+static void full_message(ParamSet *msg)
+{
+  memset(msg, 0, sizeof(*msg));
+  msg->version = 7;
+  strcpy(msg->name, "mixer-line-2");
+  msg->period_ms = 250;
+  msg->trim = -12;
+  msg->autostart = true;
+  msg->kp = 1.5f;
+  msg->ki = 0.02f;
+  msg->kd = 0.3f;
+  msg->channels_count = 8;
+  for(uint8_t i = 0; i < 8; i++) {
+    Channel *channel = &msg->channels[i];
+    channel->id = i + 1;
+    channel->gain = 1.0f + i;
+    channel->offset = -0.5f * i;
+    channel->min = -1000 * i;
+    channel->max = 4000 + i;
+    channel->enabled = i & 1;
+    channel->unit = (Unit)(i % 4);
+  }
+  msg->limits_count = 6;
+  for(uint8_t i = 0; i < 6; i++) msg->limits[i] = 100 * i * i;
+  msg->has_serial = true;
+  msg->serial = 0x0123456789ABCDEFull;
+  msg->key.size = 8;
+  memcpy(msg->key.bytes, "\x13\x37\xC0\xDE\xBA\xAD\xF0\x0D", 8);
+}
+
+//------------------------------------------------------------------------------------------------- Check
+
+static uint32_t fails;
+
+#define CHECK(cond, what, n) do { \
+  if(!(cond)) { \
+    if(fails++ < 10) printf("FAIL %s case:%u\n", what, (unsigned)(n)); \
+  } \
+} while(0)
+
+static void check(void)
+{
+  static ParamSet msg, generic, generated;
+  static uint8_t a[PBGEN_BUFF_SIZE], b[PBGEN_BUFF_SIZE];
+  for(uint32_t n = 0; n < PBGEN_CASES; n++) {
+    random_message(&msg);
+    pb_ostream_t os_a = pb_ostream_from_buffer(a, sizeof(a));
+    pb_ostream_t os_b = pb_ostream_from_buffer(b, sizeof(b));
+    bool ok_a = pb_encode(&os_a, ParamSet_fields, &msg);
+    bool ok_b = ParamSet_Encode(&os_b, &msg);
+    CHECK(ok_a && ok_b, "encode", n);
+    CHECK(os_a.bytes_written == os_b.bytes_written && !memcmp(a, b, os_a.bytes_written), "encode bytes", n);
+    CHECK(ParamSet_Size(&msg) == os_a.bytes_written, "ParamSet_Size", n);
+    // Decoded structs are compared as memory: generated decoder clears padding and unused
+    // array entries too, generic one only sets fields
+    memset(&generic, 0, sizeof(generic));
+    memset(&generated, 0x5A, sizeof(generated));
+    pb_istream_t is_a = pb_istream_from_buffer(a, os_a.bytes_written);
+    pb_istream_t is_b = pb_istream_from_buffer(a, os_a.bytes_written);
+    ok_a = pb_decode(&is_a, ParamSet_fields, &generic);
+    ok_b = ParamSet_Decode(&is_b, &generated);
+    CHECK(ok_a && ok_b, "decode", n);
+    CHECK(!memcmp(&generic, &generated, sizeof(generic)), "decode struct", n);
+    // Truncated input: both reject at every cut of short messages
+    if(os_a.bytes_written < 64) {
+      for(size_t cut = 0; cut < os_a.bytes_written; cut++) {
+        memset(&generic, 0, sizeof(generic));
+        is_a = pb_istream_from_buffer(a, cut);
+        is_b = pb_istream_from_buffer(a, cut);
+        ok_a = pb_decode(&is_a, ParamSet_fields, &generic);
+        ok_b = ParamSet_Decode(&is_b, &generated);
+        CHECK(ok_a == ok_b, "decode truncated", n);
+      }
+    }
+  }
+  // Unknown field (tag 15) and unpacked `limits` are accepted like by generic decoder
+  static const uint8_t unknown[] = { 0x08, 0x05, 0x78, 0x03, 0x50, 0x01, 0x50, 0x02, 0x7D, 1, 2, 3, 4, 0x18, 0x09 };
+  memset(&generic, 0, sizeof(generic));
+  memset(&generated, 0x5A, sizeof(generated));
+  pb_istream_t is_a = pb_istream_from_buffer(unknown, sizeof(unknown));
+  pb_istream_t is_b = pb_istream_from_buffer(unknown, sizeof(unknown));
+  bool ok_a = pb_decode(&is_a, ParamSet_fields, &generic);
+  bool ok_b = ParamSet_Decode(&is_b, &generated);
+  CHECK(ok_a && ok_b && !memcmp(&generic, &generated, sizeof(generic)) && generated.limits_count == 2, "unknown field", 0);
+}
+
+//------------------------------------------------------------------------------------------------- Benchmark
+
+static double now_ns(void)
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+static volatile uint32_t sink;
+
+// Messages per second, `generated` selects `pbgen` codec
+static double bench_decode(const uint8_t *data, size_t size, bool generated)
+{
+  static ParamSet msg;
+  uint32_t reps = 500000;
+  double start = now_ns();
+  for(uint32_t r = 0; r < reps; r++) {
+    pb_istream_t is = pb_istream_from_buffer(data, size);
+    if(generated) ParamSet_Decode(&is, &msg);
+    else pb_decode(&is, ParamSet_fields, &msg);
+    sink += msg.version;
+  }
+  return reps / (now_ns() - start) * 1e9;
+}
+
+static double bench_encode(const ParamSet *msg, bool generated)
+{
+  static uint8_t data[PBGEN_BUFF_SIZE];
+  uint32_t reps = 500000;
+  double start = now_ns();
+  for(uint32_t r = 0; r < reps; r++) {
+    pb_ostream_t os = pb_ostream_from_buffer(data, sizeof(data));
+    if(generated) ParamSet_Encode(&os, msg);
+    else pb_encode(&os, ParamSet_fields, msg);
+    sink += os.bytes_written;
+  }
+  return reps / (now_ns() - start) * 1e9;
+}
+
+static void benchmark(void)
+{
+  static ParamSet msg;
+  static uint8_t data[PBGEN_BUFF_SIZE];
+  full_message(&msg);
+  pb_ostream_t os = pb_ostream_from_buffer(data, sizeof(data));
+  pb_encode(&os, ParamSet_fields, &msg);
+  printf("ParamSet %u B %14s %14s %8s   [msg/s]\n", (unsigned)os.bytes_written, "generic", "pbgen", "speedup");
+  double generic = bench_decode(data, os.bytes_written, false);
+  double generated = bench_decode(data, os.bytes_written, true);
+  printf("%-14s %14.0f %14.0f %7.2fx\n", "decode", generic, generated, generated / generic);
+  generic = bench_encode(&msg, false);
+  generated = bench_encode(&msg, true);
+  printf("%-14s %14.0f %14.0f %7.2fx\n", "encode", generic, generated, generated / generic);
+}
+
+//-------------------------------------------------------------------------------------------------
+
+int main(void)
+{
+  check();
+  printf("check: %u cases, %u fails\n", PBGEN_CASES, fails);
+  if(fails) return 1;
+  benchmark();
+  return 0;
+}
+
+#endif
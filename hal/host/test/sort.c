@@ -0,0 +1,243 @@
+// hal/host/test/sort.c
+// Host check of `xmath` sort and select kernels against insertion sort and quickselect
+// they replaced (randomized input, exit code `1` on mismatch), followed by benchmark.
+//   gcc -std=gnu11 -O2 -Ilib/ext hal/host/test/sort.c lib/ext/xmath.c -lm -o sort && ./sort
+
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include "xmath.h"
+
+#define SORT_CASES 4000
+#define SORT_LEN_MAX 4096
+
+//------------------------------------------------------------------------------------------------- Reference
+
+// Previous `sort_asc_*`/`sort_desc_*` implementation
+#define OLD_SORT(name, type, cmp) \
+  static void name(type *array, uint16_t len) \
+  { \
+    for(uint16_t i = 1; i < len; i++) { \
+      type key = array[i]; \
+      int32_t j = i - 1; \
+      while(j >= 0 && array[j] cmp key) { \
+        array[j + 1] = array[j]; \
+        j--; \
+      } \
+      array[j + 1] = key; \
+    } \
+  }
+
+OLD_SORT(old_asc_u16, uint16_t, >)
+OLD_SORT(old_asc_i16, int16_t, >)
+OLD_SORT(old_desc_u16, uint16_t, <)
+OLD_SORT(old_desc_i16, int16_t, <)
+OLD_SORT(old_asc_u32, uint32_t, >)
+OLD_SORT(old_asc_i32, int32_t, >)
+OLD_SORT(old_desc_u32, uint32_t, <)
+OLD_SORT(old_desc_i32, int32_t, <)
+
+// Previous `select_u16` used by `mid_mean_u16`
+static void old_select_u16(uint16_t *array, uint16_t len, uint16_t nth)
+{
+  if(len < 2 || nth >= len) return;
+  uint16_t left = 0;
+  uint16_t right = len - 1;
+  while(left < right) {
+    uint16_t mid = left + (right - left) / 2;
+    uint16_t a = array[left];
+    uint16_t b = array[mid];
+    uint16_t c = array[right];
+    uint16_t pivot;
+    if(a < b) pivot = (b < c) ? b : ((a < c) ? c : a);
+    else pivot = (a < c) ? a : ((b < c) ? c : b);
+    uint16_t i = left;
+    uint16_t j = right;
+    while(1) {
+      while(i <= right && array[i] < pivot) i++;
+      while(j > left && array[j] > pivot) j--;
+      if(i >= j) break;
+      uint16_t tmp = array[i];
+      array[i] = array[j];
+      array[j] = tmp;
+      i++;
+      if(j == 0) break;
+      j--;
+    }
+    if(nth <= j) right = j;
+    else left = j + 1;
+  }
+}
+
+static float old_mid_mean_u16(uint16_t *buff, uint16_t len)
+{
+  if(len == 0) return 0.0f;
+  if(len <= 2) return avg_u16(buff, len);
+  uint16_t size = len / 3;
+  if(size == 0) return avg_u16(buff, len);
+  uint16_t start = size;
+  old_select_u16(buff, len, start);
+  old_select_u16(&buff[start], len - start, size - 1);
+  return avg_u16(&buff[start], size);
+}
+
+//------------------------------------------------------------------------------------------------- Input
+
+static uint32_t rng_state = 0x12345678;
+
+static uint32_t rng(void)
+{
+  rng_state ^= rng_state << 13;
+  rng_state ^= rng_state >> 17;
+  rng_state ^= rng_state << 5;
+  return rng_state;
+}
+
+typedef enum {
+  INPUT_Random,
+  INPUT_Ascending,
+  INPUT_Descending,
+  INPUT_FewUnique,
+  INPUT_Count
+} INPUT_t;
+
+static uint32_t input_value(INPUT_t input, uint16_t i, uint16_t len)
+{
+  switch(input) {
+    case INPUT_Ascending: return i * 7u;
+    case INPUT_Descending: return (uint32_t)(len - i) * 7u;
+    case INPUT_FewUnique: return rng() % 4;
+    default: return rng();
+  }
+}
+
+//------------------------------------------------------------------------------------------------- Check
+
+static uint32_t fails;
+
+#define CHECK(cond, what, len) do { \
+  if(!(cond)) { \
+    if(fails++ < 10) printf("FAIL %s len:%u\n", what, (unsigned)(len)); \
+  } \
+} while(0)
+
+#define CHECK_SORT(type, src, len, new_fn, old_fn) do { \
+  static type a[SORT_LEN_MAX], b[SORT_LEN_MAX]; \
+  for(uint16_t k = 0; k < len; k++) a[k] = b[k] = (type)src[k]; \
+  new_fn(a, len); \
+  old_fn(b, len); \
+  CHECK(!memcmp(a, b, len * sizeof(type)), #new_fn, len); \
+} while(0)
+
+#define CHECK_NTH(type, src, len, fn, old_fn) do { \
+  static type a[SORT_LEN_MAX], b[SORT_LEN_MAX]; \
+  for(uint16_t k = 0; k < len; k++) a[k] = b[k] = (type)src[k]; \
+  old_fn(b, len); \
+  uint16_t nth = rng() % len; \
+  type value = fn(a, len, nth); \
+  CHECK(value == b[nth] && a[nth] == b[nth], #fn, len); \
+  for(uint16_t k = 0; k < len; k++) { \
+    CHECK(k < nth ? a[k] <= value : a[k] >= value, #fn " partition", len); \
+  } \
+} while(0)
+
+static void check(void)
+{
+  static uint32_t src[SORT_LEN_MAX];
+  static uint16_t a[SORT_LEN_MAX], b[SORT_LEN_MAX], temp[SORT_LEN_MAX];
+  static int16_t sa[SORT_LEN_MAX], sb[SORT_LEN_MAX], stemp[SORT_LEN_MAX];
+  for(uint32_t n = 0; n < SORT_CASES; n++) {
+    // Mostly small arrays (AIN window sizes), some up to limit
+    uint16_t len = n % 8 ? rng() % 600 : rng() % SORT_LEN_MAX;
+    INPUT_t input = (INPUT_t)(n % INPUT_Count);
+    for(uint16_t i = 0; i < len; i++) src[i] = input_value(input, i, len);
+    CHECK_SORT(uint16_t, src, len, sort_asc_u16, old_asc_u16);
+    CHECK_SORT(int16_t, src, len, sort_asc_i16, old_asc_i16);
+    CHECK_SORT(uint16_t, src, len, sort_desc_u16, old_desc_u16);
+    CHECK_SORT(int16_t, src, len, sort_desc_i16, old_desc_i16);
+    CHECK_SORT(uint32_t, src, len, sort_asc_u32, old_asc_u32);
+    CHECK_SORT(int32_t, src, len, sort_asc_i32, old_asc_i32);
+    CHECK_SORT(uint32_t, src, len, sort_desc_u32, old_desc_u32);
+    CHECK_SORT(int32_t, src, len, sort_desc_i32, old_desc_i32);
+    for(uint16_t i = 0; i < len; i++) {
+      a[i] = b[i] = (uint16_t)src[i];
+      sa[i] = sb[i] = (int16_t)src[i];
+    }
+    sort_radix_u16(a, len, temp);
+    old_asc_u16(b, len);
+    CHECK(!memcmp(a, b, len * sizeof(uint16_t)), "sort_radix_u16", len);
+    sort_radix_i16(sa, len, stemp);
+    old_asc_i16(sb, len);
+    CHECK(!memcmp(sa, sb, len * sizeof(int16_t)), "sort_radix_i16", len);
+    if(!len) continue;
+    CHECK_NTH(uint16_t, src, len, nth_u16, old_asc_u16);
+    CHECK_NTH(int16_t, src, len, nth_i16, old_asc_i16);
+    CHECK_NTH(uint32_t, src, len, nth_u32, old_asc_u32);
+    CHECK_NTH(int32_t, src, len, nth_i32, old_asc_i32);
+    for(uint16_t i = 0; i < len; i++) a[i] = b[i] = (uint16_t)src[i];
+    CHECK(mid_mean_u16(a, len) == old_mid_mean_u16(b, len), "mid_mean_u16", len);
+  }
+}
+
+//------------------------------------------------------------------------------------------------- Benchmark
+
+static double now_ns(void)
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+static void bench_old_nth(uint16_t *array, uint16_t len)
+{
+  old_select_u16(array, len, len / 2);
+}
+
+static void bench_nth(uint16_t *array, uint16_t len)
+{
+  nth_u16(array, len, len / 2);
+}
+
+static uint16_t bench_temp[SORT_LEN_MAX];
+
+static void bench_radix(uint16_t *array, uint16_t len)
+{
+  sort_radix_u16(array, len, bench_temp);
+}
+
+// Average time of one call [ns], copy of input included
+static double bench(void (*fn)(uint16_t *, uint16_t), const uint16_t *src, uint16_t len)
+{
+  static uint16_t work[SORT_LEN_MAX];
+  uint32_t reps = 4000000 / ((uint32_t)len * len / 8 + len + 1) + 3;
+  double start = now_ns();
+  for(uint32_t r = 0; r < reps; r++) {
+    memcpy(work, src, len * sizeof(uint16_t));
+    fn(work, len);
+  }
+  return (now_ns() - start) / reps;
+}
+
+static void benchmark(void)
+{
+  static uint16_t src[SORT_LEN_MAX];
+  printf("%6s %12s %12s %12s %12s %12s   [ns/call, random u16]\n",
+    "len", "insertion", "introsort", "radix", "old select", "nth");
+  for(uint32_t len = 8; len <= SORT_LEN_MAX; len *= 2) {
+    for(uint32_t i = 0; i < len; i++) src[i] = (uint16_t)rng();
+    printf("%6u %12.0f %12.0f %12.0f %12.0f %12.0f\n", len,
+      bench(old_asc_u16, src, len), bench(sort_asc_u16, src, len), bench(bench_radix, src, len),
+      bench(bench_old_nth, src, len), bench(bench_nth, src, len));
+  }
+}
+
+//-------------------------------------------------------------------------------------------------
+
+int main(void)
+{
+  check();
+  printf("check: %u cases, %u fails\n", SORT_CASES, fails);
+  if(fails) return 1;
+  benchmark();
+  return 0;
+}
@@ -42,6 +42,20 @@ static uint64_t time_ms_get(void)
   #endif
 }
 
+static uint64_t time_us_get(void)
+{
+  #if defined(_WIN32) || defined(_WIN64)
+    FILETIME ft;
+    GetSystemTimeAsFileTime(&ft);
+    uint64_t t = ((uint64_t)ft.dwHighDateTime << 32) | ft.dwLowDateTime;
+    return t / 10;
+  #else
+    struct timeval tv;
+    gettimeofday(&tv, NULL);
+    return (uint64_t)tv.tv_sec * 1000000 + tv.tv_usec;
+  #endif
+}
+
 static inline uint64_t vrts_ticker_get(void)
 {
   return (time_ms_get() - start_time_ms) / tick_ms;
@@ -164,6 +178,11 @@ int32_t tick_diff(uint64_t tick)
   return (int32_t)(((int64_t)vrts_ticker_get() - tick) * tick_ms);
 }
 
+uint32_t tick_us(void)
+{
+  return (uint32_t)(time_us_get() - start_time_ms * 1000);
+}
+
 //------------------------------------------------------------------------------------------------- Delay
 
 void delay(uint32_t ms)
@@ -63,6 +63,12 @@ bool tick_away(uint64_t *tick);
  */
 int32_t tick_diff(uint64_t tick);
 
+/**
+ * @brief Free-running microsecond clock for short time measurements
+ * @return Time in microseconds, wraps every ~71 minutes (compare with subtraction)
+ */
+uint32_t tick_us(void);
+
 //------------------------------------------------------------------------------------------------- Delay
 
 // Delays for `ms` milliseconds, yields to other threads
@@ -4,72 +4,147 @@
 
 //-------------------------------------------------------------------------------------------------
 
-static inline void I2C_Master_StartRead(I2C_Master_t *i2c)
+#define I2C_MASTER_IRQ (I2C_CR1_TXIE | I2C_CR1_RXIE | I2C_CR1_TCIE | I2C_CR1_STOPIE | I2C_CR1_NACKIE | I2C_CR1_ERRIE)
+
+static void I2C_Master_Next(I2C_Master_t *i2c);
+
+// Byte `index` of write part (`head`, then `tx`)
+static inline uint8_t I2C_Master_TxByte(I2C_Transfer_t *transfer, uint16_t index)
 {
-  i2c->_busy = false;
-  I2C_Master_Read(i2c, i2c->_addr, i2c->_rx_ptr, i2c->_size);
-  i2c->_size = 0;
+  return index < transfer->head_len ? transfer->head[index] : transfer->tx[index - transfer->head_len];
 }
 
-static void I2C_Master_IRQHandler(I2C_Master_t *i2c)
+static void I2C_Master_StartWrite(I2C_Master_t *i2c, I2C_Transfer_t *transfer)
 {
-  // Transfer complete - start read phase if pending
-  if((i2c->reg->CR1 & I2C_CR1_TCIE) && (i2c->reg->ISR & I2C_ISR_TC)) {
-    i2c->reg->CR1 &= ~I2C_CR1_TCIE;
-    if(i2c->_size) I2C_Master_StartRead(i2c);
-  }
-  // TX buffer empty (interrupt mode)
-  if(!i2c->tx_dma) {
-    if((i2c->reg->CR1 & I2C_CR1_TXIE) && (i2c->reg->ISR & I2C_ISR_TXE)) {
-      i2c->reg->TXDR = i2c->_tx_ptr[i2c->_tail];
-      i2c->_tail++;
-      if(i2c->_tail >= i2c->_head) {
-        i2c->reg->CR1 &= ~I2C_CR1_TXIE;
-        if(i2c->_size) I2C_Master_StartRead(i2c);
-        else i2c->reg->CR1 |= I2C_CR1_STOPIE;
-      }
-    }
-  }
-  // RX buffer not empty (interrupt mode)
-  if(!i2c->rx_dma) {
-    if((i2c->reg->CR1 & I2C_CR1_RXIE) && (i2c->reg->ISR & I2C_ISR_RXNE)) {
-      i2c->_rx_ptr[i2c->_tail] = i2c->reg->RXDR;
-      i2c->_tail++;
-      if(i2c->_tail >= i2c->_head) {
-        i2c->reg->CR1 &= ~I2C_CR1_RXIE;
-        i2c->reg->CR1 |= I2C_CR1_STOPIE;
-      }
-    }
+  uint16_t len = transfer->head_len + transfer->tx_len;
+  i2c->_tail = 0;
+  uint32_t cr1 = I2C_CR1_NACKIE | I2C_CR1_ERRIE | I2C_CR1_STOPIE;
+  if(transfer->rx_len) cr1 |= I2C_CR1_TCIE;
+  if(i2c->tx_dma && transfer->tx_len) {
+    i2c->_tx_dma.cha->CCR &= ~DMA_CCR_EN;
+    i2c->_tx_dma.cha->CMAR = (uint32_t)transfer->tx;
+    i2c->_tx_dma.cha->CNDTR = transfer->tx_len;
+    // Short `head` goes from interrupt, DMA takes over after it
+    if(transfer->head_len) cr1 |= I2C_CR1_TXIE;
+    else i2c->_tx_dma.cha->CCR |= DMA_CCR_EN;
   }
-  // Stop condition
-  if((i2c->reg->CR1 & I2C_CR1_STOPIE) && (i2c->reg->ISR & I2C_ISR_STOPF)) {
-    i2c->reg->ICR |= I2C_ICR_STOPCF;
-    i2c->reg->CR1 &= ~I2C_CR1_STOPIE;
-    i2c->_busy = false;
-    heap_free((void *)&i2c->_tx_buffer);
-    i2c->_tx_buffer = NULL;
+  else cr1 |= I2C_CR1_TXIE;
+  i2c->reg->CR1 = (i2c->reg->CR1 & ~I2C_MASTER_IRQ) | cr1;
+  i2c->reg->CR2 = ((uint32_t)len << I2C_CR2_NBYTES_Pos) | (transfer->addr << 1) | I2C_CR2_START |
+    (transfer->rx_len ? 0 : I2C_CR2_AUTOEND);
+}
+
+static void I2C_Master_StartRead(I2C_Master_t *i2c, I2C_Transfer_t *transfer)
+{
+  i2c->_tail = 0;
+  uint32_t cr1 = I2C_CR1_NACKIE | I2C_CR1_ERRIE | I2C_CR1_STOPIE;
+  if(i2c->rx_dma) {
+    i2c->_rx_dma.cha->CCR &= ~DMA_CCR_EN;
+    i2c->_rx_dma.cha->CMAR = (uint32_t)transfer->rx;
+    i2c->_rx_dma.cha->CNDTR = transfer->rx_len;
+    i2c->_rx_dma.cha->CCR |= DMA_CCR_EN;
   }
-  // NACK received
-  if((i2c->reg->CR1 & I2C_CR1_NACKIE) && (i2c->reg->ISR & I2C_ISR_NACKF)) {
-    i2c->reg->ICR |= I2C_ICR_NACKCF;
-    i2c->reg->CR1 &= ~I2C_CR1_NACKIE;
-    i2c->_busy = false;
+  else cr1 |= I2C_CR1_RXIE;
+  i2c->reg->CR1 = (i2c->reg->CR1 & ~I2C_MASTER_IRQ) | cr1;
+  // Repeated start when write part was sent
+  i2c->reg->CR2 = ((uint32_t)transfer->rx_len << I2C_CR2_NBYTES_Pos) | I2C_CR2_RD_WRN |
+    (transfer->addr << 1) | I2C_CR2_AUTOEND | I2C_CR2_START;
+}
+
+// End active transfer, run its callback and start next one
+static void I2C_Master_Finish(I2C_Master_t *i2c, status_t status)
+{
+  I2C_Transfer_t *transfer = i2c->_active;
+  i2c->reg->CR1 &= ~I2C_MASTER_IRQ;
+  if(i2c->tx_dma) i2c->_tx_dma.cha->CCR &= ~DMA_CCR_EN;
+  if(i2c->rx_dma) i2c->_rx_dma.cha->CCR &= ~DMA_CCR_EN;
+  i2c->reg->ISR |= I2C_ISR_TXE; // Flush byte left after NACK
+  i2c->_active = NULL;
+  if(transfer) {
+    if(status == OK) {
+      i2c->count++;
+      i2c->bytes += transfer->head_len + transfer->tx_len + transfer->rx_len;
+    }
+    else i2c->errors++;
+    transfer->status = status;
+    if(transfer->Done) transfer->Done(transfer);
   }
+  I2C_Master_Next(i2c);
 }
 
-static void I2C_Master_DMA_TX_IRQHandler(I2C_Master_t *i2c)
+// Start first queued transfer if bus is idle (called from interrupt or with interrupts off)
+static void I2C_Master_Next(I2C_Master_t *i2c)
 {
-  if(i2c->_tx_dma.reg->ISR & DMA_ISR_TCIF(i2c->_tx_dma.pos)) {
-    i2c->_tx_dma.reg->IFCR |= DMA_ISR_TCIF(i2c->_tx_dma.pos);
-    i2c->reg->CR1 |= I2C_CR1_STOPIE;
+  while(!i2c->_active && i2c->_queue_tail != i2c->_queue_head) {
+    I2C_Transfer_t *transfer = i2c->_queue[i2c->_queue_tail];
+    i2c->_queue_tail = (i2c->_queue_tail + 1) % I2C_QUEUE_SIZE;
+    if(transfer->status != BUSY) continue; // Aborted while queued
+    i2c->_active = transfer;
+    i2c->_error = false;
+    if(transfer->head_len > sizeof(transfer->head) || transfer->head_len + transfer->tx_len > 255 || transfer->rx_len > 255) {
+      I2C_Master_Finish(i2c, ERR);
+      return;
+    }
+    if(transfer->head_len + transfer->tx_len) I2C_Master_StartWrite(i2c, transfer);
+    else if(transfer->rx_len) I2C_Master_StartRead(i2c, transfer);
+    else {
+      I2C_Master_Finish(i2c, OK);
+      return;
+    }
   }
 }
 
-static void I2C_Master_DMA_RX_IRQHandler(I2C_Master_t *i2c)
+// Software reset: clears bus state, keeps configuration
+static void I2C_Master_Restart(I2C_Master_t *i2c)
+{
+  i2c->reg->CR1 &= ~I2C_CR1_PE;
+  while(i2c->reg->CR1 & I2C_CR1_PE);
+  i2c->reg->CR1 |= I2C_CR1_PE;
+}
+
+static void I2C_Master_IRQHandler(I2C_Master_t *i2c)
 {
-  if(i2c->_rx_dma.reg->ISR & DMA_ISR_TCIF(i2c->_rx_dma.pos)) {
-    i2c->_rx_dma.reg->IFCR |= DMA_ISR_TCIF(i2c->_rx_dma.pos);
-    i2c->reg->CR1 |= I2C_CR1_STOPIE;
+  I2C_Transfer_t *transfer = i2c->_active;
+  uint32_t isr = i2c->reg->ISR;
+  uint32_t cr1 = i2c->reg->CR1;
+  if(!transfer) {
+    i2c->reg->CR1 &= ~I2C_MASTER_IRQ;
+    return;
+  }
+  // Bus error or arbitration lost: no STOP of ours will come
+  if((cr1 & I2C_CR1_ERRIE) && (isr & (I2C_ISR_BERR | I2C_ISR_ARLO))) {
+    i2c->reg->ICR = I2C_ICR_BERRCF | I2C_ICR_ARLOCF;
+    I2C_Master_Restart(i2c);
+    I2C_Master_Finish(i2c, ERR);
+    return;
+  }
+  // NACK: peripheral sends STOP by itself, transfer ends on STOPF
+  if((cr1 & I2C_CR1_NACKIE) && (isr & I2C_ISR_NACKF)) {
+    i2c->reg->ICR = I2C_ICR_NACKCF;
+    i2c->reg->CR1 &= ~(I2C_CR1_TXIE | I2C_CR1_RXIE | I2C_CR1_TCIE);
+    i2c->_error = true;
+  }
+  // TX register empty: `head` bytes (DMA mode) or all bytes (interrupt mode)
+  if((i2c->reg->CR1 & I2C_CR1_TXIE) && (isr & I2C_ISR_TXIS)) {
+    i2c->reg->TXDR = I2C_Master_TxByte(transfer, i2c->_tail++);
+    bool dma = i2c->tx_dma && transfer->tx_len;
+    if(i2c->_tail >= (dma ? transfer->head_len : transfer->head_len + transfer->tx_len)) {
+      i2c->reg->CR1 &= ~I2C_CR1_TXIE;
+      if(dma) i2c->_tx_dma.cha->CCR |= DMA_CCR_EN;
+    }
+  }
+  // RX register not empty (interrupt mode)
+  if((i2c->reg->CR1 & I2C_CR1_RXIE) && (isr & I2C_ISR_RXNE)) {
+    transfer->rx[i2c->_tail++] = i2c->reg->RXDR;
+    if(i2c->_tail >= transfer->rx_len) i2c->reg->CR1 &= ~I2C_CR1_RXIE;
+  }
+  // Write part done without STOP: read part follows
+  if((i2c->reg->CR1 & I2C_CR1_TCIE) && (isr & I2C_ISR_TC)) {
+    I2C_Master_StartRead(i2c, transfer);
+  }
+  if((i2c->reg->CR1 & I2C_CR1_STOPIE) && (isr & I2C_ISR_STOPF)) {
+    i2c->reg->ICR = I2C_ICR_STOPCF;
+    I2C_Master_Finish(i2c, i2c->_error ? ERR : OK);
   }
 }
 
@@ -78,21 +153,20 @@ static void I2C_Master_DMA_RX_IRQHandler(I2C_Master_t *i2c)
 void I2C_Master_Init(I2C_Master_t *i2c)
 {
   RCC_EnableI2C(i2c->reg);
-  IRQ_EnableI2C(i2c->reg, i2c->irq_priority, (IRQ_Handler_t)I2C_Master_IRQHandler, NULL, i2c);
+  IRQ_EnableI2C(i2c->reg, i2c->irq_priority, (IRQ_Handler_t)I2C_Master_IRQHandler,
+    (IRQ_Handler_t)I2C_Master_IRQHandler, i2c);
   GPIO_InitAlternate(&I2C_SCL_MAP[i2c->scl], i2c->pull_up);
   GPIO_InitAlternate(&I2C_SDA_MAP[i2c->sda], i2c->pull_up);
   i2c->reg->TIMINGR = i2c->timing;
   i2c->reg->CR1 &= ~I2C_CR1_DNF;
-  // TX DMA
+  // TX DMA (completion is taken from I2C `TC`/`STOPF`, channel needs no interrupt)
   if(i2c->tx_dma) {
     DMA_SetRegisters(i2c->tx_dma, &i2c->_tx_dma);
     RCC_EnableDMA(i2c->_tx_dma.reg);
     i2c->_tx_dma.mux->CCR &= 0xFFFFFFC0;
     I2C_DmaSetTxRequest(i2c->reg, &i2c->_tx_dma);
     i2c->_tx_dma.cha->CPAR = (uint32_t)&i2c->reg->TXDR;
-    i2c->_tx_dma.cha->CCR |= DMA_CCR_MINC | DMA_CCR_DIR | DMA_CCR_TCIE;
-    IRQ_EnableDMA(i2c->tx_dma, i2c->irq_priority,
-      (IRQ_Handler_t)I2C_Master_DMA_TX_IRQHandler, i2c);
+    i2c->_tx_dma.cha->CCR |= DMA_CCR_MINC | DMA_CCR_DIR;
     i2c->reg->CR1 |= I2C_CR1_TXDMAEN;
   }
   // RX DMA
@@ -102,18 +176,20 @@ void I2C_Master_Init(I2C_Master_t *i2c)
     i2c->_rx_dma.mux->CCR &= 0xFFFFFFC0;
     I2C_DmaSetRxRequest(i2c->reg, &i2c->_rx_dma);
     i2c->_rx_dma.cha->CPAR = (uint32_t)&i2c->reg->RXDR;
-    i2c->_rx_dma.cha->CCR |= DMA_CCR_MINC | DMA_CCR_TCIE;
-    IRQ_EnableDMA(i2c->rx_dma, i2c->irq_priority,
-      (IRQ_Handler_t)I2C_Master_DMA_RX_IRQHandler, i2c);
+    i2c->_rx_dma.cha->CCR |= DMA_CCR_MINC;
     i2c->reg->CR1 |= I2C_CR1_RXDMAEN;
   }
   i2c->reg->CR1 |= I2C_CR1_PE | (i2c->filter << I2C_CR1_DNF_Pos);
-  i2c->_busy = false;
+  i2c->_active = NULL;
+  i2c->_queue_head = 0;
+  i2c->_queue_tail = 0;
+  i2c->_direct.status = OK;
+  i2c->_disabled = false;
 }
 
 void I2C_Master_Disable(I2C_Master_t *i2c)
 {
-  i2c->_busy = true;
+  i2c->_disabled = true;
   i2c->reg->CR1 &= ~I2C_CR1_PE;
   RCC_DisableI2C(i2c->reg);
 }
@@ -122,56 +198,98 @@ void I2C_Master_Disable(I2C_Master_t *i2c)
 
 bool I2C_Master_IsBusy(I2C_Master_t *i2c)
 {
-  return i2c->_busy;
+  return i2c->_disabled || i2c->_active || i2c->_queue_tail != i2c->_queue_head;
 }
 
 bool I2C_Master_IsFree(I2C_Master_t *i2c)
 {
-  return !i2c->_busy;
+  return !I2C_Master_IsBusy(i2c);
 }
 
 //---------------------------------------------------------------------------------------------
 
-status_t I2C_Master_Write(I2C_Master_t *i2c, uint8_t addr, uint8_t *data, uint16_t len)
+status_t I2C_Master_Submit(I2C_Master_t *i2c, I2C_Transfer_t *transfer)
 {
-  if(i2c->_busy) return BUSY;
-  if(i2c->tx_dma) {
-    i2c->_tx_dma.cha->CCR &= ~DMA_CCR_EN;
-    i2c->_tx_dma.cha->CMAR = (uint32_t)data;
-    i2c->_tx_dma.cha->CNDTR = len;
-    i2c->_tx_dma.cha->CCR |= DMA_CCR_EN;
+  if(i2c->_disabled) {
+    transfer->status = ERR;
+    return ERR;
   }
-  else {
-    i2c->_tx_ptr = data;
-    i2c->_tail = 1;
-    i2c->_head = len;
-    i2c->reg->TXDR = data[0];
-    if(len == 1) i2c->reg->CR1 |= I2C_CR1_STOPIE | I2C_CR1_NACKIE;
-    else i2c->reg->CR1 |= I2C_CR1_TXIE | I2C_CR1_NACKIE;
+  uint32_t primask = __get_PRIMASK();
+  __disable_irq();
+  uint8_t next = (i2c->_queue_head + 1) % I2C_QUEUE_SIZE;
+  if(next == i2c->_queue_tail) {
+    __set_PRIMASK(primask);
+    return BUSY;
   }
-  i2c->reg->CR2 = I2C_CR2_AUTOEND | (len << 16) | (addr << 1) | I2C_CR2_START;
-  i2c->_busy = true;
-  return FREE;
+  transfer->status = BUSY;
+  i2c->_queue[i2c->_queue_head] = transfer;
+  i2c->_queue_head = next;
+  I2C_Master_Next(i2c);
+  __set_PRIMASK(primask);
+  return OK;
 }
 
-status_t I2C_Master_Read(I2C_Master_t *i2c, uint8_t addr, uint8_t *data, uint16_t len)
+void I2C_Master_Abort(I2C_Master_t *i2c, I2C_Transfer_t *transfer)
 {
-  if(i2c->_busy) return BUSY;
-  if(i2c->rx_dma) {
-    i2c->_rx_dma.cha->CCR &= ~DMA_CCR_EN;
-    i2c->_rx_dma.cha->CMAR = (uint32_t)data;
-    i2c->_rx_dma.cha->CNDTR = len;
-    i2c->_rx_dma.cha->CCR |= DMA_CCR_EN;
+  uint32_t primask = __get_PRIMASK();
+  __disable_irq();
+  if(i2c->_active == transfer) {
+    I2C_Master_Restart(i2c);
+    I2C_Master_Finish(i2c, ERR);
   }
-  else {
-    i2c->_rx_ptr = data;
-    i2c->_tail = 0;
-    i2c->_head = len;
-    i2c->reg->CR1 |= I2C_CR1_RXIE;
+  else if(transfer->status == BUSY) {
+    // Queue slot is skipped by `I2C_Master_Next`
+    transfer->status = ERR;
+    i2c->errors++;
+    if(transfer->Done) transfer->Done(transfer);
   }
-  i2c->reg->CR2 = I2C_CR2_AUTOEND | (len << 16) | I2C_CR2_RD_WRN | (addr << 1) | I2C_CR2_START;
-  i2c->_busy = true;
-  return FREE;
+  __set_PRIMASK(primask);
+}
+
+status_t I2C_Master_Run(I2C_Master_t *i2c, I2C_Transfer_t *transfer, uint32_t timeout_ms)
+{
+  status_t status;
+  while((status = I2C_Master_Submit(i2c, transfer)) == BUSY) let();
+  if(status == ERR) return ERR;
+  if(transfer->status != BUSY) return transfer->status;
+  uint64_t tick = 0;
+  while(transfer->status == BUSY) {
+    if(i2c->_active == transfer) {
+      if(!tick) tick = tick_keep(timeout_ms);
+      else if(tick_over(&tick)) I2C_Master_Abort(i2c, transfer);
+    }
+    let();
+  }
+  return transfer->status;
+}
+
+//---------------------------------------------------------------------------------------------
+
+static status_t I2C_Master_Direct(I2C_Master_t *i2c, uint8_t addr, uint8_t *head, uint8_t head_len,
+  uint8_t *tx_data, uint16_t tx_len, uint8_t *rx_data, uint16_t rx_len)
+{
+  I2C_Transfer_t *transfer = &i2c->_direct;
+  if(transfer->status == BUSY) return BUSY;
+  transfer->addr = addr;
+  transfer->head_len = head_len;
+  if(head_len) memcpy(transfer->head, head, head_len);
+  transfer->tx = tx_data;
+  transfer->tx_len = tx_len;
+  transfer->rx = rx_data;
+  transfer->rx_len = rx_len;
+  transfer->Done = NULL;
+  status_t status = I2C_Master_Submit(i2c, transfer);
+  return status == OK ? FREE : status;
+}
+
+status_t I2C_Master_Write(I2C_Master_t *i2c, uint8_t addr, uint8_t *data, uint16_t len)
+{
+  return I2C_Master_Direct(i2c, addr, NULL, 0, data, len, NULL, 0);
+}
+
+status_t I2C_Master_Read(I2C_Master_t *i2c, uint8_t addr, uint8_t *data, uint16_t len)
+{
+  return I2C_Master_Direct(i2c, addr, NULL, 0, NULL, 0, data, len);
 }
 
 //---------------------------------------------------------------------------------------------
@@ -180,27 +298,14 @@ status_t I2C_Master_WriteReg(I2C_Master_t *i2c, uint8_t addr, uint8_t reg,
   uint8_t *data, uint16_t len
 )
 {
-  if(i2c->_busy) return BUSY;
-  i2c->_tx_buffer = heap_alloc(len + 1);
-  if(!i2c->_tx_buffer) return ERR;
-  i2c->_tx_buffer[0] = reg;
-  memcpy(&i2c->_tx_buffer[1], data, len);
-  return I2C_Master_Write(i2c, addr, i2c->_tx_buffer, len + 1);
+  return I2C_Master_Direct(i2c, addr, &reg, 1, data, len, NULL, 0);
 }
 
 status_t I2C_Master_ReadReg(I2C_Master_t *i2c, uint8_t addr, uint8_t reg,
   uint8_t *data, uint16_t len
 )
 {
-  if(i2c->_busy) return BUSY;
-  i2c->_addr = addr;
-  i2c->_rx_ptr = data;
-  i2c->_size = len;
-  i2c->reg->CR1 |= I2C_CR1_TCIE | I2C_CR1_NACKIE;
-  i2c->reg->CR2 = (1 << 16) | (addr << 1) | I2C_CR2_START;
-  i2c->reg->TXDR = reg;
-  i2c->_busy = true;
-  return FREE;
+  return I2C_Master_Direct(i2c, addr, &reg, 1, NULL, 0, data, len);
 }
 
 //---------------------------------------------------------------------------------------------
@@ -209,27 +314,7 @@ status_t I2C_Master_WriteRead(I2C_Master_t *i2c, uint8_t addr,
   uint8_t *tx_data, uint16_t tx_len, uint8_t *rx_data, uint16_t rx_len
 )
 {
-  if(i2c->_busy) return BUSY;
-  i2c->_addr = addr;
-  i2c->_rx_ptr = rx_data;
-  i2c->_size = rx_len;
-  if(i2c->tx_dma) {
-    i2c->_tx_dma.cha->CCR &= ~DMA_CCR_EN;
-    i2c->_tx_dma.cha->CMAR = (uint32_t)tx_data;
-    i2c->_tx_dma.cha->CNDTR = tx_len;
-    i2c->_tx_dma.cha->CCR |= DMA_CCR_EN;
-    i2c->reg->CR1 |= I2C_CR1_TCIE | I2C_CR1_NACKIE;
-  }
-  else {
-    i2c->_tx_ptr = tx_data;
-    i2c->_tail = 1;
-    i2c->_head = tx_len;
-    i2c->reg->TXDR = tx_data[0];
-    i2c->reg->CR1 |= I2C_CR1_TXIE | I2C_CR1_TCIE | I2C_CR1_NACKIE;
-  }
-  i2c->reg->CR2 = (tx_len << 16) | (addr << 1) | I2C_CR2_START;
-  i2c->_busy = true;
-  return FREE;
+  return I2C_Master_Direct(i2c, addr, NULL, 0, tx_data, tx_len, rx_data, rx_len);
 }
 
 //-------------------------------------------------------------------------------------------------
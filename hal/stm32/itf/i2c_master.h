@@ -8,14 +8,49 @@
 #include "dma.h"
 #include "pwr.h"
 #include "i2c.h"
-#include "heap.h"
+#include "vrts.h"
 #include "xdef.h"
 #include "main.h"
 
 //-------------------------------------------------------------------------------------------------
 
+#ifndef I2C_QUEUE_SIZE
+  // Transfers waiting for bus (descriptors are owned by callers)
+  #define I2C_QUEUE_SIZE 8
+#endif
+
+typedef struct I2C_Transfer_s I2C_Transfer_t;
+
+/**
+ * @brief I2C transaction descriptor: write part (`head` + `tx`), repeated start, read part (`rx`).
+ * Descriptor and buffers must stay valid until `status` leaves `BUSY`.
+ * @param[in] addr 7-bit device address
+ * @param[in] head Short prefix sent before `tx` (register or memory address)
+ * @param[in] head_len Prefix length (0-4)
+ * @param[in] tx Data to write
+ * @param[in] tx_len Number of bytes to write (`head_len + tx_len` up to 255)
+ * @param[out] rx Buffer for read data
+ * @param[in] rx_len Number of bytes to read (up to 255)
+ * @param[in] Done Completion callback, runs in interrupt (may be `NULL`)
+ * @param[in] arg User data for `Done`
+ * @param[out] status `BUSY` while queued or running, then `OK` or `ERR` (NACK, bus error, abort)
+ */
+struct I2C_Transfer_s {
+  uint8_t addr;
+  uint8_t head[4];
+  uint8_t head_len;
+  const uint8_t *tx;
+  uint16_t tx_len;
+  uint8_t *rx;
+  uint16_t rx_len;
+  void (*Done)(I2C_Transfer_t *transfer);
+  void *arg;
+  volatile status_t status;
+};
+
 /**
- * @brief I2C master control structure.
+ * @brief I2C master control structure. Transfers are queued and started one after another
+ * from interrupt (STOP of previous transfer starts next one), without heap.
  * @param[in] reg Pointer to I2C peripheral registers
  * @param[in] scl SCL pin mapping enum value
  * @param[in] sda SDA pin mapping enum value
@@ -25,17 +60,20 @@
  * @param[in] filter Digital noise filter coefficient (0-15)
  * @param[in] tx_dma TX DMA channel (`DMA_None` = interrupt mode)
  * @param[in] rx_dma RX DMA channel (`DMA_None` = interrupt mode)
+ * @param[out] count Completed transfers
+ * @param[out] errors Failed transfers
+ * @param[out] bytes Bytes moved by completed transfers
  * Internal:
  * @param _tx_dma TX DMA registers structure
  * @param _rx_dma RX DMA registers structure
- * @param _busy Transfer in progress flag
- * @param _tx_buffer Allocated TX buffer for `WriteReg`
- * @param _tx_ptr Current TX pointer (interrupt mode)
- * @param _rx_ptr Current RX pointer
- * @param _tail Current byte index
- * @param _head Total byte count
- * @param _addr Stored device address for read phase
- * @param _size Pending read size
+ * @param _disabled Peripheral disabled (pins used by other function)
+ * @param _queue Transfers waiting for bus
+ * @param _queue_head Write index of `_queue`
+ * @param _queue_tail Read index of `_queue`
+ * @param _active Transfer on bus
+ * @param _direct Descriptor of single-call API (`I2C_Master_Write`, ...)
+ * @param _tail Current byte index (interrupt mode)
+ * @param _error Active transfer failed, finished on STOP
  */
 typedef struct {
   I2C_TypeDef *reg;
@@ -47,17 +85,20 @@ typedef struct {
   uint8_t filter;
   DMA_CHx_t tx_dma;
   DMA_CHx_t rx_dma;
+  uint32_t count;
+  uint32_t errors;
+  uint32_t bytes;
   // internal
   DMA_t _tx_dma;
   DMA_t _rx_dma;
-  volatile bool _busy;
-  uint8_t *_tx_buffer;
-  volatile uint8_t *_tx_ptr;
-  uint8_t *_rx_ptr;
+  bool _disabled;
+  I2C_Transfer_t *_queue[I2C_QUEUE_SIZE];
+  volatile uint8_t _queue_head;
+  volatile uint8_t _queue_tail;
+  I2C_Transfer_t *volatile _active;
+  I2C_Transfer_t _direct;
   volatile uint16_t _tail;
-  uint16_t _head;
-  uint8_t _addr;
-  uint16_t _size;
+  bool _error;
 } I2C_Master_t;
 
 //-------------------------------------------------------------------------------------------------
@@ -75,7 +116,7 @@ void I2C_Master_Init(I2C_Master_t *i2c);
 void I2C_Master_Disable(I2C_Master_t *i2c);
 
 /**
- * @brief Check if I2C transfer is in progress.
+ * @brief Check if I2C transfer is in progress or queued.
  * @param[in] i2c Pointer to I2C master structure
  * @return `true` if busy
  */
@@ -88,6 +129,31 @@ bool I2C_Master_IsBusy(I2C_Master_t *i2c);
  */
 bool I2C_Master_IsFree(I2C_Master_t *i2c);
 
+/**
+ * @brief Queue transfer, it starts as soon as bus is free.
+ * @param[in,out] i2c Pointer to I2C master structure
+ * @param[in,out] transfer Transaction descriptor
+ * @return `OK` if queued, `BUSY` if queue is full, `ERR` if master is disabled
+ *   (`transfer->status` is set to `ERR` too)
+ */
+status_t I2C_Master_Submit(I2C_Master_t *i2c, I2C_Transfer_t *transfer);
+
+/**
+ * @brief Cancel transfer: removes it from queue or stops it on bus (peripheral restart).
+ * @param[in,out] i2c Pointer to I2C master structure
+ * @param[in,out] transfer Transaction descriptor, ends with `ERR`
+ */
+void I2C_Master_Abort(I2C_Master_t *i2c, I2C_Transfer_t *transfer);
+
+/**
+ * @brief Queue transfer and yield until it completes.
+ * @param[in,out] i2c Pointer to I2C master structure
+ * @param[in,out] transfer Transaction descriptor
+ * @param[in] timeout_ms Time limit counted from transfer start on bus (queue wait not included)
+ * @return `OK` or `ERR` (NACK, bus error, timeout, master disabled)
+ */
+status_t I2C_Master_Run(I2C_Master_t *i2c, I2C_Transfer_t *transfer, uint32_t timeout_ms);
+
 /**
  * @brief Write data to I2C device.
  * @param[in,out] i2c Pointer to I2C master structure
@@ -115,7 +181,7 @@ status_t I2C_Master_Read(I2C_Master_t *i2c, uint8_t addr, uint8_t *data, uint16_
  * @param[in] reg Register address
  * @param[in] data Pointer to data buffer
  * @param[in] len Number of data bytes
- * @return `FREE` if started, `BUSY`/`ERR` on failure
+ * @return `FREE` if started, `BUSY` if transfer in progress
  */
 status_t I2C_Master_WriteReg(I2C_Master_t *i2c, uint8_t addr, uint8_t reg, uint8_t *data, uint16_t len);
 
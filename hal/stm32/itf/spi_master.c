@@ -4,13 +4,102 @@
 
 //-------------------------------------------------------------------------------------------------
 
+#define SPI_MASTER_CR1_CONFIG (SPI_CR1_LSBFIRST | SPI_CR1_BR | SPI_CR1_CPOL | SPI_CR1_CPHA)
+
+static void SPI_Master_Next(SPI_Master_t *spi);
+
+static inline uint32_t SPI_Master_Config(SPI_Device_t *device)
+{
+  return (device->lsb << 7) | (device->prescaler << 3) | (device->cpol << 1) | device->cpha;
+}
+
+static void SPI_Master_Start(SPI_Master_t *spi, SPI_Transfer_t *transfer)
+{
+  SPI_Device_t *device = transfer->device;
+  uint32_t config = SPI_Master_Config(device);
+  // Clock settings can be changed only with SPI disabled (bus is idle between transfers)
+  if((spi->reg->CR1 & SPI_MASTER_CR1_CONFIG) != config) {
+    spi->reg->CR1 &= ~SPI_CR1_SPE;
+    spi->reg->CR1 = (spi->reg->CR1 & ~SPI_MASTER_CR1_CONFIG) | config;
+    if(spi->mosi) spi->reg->CR1 |= SPI_CR1_SPE;
+    spi->reconfig++;
+  }
+  spi->_tx_dma.cha->CCR &= ~DMA_CCR_EN;
+  spi->_rx_dma.cha->CCR &= ~DMA_CCR_EN;
+  if(spi->miso) {
+    if(transfer->rx) {
+      spi->_rx_dma.cha->CCR |= DMA_CCR_MINC;
+      spi->_rx_dma.cha->CMAR = (uint32_t)transfer->rx;
+    }
+    else {
+      spi->_rx_dma.cha->CCR &= ~DMA_CCR_MINC;
+      spi->_rx_dma.cha->CMAR = (uint32_t)&spi->_dummy;
+    }
+    spi->_rx_dma.cha->CNDTR = transfer->len;
+  }
+  if(spi->mosi) {
+    if(transfer->tx) {
+      spi->_tx_dma.cha->CCR |= DMA_CCR_MINC;
+      spi->_tx_dma.cha->CMAR = (uint32_t)transfer->tx;
+    }
+    else {
+      spi->_fill = transfer->fill;
+      spi->_tx_dma.cha->CCR &= ~DMA_CCR_MINC;
+      spi->_tx_dma.cha->CMAR = (uint32_t)&spi->_fill;
+    }
+    spi->_tx_dma.cha->CNDTR = transfer->len;
+  }
+  if(device->cs) {
+    GPIO_Set(device->cs);
+    SPI_Delay(device->cs_delay);
+  }
+  if(spi->miso) spi->_rx_dma.cha->CCR |= DMA_CCR_EN;
+  if(spi->mosi) spi->_tx_dma.cha->CCR |= DMA_CCR_EN;
+  else spi->reg->CR1 |= SPI_CR1_SPE; // RX-only: clock runs while SPI is enabled
+}
+
+// End active transfer, release CS, run its callback and start next one
+static void SPI_Master_Finish(SPI_Master_t *spi, status_t status)
+{
+  SPI_Transfer_t *transfer = spi->_active;
+  spi->_tx_dma.cha->CCR &= ~DMA_CCR_EN;
+  spi->_rx_dma.cha->CCR &= ~DMA_CCR_EN;
+  if(!spi->mosi) spi->reg->CR1 &= ~SPI_CR1_SPE;
+  spi->_active = NULL;
+  if(transfer) {
+    if(transfer->device->cs) GPIO_Rst(transfer->device->cs);
+    if(status == OK) spi->count++;
+    transfer->status = status;
+    if(transfer->Done) transfer->Done(transfer);
+  }
+  SPI_Master_Next(spi);
+}
+
+// Start first queued transfer if bus is idle (called from interrupt or with interrupts off)
+static void SPI_Master_Next(SPI_Master_t *spi)
+{
+  while(!spi->_active && spi->_queue_tail != spi->_queue_head) {
+    SPI_Transfer_t *transfer = spi->_queue[spi->_queue_tail];
+    spi->_queue_tail = (spi->_queue_tail + 1) % SPI_QUEUE_SIZE;
+    if(transfer->status != BUSY) continue; // Aborted while queued
+    spi->_active = transfer;
+    if(!transfer->len) {
+      SPI_Master_Finish(spi, OK);
+      return;
+    }
+    SPI_Master_Start(spi, transfer);
+  }
+}
+
+// Completion of channel that finishes last: RX, or TX when there is no MISO
 static void SPI_Master_DMA_IRQHandler(SPI_Master_t *spi)
 {
-  if(spi->_rx_dma.reg->ISR & DMA_ISR_TCIF(spi->_rx_dma.pos)) {
-    spi->_rx_dma.reg->IFCR |= DMA_ISR_TCIF(spi->_rx_dma.pos);
-    if(spi->cs) GPIO_Rst(spi->cs);
-    spi->_busy = false;
-    if(!spi->mosi) spi->reg->CR1 &= ~SPI_CR1_SPE;
+  DMA_t *dma = spi->miso ? &spi->_rx_dma : &spi->_tx_dma;
+  if(dma->reg->ISR & DMA_ISR_TCIF(dma->pos)) {
+    dma->reg->IFCR |= DMA_ISR_TCIF(dma->pos);
+    // TX-only: last bytes are still in FIFO and shift register
+    if(!spi->miso) while(spi->reg->SR & (SPI_SR_FTLVL | SPI_SR_BSY));
+    SPI_Master_Finish(spi, OK);
   }
 }
 
@@ -35,9 +124,17 @@ void SPI_Master_Init(SPI_Master_t *spi)
     GPIO_InitAlternate(&SPI_MOSI_MAP[spi->mosi], false);
     spi->_tx_dma.cha->CPAR = (uint32_t)&spi->reg->DR;
     spi->_tx_dma.cha->CCR |= DMA_CCR_MINC | DMA_CCR_DIR;
+    if(!spi->miso) {
+      IRQ_EnableDMA(spi->tx_dma, spi->irq_priority, (IRQ_Handler_t)SPI_Master_DMA_IRQHandler, spi);
+      spi->_tx_dma.cha->CCR |= DMA_CCR_TCIE;
+    }
   }
+  spi->_device = (SPI_Device_t){
+    .cs = spi->cs, .cs_delay = spi->cs_delay, .prescaler = spi->prescaler,
+    .lsb = spi->lsb, .cpol = spi->cpol, .cpha = spi->cpha
+  };
   uint32_t cr2 = SPI_CR2_RXDMAEN | SPI_CR2_FRXTH | SPI_CR2_SSOE | 0x00000700;
-  uint32_t cr1 = SPI_CR1_MSTR | (spi->lsb << 7) | (spi->prescaler << 3) | SPI_CR1_SPE | (spi->cpol << 1) | spi->cpha;
+  uint32_t cr1 = SPI_CR1_MSTR | SPI_Master_Config(&spi->_device);
   if(spi->cs) {
     spi->cs->mode = GPIO_Mode_Output;
     GPIO_Init(spi->cs);
@@ -45,97 +142,120 @@ void SPI_Master_Init(SPI_Master_t *spi)
   else {
     cr2 |= SPI_CR1_SSM | SPI_CR1_SSI;
   }
-  if(spi->mosi) cr2 |= SPI_CR2_TXDMAEN;
-  else cr1 |= SPI_CR1_RXONLY;
+  if(spi->mosi) {
+    cr2 |= SPI_CR2_TXDMAEN;
+    cr1 |= SPI_CR1_SPE;
+  }
+  else cr1 |= SPI_CR1_RXONLY; // Enabled only during transfer
   RCC_EnableSPI(spi->reg);
   spi->reg->CR2 = cr2;
   spi->reg->CR1 = cr1;
+  spi->_active = NULL;
+  spi->_queue_head = 0;
+  spi->_queue_tail = 0;
+  spi->_direct.status = OK;
 }
 
 //-------------------------------------------------------------------------------------------------
 
 bool SPI_Master_IsBusy(SPI_Master_t *spi)
 {
-  return spi->_busy;
+  return spi->_active || spi->_queue_tail != spi->_queue_head;
 }
 
 bool SPI_Master_IsFree(SPI_Master_t *spi)
 {
-  return !spi->_busy;
+  return !SPI_Master_IsBusy(spi);
 }
 
 //-------------------------------------------------------------------------------------------------
 
-static void SPI_Master_Start(SPI_Master_t *spi)
+status_t SPI_Master_Submit(SPI_Master_t *spi, SPI_Transfer_t *transfer)
 {
-  spi->_tx_dma.cha->CCR &= ~DMA_CCR_EN;
-  spi->_rx_dma.cha->CCR &= ~DMA_CCR_EN;
+  uint32_t primask = __get_PRIMASK();
+  __disable_irq();
+  uint8_t next = (spi->_queue_head + 1) % SPI_QUEUE_SIZE;
+  if(next == spi->_queue_tail) {
+    __set_PRIMASK(primask);
+    return BUSY;
+  }
+  transfer->status = BUSY;
+  spi->_queue[spi->_queue_head] = transfer;
+  spi->_queue_head = next;
+  SPI_Master_Next(spi);
+  __set_PRIMASK(primask);
+  return OK;
 }
 
-static void SPI_Master_End(SPI_Master_t *spi, uint16_t len)
+void SPI_Master_Abort(SPI_Master_t *spi, SPI_Transfer_t *transfer)
 {
-  spi->_tx_dma.cha->CNDTR = len;
-  spi->_rx_dma.cha->CNDTR = len;
-  if(spi->cs) {
-    GPIO_Set(spi->cs);
-    SPI_Delay(spi->cs_delay);
+  uint32_t primask = __get_PRIMASK();
+  __disable_irq();
+  if(spi->_active == transfer) {
+    spi->_tx_dma.cha->CCR &= ~DMA_CCR_EN;
+    spi->_rx_dma.cha->CCR &= ~DMA_CCR_EN;
+    // Drop bytes left in RX FIFO
+    while(spi->reg->SR & SPI_SR_FRLVL) (void)*(volatile uint8_t *)&spi->reg->DR;
+    SPI_Master_Finish(spi, ERR);
+  }
+  else if(transfer->status == BUSY) {
+    // Queue slot is skipped by `SPI_Master_Next`
+    transfer->status = ERR;
+    if(transfer->Done) transfer->Done(transfer);
+  }
+  __set_PRIMASK(primask);
+}
+
+status_t SPI_Master_Run(SPI_Master_t *spi, SPI_Transfer_t *transfer, uint32_t timeout_ms)
+{
+  while(SPI_Master_Submit(spi, transfer) == BUSY) let();
+  uint64_t tick = 0;
+  while(transfer->status == BUSY) {
+    if(spi->_active == transfer) {
+      if(!tick) tick = tick_keep(timeout_ms);
+      else if(tick_over(&tick)) SPI_Master_Abort(spi, transfer);
+    }
+    let();
   }
-  spi->_rx_dma.cha->CCR |= DMA_CCR_EN;
-  spi->_tx_dma.cha->CCR |= DMA_CCR_EN;
-  spi->_busy = true;
+  return transfer->status;
 }
 
 //-------------------------------------------------------------------------------------------------
 
+static status_t SPI_Master_Direct(SPI_Master_t *spi, const uint8_t *tx_data, uint8_t fill, uint8_t *rx_data, uint16_t len)
+{
+  SPI_Transfer_t *transfer = &spi->_direct;
+  if(transfer->status == BUSY) return BUSY;
+  // Default device follows `spi` fields, drivers may still swap `cs` between calls
+  spi->_device.cs = spi->cs;
+  transfer->device = &spi->_device;
+  transfer->tx = tx_data;
+  transfer->rx = rx_data;
+  transfer->len = len;
+  transfer->fill = fill;
+  transfer->Done = NULL;
+  status_t status = SPI_Master_Submit(spi, transfer);
+  return status == OK ? FREE : status;
+}
+
 status_t SPI_Master_Transfer(SPI_Master_t *spi, uint8_t *rx_data, uint8_t *tx_data, uint16_t len)
 {
-  if(spi->_busy) return BUSY;
-  SPI_Master_Start(spi);
-  spi->_tx_dma.cha->CCR |= DMA_CCR_MINC;
-  spi->_rx_dma.cha->CCR |= DMA_CCR_MINC;
-  spi->_tx_dma.cha->CMAR = (uint32_t)tx_data;
-  spi->_rx_dma.cha->CMAR = (uint32_t)rx_data;
-  SPI_Master_End(spi, len);
-  return FREE;
+  return SPI_Master_Direct(spi, tx_data, 0, rx_data, len);
 }
 
 void SPI_Master_OnlyRead(SPI_Master_t *spi, uint8_t *rx_data, uint16_t len)
 {
-  spi->_rx_dma.cha->CCR &= ~DMA_CCR_EN;
-  spi->_rx_dma.cha->CMAR = (uint32_t)rx_data;
-  spi->_rx_dma.cha->CNDTR = len;
-  spi->_rx_dma.cha->CCR |= DMA_CCR_EN;
-  spi->_busy = true;
-  spi->reg->CR1 |= SPI_CR1_SPE;
+  SPI_Master_Direct(spi, NULL, 0, rx_data, len);
 }
 
 status_t SPI_Master_Read(SPI_Master_t *spi, uint8_t cmd, uint8_t *rx_data, uint16_t len)
 {
-  if(spi->_busy) return BUSY;
-  spi->_const_byte = cmd;
-  if(!spi->mosi) {
-    SPI_Master_OnlyRead(spi, rx_data, len);
-    return FREE;
-  }
-  SPI_Master_Start(spi);
-  spi->_tx_dma.cha->CCR &= ~DMA_CCR_MINC;
-  spi->_rx_dma.cha->CCR |= DMA_CCR_MINC;
-  spi->_tx_dma.cha->CMAR = (uint32_t)&spi->_const_byte;
-  spi->_rx_dma.cha->CMAR = (uint32_t)rx_data;
-  SPI_Master_End(spi, len);
-  return FREE;
+  return SPI_Master_Direct(spi, NULL, cmd, rx_data, len);
 }
 
 status_t SPI_Master_Write(SPI_Master_t *spi, uint8_t *tx_data, uint16_t len)
 {
-  if(spi->_busy) return BUSY;
-  SPI_Master_Start(spi);
-  spi->_tx_dma.cha->CCR |= DMA_CCR_MINC;
-  spi->_rx_dma.cha->CCR &= ~DMA_CCR_MINC;
-  spi->_tx_dma.cha->CMAR = (uint32_t)tx_data;
-  spi->_rx_dma.cha->CMAR = (uint32_t)&spi->_const_byte;
-  SPI_Master_End(spi, len);
-  return FREE;
+  return SPI_Master_Direct(spi, tx_data, 0, NULL, len);
 }
 
 //-------------------------------------------------------------------------------------------------
@@ -6,6 +6,7 @@
 #include "irq.h"
 #include "dma.h"
 #include "spi.h"
+#include "vrts.h"
 #include "xdef.h"
 #include "main.h"
 
@@ -14,13 +15,65 @@
 #endif
 
 #ifndef SPI_Delay
-  #define SPI_Delay(x) delay(x)
+  // CS setup delay, runs in DMA interrupt when transfers are chained
+  #define SPI_Delay(x) for(uint32_t _i = 0; _i < (x); _i++) __NOP()
+#endif
+
+#ifndef SPI_QUEUE_SIZE
+  // Transfers waiting for bus (descriptors are owned by callers)
+  #define SPI_QUEUE_SIZE 8
 #endif
 
 //-------------------------------------------------------------------------------------------------
 
 /**
- * @brief SPI master control structure with DMA.
+ * @brief Device on shared SPI bus: chip select and clock settings.
+ * Master reconfigures peripheral only when device settings differ from previous transfer.
+ * @param[in] cs Pointer to CS GPIO, initialized by device driver (`NULL` = hardware NSS)
+ * @param[in] cs_delay CS setup delay in `__NOP` cycles
+ * @param[in] prescaler SPI clock prescaler
+ * @param[in] lsb LSB-first mode (`false` = MSB first)
+ * @param[in] cpol Clock polarity
+ * @param[in] cpha Clock phase
+ */
+typedef struct {
+  GPIO_t *cs;
+  uint32_t cs_delay;
+  SPI_Prescaler_t prescaler;
+  bool lsb;
+  bool cpol;
+  bool cpha;
+} SPI_Device_t;
+
+typedef struct SPI_Transfer_s SPI_Transfer_t;
+
+/**
+ * @brief SPI transaction descriptor: one CS frame of `len` bytes, full-duplex.
+ * Descriptor and buffers must stay valid until `status` leaves `BUSY`.
+ * @param[in] device Target device
+ * @param[in] tx Data to write (`NULL` = send `fill` byte)
+ * @param[out] rx Buffer for read data (`NULL` = discard)
+ * @param[in] len Number of bytes
+ * @param[in] fill Byte sent when `tx` is `NULL`
+ * @param[in] Done Completion callback, runs in interrupt (may be `NULL`)
+ * @param[in] arg User data for `Done`
+ * @param[out] status `BUSY` while queued or running, then `OK` or `ERR` (abort)
+ */
+struct SPI_Transfer_s {
+  SPI_Device_t *device;
+  const uint8_t *tx;
+  uint8_t *rx;
+  uint16_t len;
+  uint8_t fill;
+  void (*Done)(SPI_Transfer_t *transfer);
+  void *arg;
+  volatile status_t status;
+};
+
+/**
+ * @brief SPI master control structure with DMA. Transfers of many devices are queued
+ * and chained from DMA completion interrupt, each with its own CS and clock settings.
+ * Fields `cs` ... `cpha` describe default device used by single-call API (`SPI_Master_Read`, ...).
  * @param[in] reg Pointer to SPI peripheral registers
  * @param[in] tx_dma TX DMA channel number
  * @param[in] rx_dma RX DMA channel number
@@ -29,16 +82,24 @@
  * @param[in] miso MISO pin mapping (`SPI_MISO_None` = TX-only)
  * @param[in] mosi MOSI pin mapping (`SPI_MOSI_None` = RX-only)
  * @param[in] cs Pointer to CS GPIO (`NULL` = hardware NSS)
- * @param[in] cs_delay CS setup delay in ticks
+ * @param[in] cs_delay CS setup delay in `__NOP` cycles
  * @param[in] prescaler SPI clock prescaler
  * @param[in] lsb LSB-first mode (`false` = MSB first)
  * @param[in] cpol Clock polarity
  * @param[in] cpha Clock phase
+ * @param[out] count Completed transfers
+ * @param[out] reconfig Peripheral reconfigurations between devices
  * Internal:
  * @param _tx_dma TX DMA registers structure
  * @param _rx_dma RX DMA registers structure
- * @param _const_byte Constant byte for read operations
- * @param _busy Transfer in progress flag
+ * @param _fill Constant byte sent by transfer without `tx`
+ * @param _dummy Sink for read data of transfer without `rx`
+ * @param _queue Transfers waiting for bus
+ * @param _queue_head Write index of `_queue`
+ * @param _queue_tail Read index of `_queue`
+ * @param _active Transfer on bus
+ * @param _device Default device of single-call API
+ * @param _direct Descriptor of single-call API
  */
 typedef struct {
   SPI_TypeDef *reg;
@@ -54,11 +115,19 @@ typedef struct {
   bool lsb;
   bool cpol;
   bool cpha;
+  uint32_t count;
+  uint32_t reconfig;
   // internal
   DMA_t _tx_dma;
   DMA_t _rx_dma;
-  uint8_t _const_byte;
-  volatile bool _busy;
+  uint8_t _fill;
+  uint8_t _dummy;
+  SPI_Transfer_t *_queue[SPI_QUEUE_SIZE];
+  volatile uint8_t _queue_head;
+  volatile uint8_t _queue_tail;
+  SPI_Transfer_t *volatile _active;
+  SPI_Device_t _device;
+  SPI_Transfer_t _direct;
 } SPI_Master_t;
 
 //-------------------------------------------------------------------------------------------------
@@ -70,7 +139,7 @@ typedef struct {
 void SPI_Master_Init(SPI_Master_t *spi);
 
 /**
- * @brief Check if SPI transfer is in progress.
+ * @brief Check if SPI transfer is in progress or queued.
  * @param[in] spi Pointer to SPI master structure
  * @return `true` if busy
  */
@@ -84,31 +153,56 @@ bool SPI_Master_IsBusy(SPI_Master_t *spi);
 bool SPI_Master_IsFree(SPI_Master_t *spi);
 
 /**
- * @brief Full-duplex SPI transfer.
+ * @brief Queue transfer, it starts as soon as bus is free.
+ * Transfers submitted together run back-to-back (e.g. one burst over all sensors).
+ * @param[in,out] spi Pointer to SPI master structure
+ * @param[in,out] transfer Transaction descriptor
+ * @return `OK` if queued, `BUSY` if queue is full
+ */
+status_t SPI_Master_Submit(SPI_Master_t *spi, SPI_Transfer_t *transfer);
+
+/**
+ * @brief Cancel transfer: removes it from queue or stops DMA and releases CS.
+ * @param[in,out] spi Pointer to SPI master structure
+ * @param[in,out] transfer Transaction descriptor, ends with `ERR`
+ */
+void SPI_Master_Abort(SPI_Master_t *spi, SPI_Transfer_t *transfer);
+
+/**
+ * @brief Queue transfer and yield until it completes.
+ * @param[in,out] spi Pointer to SPI master structure
+ * @param[in,out] transfer Transaction descriptor
+ * @param[in] timeout_ms Time limit counted from transfer start on bus (queue wait not included)
+ * @return `OK` or `ERR` (timeout)
+ */
+status_t SPI_Master_Run(SPI_Master_t *spi, SPI_Transfer_t *transfer, uint32_t timeout_ms);
+
+/**
+ * @brief Full-duplex SPI transfer to default device.
  * @param[in,out] spi Pointer to SPI master structure
  * @param[out] rx_data Pointer to receive buffer
  * @param[in] tx_data Pointer to transmit buffer
  * @param[in] len Number of bytes to transfer
- * @return `FREE` if started, `BUSY` if transfer in progress
+ * @return `FREE` if queued, `BUSY` if previous single-call transfer is not finished
  */
 status_t SPI_Master_Transfer(SPI_Master_t *spi, uint8_t *rx_data, uint8_t *tx_data, uint16_t len);
 
 /**
- * @brief Read from SPI device (sends constant `cmd` byte).
+ * @brief Read from default device (sends constant `cmd` byte).
  * @param[in,out] spi Pointer to SPI master structure
  * @param[in] cmd Constant byte to send (e.g. register address)
  * @param[out] rx_data Pointer to receive buffer
  * @param[in] len Number of bytes to read
- * @return `FREE` if started, `BUSY` if transfer in progress
+ * @return `FREE` if queued, `BUSY` if previous single-call transfer is not finished
  */
 status_t SPI_Master_Read(SPI_Master_t *spi, uint8_t cmd, uint8_t *rx_data, uint16_t len);
 
 /**
- * @brief Write to SPI device.
+ * @brief Write to default device.
  * @param[in,out] spi Pointer to SPI master structure
  * @param[in] tx_data Pointer to transmit buffer
  * @param[in] len Number of bytes to write
- * @return `FREE` if started, `BUSY` if transfer in progress
+ * @return `FREE` if queued, `BUSY` if previous single-call transfer is not finished
  */
 status_t SPI_Master_Write(SPI_Master_t *spi, uint8_t *tx_data, uint16_t len);
 
@@ -61,6 +61,10 @@ status_t ADC_LastSamples(ADC_t *adc, uint16_t *buffer, uint16_t count, bool sort
 
 float ADC_RecordSampleTime_s(ADC_t *adc)
 {
+  if(adc->record.tim) {
+    TIM_t *tim = adc->record.tim;
+    return (float)tim->prescaler * ((float)tim->auto_reload + 1.0f) / (float)SystemCoreClock;
+  }
   float freq = (adc->use_hsi ? 16000000.0f : (float)SystemCoreClock);
   freq /= (float)ADC_PRESCALER_TAB[adc->record.prescaler];
   float cycles = (float)ADC_SAMPLING_TIME_TAB[adc->record.sampling_time];
@@ -71,5 +75,99 @@ float ADC_RecordSampleTime_s(ADC_t *adc)
   return time;
 }
 
+//------------------------------------------------------------------------------------------------- Pipeline
+
+static void ADC_PipeProcess(ADC_t *adc, uint8_t half)
+{
+  ADC_Pipe_t *pipe = adc->record.pipe;
+  uint16_t n = adc->record.chan_count;
+  uint16_t half_len = adc->record.buff_len / 2;
+  uint16_t samples = half_len / n;
+  const uint16_t *base = adc->record.buff + half * half_len;
+  // Split at ring end, so every filter call gets contiguous output
+  uint16_t first = pipe->ring_len - pipe->_index;
+  if(first > samples) first = samples;
+  for(uint8_t ch = 0; ch < n; ch++) {
+    uint16_t *ring = pipe->ring + ch * pipe->ring_len;
+    const uint16_t *src = base + ch;
+    uint16_t index = pipe->_index;
+    uint16_t left = samples;
+    uint16_t len = first;
+    while(left) {
+      if(pipe->Filter) pipe->Filter(pipe->filter_arg, ch, src, n, &ring[index], len);
+      else for(uint16_t i = 0; i < len; i++) ring[index + i] = src[i * n];
+      src += len * n;
+      left -= len;
+      index = 0;
+      len = left;
+    }
+  }
+  pipe->_index = (uint16_t)((pipe->_index + samples) % pipe->ring_len);
+  pipe->_head += samples;
+  if(pipe->Ready) pipe->Ready(adc->record.callback_arg);
+}
+
+status_t ADC_PipeStart(ADC_t *adc)
+{
+  ADC_Pipe_t *pipe = adc->record.pipe;
+  uint16_t n = adc->record.chan_count;
+  if(!adc->record.continuous_mode || !n || adc->record.buff_len % (2 * n)) return ERR;
+  // At least one sample beyond block written by interrupt, otherwise nothing is ever stable
+  if(pipe->ring_len <= adc->record.buff_len / 2 / n) return ERR;
+  // `_head` and `_index` carry on: reader cursors stay valid across restarts
+  if(pipe->_index >= pipe->ring_len) pipe->_index = 0;
+  pipe->_pending[0] = pipe->_pending[1] = false;
+  pipe->_next = 0;
+  return OK;
+}
+
+void ADC_PipeEvent(ADC_t *adc, uint8_t half)
+{
+  ADC_Pipe_t *pipe = adc->record.pipe;
+  if(pipe->_pending[half]) pipe->_overflow++;
+  pipe->_pending[half] = true;
+  if(!pipe->deferred) ADC_PipeLoop(adc);
+}
+
+uint8_t ADC_PipeLoop(ADC_t *adc)
+{
+  ADC_Pipe_t *pipe = adc->record.pipe;
+  if(!pipe) return 0;
+  uint8_t count = 0;
+  while(pipe->_pending[pipe->_next]) {
+    // Clear before processing: mark set again meanwhile means real overrun
+    pipe->_pending[pipe->_next] = false;
+    ADC_PipeProcess(adc, pipe->_next);
+    pipe->_next ^= 1;
+    count++;
+  }
+  return count;
+}
+
+uint16_t ADC_PipeRead(ADC_t *adc, uint8_t channel, uint32_t *tail, uint16_t *out, uint16_t len)
+{
+  ADC_Pipe_t *pipe = adc->record.pipe;
+  if(!pipe || channel >= adc->record.chan_count) return 0;
+  uint32_t head;
+  uint16_t index;
+  do {
+    head = pipe->_head;
+    index = pipe->_index;
+  } while(head != pipe->_head);
+  // Block that may be written by interrupt right now is not stable
+  uint32_t stable = pipe->ring_len - adc->record.buff_len / 2 / adc->record.chan_count;
+  if(head - *tail > stable) *tail = head - stable;
+  uint32_t available = head - *tail;
+  if(len > available) len = (uint16_t)available;
+  const uint16_t *ring = pipe->ring + channel * pipe->ring_len;
+  uint16_t pos = (uint16_t)((index + pipe->ring_len - (head - *tail) % pipe->ring_len) % pipe->ring_len);
+  for(uint16_t i = 0; i < len; i++) {
+    out[i] = ring[pos];
+    if(++pos >= pipe->ring_len) pos = 0;
+  }
+  *tail += len;
+  return len;
+}
+
 #endif
 //-------------------------------------------------------------------------------------------------
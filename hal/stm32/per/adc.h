@@ -6,6 +6,7 @@
 #include "irq.h"
 #include "dma.h"
 #include "gpio.h"
+#include "tim.h"
 #include "xdef.h"
 #include "vrts.h"
 #include "main.h"
@@ -107,6 +108,44 @@ typedef struct {
 /** @brief DMA callback type for continuous mode */
 typedef void (*ADC_DmaCallback_t)(void *arg);
 
+/**
+ * @brief Pipeline block filter for one channel.
+ * Reads `len` samples from interleaved DMA half-buffer (every `stride` element)
+ * and writes `len` samples to contiguous channel ring segment.
+ */
+typedef void (*ADC_PipeFilter_t)(void *arg, uint8_t channel, const uint16_t *in, uint16_t stride, uint16_t *out, uint16_t len);
+
+/**
+ * @brief ADC acquisition pipeline: de-interleaves each DMA half-buffer into per-channel rings.
+ * Used with `continuous_mode` and (preferably) timer-triggered sampling.
+ * Half-buffer must hold whole sequences: `buff_len` divisible by `2 * chan_count`.
+ * @param[in] ring Per-channel rings, channel `n` starts at `ring + n * ring_len`
+ * @param[in] ring_len Ring length in samples per channel (more than half-buffer samples per channel)
+ * @param[in] deferred `true` = DMA interrupt only marks half-buffer, processing in `ADC_PipeLoop`
+ * @param[in] Filter Block filter called per channel (`NULL` = plain copy)
+ * @param[in] filter_arg User argument passed to `Filter`
+ * @param[in] Ready Called after each processed half-buffer with `callback_arg` of record (`NULL` = disabled)
+ * Internal:
+ * @param _head Samples written per channel since first `ADC_Record` (wraps at 2^32)
+ * @param _index Write position in rings
+ * @param _pending Half-buffers waiting for processing
+ * @param _next Half-buffer to process next (keeps chronological order)
+ * @param _overflow Half-buffers refilled by DMA before they were processed
+ */
+typedef struct {
+  uint16_t *ring;
+  uint16_t ring_len;
+  bool deferred;
+  ADC_PipeFilter_t Filter;
+  void *filter_arg;
+  ADC_DmaCallback_t Ready;
+  volatile uint32_t _head;
+  volatile uint16_t _index;
+  volatile bool _pending[2];
+  uint8_t _next;
+  uint16_t _overflow;
+} ADC_Pipe_t;
+
 /**
  * @brief ADC DMA recording configuration.
  * @param[in] chan Pointer to channel array
@@ -118,7 +157,11 @@ typedef void (*ADC_DmaCallback_t)(void *arg);
  * @param[in] continuous_mode Circular DMA mode (continuous recording)
  * @param[in] buff Pointer to DMA buffer
  * @param[in] buff_len Buffer length in samples
- * @param[in] tim Optional timer for triggered sampling (`NULL` = continuous)
+ * @param[in] ext_trig Start each sequence on external trigger `ext_select`
+ * @param[in] ext_select External trigger source
+ * @param[in] tim Optional timer for triggered sampling, TRGO on update (`NULL` = continuous),
+ *   must be initialized (`TIM_Init`) and selected in `ext_select`, runs only while recording
+ * @param[in] pipe Optional acquisition pipeline (`NULL` = disabled)
  * @param[in] HalfCallback Called when first half of buffer filled (continuous mode, NULL = disabled)
  * @param[in] CompleteCallback Called when buffer complete (continuous mode, NULL = disabled)
  * @param[in] callback_arg User argument passed to callbacks
@@ -137,6 +180,8 @@ typedef struct {
   ADC_ExtTrig_t ext_select;
   uint16_t *buff;
   uint16_t buff_len;
+  TIM_t *tim;
+  ADC_Pipe_t *pipe;
   ADC_DmaCallback_t HalfCallback;
   ADC_DmaCallback_t CompleteCallback;
   void *callback_arg;
@@ -188,7 +233,7 @@ status_t ADC_Measure(ADC_t *adc);
 /**
  * @brief Start DMA recording.
  * @param[in,out] adc Pointer to ADC structure
- * @return `OK` if started, `BUSY` if conversion in progress
+ * @return `OK` if started, `BUSY` if conversion in progress, `ERR` on invalid `pipe` configuration
  */
 status_t ADC_Record(ADC_t *adc);
 
@@ -204,10 +249,56 @@ status_t ADC_LastSamples(ADC_t *adc, uint16_t *buffer, uint16_t count, bool sort
 
 /**
  * @brief Calculate sample time for one complete sequence.
+ * With trigger timer `tim` this is timer period.
  * @param[in] adc Pointer to ADC structure
  * @return Sample time in seconds
  */
 float ADC_RecordSampleTime_s(ADC_t *adc);
+
+/**
+ * @brief Check pipeline configuration and clear pending half-buffers, called by `ADC_Record`.
+ * `_head` keeps counting across restarts, so reader cursors stay valid.
+ * @param[in,out] adc Pointer to ADC structure
+ * @return `OK` or `ERR` when configuration is not usable
+ */
+status_t ADC_PipeStart(ADC_t *adc);
+
+/**
+ * @brief Pipeline handler for filled DMA half-buffer, called from DMA interrupt.
+ * @param[in,out] adc Pointer to ADC structure
+ * @param[in] half `0` = first half, `1` = second half
+ */
+void ADC_PipeEvent(ADC_t *adc, uint8_t half);
+
+/**
+ * @brief Process half-buffers marked in deferred pipeline mode (call from thread loop).
+ * @param[in,out] adc Pointer to ADC structure
+ * @return Number of processed half-buffers
+ */
+uint8_t ADC_PipeLoop(ADC_t *adc);
+
+/**
+ * @brief Read channel stream from pipeline rings, gap-free as long as reader keeps up.
+ * Each reader owns its `tail` cursor (start with `ADC_PipeHead`).
+ * If reader fell behind, `tail` jumps forward to oldest stable sample.
+ * @param[in] adc Pointer to ADC structure
+ * @param[in] channel Channel index in sequence
+ * @param[in,out] tail Reader cursor (samples)
+ * @param[out] out Output buffer
+ * @param[in] len Output buffer length
+ * @return Number of samples copied
+ */
+uint16_t ADC_PipeRead(ADC_t *adc, uint8_t channel, uint32_t *tail, uint16_t *out, uint16_t len);
+
+/**
+ * @brief Get pipeline head (samples written per channel since start).
+ * @param[in] adc Pointer to ADC structure
+ * @return Head cursor
+ */
+static inline uint32_t ADC_PipeHead(ADC_t *adc)
+{
+  return adc->record.pipe->_head;
+}
 #endif
 
 /**
@@ -0,0 +1,210 @@
+// hal/stm32/per/cnt.c
+
+#include "cnt.h"
+
+//------------------------------------------------------------------------------------------------- Internal
+
+// Signed distance `a - b` on counter ring (valid below half of `_span`)
+static inline int64_t CNT_Distance(CNT_t *cnt, uint32_t a, uint32_t b)
+{
+  uint64_t diff = ((uint64_t)a - b) & (cnt->_span - 1);
+  return diff < (cnt->_span >> 1) ? (int64_t)diff : (int64_t)diff - (int64_t)cnt->_span;
+}
+
+// Events raised by counter moving `move` from `_last`: `TIM_SR_UIF` on wrap, `_half` on half of range
+static uint32_t CNT_Events(CNT_t *cnt, int64_t move)
+{
+  int64_t span = (int64_t)cnt->_span;
+  int64_t from = cnt->_last;
+  int64_t to = from + move;
+  uint32_t events = (to < 0 || to >= span) ? TIM_SR_UIF : 0;
+  for(int64_t half = (span >> 1) - span; half < 2 * span; half += span) {
+    if(move > 0 ? (from < half && half <= to) : (to <= half && half < from)) events |= cnt->_half;
+  }
+  return events;
+}
+
+/**
+ * @brief Follow counter from `_last` to current value (call with interrupts disabled).
+ * Interrupts on wrap and on half of range keep observations less than about half `_span` apart,
+ * so shorter way around ring is taken, unless only longer way explains flags raised since last call.
+ * Jitter over wrap point and merged or late interrupts do not add or lose `_span`.
+ */
+static void CNT_Track(CNT_t *cnt)
+{
+  uint32_t flags = cnt->reg->SR & (TIM_SR_UIF | cnt->_half);
+  uint32_t value = cnt->reg->CNT;
+  cnt->reg->SR = ~flags;
+  int64_t move = CNT_Distance(cnt, value, cnt->_last);
+  if(CNT_Events(cnt, move) != flags) {
+    int64_t span = (int64_t)cnt->_span;
+    int64_t other = move > 0 ? move - span : move < 0 ? move + span : (cnt->reg->CR1 & TIM_CR1_DIR) ? -span : span;
+    if(CNT_Events(cnt, other) == flags) move = other;
+  }
+  cnt->_count += move;
+  cnt->_last = value;
+}
+
+static void CNT_Interrupt(CNT_t *cnt)
+{
+  // `DIER` enable bits share positions with `SR` flags: unused compare channels are ignored
+  uint32_t sr = cnt->reg->SR & cnt->reg->DIER;
+  CNT_Track(cnt);
+  uint32_t latch = sr & (TIM_SR_CC3IF | TIM_SR_CC4IF) & ~cnt->_half;
+  if(latch) {
+    // Reading CCR clears capture flag, capture is placed relative to count now (wrap-safe)
+    uint32_t capture = (latch & TIM_SR_CC4IF) ? cnt->reg->CCR4 : cnt->reg->CCR3;
+    cnt->_latch = cnt->_count + CNT_Distance(cnt, capture, cnt->_last);
+    cnt->_latched = true;
+  }
+}
+
+static void CNT_RateRef(CNT_t *cnt, int64_t count, uint32_t time_us, bool edge)
+{
+  cnt->_ref_count = count;
+  cnt->_ref_us = time_us;
+  cnt->_ref_edge = edge;
+}
+
+//------------------------------------------------------------------------------------------------- API
+
+void CNT_Init(CNT_t *cnt)
+{
+  TIM_TypeDef *reg = cnt->reg;
+  RCC_EnableTIM(reg);
+  reg->CR1 = 0;
+  reg->PSC = 0;
+  reg->ARR = TIM_Is32bit(reg) ? 0xFFFFFFFF : 0xFFFF;
+  cnt->_span = (uint64_t)reg->ARR + 1;
+  uint32_t ccmr1 = 0, ccer = 0, smcr = 0;
+  bool ti2 = !cnt->channel[TIM_CH1];
+  if(cnt->mode == CNT_Mode_Encoder) {
+    ccmr1 = TIM_CCMR1_CC1S_0 | TIM_CCMR1_CC2S_0 | (cnt->filter << TIM_CCMR1_IC1F_Pos) | (cnt->filter << TIM_CCMR1_IC2F_Pos);
+    ccer = cnt->falling ? TIM_CCER_CC1P : 0;
+    smcr = TIM_SMCR_SMS_1 | TIM_SMCR_SMS_0; // Encoder mode 3: both inputs, both edges
+  }
+  else if(ti2) {
+    ccmr1 = TIM_CCMR1_CC2S_0 | (cnt->filter << TIM_CCMR1_IC2F_Pos);
+    ccer = cnt->falling ? TIM_CCER_CC2P : 0;
+    smcr = TIM_SMCR_TS_2 | TIM_SMCR_TS_1 | TIM_SMCR_SMS_2 | TIM_SMCR_SMS_1 | TIM_SMCR_SMS_0; // TI2FP2, external clock 1
+  }
+  else {
+    ccmr1 = TIM_CCMR1_CC1S_0 | (cnt->filter << TIM_CCMR1_IC1F_Pos);
+    ccer = cnt->falling ? TIM_CCER_CC1P : 0;
+    smcr = TIM_SMCR_TS_2 | TIM_SMCR_TS_0 | TIM_SMCR_SMS_2 | TIM_SMCR_SMS_1 | TIM_SMCR_SMS_0; // TI1FP1, external clock 1
+  }
+  uint32_t ccmr2 = 0, dier = TIM_DIER_UIE;
+  // Free one of CH3/CH4 compares at half of range (output frozen, no pin): second observation point
+  cnt->_half = cnt->channel[TIM_CH3] ? TIM_SR_CC4IF : TIM_SR_CC3IF;
+  dier |= cnt->_half;
+  if(cnt->channel[TIM_CH3]) {
+    ccmr2 = TIM_CCMR2_CC3S_0 | (cnt->filter << TIM_CCMR2_IC3F_Pos);
+    ccer |= TIM_CCER_CC3E | (cnt->latch_falling ? TIM_CCER_CC3P : 0);
+    dier |= TIM_DIER_CC3IE;
+  }
+  else if(cnt->channel[TIM_CH4]) {
+    ccmr2 = TIM_CCMR2_CC4S_0 | (cnt->filter << TIM_CCMR2_IC4F_Pos);
+    ccer |= TIM_CCER_CC4E | (cnt->latch_falling ? TIM_CCER_CC4P : 0);
+    dier |= TIM_DIER_CC4IE;
+  }
+  reg->CCER = 0;
+  reg->CCMR1 = ccmr1;
+  reg->CCMR2 = ccmr2;
+  reg->CCER = ccer;
+  reg->SMCR = smcr;
+  if(cnt->_half == TIM_SR_CC4IF) reg->CCR4 = (uint32_t)(cnt->_span >> 1);
+  else reg->CCR3 = (uint32_t)(cnt->_span >> 1);
+  for(uint8_t i = TIM_CH1; i <= TIM_CH4; i++) {
+    if(cnt->channel[i]) GPIO_InitAlternate(&TIM_CHx_MAP[cnt->channel[i]], true);
+  }
+  // URS: `UG` below resets counter without wrap interrupt
+  reg->CR1 = TIM_CR1_URS;
+  reg->EGR = TIM_EGR_UG;
+  reg->SR = 0;
+  cnt->_count = 0;
+  cnt->_last = 0;
+  cnt->_latched = false;
+  IRQ_EnableTIM(reg, cnt->irq_priority, (void (*)(void *))&CNT_Interrupt, cnt);
+  reg->DIER = dier;
+  reg->CR1 |= TIM_CR1_CEN;
+  cnt->rate = 0;
+  cnt->_edge_count = 0;
+  cnt->_edge_us = tick_us();
+  CNT_RateRef(cnt, 0, cnt->_edge_us, false);
+}
+
+int64_t CNT_Value(CNT_t *cnt)
+{
+  uint32_t primask = __get_PRIMASK();
+  __disable_irq();
+  CNT_Track(cnt);
+  int64_t value = cnt->_count;
+  __set_PRIMASK(primask);
+  return value;
+}
+
+void CNT_Reset(CNT_t *cnt)
+{
+  uint32_t primask = __get_PRIMASK();
+  __disable_irq();
+  cnt->reg->CNT = 0;
+  cnt->reg->SR = ~(TIM_SR_UIF | cnt->_half);
+  cnt->_count = 0;
+  cnt->_last = 0;
+  cnt->_latched = false;
+  __set_PRIMASK(primask);
+  cnt->_edge_count = 0;
+  cnt->_edge_us = tick_us();
+  CNT_RateRef(cnt, 0, cnt->_edge_us, false);
+}
+
+bool CNT_Latched(CNT_t *cnt, int64_t *value)
+{
+  if(!cnt->_latched) return false;
+  uint32_t primask = __get_PRIMASK();
+  __disable_irq();
+  if(value) *value = cnt->_latch;
+  cnt->_latched = false;
+  __set_PRIMASK(primask);
+  return true;
+}
+
+bool CNT_Loop(CNT_t *cnt)
+{
+  uint32_t now = tick_us();
+  int64_t value = CNT_Value(cnt);
+  if(value != cnt->_edge_count) {
+    cnt->_edge_count = value;
+    cnt->_edge_us = now;
+  }
+  uint32_t elapsed = now - cnt->_ref_us;
+  if(elapsed < CNT_WINDOW_ms * 1000) return false;
+  int64_t delta = value - cnt->_ref_count;
+  if(delta >= CNT_RATE_COUNTS || delta <= -CNT_RATE_COUNTS) {
+    // High frequency: count per window, error `1 / CNT_RATE_COUNTS` or better
+    cnt->rate = (float)delta * 1000000.0f / elapsed;
+    cnt->period_method = false;
+    CNT_RateRef(cnt, value, now, false);
+    return true;
+  }
+  int64_t edges = cnt->_edge_count - cnt->_ref_count;
+  if(edges) {
+    bool valid = cnt->_ref_edge;
+    if(valid) {
+      // Low frequency: counts between two observed changes over their distance in time
+      cnt->rate = (float)edges * 1000000.0f / (uint32_t)(cnt->_edge_us - cnt->_ref_us);
+      cnt->period_method = true;
+    }
+    CNT_RateRef(cnt, cnt->_edge_count, cnt->_edge_us, true);
+    return valid;
+  }
+  if(elapsed >= CNT_TIMEOUT_ms * 1000) {
+    cnt->rate = 0;
+    cnt->period_method = false;
+    CNT_RateRef(cnt, value, now, false);
+    return true;
+  }
+  return false;
+}
+
+//-------------------------------------------------------------------------------------------------
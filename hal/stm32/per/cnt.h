@@ -0,0 +1,124 @@
+// hal/stm32/per/cnt.h
+
+#ifndef CNT_H_
+#define CNT_H_
+
+#include "gpio.h"
+#include "tim.h"
+#include "vrts.h"
+#include "main.h"
+
+//-------------------------------------------------------------------------------------------------
+
+#ifndef CNT_WINDOW_ms
+  // Rate estimation window (count-per-window method)
+  #define CNT_WINDOW_ms 100
+#endif
+
+#ifndef CNT_TIMEOUT_ms
+  // No count change for this long means rate `0`
+  #define CNT_TIMEOUT_ms 2000
+#endif
+
+#ifndef CNT_RATE_COUNTS
+  // Below this many counts per window rate comes from edge-to-edge period (low frequency)
+  #define CNT_RATE_COUNTS 100
+#endif
+
+typedef enum {
+  CNT_Mode_Clock = 0,   // Count edges of one input (TI1 or TI2), external clock mode 1
+  CNT_Mode_Encoder = 1  // Quadrature A/B on TI1/TI2, x4 resolution, up/down
+} CNT_Mode_t;
+
+/**
+ * @brief Hardware pulse counter / quadrature decoder on timer with 64-bit software extension.
+ * Timer counts edges without CPU, interrupt runs only on counter wrap, half of range and latch capture.
+ * @param[in] reg Timer peripheral with slave mode controller and 4 channels (TIM1, TIM2, TIM3, ...)
+ * @param[in] mode Counter mode
+ * @param[in] channel[4] Channel pin mapping: `[TIM_CH1]` = TI1 (A), `[TIM_CH2]` = TI2 (B),
+ *   `CNT_Mode_Clock` uses the one that is set. Optional `[TIM_CH3]` or `[TIM_CH4]`
+ *   is latch input: its edge captures counter in hardware (`CNT_Latched`).
+ * @param[in] falling Count on falling edges, in encoder mode reverses direction
+ * @param[in] latch_falling Latch on falling edge of latch input
+ * @param[in] filter Input filter
+ * @param[in] irq_priority Interrupt priority
+ * @param[out] rate Count rate `[Hz]` (negative for encoder moving down), updated by `CNT_Loop`
+ * @param[out] period_method `rate` comes from edge-to-edge period, otherwise from count per window
+ * Internal:
+ * @param _count Extended count (sum of counter moves).
+ * @param _last Counter value at last observation (`_count` matches it).
+ * @param _span Counter wrap (`ARR + 1`).
+ * @param _half `SR` flag of free compare channel (CH3 or CH4) set at half of range.
+ * @param _latch Latched 64-bit count.
+ * @param _latched New latch available.
+ * @param _ref_count Count at start of rate measurement.
+ * @param _ref_us Time of `_ref_count` `[us]`.
+ * @param _edge_count Count at last observed change.
+ * @param _edge_us Time of `_edge_count` `[us]`.
+ * @param _ref_edge `_ref_count` was taken at observed change (valid period reference).
+ */
+typedef struct {
+  TIM_TypeDef *reg;
+  CNT_Mode_t mode;
+  TIM_CHx_t channel[4];
+  bool falling;
+  bool latch_falling;
+  TIM_Filter_t filter;
+  IRQ_Priority_t irq_priority;
+  float rate;
+  bool period_method;
+  volatile int64_t _count;
+  volatile uint32_t _last;
+  uint64_t _span;
+  uint32_t _half;
+  volatile int64_t _latch;
+  volatile bool _latched;
+  int64_t _ref_count;
+  uint32_t _ref_us;
+  int64_t _edge_count;
+  uint32_t _edge_us;
+  bool _ref_edge;
+} CNT_t;
+
+//------------------------------------------------------------------------------------------------- API
+
+/**
+ * @brief Initialize counter, pins go to alternate function (input data register still readable).
+ * @param[in,out] cnt Counter instance
+ */
+void CNT_Init(CNT_t *cnt);
+
+/**
+ * @brief Current 64-bit count, consistent with pending counter wrap.
+ * @param[in] cnt Counter instance
+ * @return Count (encoder: position)
+ */
+int64_t CNT_Value(CNT_t *cnt);
+
+/**
+ * @brief Set count to zero, also drops pending latch and restarts rate measurement.
+ * @param[in,out] cnt Counter instance
+ */
+void CNT_Reset(CNT_t *cnt);
+
+/**
+ * @brief Take count latched by `latch` pin edge.
+ * @param[in,out] cnt Counter instance
+ * @param[out] value Latched count (may be `NULL`)
+ * @return `true` if new latch since last call
+ */
+bool CNT_Latched(CNT_t *cnt, int64_t *value);
+
+/**
+ * @brief Update `rate` (call in main loop or scan cycle).
+ * High frequency: counts over `CNT_WINDOW_ms`. Below `CNT_RATE_COUNTS` per window:
+ * counts between first and last observed change over their time distance,
+ * window stretches until edges come or `CNT_TIMEOUT_ms` passes.
+ * @param[in,out] cnt Counter instance
+ * @return `true` if `rate` was updated
+ */
+bool CNT_Loop(CNT_t *cnt);
+
+//-------------------------------------------------------------------------------------------------
+
+#endif
@@ -4,40 +4,114 @@
 
 //-------------------------------------------------------------------------------------------------
 
-uint32_t CRC_Run(const CRC_t *crc, void *data, uint16_t count)
+#define CRC_REV_IN_BYTE (1 << CRC_CR_REV_IN_Pos)
+#define CRC_REV_IN_WORD (3 << CRC_CR_REV_IN_Pos)
+
+static inline void CRC_Bytes(const uint8_t *bytes, uint16_t count)
+{
+  while(count--) *(volatile uint8_t *)&CRC->DR = *bytes++;
+}
+
+// Memory-to-memory transfer into `DR` (`size`: 0 = byte, 2 = word), waits for completion
+static void CRC_Dma(const void *data, uint16_t count, uint8_t size)
+{
+  static DMA_t dma;
+  if(!dma.cha) {
+    DMA_SetRegisters(CRC_DMA, &dma);
+    RCC_EnableDMA(dma.reg);
+    dma.mux->CCR = 0;
+  }
+  dma.cha->CCR = 0;
+  dma.cha->CPAR = (uint32_t)&CRC->DR;
+  dma.cha->CMAR = (uint32_t)data;
+  dma.cha->CNDTR = count;
+  dma.cha->CCR = DMA_CCR_MEM2MEM | DMA_CCR_DIR | DMA_CCR_MINC |
+    (size << DMA_CCR_MSIZE_Pos) | (size << DMA_CCR_PSIZE_Pos) | DMA_CCR_EN;
+  while(!(dma.reg->ISR & DMA_ISR_TCIF(dma.pos)));
+  dma.reg->IFCR |= DMA_ISR_GIF(dma.pos);
+  dma.cha->CCR = 0;
+}
+
+// Feed data to CRC unit started from `init` register value, returns `DR`
+static uint32_t CRC_Feed(const CRC_t *crc, uint32_t init, bool reflect_out, const void *data, uint16_t count)
 {
-  uint32_t out;
-  uint8_t *pointner = (uint8_t *)&out;
-  CRC->CR &= 0xFFFFFF07;
+  const uint8_t *bytes = (const uint8_t *)data;
   RCC_CRC_EN();
   CRC->POL = crc->polynomial;
-  CRC->INIT = crc->initial;
+  CRC->INIT = init;
+  uint32_t cr = 0;
   switch(crc->width) {
-    case 8:  CRC->CR = (2 << CRC_CR_POLYSIZE_Pos); break;
-    case 16: CRC->CR = (1 << CRC_CR_POLYSIZE_Pos); break;
-    case 32: CRC->CR = 0; break;
+    case 8:  cr = (2 << CRC_CR_POLYSIZE_Pos); break;
+    case 16: cr = (1 << CRC_CR_POLYSIZE_Pos); break;
+    case 32: cr = 0; break;
   }
-  switch(crc->reflect_data_in) {
-    case 8:  CRC->CR |= (1 << CRC_CR_REV_IN_Pos); break;
-    case 16: CRC->CR |= (2 << CRC_CR_REV_IN_Pos); break;
-    case 32: CRC->CR |= (3 << CRC_CR_REV_IN_Pos); break;
-  }
-  CRC->CR |= (crc->reflect_data_out << CRC_CR_REV_OUT_Pos) | CRC_CR_RESET;
+  cr |= (reflect_out << CRC_CR_REV_OUT_Pos);
+  bool reflect = crc->reflect_data_in;
+  CRC->CR = cr | (reflect ? CRC_REV_IN_BYTE : 0) | CRC_CR_RESET;
   __DSB();
-  while(count--) {
-    *(volatile uint8_t *) &CRC->DR = *(const uint8_t *)(data);
-    data = (void *)((const uint8_t *)data + 1);
+  // Head up to word alignment
+  uint8_t head = (4 - ((uint32_t)bytes & 3)) & 3;
+  if(head > count) head = count;
+  CRC_Bytes(bytes, head);
+  bytes += head;
+  count -= head;
+  uint16_t words = count / 4;
+  if(words) {
+    if(reflect) {
+      // Word reversal of little-endian word equals byte reversal of its bytes in memory order
+      CRC->CR = cr | CRC_REV_IN_WORD;
+      // `CRC_DMA` is enum constant, so it is checked in code (branch is removed when `DMA_None`)
+      if(CRC_DMA != DMA_None && count >= CRC_DMA_THRESHOLD) CRC_Dma(bytes, words, 2);
+      else for(uint16_t i = 0; i < words; i++) CRC->DR = ((const uint32_t *)bytes)[i];
+      CRC->CR = cr | CRC_REV_IN_BYTE;
+    }
+    else {
+      // Unit takes word from MSB, so byte order is swapped (DMA cannot swap, it feeds bytes)
+      if(CRC_DMA != DMA_None && count >= CRC_DMA_THRESHOLD) CRC_Dma(bytes, words * 4, 0);
+      else for(uint16_t i = 0; i < words; i++) CRC->DR = __REV(((const uint32_t *)bytes)[i]);
+    }
+    bytes += words * 4;
+    count -= words * 4;
   }
-  out = (CRC->DR ^ crc->final_xor);
+  CRC_Bytes(bytes, count);
+  return CRC->DR;
+}
+
+static uint32_t CRC_Output(const CRC_t *crc, uint32_t out)
+{
+  out ^= crc->final_xor;
   if(crc->invert_out) {
     switch(crc->width) {
-      case 32: return (pointner[0] << 24) | (pointner[1] << 16) | (pointner[2] << 8) | pointner[3];
-      case 16: return (pointner[0] << 8) | pointner[1];
+      case 32: return __REV(out);
+      case 16: return __REV16(out) & 0xFFFF;
     }
   }
   return out;
 }
 
+uint32_t CRC_Run(const CRC_t *crc, void *data, uint16_t count)
+{
+  return CRC_Output(crc, CRC_Feed(crc, crc->initial, crc->reflect_data_out, data, count));
+}
+
+uint32_t CRC_Begin(const CRC_t *crc)
+{
+  return crc->initial;
+}
+
+// State is `DR` read without output reflection, so it can be loaded back to `INIT`
+uint32_t CRC_Update(const CRC_t *crc, uint32_t state, const void *data, uint16_t count)
+{
+  return CRC_Feed(crc, state, false, data, count);
+}
+
+uint32_t CRC_End(const CRC_t *crc, uint32_t state)
+{
+  state &= 0xFFFFFFFF >> (32 - crc->width);
+  if(crc->reflect_data_out) state = __RBIT(state) >> (32 - crc->width);
+  return CRC_Output(crc, state);
+}
+
 //-------------------------------------------------------------------------------------------------
 
 uint16_t CRC_Append(const CRC_t *crc, uint8_t *data, uint16_t count)
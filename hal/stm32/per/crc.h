@@ -12,6 +12,8 @@
 #elif defined(STM32G4)
   #include "stm32g4xx.h"
 #endif
+#include "dma.h"
+#include "pwr.h"
 #include "xdef.h"
 #include "main.h"
 
@@ -29,6 +31,16 @@
   #define CRC_PRESETS 1
 #endif
 
+#ifndef CRC_DMA
+  // DMA channel feeding CRC unit from memory (`DMA_None` = CPU only)
+  #define CRC_DMA DMA_None
+#endif
+
+#ifndef CRC_DMA_THRESHOLD
+  // Smallest buffer [bytes] sent to CRC unit by DMA
+  #define CRC_DMA_THRESHOLD 256
+#endif
+
 //--------------------------------------------------------------------------------------- Types
 
 /**
@@ -36,7 +48,7 @@
  * @param[in] width CRC width in bits (8, 16, or 32)
  * @param[in] polynomial Generator polynomial
  * @param[in] initial Initial CRC register value
- * @param[in] reflect_data_in Bit-reflect input bytes (0 = none, 8/16/32 = width)
+ * @param[in] reflect_data_in Bit-reflect input bytes (0 = none, any other value = reflect)
  * @param[in] reflect_data_out Bit-reflect final CRC
  * @param[in] final_xor XOR mask applied to final CRC
  * @param[in] invert_out Invert final CRC byte order
@@ -54,7 +66,8 @@ typedef struct {
 //---------------------------------------------------------------------------------------- API
 
 /**
- * @brief Calculate CRC checksum.
+ * @brief Calculate CRC checksum on CRC unit. Aligned part of data is written by words
+ * (by DMA for buffers from `CRC_DMA_THRESHOLD`), rest by bytes.
  * @param[in] crc CRC algorithm configuration
  * @param[in] data Pointer to input data
  * @param[in] count Data length in bytes
@@ -62,6 +75,32 @@ typedef struct {
  */
 uint32_t CRC_Run(const CRC_t *crc, void *data, uint16_t count);
 
+/**
+ * @brief Start incremental CRC (`CRC_Begin`, `CRC_Update` for each part, `CRC_End`).
+ * Result equals `CRC_Run` over all parts joined.
+ * @param[in] crc CRC algorithm configuration
+ * @return Initial state
+ */
+uint32_t CRC_Begin(const CRC_t *crc);
+
+/**
+ * @brief Add data to incremental CRC.
+ * @param[in] crc CRC algorithm configuration
+ * @param[in] state State from `CRC_Begin` or previous `CRC_Update`
+ * @param[in] data Pointer to input data
+ * @param[in] count Data length in bytes
+ * @return New state
+ */
+uint32_t CRC_Update(const CRC_t *crc, uint32_t state, const void *data, uint16_t count);
+
+/**
+ * @brief Finish incremental CRC.
+ * @param[in] crc CRC algorithm configuration
+ * @param[in] state State from last `CRC_Update`
+ * @return CRC checksum
+ */
+uint32_t CRC_End(const CRC_t *crc, uint32_t state);
+
 /**
  * @brief Calculate CRC and append to data (big-endian).
  * @param[in] crc CRC algorithm configuration
@@ -97,8 +97,224 @@ bool GPIO_In(GPIO_t *gpio)
 
 bool GPIO_NotIn(GPIO_t *gpio) { return !GPIO_In(gpio); }
 
+//------------------------------------------------------------------------------------------------- SCAN
+
+// Deadline `ms` after event that happened `age_ms` ago
+static uint64_t GPIF_Keep(uint32_t ms, uint32_t age_ms)
+{
+  return tick_keep(ms > age_ms ? ms - age_ms : 0);
+}
+
+// Edge bookkeeping of long press/toggle, `edge` = debounced state changed to `input` `age_ms` ago
+static void GPIF_Timers(GPIF_t *gpif, bool input, bool edge, uint32_t age_ms)
+{
+  if(edge) {
+    // Toggle logic
+    if(!gpif->_tick_reset) gpif->_tick_toggle = GPIF_Keep(gpif->toggle_ms, age_ms);
+    if(!gpif->_toggle) gpif->_tick_reset = GPIF_Keep(gpif->toggle_ms / 2, age_ms);
+    gpif->_tick_long = GPIF_Keep(input ? gpif->ton_long_ms : gpif->toff_long_ms, age_ms);
+  }
+  // Long press/release
+  if(tick_over(&gpif->_tick_long)) {
+    if(input) gpif->_rise_long = true;
+    else gpif->_fall_long = true;
+  }
+  // Toggle reset window
+  if(tick_over(&gpif->_tick_reset)) gpif->_tick_toggle = 0;
+  // Toggle trigger
+  if(tick_over(&gpif->_tick_toggle)) {
+    gpif->_toggle = !gpif->_toggle;
+    gpif->_toggle_changed = true;
+  }
+}
+
+static void GPIO_ScanStats(GPIO_Scan_t *scan, uint32_t start_us, bool add)
+{
+  uint16_t time_us = (uint16_t)(tick_us() - start_us);
+  scan->_time_us = add ? (uint16_t)(scan->_time_us + time_us) : time_us;
+  if(scan->_time_us > scan->_max_us) scan->_max_us = scan->_time_us;
+}
+
+uint16_t GPIO_ScanInputs(GPIO_Scan_t *scan)
+{
+  uint32_t start_us = tick_us();
+  uint16_t raw = (uint16_t)((scan->port->IDR ^ scan->_reverse) & scan->_mask);
+  uint32_t elapsed = (uint32_t)tick_diff(scan->_tick);
+  if(elapsed) scan->_tick = tick_now();
+  if(elapsed > (1u << GPIO_SCAN_BITS) - 1) elapsed = (1u << GPIO_SCAN_BITS) - 1;
+  uint16_t input = scan->_input;
+  uint16_t stable = (uint16_t)~(raw ^ input);
+  // Changing pins: counters minus `elapsed` (bit-parallel subtractor), underflow saturates at zero
+  uint16_t borrow = 0;
+  for(uint8_t k = 0; k < GPIO_SCAN_BITS; k++) {
+    uint16_t count = scan->_count[k];
+    uint16_t minus = ((elapsed >> k) & 1) ? 0xFFFF : 0;
+    scan->_count[k] = count ^ minus ^ borrow;
+    borrow = (uint16_t)((~count & (minus | borrow)) | (minus & borrow));
+  }
+  // Stable pins: reload time needed to leave current state (`toff` when high, `ton` when low)
+  uint16_t pending = 0;
+  for(uint8_t k = 0; k < GPIO_SCAN_BITS; k++) {
+    uint16_t count = scan->_count[k] & (uint16_t)~borrow;
+    uint16_t reload = (scan->_toff[k] & input) | (scan->_ton[k] & (uint16_t)~input);
+    pending |= count;
+    scan->_count[k] = (reload & stable) | (count & (uint16_t)~stable);
+  }
+  uint16_t flip = (uint16_t)(~stable & ~pending & scan->_mask);
+  input ^= flip;
+  scan->_input = input;
+  if(flip) {
+    // Flipped pins start timing from new state
+    for(uint8_t k = 0; k < GPIO_SCAN_BITS; k++) {
+      uint16_t reload = (scan->_toff[k] & input) | (scan->_ton[k] & (uint16_t)~input);
+      scan->_count[k] = (scan->_count[k] & (uint16_t)~flip) | (reload & flip);
+    }
+  }
+  scan->_rise |= flip & input;
+  scan->_fall |= flip & (uint16_t)~input;
+  // Per-pin work only for fresh edges and running long press/toggle timers
+  uint16_t todo = flip | scan->_active;
+  while(todo) {
+    uint8_t pin = (uint8_t)__builtin_ctz(todo);
+    uint16_t bit = (uint16_t)(1u << pin);
+    todo &= (uint16_t)~bit;
+    GPIF_t *gpif = scan->_gpif[pin];
+    GPIF_Timers(gpif, input & bit, flip & bit, 0);
+    if(gpif->_tick_long || gpif->_tick_toggle || gpif->_tick_reset) scan->_active |= bit;
+    else scan->_active &= (uint16_t)~bit;
+  }
+  GPIO_ScanStats(scan, start_us, false);
+  return flip;
+}
+
+void GPIO_ScanOutputs(GPIO_Scan_t *scan)
+{
+  uint32_t start_us = tick_us();
+  if(scan->_set | scan->_rst) {
+    scan->port->BSRR = ((uint32_t)scan->_rst << 16) | scan->_set;
+    scan->_set = 0;
+    scan->_rst = 0;
+  }
+  GPIO_ScanStats(scan, start_us, true);
+}
+
+uint16_t GPIO_ScanTime(GPIO_Scan_t *scan, uint16_t *max_us)
+{
+  if(max_us) *max_us = scan->_max_us;
+  return scan->_time_us;
+}
+
+// Take (test and clear) event bit of pin
+static bool GPIO_ScanTake(uint16_t *word, uint8_t pin)
+{
+  uint16_t bit = (uint16_t)(1u << pin);
+  if(!(*word & bit)) return false;
+  *word &= (uint16_t)~bit;
+  return true;
+}
+
 //------------------------------------------------------------------------------------------------- GPIF
 
+// Interrupt: record edge time and level (`reverse` applied)
+static void GPIF_CapturePush(GPIF_t *gpif, bool raw)
+{
+  GPIF_Capture_t *capture = gpif->capture;
+  uint32_t time_us = tick_us();
+  uint8_t head = capture->_head;
+  uint8_t next = (head + 1) & (GPIF_CAPTURE_RING - 1);
+  if(next == capture->_tail) {
+    capture->_lost = true;
+    return;
+  }
+  capture->_edge[head].time_us = time_us;
+  capture->_edge[head].level = gpif->gpio.reverse ? !raw : raw;
+  capture->_head = next;
+}
+
+static void GPIF_CaptureRise(void *gpif) { GPIF_CapturePush((GPIF_t *)gpif, true); }
+static void GPIF_CaptureFall(void *gpif) { GPIF_CapturePush((GPIF_t *)gpif, false); }
+
+// Accept pending level if it stayed for debounce time before `until_us`
+static void GPIF_CaptureSettle(GPIF_t *gpif, uint32_t until_us, uint32_t now_us)
+{
+  GPIF_Capture_t *capture = gpif->capture;
+  if(capture->_raw == gpif->_input) return;
+  uint32_t debounce_us = (capture->_raw ? gpif->ton_ms : gpif->toff_ms) * 1000;
+  if((int32_t)(until_us - capture->_raw_us) < (int32_t)debounce_us) return;
+  gpif->_input = capture->_raw;
+  if(gpif->_input) gpif->_rise = true;
+  else gpif->_fall = true;
+  // Timers count from moment debounce was satisfied, not from this call
+  int32_t age_us = (int32_t)(now_us - (capture->_raw_us + debounce_us));
+  GPIF_Timers(gpif, gpif->_input, true, age_us > 0 ? (uint32_t)age_us / 1000 : 0);
+}
+
+static void GPIF_CaptureLoop(GPIF_t *gpif)
+{
+  GPIF_Capture_t *capture = gpif->capture;
+  // Edges recorded after `head` snapshot are newer than `now_us`, they wait for next call
+  uint8_t head = capture->_head;
+  uint32_t now_us = tick_us();
+  while(capture->_tail != head) {
+    GPIF_Edge_t *edge = &capture->_edge[capture->_tail];
+    GPIF_CaptureSettle(gpif, edge->time_us, now_us);
+    if(edge->level != capture->_raw) {
+      capture->_raw = edge->level;
+      capture->_raw_us = edge->time_us;
+    }
+    capture->_tail = (capture->_tail + 1) & (GPIF_CAPTURE_RING - 1);
+  }
+  if(capture->_lost) {
+    // Edges between full ring and now are gone, continue from actual pin level
+    capture->_lost = false;
+    bool raw = GPIO_In(&gpif->gpio);
+    if(raw != capture->_raw) {
+      capture->_raw = raw;
+      capture->_raw_us = now_us;
+    }
+  }
+  GPIF_CaptureSettle(gpif, now_us, now_us);
+  GPIF_Timers(gpif, gpif->_input, false, 0);
+}
+
+static void GPIF_CaptureInit(GPIF_t *gpif)
+{
+  GPIF_Capture_t *capture = gpif->capture;
+  EXTI_t *exti = &capture->exti;
+  exti->port = gpif->gpio.port;
+  exti->pin = gpif->gpio.pin;
+  exti->mode = GPIO_Mode_Input;
+  exti->pull = gpif->gpio.pull;
+  exti->rise_detect = true;
+  exti->fall_detect = true;
+  exti->irq_enable = true;
+  exti->oneshot = false;
+  exti->RiseHandler = &GPIF_CaptureRise;
+  exti->rise_arg = gpif;
+  exti->FallHandler = &GPIF_CaptureFall;
+  exti->fall_arg = gpif;
+  capture->_head = 0;
+  capture->_tail = 0;
+  capture->_lost = false;
+  capture->_raw = gpif->_input;
+  capture->_raw_us = tick_us();
+  EXTI_Init(exti);
+}
+
+void GPIF_Timing(GPIF_t *gpif)
+{
+  GPIO_Scan_t *scan = gpif->scan;
+  if(!scan) return;
+  uint32_t limit = (1u << GPIO_SCAN_BITS) - 1;
+  uint32_t ton = gpif->ton_ms < limit ? gpif->ton_ms : limit;
+  uint32_t toff = gpif->toff_ms < limit ? gpif->toff_ms : limit;
+  uint16_t bit = (uint16_t)(1u << gpif->gpio.pin);
+  for(uint8_t k = 0; k < GPIO_SCAN_BITS; k++) {
+    scan->_ton[k] = (scan->_ton[k] & (uint16_t)~bit) | (((ton >> k) & 1) ? bit : 0);
+    scan->_toff[k] = (scan->_toff[k] & (uint16_t)~bit) | (((toff >> k) & 1) ? bit : 0);
+  }
+}
+
 void GPIF_Init(GPIF_t *gpif)
 {
   gpif->gpio.mode = GPIO_Mode_Input;
@@ -119,55 +335,64 @@ void GPIF_Init(GPIF_t *gpif)
   gpif->_tick_long = 0;
   gpif->_tick_toggle = 0;
   gpif->_tick_reset = 0;
+  if(gpif->scan) {
+    GPIO_Scan_t *scan = gpif->scan;
+    uint16_t bit = (uint16_t)(1u << gpif->gpio.pin);
+    if(!scan->_mask) scan->_tick = tick_now();
+    scan->_mask |= bit;
+    scan->_gpif[gpif->gpio.pin] = gpif;
+    if(gpif->gpio.reverse) scan->_reverse |= bit;
+    else scan->_reverse &= (uint16_t)~bit;
+    if(gpif->_input) scan->_input |= bit;
+    else scan->_input &= (uint16_t)~bit;
+    // Counter starts stable, first scan reloads it
+    for(uint8_t k = 0; k < GPIO_SCAN_BITS; k++) scan->_count[k] &= (uint16_t)~bit;
+    GPIF_Timing(gpif);
+  }
+  else if(gpif->capture) GPIF_CaptureInit(gpif);
 }
 
 void GPIF_Loop(GPIF_t *gpif)
 {
+  if(gpif->scan) return;
+  if(gpif->capture) {
+    GPIF_CaptureLoop(gpif);
+    return;
+  }
   bool raw = GPIO_In(&gpif->gpio);
+  bool edge = false;
   // Debounce
   if(raw == gpif->_input) {
     gpif->_tick_debounce = raw ? tick_keep(gpif->toff_ms) : tick_keep(gpif->ton_ms);
   }
   else if(tick_over(&gpif->_tick_debounce)) {
     gpif->_input = raw;
-    // Toggle logic
-    if(!gpif->_tick_reset) gpif->_tick_toggle = tick_keep(gpif->toggle_ms);
-    if(!gpif->_toggle) gpif->_tick_reset = tick_keep(gpif->toggle_ms / 2);
+    edge = true;
     // Edge detection
-    if(raw) {
-      gpif->_rise = true;
-      gpif->_tick_long = tick_keep(gpif->ton_long_ms);
-    }
-    else {
-      gpif->_fall = true;
-      gpif->_tick_long = tick_keep(gpif->toff_long_ms);
-    }
-  }
-  // Long press/release
-  if(tick_over(&gpif->_tick_long)) {
-    if(gpif->_input) gpif->_rise_long = true;
-    else gpif->_fall_long = true;
-  }
-  // Toggle reset window
-  if(tick_over(&gpif->_tick_reset)) gpif->_tick_toggle = 0;
-  // Toggle trigger
-  if(tick_over(&gpif->_tick_toggle)) {
-    gpif->_toggle = !gpif->_toggle;
-    gpif->_toggle_changed = true;
+    if(raw) gpif->_rise = true;
+    else gpif->_fall = true;
   }
+  GPIF_Timers(gpif, gpif->_input, edge, 0);
+}
+
+bool GPIF_Input(GPIF_t *gpif)
+{
+  if(gpif->scan) return (gpif->scan->_input >> gpif->gpio.pin) & 1;
+  return gpif->_input;
 }
 
-bool GPIF_Input(GPIF_t *gpif) { return gpif->_input; }
 bool GPIF_Toggle(GPIF_t *gpif) { return gpif->_toggle; }
 
 bool GPIF_Rise(GPIF_t *gpif)
 {
+  if(gpif->scan) return GPIO_ScanTake(&gpif->scan->_rise, gpif->gpio.pin);
   if(gpif->_rise) { gpif->_rise = false; return true; }
   return false;
 }
 
 bool GPIF_Fall(GPIF_t *gpif)
 {
+  if(gpif->scan) return GPIO_ScanTake(&gpif->scan->_fall, gpif->gpio.pin);
   if(gpif->_fall) { gpif->_fall = false; return true; }
   return false;
 }
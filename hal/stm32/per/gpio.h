@@ -20,6 +20,16 @@
   #define GPIO_INCLUDE_WAKEUP 0
 #endif
 
+#ifndef GPIO_SCAN_BITS
+  // Width of vertical debounce counters in port scan, limits debounce time to `2^bits - 1` ms
+  #define GPIO_SCAN_BITS 10
+#endif
+
+#ifndef GPIF_CAPTURE_RING
+  // Edge timestamps buffered per EXTI capture input between `GPIF_Loop` calls (power of 2)
+  #define GPIF_CAPTURE_RING 8
+#endif
+
 //------------------------------------------------------------------------------------------------- GPIO Types
 
 typedef enum {
@@ -279,6 +289,103 @@ uint16_t EXTI_Fall(EXTI_t *exti);
  */
 bool EXTI_In(EXTI_t *exti);
 
+//------------------------------------------------------------------------------------------------- SCAN Types
+
+typedef struct GPIF_s GPIF_t;
+
+/**
+ * @brief Port-wide I/O scan: one `IDR` read and one `BSRR` write per port.
+ * All inputs of port are debounced together with vertical counters (bit `n` of plane `k`
+ * is bit `k` of pin `n` counter), so stable port costs same regardless of inputs count.
+ * Attached `GPIF_t` inputs become views onto `input`/`rise`/`fall` words.
+ * @param[in] port GPIO port pointer (`GPIOA`, `GPIOB`, etc.)
+ * Internal:
+ * @param _mask Pins attached as inputs
+ * @param _reverse Inverted inputs
+ * @param _input Debounced input states
+ * @param _rise Rising edges not yet taken
+ * @param _fall Falling edges not yet taken
+ * @param _active Inputs with running long press/toggle timers
+ * @param _ton Debounce ON time planes
+ * @param _toff Debounce OFF time planes
+ * @param _count Debounce counters planes
+ * @param _set Pins to set on next `GPIO_ScanOutputs`
+ * @param _rst Pins to reset on next `GPIO_ScanOutputs`
+ * @param _gpif Attached inputs by pin
+ * @param _tick Last input scan tick
+ * @param _time_us Duration of last input and output scan `[us]`
+ * @param _max_us Longest input and output scan `[us]`
+ */
+typedef struct {
+  GPIO_TypeDef *port;
+  // internal
+  uint16_t _mask;
+  uint16_t _reverse;
+  uint16_t _input;
+  uint16_t _rise;
+  uint16_t _fall;
+  uint16_t _active;
+  uint16_t _ton[GPIO_SCAN_BITS];
+  uint16_t _toff[GPIO_SCAN_BITS];
+  uint16_t _count[GPIO_SCAN_BITS];
+  uint16_t _set;
+  uint16_t _rst;
+  GPIF_t *_gpif[16];
+  uint64_t _tick;
+  uint16_t _time_us;
+  uint16_t _max_us;
+} GPIO_Scan_t;
+
+//------------------------------------------------------------------------------------------------- SCAN API
+
+/**
+ * @brief Snapshot port inputs, debounce them and run timers of attached `GPIF_t`.
+ * Call once per cycle before logic.
+ * @param[in,out] scan Pointer to port scan structure
+ * @return Debounced edges (rise or fall) in this scan
+ */
+uint16_t GPIO_ScanInputs(GPIO_Scan_t *scan);
+
+/**
+ * @brief Write queued output changes of port with single `BSRR` access.
+ * Call once per cycle after logic.
+ * @param[in,out] scan Pointer to port scan structure
+ */
+void GPIO_ScanOutputs(GPIO_Scan_t *scan);
+
+/**
+ * @brief Queue output pin change for next `GPIO_ScanOutputs` (respects `reverse` flag).
+ * Also updates `gpio->set`, so state getters see new value immediately.
+ * @param[in,out] scan Pointer to port scan structure
+ * @param[in,out] gpio Output pin on `scan->port`
+ * @param[in] value `true` = set, `false` = reset
+ */
+static inline void GPIO_ScanWrite(GPIO_Scan_t *scan, GPIO_t *gpio, bool value)
+{
+  uint16_t bit = (uint16_t)(1u << gpio->pin);
+  gpio->set = value;
+  if(value != gpio->reverse) { scan->_set |= bit; scan->_rst &= (uint16_t)~bit; }
+  else { scan->_rst |= bit; scan->_set &= (uint16_t)~bit; }
+}
+
+/**
+ * @brief Get debounced state of all inputs of port.
+ * @param[in] scan Pointer to port scan structure
+ * @return Input word, bit `n` = pin `n` (`reverse` applied)
+ */
+static inline uint16_t GPIO_ScanWord(GPIO_Scan_t *scan)
+{
+  return scan->_input;
+}
+
+/**
+ * @brief Get scan time statistics.
+ * @param[in] scan Pointer to port scan structure
+ * @param[out] max_us Longest scan `[us]` (optional, `NULL` = skip)
+ * @return Last scan time `[us]` (inputs plus outputs)
+ */
+uint16_t GPIO_ScanTime(GPIO_Scan_t *scan, uint16_t *max_us);
+
 //------------------------------------------------------------------------------------------------- GPIF Types
 
 #define GPIF_DEFAULT_TON_ms       50
@@ -287,6 +394,38 @@ bool EXTI_In(EXTI_t *exti);
 #define GPIF_DEFAULT_TOFF_LONG_ms 2000
 #define GPIF_DEFAULT_TOGGLE_ms    400
 
+typedef struct {
+  uint32_t time_us;
+  bool level;
+} GPIF_Edge_t;
+
+/**
+ * @brief EXTI edge capture of `GPIF_t`: interrupt stores timestamp (SysTick + sub-tick `tick_us`)
+ * and level of every edge, `GPIF_Loop` debounces recorded edges at their own time.
+ * Pulses shorter than loop period are not lost and idle input costs no reading.
+ * EXTI line is pin number, so only one port can use each pin number.
+ * @param[in] exti EXTI configuration, `GPIF_Init` fills pin, edges and handlers,
+ *   only `irq_priority` is taken from user. Any priority gives correct timestamps,
+ *   default `0` (above SysTick) keeps edge latency lowest.
+ * Internal:
+ * @param _edge Edge ring written by interrupt
+ * @param _head Write index (interrupt)
+ * @param _tail Read index (`GPIF_Loop`)
+ * @param _lost Ring was full, edges dropped (pin level is read again)
+ * @param _raw Level after last recorded edge
+ * @param _raw_us Time of last recorded edge
+ */
+typedef struct {
+  EXTI_t exti;
+  // internal
+  GPIF_Edge_t _edge[GPIF_CAPTURE_RING];
+  volatile uint8_t _head;
+  volatile uint8_t _tail;
+  volatile bool _lost;
+  bool _raw;
+  uint32_t _raw_us;
+} GPIF_Capture_t;
+
 /**
  * @brief Filtered GPIO input with debounce, edge detection and toggle.
  * @param[in] gpio Underlying GPIO configuration
@@ -295,6 +434,10 @@ bool EXTI_In(EXTI_t *exti);
  * @param[in] ton_long_ms Long press threshold [ms]
  * @param[in] toff_long_ms Long release threshold [ms]
  * @param[in] toggle_ms Double-click window for toggle [ms]
+ * @param[in] scan Optional port scan (`NULL` = own pin read in `GPIF_Loop`),
+ *   debounce time is limited by `GPIO_SCAN_BITS`
+ * @param[in] capture Optional EXTI edge capture (`NULL` = level polled in `GPIF_Loop`),
+ *   ignored when `scan` is set
  * Internal:
  * @param _rise Rising edge flag
  * @param _fall Falling edge flag
@@ -308,13 +451,15 @@ bool EXTI_In(EXTI_t *exti);
  * @param _tick_toggle Toggle window timer
  * @param _tick_reset Toggle reset timer
  */
-typedef struct {
+struct GPIF_s {
   GPIO_t gpio;
   uint32_t ton_ms;
   uint32_t toff_ms;
   uint32_t ton_long_ms;
   uint32_t toff_long_ms;
   uint32_t toggle_ms;
+  GPIO_Scan_t *scan;
+  GPIF_Capture_t *capture;
   // internal
   bool _rise;
   bool _fall;
@@ -327,7 +472,7 @@ typedef struct {
   uint64_t _tick_long;
   uint64_t _tick_toggle;
   uint64_t _tick_reset;
-} GPIF_t;
+};
 
 //------------------------------------------------------------------------------------------------- GPIF API
 
@@ -339,10 +484,18 @@ void GPIF_Init(GPIF_t *gpif);
 
 /**
  * @brief Update GPIF state (call periodically).
+ * Does nothing for inputs attached to port `scan`, `GPIO_ScanInputs` updates them.
+ * With `capture` it processes edges recorded by interrupt since last call.
  * @param[in,out] gpif Pointer to GPIF structure
  */
 void GPIF_Loop(GPIF_t *gpif);
 
+/**
+ * @brief Reload debounce times after `ton_ms`/`toff_ms` change (port scan only).
+ * @param[in,out] gpif Pointer to GPIF structure
+ */
+void GPIF_Timing(GPIF_t *gpif);
+
 /**
  * @brief Get debounced input state.
  * @param[in] gpif Pointer to GPIF structure
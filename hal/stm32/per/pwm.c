@@ -25,12 +25,32 @@ static bool PWM_HasBDTR(TIM_TypeDef *reg)
   return false;
 }
 
+// Repetition counter range in periods: `REP` is 16-bit on advanced timers, 8-bit on TIM15/16/17
+static uint32_t PWM_RepRange(TIM_TypeDef *reg)
+{
+  if(!IS_TIM_REPETITION_COUNTER_INSTANCE(reg)) return 0;
+  if(reg == TIM1) return 0x10000;
+  #ifdef TIM8
+    if(reg == TIM8) return 0x10000;
+  #endif
+  #ifdef TIM20
+    if(reg == TIM20) return 0x10000;
+  #endif
+  return 0x100;
+}
+
 //-------------------------------------------------------------------------------------------------
 
+static void PWM_TrainBatch(PWM_t *pwm);
+
 static void PWM_Interrupt(PWM_t *pwm)
 {
   if(pwm->reg->SR & TIM_SR_UIF) {
     pwm->reg->SR = ~TIM_SR_UIF;
+    if(pwm->_train_busy) {
+      if(pwm->_train_last) PWM_TrainStop(pwm);
+      else PWM_TrainBatch(pwm);
+    }
     if(pwm->UpdateCallback) pwm->UpdateCallback(pwm->update_arg);
   }
 }
@@ -61,16 +81,22 @@ void PWM_SetAutoreload(PWM_t *pwm, uint32_t auto_reload)
   pwm->reg->ARR = pwm->auto_reload;
 }
 
-void PWM_SetValue(PWM_t *pwm, TIM_Channel_t channel, uint32_t value)
+static void PWM_WriteCompare(PWM_t *pwm, TIM_Channel_t channel, uint32_t value)
 {
   switch(channel) {
-    case TIM_CH1: case TIM_CH1N: pwm->value[TIM_CH1] = value; pwm->reg->CCR1 = value; break;
-    case TIM_CH2: case TIM_CH2N: pwm->value[TIM_CH2] = value; pwm->reg->CCR2 = value; break;
-    case TIM_CH3: case TIM_CH3N: pwm->value[TIM_CH3] = value; pwm->reg->CCR3 = value; break;
-    case TIM_CH4: case TIM_CH4N: pwm->value[TIM_CH4] = value; pwm->reg->CCR4 = value; break;
+    case TIM_CH1: case TIM_CH1N: pwm->reg->CCR1 = value; break;
+    case TIM_CH2: case TIM_CH2N: pwm->reg->CCR2 = value; break;
+    case TIM_CH3: case TIM_CH3N: pwm->reg->CCR3 = value; break;
+    case TIM_CH4: case TIM_CH4N: pwm->reg->CCR4 = value; break;
   }
 }
 
+void PWM_SetValue(PWM_t *pwm, TIM_Channel_t channel, uint32_t value)
+{
+  pwm->value[channel & 3] = value;
+  if(!pwm->_train_busy) PWM_WriteCompare(pwm, channel, value);
+}
+
 uint32_t PWM_GetValue(PWM_t *pwm, TIM_Channel_t channel)
 {
   switch(channel) {
@@ -194,4 +220,91 @@ void PWM_Init(PWM_t *pwm)
   pwm->reg->CR1 |= TIM_CR1_CEN;
 }
 
+//------------------------------------------------------------------------------------------------- Train
+
+// Program next batch into preload registers, they take effect on next update event.
+// Nothing left: compare goes to `0` (inactive) for period after last pulse and train ends there.
+// Remainder goes first, so every batch running while interrupt preloads next one is full
+// `_train_rcr` periods long: that is the time interrupt has (one period without repetition counter).
+static void PWM_TrainBatch(PWM_t *pwm)
+{
+  if(!pwm->_train) {
+    PWM_WriteCompare(pwm, pwm->_train_channel, 0);
+    pwm->_train_last = true;
+    return;
+  }
+  uint32_t batch = 1;
+  if(pwm->_train_rcr) {
+    batch = pwm->_train % pwm->_train_rcr;
+    if(!batch) batch = pwm->_train_rcr;
+    pwm->reg->RCR = batch - 1;
+  }
+  pwm->_train -= batch;
+}
+
+bool PWM_Train(PWM_t *pwm, TIM_Channel_t channel, uint32_t count, uint32_t ton_us, uint32_t toff_us)
+{
+  if(pwm->_train_busy || !count || !ton_us || !toff_us) return false;
+  uint64_t ticks = ((uint64_t)ton_us + toff_us) * SystemCoreClock / 1000000;
+  uint64_t limit = TIM_Is32bit(pwm->reg) ? 0x100000000 : 0x10000;
+  uint64_t prescaler = ticks / limit + 1;
+  if(prescaler > 0x10000) return false;
+  uint32_t period = ticks / prescaler;
+  uint32_t ton = (uint64_t)ton_us * SystemCoreClock / 1000000 / prescaler;
+  if(!ton || ton >= period) return false;
+  // More than one batch: update interrupt must preload next batch before running one ends
+  uint32_t rcr = PWM_RepRange(pwm->reg);
+  uint32_t window = rcr ? rcr : 1;
+  if(count > window && (uint64_t)window * (ton_us + toff_us) < PWM_TRAIN_LATENCY_us) return false;
+  TIM_TypeDef *reg = pwm->reg;
+  reg->DIER &= ~TIM_DIER_UIE;
+  // URS: `UG` reloads registers without update interrupt
+  reg->CR1 = (reg->CR1 & ~(TIM_CR1_CEN | TIM_CR1_CMS_Msk)) | TIM_CR1_URS;
+  reg->CNT = 0;
+  reg->PSC = prescaler - 1;
+  reg->ARR = period - 1;
+  for(TIM_Channel_t CH = TIM_CH1; CH <= TIM_CH4; CH++) {
+    uint64_t value = (uint64_t)pwm->value[CH] * period / pwm->auto_reload;
+    PWM_WriteCompare(pwm, CH, value > period ? period : value);
+  }
+  PWM_WriteCompare(pwm, channel, ton);
+  pwm->_train_channel = channel;
+  pwm->_train = count;
+  pwm->_train_last = false;
+  pwm->_train_rcr = rcr;
+  pwm->_train_busy = true;
+  // First batch goes to shadow registers by `UG`, second one waits in preload
+  PWM_TrainBatch(pwm);
+  reg->EGR |= TIM_EGR_UG;
+  PWM_TrainBatch(pwm);
+  IRQ_EnableTIM(reg, pwm->irq_priority, (void (*)(void *))PWM_Interrupt, pwm);
+  reg->SR = ~TIM_SR_UIF;
+  reg->DIER |= TIM_DIER_UIE;
+  reg->CR1 |= TIM_CR1_CEN;
+  return true;
+}
+
+void PWM_TrainStop(PWM_t *pwm)
+{
+  if(!pwm->_train_busy) return;
+  TIM_TypeDef *reg = pwm->reg;
+  reg->DIER &= ~TIM_DIER_UIE;
+  reg->CR1 &= ~TIM_CR1_CEN;
+  pwm->_train_busy = false;
+  if(pwm->_train_rcr) reg->RCR = 0;
+  reg->PSC = pwm->prescaler - 1;
+  reg->ARR = pwm->auto_reload;
+  for(TIM_Channel_t CH = TIM_CH1; CH <= TIM_CH4; CH++) {
+    PWM_WriteCompare(pwm, CH, pwm->value[CH]);
+  }
+  reg->CNT = 0;
+  uint8_t center_aligned = pwm->center_aligned ? 0x03 << TIM_CR1_CMS_Pos : 0;
+  reg->CR1 = (reg->CR1 & ~TIM_CR1_CMS_Msk) | center_aligned;
+  reg->EGR |= TIM_EGR_UG;
+  reg->CR1 &= ~TIM_CR1_URS;
+  reg->SR = ~TIM_SR_UIF;
+  if(pwm->UpdateCallback) reg->DIER |= TIM_DIER_UIE;
+  reg->CR1 |= TIM_CR1_CEN;
+}
+
 //-------------------------------------------------------------------------------------------------
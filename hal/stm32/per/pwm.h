@@ -8,6 +8,11 @@
 
 //-------------------------------------------------------------------------------------------------
 
+#ifndef PWM_TRAIN_LATENCY_us
+  // Worst-case update interrupt latency, pulse train refuses batches shorter than that
+  #define PWM_TRAIN_LATENCY_us 50
+#endif
+
 #define PWM_ARR(freq_Hz, clock_Hz, center_aligned) \
   ((clock_Hz) / (freq_Hz) / ((center_aligned) + 1))
 
@@ -25,6 +30,13 @@
  * @param[in] UpdateCallback Update interrupt callback (NULL = disabled)
  * @param[in] update_arg Callback argument
  * @param[in] irq_priority Interrupt priority
+ * Internal:
+ * @param _ccer_mask Enabled channel outputs (`PWM_OutputEnable`).
+ * @param _train Pulse-train periods not yet programmed into timer.
+ * @param _train_channel Channel emitting pulse train.
+ * @param _train_busy Pulse train running, timer registers belong to train.
+ * @param _train_last Last batch running, train ends on next update event.
+ * @param _train_rcr Max batch of repetition counter in periods (`0` = none, `256` or `65536`).
  */
 typedef struct {
   TIM_TypeDef *reg;
@@ -41,6 +53,11 @@ typedef struct {
   IRQ_Priority_t irq_priority;
   // internal
   uint32_t _ccer_mask;
+  volatile uint32_t _train;
+  TIM_Channel_t _train_channel;
+  volatile bool _train_busy;
+  volatile bool _train_last;
+  uint32_t _train_rcr;
 } PWM_t;
 
 //------------------------------------------------------------------------------------------------- API
@@ -67,6 +84,7 @@ void PWM_SetAutoreload(PWM_t *pwm, uint32_t auto_reload);
 
 /**
  * @brief Set channel duty cycle value.
+ * During pulse train value is only stored and applied when train ends.
  * @param[in,out] pwm PWM instance
  * @param[in] channel Channel (TIM_CH1-4 or TIM_CH1N-4N)
  * @param[in] value Compare value
@@ -114,6 +132,44 @@ void PWM_InterruptEnable(PWM_t *pwm);
  */
 void PWM_InterruptDisable(PWM_t *pwm);
 
+//------------------------------------------------------------------------------------------------- Train
+
+/**
+ * @brief Start pulse train on channel: `count` periods of `ton_us` active and `toff_us` inactive.
+ * Edges come from timer compare, CPU runs only in update interrupt once per batch
+ * (`65536` periods on TIM1, `256` on TIM15/16/17, otherwise once per period).
+ * Pulse count is exact only when update interrupt runs within one batch: late interrupt merges
+ * updates (sticky `UIF`) and preloaded batch repeats. So with more than one batch, batch time
+ * below `PWM_TRAIN_LATENCY_us` is refused (without repetition counter: `ton_us + toff_us`).
+ * Train takes whole timer: counter runs edge-aligned with train period, other channels
+ * keep their duty ratio. Prescaler, period, compare values and alignment are restored at end.
+ * @param[in,out] pwm PWM instance (initialized)
+ * @param[in] channel Channel (TIM_CH1-4 or TIM_CH1N-4N)
+ * @param[in] count Number of pulses (`1` to `2^32 - 1`)
+ * @param[in] ton_us Pulse active time `[us]`
+ * @param[in] toff_us Pulse inactive time `[us]`
+ * @return `true` if started, `false` if train already running, timing out of range
+ *   or period too short for interrupt latency
+ */
+bool PWM_Train(PWM_t *pwm, TIM_Channel_t channel, uint32_t count, uint32_t ton_us, uint32_t toff_us);
+
+/**
+ * @brief Abort pulse train and restore PWM configuration.
+ * Called from update interrupt when train ends.
+ * @param[in,out] pwm PWM instance
+ */
+void PWM_TrainStop(PWM_t *pwm);
+
+/**
+ * @brief Check if pulse train is running.
+ * @param[in] pwm PWM instance
+ * @return `true` if running
+ */
+static inline bool PWM_IsTrain(const PWM_t *pwm)
+{
+  return pwm->_train_busy;
+}
+
 //-------------------------------------------------------------------------------------------------
 
 #endif
\ No newline at end of file
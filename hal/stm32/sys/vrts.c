@@ -179,6 +179,25 @@ int32_t tick_diff(uint64_t tick)
   return (int32_t)(((int64_t)vrts_ticker_get() - tick) * tick_ms);
 }
 
+uint32_t tick_us(void)
+{
+  // Ticker and SysTick counter must come from same period
+  uint64_t ticker;
+  uint32_t value;
+  bool pending;
+  do {
+    ticker = vrts_ticker_get();
+    value = SysTick->VAL;
+    // Called from interrupt above SysTick: counter may have wrapped with `VrtsTicker`
+    // not yet incremented. `VAL` is read again, so it surely comes from new period.
+    pending = SCB->ICSR & SCB_ICSR_PENDSTSET_Msk;
+    if(pending) value = SysTick->VAL;
+  } while(ticker != vrts_ticker_get());
+  if(pending) ticker++;
+  uint32_t elapsed = (SysTick->LOAD - value) / (SystemCoreClock / 1000000);
+  return (uint32_t)ticker * tick_ms * 1000 + elapsed;
+}
+
 //------------------------------------------------------------------------------------------------- Delay
 
 void delay(uint32_t ms)
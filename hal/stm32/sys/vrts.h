@@ -82,6 +82,13 @@ bool tick_away(uint64_t *tick);
  */
 int32_t tick_diff(uint64_t tick);
 
+/**
+ * @brief Free-running microsecond clock for short time measurements.
+ * Valid in interrupts of any priority, also above SysTick with its wrap still pending.
+ * @return Time in microseconds, wraps every ~71 minutes (compare with subtraction)
+ */
+uint32_t tick_us(void);
+
 //--------------------------------------------------------------------------------------- Delay
 
 // Delays for `ms` milliseconds, yields to other threads
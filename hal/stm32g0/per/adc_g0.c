@@ -61,6 +61,7 @@ static void ADC_DMA_IRQHandler(ADC_t *adc)
   uint8_t pos = adc->record._dma.pos;
   if(isr & DMA_ISR_HTIF(pos)) {
     adc->record._dma.reg->IFCR = DMA_ISR_HTIF(pos);
+    if(adc->record.pipe) ADC_PipeEvent(adc, 0);
     if(adc->record.HalfCallback) {
       adc->record.HalfCallback(adc->record.callback_arg);
     }
@@ -68,6 +69,7 @@ static void ADC_DMA_IRQHandler(ADC_t *adc)
   if(isr & DMA_ISR_TCIF(pos)) {
     adc->record._dma.reg->IFCR = DMA_ISR_TCIF(pos);
     if(adc->record.continuous_mode) {
+      if(adc->record.pipe) ADC_PipeEvent(adc, 1);
       if(adc->record.CompleteCallback) {
         adc->record.CompleteCallback(adc->record.callback_arg);
       }
@@ -134,6 +136,7 @@ void ADC_Stop(ADC_t *adc)
       break;
     #if(ADC_RECORD)
     case ADC_State_Record:
+      if(adc->record.tim) TIM_Disable(adc->record.tim);
       adc->record._dma.cha->CCR &= ~DMA_CCR_EN;
       break;
     #endif
@@ -169,6 +172,7 @@ status_t ADC_Measure(ADC_t *adc)
 status_t ADC_Record(ADC_t *adc)
 {
   if(adc->_busy) return BUSY;
+  if(adc->record.pipe && ADC_PipeStart(adc)) return ERR;
   adc->_busy = ADC_State_Record;
   ADC_SetPrescaler(adc, adc->record.prescaler);
   ADC_SetOversampling(adc, &adc->record.oversampling);
@@ -179,7 +183,7 @@ status_t ADC_Record(ADC_t *adc)
   adc->record._dma.cha->CNDTR = adc->record.buff_len;
   uint32_t cfgr_rst = ADC_CFGR1_EXTSEL_Msk;
   uint32_t cfgr_set;
-  if(adc->record.ext_trig) {
+  if(adc->record.ext_trig || adc->record.tim) {
     cfgr_set = ADC_CFGR1_EXTEN_0 | (adc->record.ext_select << ADC_CFGR1_EXTSEL_Pos);
     cfgr_rst |= ADC_CFGR1_CONT;
   }
@@ -190,13 +194,13 @@ status_t ADC_Record(ADC_t *adc)
   adc->reg->CFGR1 = (adc->reg->CFGR1 & ~cfgr_rst) | cfgr_set;
   if(adc->record.continuous_mode) {
     adc->record._dma.cha->CCR |= DMA_CCR_CIRC;
-    if(adc->record.HalfCallback) {
+    if(adc->record.HalfCallback || adc->record.pipe) {
       adc->record._dma.cha->CCR |= DMA_CCR_HTIE;
     }
     else {
       adc->record._dma.cha->CCR &= ~DMA_CCR_HTIE;
     }
-    if(adc->record.CompleteCallback) {
+    if(adc->record.CompleteCallback || adc->record.pipe) {
       adc->record._dma.cha->CCR |= DMA_CCR_TCIE;
     }
     else {
@@ -210,6 +214,12 @@ status_t ADC_Record(ADC_t *adc)
   }
   adc->record._dma.cha->CCR |= DMA_CCR_EN;
   adc->reg->CR |= ADC_CR_ADSTART;
+  if(adc->record.tim) {
+    // ADC waits for trigger, timer sets sampling rate
+    TIM_MasterMode(adc->record.tim, TIM_MasterMode_Update);
+    TIM_ResetValue(adc->record.tim);
+    TIM_Enable(adc->record.tim);
+  }
   return OK;
 }
 
@@ -80,9 +80,60 @@ bool BUFF_Break(BUFF_t *buff)
 
 //------------------------------------------------------------------------------------------------- Push (console-aware)
 
+#define BUFF_FRAME_HEAD 3 // sync + length:u16le
+
+// Drop in-progress binary frame
+static void BUFF_FrameDrop(BUFF_t *buff)
+{
+  while(BUFF_Pop(buff, NULL));
+  buff->_frame = false;
+  buff->_frame_expire = false;
+}
+
+// Binary frame byte: no console filtering and no echo, break after last byte
+static bool BUFF_Frame(BUFF_t *buff, uint8_t value)
+{
+  if(!BUFF_Append(buff, value)) {
+    BUFF_FrameDrop(buff);
+    return false;
+  }
+  buff->_echo = buff->_head;
+  buff->_frame = true;
+  switch(buff->_msg_counter) {
+    case 1: return true;
+    case 2: buff->_frame_left = value; return true;
+    case BUFF_FRAME_HEAD:
+      buff->_frame_left |= (uint16_t)value << 8;
+      buff->_frame_left += buff->frame_tail;
+      if(buff->_frame_left >= buff->size - BUFF_FRAME_HEAD) {
+        BUFF_FrameDrop(buff);
+        return false;
+      }
+      break;
+    default: buff->_frame_left--;
+  }
+  if(buff->_frame_left) return true;
+  buff->_frame = false;
+  BUFF_Break(buff);
+  return true;
+}
+
+// Drop console line in progress, echo pointer inside it goes back with head (no `^C` echo)
+static void BUFF_Cancel(BUFF_t *buff)
+{
+  uint16_t lag = (uint16_t)((buff->_head - buff->_echo + buff->size) % buff->size);
+  bool echo_inside = lag <= buff->_msg_counter;
+  while(BUFF_Pop(buff, NULL));
+  if(echo_inside) buff->_echo = buff->_head;
+}
+
 bool BUFF_Push(BUFF_t *buff, uint8_t value)
 {
   if(buff->console_mode) {
+    if(buff->_frame_expire) BUFF_FrameDrop(buff);
+    if(buff->_frame || (buff->frame_sync && value == buff->frame_sync && !buff->_msg_counter && !buff->_esc)) {
+      return BUFF_Frame(buff, value);
+    }
     // ESC sequence: second byte
     if(buff->_esc == 1) {
       if(value == '[' || value == 'O') buff->_esc = 2;
@@ -106,8 +157,14 @@ bool BUFF_Push(BUFF_t *buff, uint8_t value)
       BUFF_Break(buff);
       return true;
     }
-    // FF / Ctrl+C: close + skip message
+    // FF / Ctrl+C: drop line in progress
     if(value == '\f' || value == 0x03) {
+      // `BUFF_Skip` takes oldest message: only safe when closed line is the only one.
+      // Otherwise pending (possibly borrowed) messages stay and line is dropped from head.
+      if(BUFF_MessageCount(buff)) {
+        BUFF_Cancel(buff);
+        return true;
+      }
       BUFF_Append(buff, '\f');
       BUFF_Break(buff);
       BUFF_Skip(buff);
@@ -154,6 +211,29 @@ uint16_t BUFF_Peek(BUFF_t *buff, uint8_t *dst)
   return size;
 }
 
+uint16_t BUFF_PeekAt(BUFF_t *buff, uint16_t offset, uint8_t *dst, uint16_t count)
+{
+  uint16_t size = BUFF_Size(buff);
+  if(offset >= size) return 0;
+  if(count > size - offset) count = size - offset;
+  uint8_t *ptr = (uint8_t*)buff->_tail + offset;
+  if(ptr >= buff->_end_memory) ptr -= buff->size;
+  uint16_t first = buff->_end_memory - ptr;
+  if(first > count) first = count;
+  memcpy(dst, ptr, first);
+  memcpy(dst + first, buff->memory, count - first);
+  return count;
+}
+
+uint8_t *BUFF_Borrow(BUFF_t *buff)
+{
+  uint16_t size = BUFF_Size(buff);
+  if(!size) return NULL;
+  uint8_t *ptr = (uint8_t*)buff->_tail;
+  if(ptr + size > buff->_end_memory) return NULL;
+  return ptr;
+}
+
 bool BUFF_Skip(BUFF_t *buff)
 {
   return BUFF_Read(buff, NULL) ? true : false;
@@ -180,6 +260,8 @@ void BUFF_Clear(BUFF_t *buff)
   buff->_echo = buff->_tail;
   buff->_esc = 0;
   buff->_break_allow = false;
+  buff->_frame = false;
+  buff->_frame_expire = false;
 }
 
 //-------------------------------------------------------------------------------------------------
\ No newline at end of file
@@ -22,6 +22,8 @@
  * @param[in] memory Pointer to buffer memory
  * @param[in] size Buffer size in bytes
  * @param[in] console_mode Enable console input parsing (ESC, Enter, Ctrl+C)
+ * @param[in] frame_sync First byte of binary frame in console mode (`0` = disabled), see `BUFF_Push`
+ * @param[in] frame_tail Bytes after binary frame payload (e.g. CRC size)
  * @param[in] Overflow Optional overflow handler (`NULL` = disabled)
  * Internal:
  * @param _esc ESC parser state
@@ -34,11 +36,16 @@
  * @param _msg_head Message write index
  * @param _msg_tail Message read index
  * @param _break_allow Allow message break flag
+ * @param _frame Binary frame in progress
+ * @param _frame_left Frame bytes left (length while header is received)
+ * @param _frame_expire Drop in-progress frame on next byte, set by `BUFF_FrameExpire`
  */
 typedef struct {
   uint8_t *memory;
   uint16_t size;
   bool console_mode;
+  uint8_t frame_sync;
+  uint8_t frame_tail;
   void (*Overflow)(void);
   // internal
   uint8_t _esc;
@@ -51,6 +58,9 @@ typedef struct {
   volatile uint16_t _msg_head;
   volatile uint16_t _msg_tail;
   bool _break_allow;
+  volatile bool _frame;
+  uint16_t _frame_left;
+  volatile bool _frame_expire;
 } BUFF_t;
 
 //------------------------------------------------------------------------------------------------- API
@@ -70,6 +80,8 @@ static inline void BUFF_Init(BUFF_t *buff)
   buff->_msg_tail = 0;
   buff->_esc = 0;
   buff->_break_allow = false;
+  buff->_frame = false;
+  buff->_frame_expire = false;
 }
 
 /**
@@ -120,12 +132,26 @@ bool BUFF_Pop(BUFF_t *buff, uint8_t *value);
 /**
  * @brief Push byte with optional console-mode filtering.
  *   Handles ESC sequences, Enter, Ctrl+C, XOFF.
+ *   With `frame_sync`, message starting with it is binary frame
+ *   `frame_sync | length:u16le | payload | frame_tail bytes`: taken raw, without echo,
+ *   and closed after last byte. Frame longer than buffer is dropped.
  * @param[in,out] buff Pointer to buffer structure
  * @param[in] value Byte to push
  * @return `true` if appended or message ended, `false` if ignored or full
  */
 bool BUFF_Push(BUFF_t *buff, uint8_t value);
 
+/**
+ * @brief Mark in-progress binary frame as stale (e.g. bytes lost on line).
+ *   Frame is dropped by `BUFF_Push` when next byte arrives, so writer context stays the only one
+ *   that modifies it. No effect when no frame is in progress.
+ * @param[in,out] buff Pointer to buffer structure
+ */
+static inline void BUFF_FrameExpire(BUFF_t *buff)
+{
+  if(buff->_frame) buff->_frame_expire = true;
+}
+
 /**
  * @brief Read current message to `dst` and advance queue.
  * @param[in,out] buff Pointer to buffer structure
@@ -142,6 +168,24 @@ uint16_t BUFF_Read(BUFF_t *buff, uint8_t *dst);
  */
 uint16_t BUFF_Peek(BUFF_t *buff, uint8_t *dst);
 
+/**
+ * @brief Copy part of current message without advancing queue (handles wrap-around).
+ * @param[in] buff Pointer to buffer structure
+ * @param[in] offset Position in message
+ * @param[out] dst Destination buffer
+ * @param[in] count Bytes to copy
+ * @return Bytes copied (less than `count` at end of message)
+ */
+uint16_t BUFF_PeekAt(BUFF_t *buff, uint16_t offset, uint8_t *dst, uint16_t count);
+
+/**
+ * @brief Access current message in place, without copy. Message stays in queue,
+ *   so its bytes are not overwritten (and may be modified) until `BUFF_Skip`.
+ * @param[in] buff Pointer to buffer structure
+ * @return Pointer into `memory` or `NULL` if empty or message wraps around end of `memory`
+ */
+uint8_t *BUFF_Borrow(BUFF_t *buff);
+
 /**
  * @brief Skip current message.
  * @param[in,out] buff Pointer to buffer structure
@@ -0,0 +1,158 @@
+// lib/ext/xdsp.c
+
+#include "xdsp.h"
+#include <math.h>
+
+#ifndef M_PI
+  #define M_PI 3.14159265358979323846
+#endif
+
+//-------------------------------------------------------------------------------------------------
+
+void DSP_U16ToQ15(uint16_t *block, uint16_t len)
+{
+  for(uint16_t i = 0; i < len; i++) block[i] ^= 0x8000;
+}
+
+void DSP_Q15ToU16(int16_t *block, uint16_t len)
+{
+  uint16_t *raw = (uint16_t *)block;
+  for(uint16_t i = 0; i < len; i++) raw[i] ^= 0x8000;
+}
+
+//-------------------------------------------------------------------------------------- Biquad
+
+static bool DSP_CoefQ14(float value, int16_t *coef)
+{
+  float scaled = value * (1 << DSP_BIQUAD_SHIFT);
+  if(scaled >= 32767.5f || scaled < -32768.5f) return false;
+  *coef = (int16_t)lroundf(scaled);
+  return true;
+}
+
+bool DSP_BiquadDesign(DSP_BiquadCoef_t *coef, DSP_BiquadType_t type, float fc, float fs, float q)
+{
+  float w0 = 2.0f * (float)M_PI * fc / fs;
+  float cs = cosf(w0);
+  float alpha = sinf(w0) / (2.0f * q);
+  float b0, b1, b2;
+  switch(type) {
+    case DSP_Biquad_Lowpass: b0 = (1.0f - cs) / 2.0f; b1 = 1.0f - cs; b2 = b0; break;
+    case DSP_Biquad_Highpass: b0 = (1.0f + cs) / 2.0f; b1 = -(1.0f + cs); b2 = b0; break;
+    case DSP_Biquad_Bandpass: b0 = alpha; b1 = 0.0f; b2 = -alpha; break;
+    case DSP_Biquad_Notch: b0 = 1.0f; b1 = -2.0f * cs; b2 = 1.0f; break;
+    default: return false;
+  }
+  float a0 = 1.0f + alpha;
+  return DSP_CoefQ14(b0 / a0, &coef->b0) && DSP_CoefQ14(b1 / a0, &coef->b1) &&
+    DSP_CoefQ14(b2 / a0, &coef->b2) && DSP_CoefQ14(-2.0f * cs / a0, &coef->a1) &&
+    DSP_CoefQ14((1.0f - alpha) / a0, &coef->a2);
+}
+
+void DSP_BiquadInit(DSP_Biquad_t *filter)
+{
+  memset(filter->state, 0, filter->stages * sizeof(DSP_BiquadState_t));
+}
+
+void DSP_BiquadQ15(DSP_Biquad_t *filter, const int16_t *in, uint16_t stride, int16_t *out, uint16_t len)
+{
+  // Stage-major: whole block passes stage 0, then stage 1 works on `out`
+  for(uint8_t s = 0; s < filter->stages; s++) {
+    const DSP_BiquadCoef_t *c = &filter->coef[s];
+    DSP_BiquadState_t st = filter->state[s];
+    const int16_t *src = s ? out : in;
+    uint16_t step = s ? 1 : stride;
+    for(uint16_t i = 0; i < len; i++) {
+      int16_t x = src[(uint32_t)i * step];
+      int64_t acc = (int32_t)c->b0 * x;
+      acc += (int32_t)c->b1 * st.x1;
+      acc += (int32_t)c->b2 * st.x2;
+      acc -= (int32_t)c->a1 * st.y1;
+      acc -= (int32_t)c->a2 * st.y2;
+      // Error feedback: residue of last truncation goes into next output (noise shaping)
+      acc += st.residue;
+      int16_t y = DSP_SatQ15((int32_t)(acc >> DSP_BIQUAD_SHIFT));
+      st.residue = (int16_t)(acc & ((1 << DSP_BIQUAD_SHIFT) - 1));
+      st.x2 = st.x1;
+      st.x1 = x;
+      st.y2 = st.y1;
+      st.y1 = y;
+      out[i] = y;
+    }
+    filter->state[s] = st;
+  }
+}
+
+//----------------------------------------------------------------------------------------- FIR
+
+void DSP_FirInit(DSP_Fir_t *filter)
+{
+  memset(filter->state, 0, 2 * filter->taps * sizeof(int16_t));
+  filter->_index = 0;
+  filter->_phase = 0;
+}
+
+uint16_t DSP_FirQ15(DSP_Fir_t *filter, const int16_t *in, uint16_t stride, int16_t *out, uint16_t len)
+{
+  uint16_t taps = filter->taps;
+  uint16_t decim = filter->decim > 1 ? filter->decim : 1;
+  uint16_t count = 0;
+  for(uint16_t i = 0; i < len; i++) {
+    // Newest sample goes one position back, so `state[_index ...]` is newest-to-oldest
+    filter->_index = filter->_index ? filter->_index - 1 : taps - 1;
+    int16_t x = in[(uint32_t)i * stride];
+    filter->state[filter->_index] = x;
+    filter->state[filter->_index + taps] = x;
+    if(++filter->_phase < decim) continue;
+    filter->_phase = 0;
+    const int16_t *window = &filter->state[filter->_index];
+    int64_t acc = 0;
+    for(uint16_t k = 0; k < taps; k++) acc += (int32_t)filter->coef[k] * window[k];
+    out[count++] = DSP_SatQ15((int32_t)((acc + (1 << 14)) >> 15));
+  }
+  return count;
+}
+
+//------------------------------------------------------------------------------ Moving average
+
+void DSP_MavgInit(DSP_Mavg_t *filter)
+{
+  memset(filter->window, 0, ((uint32_t)1 << filter->order) * sizeof(int16_t));
+  filter->sum = 0;
+  filter->_index = 0;
+}
+
+void DSP_MavgQ15(DSP_Mavg_t *filter, const int16_t *in, uint16_t stride, int16_t *out, uint16_t len)
+{
+  uint16_t mask = (uint16_t)((1u << filter->order) - 1);
+  int32_t sum = filter->sum;
+  uint16_t index = filter->_index;
+  int32_t round = filter->order ? (1 << (filter->order - 1)) : 0;
+  for(uint16_t i = 0; i < len; i++) {
+    int16_t x = in[(uint32_t)i * stride];
+    sum += x - filter->window[index];
+    filter->window[index] = x;
+    index = (index + 1) & mask;
+    if(out) out[i] = (int16_t)((sum + round) >> filter->order);
+  }
+  filter->sum = sum;
+  filter->_index = index;
+}
+
+//----------------------------------------------------------------------------------- Decimator
+
+uint16_t DSP_DecimQ15(DSP_Decim_t *filter, const int16_t *in, uint16_t stride, int16_t *out, uint16_t len)
+{
+  uint16_t factor = filter->factor > 1 ? filter->factor : 1;
+  uint16_t count = 0;
+  for(uint16_t i = 0; i < len; i++) {
+    filter->_acc += in[(uint32_t)i * stride];
+    if(++filter->_count < factor) continue;
+    // Round half away from zero, one division per output sample
+    int32_t acc = filter->_acc;
+    out[count++] = (int16_t)((acc >= 0 ? acc + factor / 2 : acc - factor / 2) / factor);
+    filter->_acc = 0;
+    filter->_count = 0;
+  }
+  return count;
+}
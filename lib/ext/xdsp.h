@@ -0,0 +1,212 @@
+// lib/ext/xdsp.h
+
+#ifndef XDSP_H_
+#define XDSP_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+
+//-------------------------------------------------------------------------------------------------
+
+// Samples are Q15 (`int16_t`), accumulators are Q31/`int64_t`, no `float` in block kernels.
+// Block kernels read input with `stride`, so one channel can be filtered
+// directly from interleaved ADC DMA buffer after `DSP_U16ToQ15`.
+// Output is contiguous and may alias input when `stride` is `1`.
+
+#ifndef DSP_BIQUAD_SHIFT
+  // Fractional bits of biquad coefficients (Q2.14 allows `|a1| < 2`)
+  #define DSP_BIQUAD_SHIFT 14
+#endif
+
+/**
+ * @brief Saturate to Q15 range.
+ * @param[in] value Value to saturate.
+ * @return Value clamped to `[-32768, 32767]`.
+ */
+static inline int16_t DSP_SatQ15(int32_t value)
+{
+  if(value > INT16_MAX) return INT16_MAX;
+  if(value < INT16_MIN) return INT16_MIN;
+  return (int16_t)value;
+}
+
+/**
+ * @brief Convert unsigned ADC samples to Q15 in-place (offset binary to two's complement).
+ * `0` becomes `-1.0`, `32768` becomes `0.0`, `65535` becomes `+1.0 - 2^-15`.
+ * @param[in,out] block Samples, read later as `int16_t *`.
+ * @param[in] len Number of samples.
+ */
+void DSP_U16ToQ15(uint16_t *block, uint16_t len);
+
+/**
+ * @brief Convert Q15 samples back to unsigned ADC scale in-place.
+ * @param[in,out] block Samples, read later as `uint16_t *`.
+ * @param[in] len Number of samples.
+ */
+void DSP_Q15ToU16(int16_t *block, uint16_t len);
+
+//-------------------------------------------------------------------------------------- Biquad
+
+/**
+ * @brief Biquad coefficients in Q2.14 (`DSP_BIQUAD_SHIFT`).
+ * `y = b0*x + b1*x[-1] + b2*x[-2] - a1*y[-1] - a2*y[-2]`
+ */
+typedef struct {
+  int16_t b0, b1, b2;
+  int16_t a1, a2;
+} DSP_BiquadCoef_t;
+
+// Direct form I state of one biquad stage, `residue` is truncation error fed back.
+typedef struct {
+  int16_t x1, x2;
+  int16_t y1, y2;
+  int16_t residue;
+} DSP_BiquadState_t;
+
+/**
+ * @brief Biquad cascade.
+ * @param[in] coef Coefficients, `stages` elements.
+ * @param[in,out] state State, `stages` elements (zeroed by `DSP_BiquadInit`).
+ * @param[in] stages Number of second-order stages.
+ */
+typedef struct {
+  const DSP_BiquadCoef_t *coef;
+  DSP_BiquadState_t *state;
+  uint8_t stages;
+} DSP_Biquad_t;
+
+typedef enum {
+  DSP_Biquad_Lowpass,
+  DSP_Biquad_Highpass,
+  DSP_Biquad_Bandpass,
+  DSP_Biquad_Notch
+} DSP_BiquadType_t;
+
+/**
+ * @brief Compute biquad coefficients (RBJ cookbook). Uses `float`, call once at init.
+ * @param[out] coef Coefficients.
+ * @param[in] type Filter type.
+ * @param[in] fc Cutoff/center frequency `[Hz]`.
+ * @param[in] fs Sampling frequency `[Hz]`.
+ * @param[in] q Quality factor (`0.7071` = Butterworth).
+ * @return `true` if coefficients fit in Q2.14.
+ */
+bool DSP_BiquadDesign(DSP_BiquadCoef_t *coef, DSP_BiquadType_t type, float fc, float fs, float q);
+
+/**
+ * @brief Reset biquad cascade state.
+ * @param[in,out] filter Biquad cascade.
+ */
+void DSP_BiquadInit(DSP_Biquad_t *filter);
+
+/**
+ * @brief Filter block through biquad cascade.
+ * @param[in,out] filter Biquad cascade.
+ * @param[in] in Input samples (Q15), read every `stride` element.
+ * @param[in] stride Input step (number of interleaved channels).
+ * @param[out] out Output samples (Q15), `len` elements.
+ * @param[in] len Number of samples.
+ */
+void DSP_BiquadQ15(DSP_Biquad_t *filter, const int16_t *in, uint16_t stride, int16_t *out, uint16_t len);
+
+//----------------------------------------------------------------------------------------- FIR
+
+/**
+ * @brief FIR filter with circular state and optional decimation.
+ * State keeps every sample twice, so each output is one contiguous dot product.
+ * @param[in] coef Coefficients (Q15), `taps` elements, `coef[0]` applies to newest sample.
+ * @param[in,out] state State buffer, `2 * taps` elements (zeroed by `DSP_FirInit`).
+ * @param[in] taps Number of coefficients.
+ * @param[in] decim Output every `decim` input sample (`0`/`1` = no decimation).
+ * Internal:
+ * @param _index Newest sample position in `state`.
+ * @param _phase Input samples since last output.
+ */
+typedef struct {
+  const int16_t *coef;
+  int16_t *state;
+  uint16_t taps;
+  uint16_t decim;
+  uint16_t _index;
+  uint16_t _phase;
+} DSP_Fir_t;
+
+/**
+ * @brief Reset FIR state.
+ * @param[in,out] filter FIR filter.
+ */
+void DSP_FirInit(DSP_Fir_t *filter);
+
+/**
+ * @brief Filter (and decimate) block through FIR.
+ * @param[in,out] filter FIR filter.
+ * @param[in] in Input samples (Q15), read every `stride` element.
+ * @param[in] stride Input step (number of interleaved channels).
+ * @param[out] out Output samples (Q15), up to `len / decim + 1` elements.
+ * @param[in] len Number of input samples.
+ * @return Number of output samples written.
+ */
+uint16_t DSP_FirQ15(DSP_Fir_t *filter, const int16_t *in, uint16_t stride, int16_t *out, uint16_t len);
+
+//------------------------------------------------------------------------------ Moving average
+
+/**
+ * @brief Moving sum/average over power-of-two window, O(1) per sample.
+ * @param[in,out] window Sample history, `1 << order` elements (zeroed by `DSP_MavgInit`).
+ * @param[in] order Window length as power of two (divide is shift, M0+ has no divider).
+ * @param sum Current window sum (Q31 range), valid after any call.
+ * Internal:
+ * @param _index Oldest sample position in `window`.
+ */
+typedef struct {
+  int16_t *window;
+  uint8_t order;
+  int32_t sum;
+  uint16_t _index;
+} DSP_Mavg_t;
+
+/**
+ * @brief Reset moving window.
+ * @param[in,out] filter Moving average.
+ */
+void DSP_MavgInit(DSP_Mavg_t *filter);
+
+/**
+ * @brief Moving average of block.
+ * @param[in,out] filter Moving average.
+ * @param[in] in Input samples (Q15), read every `stride` element.
+ * @param[in] stride Input step (number of interleaved channels).
+ * @param[out] out Output samples (Q15), `len` elements, or `NULL` to update `sum` only.
+ * @param[in] len Number of samples.
+ */
+void DSP_MavgQ15(DSP_Mavg_t *filter, const int16_t *in, uint16_t stride, int16_t *out, uint16_t len);
+
+//----------------------------------------------------------------------------------- Decimator
+
+/**
+ * @brief Boxcar decimator: averages each `factor` input samples into one output.
+ * @param[in] factor Decimation factor.
+ * Internal:
+ * @param _acc Sum of samples in current group.
+ * @param _count Samples in current group.
+ */
+typedef struct {
+  uint16_t factor;
+  int32_t _acc;
+  uint16_t _count;
+} DSP_Decim_t;
+
+/**
+ * @brief Decimate block.
+ * @param[in,out] filter Decimator.
+ * @param[in] in Input samples (Q15), read every `stride` element.
+ * @param[in] stride Input step (number of interleaved channels).
+ * @param[out] out Output samples (Q15), up to `len / factor + 1` elements.
+ * @param[in] len Number of input samples.
+ * @return Number of output samples written.
+ */
+uint16_t DSP_DecimQ15(DSP_Decim_t *filter, const int16_t *in, uint16_t stride, int16_t *out, uint16_t len);
+
+//-------------------------------------------------------------------------------------------------
+#endif
@@ -1,6 +1,7 @@
 // lib/ext/xmath.c
 
 #include "xmath.h"
+#include <string.h>
 
 /**
  * @brief Symmetric half-up rounding division for int64.
@@ -95,108 +96,181 @@ float min_f32_NaN(uint16_t count, ...)
 
 //------------------------------------------------------------------------------------------------- sort
 
-void sort_asc_u16(uint16_t *array, uint16_t len)
-{
-  for(uint16_t i = 1; i < len; i++) {
-    uint16_t key = array[i];
-    int32_t j = i - 1;
-    while(j >= 0 && array[j] > key) {
-      array[j + 1] = array[j];
-      j--;
-    }
-    array[j + 1] = key;
-  }
-}
+#define SORT_ASC(a, b) ((a) < (b))
+#define SORT_DESC(a, b) ((a) > (b))
 
-void sort_asc_i16(int16_t *array, uint16_t len)
+// Recursion budget of introsort/introselect before falling back to heapsort
+static uint8_t sort_depth(uint16_t len)
 {
-  for(uint16_t i = 1; i < len; i++) {
-    int16_t key = array[i];
-    int32_t j = i - 1;
-    while(j >= 0 && array[j] > key) {
-      array[j + 1] = array[j];
-      j--;
-    }
-    array[j + 1] = key;
-  }
+  uint8_t depth = 0;
+  while(len >>= 1) depth++;
+  return 2 * depth;
 }
 
-void sort_desc_u16(uint16_t *array, uint16_t len)
-{
-  for(uint16_t i = 1; i < len; i++) {
-    uint16_t key = array[i];
-    int32_t j = i - 1;
-    while(j >= 0 && array[j] < key) {
-      array[j + 1] = array[j];
-      j--;
-    }
-    array[j + 1] = key;
+/**
+ * Sort kernels for one type and order, no heap, O(log n) stack:
+ * `name##_insertion`: insertion sort, used for partitions up to `XMATH_SORT_SMALL`
+ * `name##_heap`: heapsort, introsort fallback when partitioning degenerates
+ * `name##_partition`: Hoare partition around median of three, returns cut index
+ * `name##_intro`: introsort, leaves partitions up to `XMATH_SORT_SMALL` unsorted
+ */
+#define SORT_TEMPLATE(name, type, before) \
+  static void name##_insertion(type *array, uint16_t len) \
+  { \
+    for(uint16_t i = 1; i < len; i++) { \
+      type key = array[i]; \
+      uint16_t j = i; \
+      while(j && before(key, array[j - 1])) { \
+        array[j] = array[j - 1]; \
+        j--; \
+      } \
+      array[j] = key; \
+    } \
+  } \
+  static void name##_sift(type *array, uint32_t root, uint32_t len) \
+  { \
+    type value = array[root]; \
+    uint32_t child; \
+    while((child = 2 * root + 1) < len) { \
+      if(child + 1 < len && before(array[child], array[child + 1])) child++; \
+      if(!before(value, array[child])) break; \
+      array[root] = array[child]; \
+      root = child; \
+    } \
+    array[root] = value; \
+  } \
+  static void name##_heap(type *array, uint16_t len) \
+  { \
+    for(uint32_t i = len / 2; i-- > 0;) name##_sift(array, i, len); \
+    for(uint32_t end = len; end-- > 1;) { \
+      type tmp = array[0]; \
+      array[0] = array[end]; \
+      array[end] = tmp; \
+      name##_sift(array, 0, end); \
+    } \
+  } \
+  static uint16_t name##_partition(type *array, uint16_t len) \
+  { \
+    uint16_t mid = len / 2; \
+    type tmp; \
+    if(before(array[mid], array[0])) { tmp = array[0]; array[0] = array[mid]; array[mid] = tmp; } \
+    if(before(array[len - 1], array[mid])) { \
+      tmp = array[mid]; array[mid] = array[len - 1]; array[len - 1] = tmp; \
+      if(before(array[mid], array[0])) { tmp = array[0]; array[0] = array[mid]; array[mid] = tmp; } \
+    } \
+    type pivot = array[mid]; \
+    int32_t i = -1; \
+    int32_t j = len; \
+    while(1) { \
+      do i++; while(before(array[i], pivot)); \
+      do j--; while(before(pivot, array[j])); \
+      if(i >= j) return (uint16_t)(j + 1); \
+      tmp = array[i]; array[i] = array[j]; array[j] = tmp; \
+    } \
+  } \
+  static void name##_intro(type *array, uint16_t len, uint8_t depth) \
+  { \
+    while(len > XMATH_SORT_SMALL) { \
+      if(!depth--) { \
+        name##_heap(array, len); \
+        return; \
+      } \
+      uint16_t cut = name##_partition(array, len); \
+      if(cut < len - cut) { \
+        name##_intro(array, cut, depth); \
+        array += cut; \
+        len -= cut; \
+      } \
+      else { \
+        name##_intro(&array[cut], len - cut, depth); \
+        len = cut; \
+      } \
+    } \
+  } \
+  void name(type *array, uint16_t len) \
+  { \
+    if(len < 2) return; \
+    name##_intro(array, len, sort_depth(len)); \
+    name##_insertion(array, len); \
   }
-}
 
-void sort_desc_i16(int16_t *array, uint16_t len)
-{
-  for(uint16_t i = 1; i < len; i++) {
-    int16_t key = array[i];
-    int32_t j = i - 1;
-    while(j >= 0 && array[j] < key) {
-      array[j + 1] = array[j];
-      j--;
-    }
-    array[j + 1] = key;
+/**
+ * Selection for one type (introselect): partitions only the side holding `nth`,
+ * finishes small ranges with insertion sort, falls back to heapsort on bad pivots.
+ */
+#define NTH_TEMPLATE(name, type, sort) \
+  type name(type *array, uint16_t len, uint16_t nth) \
+  { \
+    if(!len) return 0; \
+    if(nth >= len) nth = len - 1; \
+    type *part = array; \
+    uint8_t depth = sort_depth(len); \
+    while(len > XMATH_SORT_SMALL) { \
+      if(!depth--) { \
+        sort##_heap(part, len); \
+        return part[nth]; \
+      } \
+      uint16_t cut = sort##_partition(part, len); \
+      if(nth < cut) len = cut; \
+      else { \
+        part += cut; \
+        len -= cut; \
+        nth -= cut; \
+      } \
+    } \
+    sort##_insertion(part, len); \
+    return part[nth]; \
   }
-}
 
-void sort_asc_u32(uint32_t *array, uint16_t len)
-{
-  for(uint16_t i = 1; i < len; i++) {
-    uint32_t key = array[i];
-    int32_t j = i - 1;
-    while(j >= 0 && array[j] > key) {
-      array[j + 1] = array[j];
-      j--;
-    }
-    array[j + 1] = key;
-  }
-}
+SORT_TEMPLATE(sort_asc_u16, uint16_t, SORT_ASC)
+SORT_TEMPLATE(sort_asc_i16, int16_t, SORT_ASC)
+SORT_TEMPLATE(sort_desc_u16, uint16_t, SORT_DESC)
+SORT_TEMPLATE(sort_desc_i16, int16_t, SORT_DESC)
+SORT_TEMPLATE(sort_asc_u32, uint32_t, SORT_ASC)
+SORT_TEMPLATE(sort_asc_i32, int32_t, SORT_ASC)
+SORT_TEMPLATE(sort_desc_u32, uint32_t, SORT_DESC)
+SORT_TEMPLATE(sort_desc_i32, int32_t, SORT_DESC)
 
-void sort_asc_i32(int32_t *array, uint16_t len)
-{
-  for(uint16_t i = 1; i < len; i++) {
-    int32_t key = array[i];
-    int32_t j = i - 1;
-    while(j >= 0 && array[j] > key) {
-      array[j + 1] = array[j];
-      j--;
+NTH_TEMPLATE(nth_u16, uint16_t, sort_asc_u16)
+NTH_TEMPLATE(nth_i16, int16_t, sort_asc_i16)
+NTH_TEMPLATE(nth_u32, uint32_t, sort_asc_u32)
+NTH_TEMPLATE(nth_i32, int32_t, sort_asc_i32)
+
+/**
+ * LSD radix sort on 16-bit keys, two byte passes through `temp`.
+ * `flip` toggles sign bit so signed values sort as unsigned.
+ */
+static void sort_radix16(uint16_t *array, uint16_t len, uint16_t *temp, uint16_t flip)
+{
+  uint16_t count[256];
+  uint16_t *src = array;
+  uint16_t *dst = temp;
+  for(uint8_t shift = 0; shift < 16; shift += 8) {
+    memset(count, 0, sizeof(count));
+    for(uint16_t i = 0; i < len; i++) count[((src[i] ^ flip) >> shift) & 0xFF]++;
+    uint16_t offset = 0;
+    for(uint16_t d = 0; d < 256; d++) {
+      uint16_t n = count[d];
+      count[d] = offset;
+      offset += n;
     }
-    array[j + 1] = key;
+    for(uint16_t i = 0; i < len; i++) dst[count[((src[i] ^ flip) >> shift) & 0xFF]++] = src[i];
+    uint16_t *swap = src;
+    src = dst;
+    dst = swap;
   }
 }
 
-void sort_desc_u32(uint32_t *array, uint16_t len)
+void sort_radix_u16(uint16_t *array, uint16_t len, uint16_t *temp)
 {
-  for(uint16_t i = 1; i < len; i++) {
-    uint32_t key = array[i];
-    int32_t j = i - 1;
-    while(j >= 0 && array[j] < key) {
-      array[j + 1] = array[j];
-      j--;
-    }
-    array[j + 1] = key;
-  }
+  if(len < 64) sort_asc_u16(array, len); // Two full passes do not pay off on short arrays
+  else sort_radix16(array, len, temp, 0);
 }
 
-void sort_desc_i32(int32_t *array, uint16_t len)
+void sort_radix_i16(int16_t *array, uint16_t len, int16_t *temp)
 {
-  for(uint16_t i = 1; i < len; i++) {
-    int32_t key = array[i];
-    int32_t j = i - 1;
-    while(j >= 0 && array[j] < key) {
-      array[j + 1] = array[j];
-      j--;
-    }
-    array[j + 1] = key;
-  }
+  if(len < 64) sort_asc_i16(array, len); // Two full passes do not pay off on short arrays
+  else sort_radix16((uint16_t *)array, len, (uint16_t *)temp, 0x8000);
 }
 
 //------------------------------------------------------------------------------------------------- avg
@@ -384,46 +458,6 @@ void convert_u16_to_i32(const uint16_t *u16, int32_t *i32, uint16_t len)
   }
 }
 
-/**
- * @brief Partitions `uint16_t` array so element `nth` lands in its sorted position.
- * @note Reorders elements in-place. Does not fully sort array.
- *   After return, all elements before `nth` are `<= array[nth]`,
- *   and all elements after `nth` are `>= array[nth]`.
- * @param[in,out] array Pointer to array to partition.
- * @param[in] len Number of elements in `array`.
- * @param[in] nth Target order index to select.
- */
-static void select_u16(uint16_t *array, uint16_t len, uint16_t nth)
-{
-  if(len < 2 || nth >= len) return;
-  uint16_t left = 0;
-  uint16_t right = len - 1;
-  while(left < right) {
-    uint16_t mid = left + (right - left) / 2;
-    uint16_t a = array[left];
-    uint16_t b = array[mid];
-    uint16_t c = array[right];
-    uint16_t pivot;
-    if(a < b) pivot = (b < c) ? b : ((a < c) ? c : a);
-    else pivot = (a < c) ? a : ((b < c) ? c : b);
-    uint16_t i = left;
-    uint16_t j = right;
-    while(1) {
-      while(i <= right && array[i] < pivot) i++;
-      while(j > left && array[j] > pivot) j--;
-      if(i >= j) break;
-      uint16_t tmp = array[i];
-      array[i] = array[j];
-      array[j] = tmp;
-      i++;
-      if(j == 0) break;
-      j--;
-    }
-    if(nth <= j) right = j;
-    else left = j + 1;
-  }
-}
-
 float mid_mean_u16(uint16_t *buff, uint16_t len)
 {
   if(len == 0) return 0.0f;
@@ -431,42 +465,11 @@ float mid_mean_u16(uint16_t *buff, uint16_t len)
   uint16_t size = len / 3;
   if(size == 0) return avg_u16(buff, len);
   uint16_t start = size;
-  select_u16(buff, len, start);
-  select_u16(&buff[start], len - start, size - 1);
+  nth_u16(buff, len, start);
+  nth_u16(&buff[start], len - start, size - 1);
   return avg_u16(&buff[start], size);
 }
 
-static void select_i16(int16_t *array, uint16_t len, uint16_t nth)
-{
-  if(len < 2 || nth >= len) return;
-  uint16_t left = 0;
-  uint16_t right = len - 1;
-  while(left < right) {
-    uint16_t mid = left + (right - left) / 2;
-    int16_t a = array[left];
-    int16_t b = array[mid];
-    int16_t c = array[right];
-    int16_t pivot;
-    if(a < b) pivot = (b < c) ? b : ((a < c) ? c : a);
-    else pivot = (a < c) ? a : ((b < c) ? c : b);
-    uint16_t i = left;
-    uint16_t j = right;
-    while(1) {
-      while(i <= right && array[i] < pivot) i++;
-      while(j > left && array[j] > pivot) j--;
-      if(i >= j) break;
-      int16_t tmp = array[i];
-      array[i] = array[j];
-      array[j] = tmp;
-      i++;
-      if(j == 0) break;
-      j--;
-    }
-    if(nth <= j) right = j;
-    else left = j + 1;
-  }
-}
-
 float mid_mean_i16(int16_t *buff, uint16_t len)
 {
   if(len == 0) return 0.0f;
@@ -474,8 +477,8 @@ float mid_mean_i16(int16_t *buff, uint16_t len)
   uint16_t size = len / 3;
   if(size == 0) return avg_i16(buff, len);
   uint16_t start = size;
-  select_i16(buff, len, start);
-  select_i16(&buff[start], len - start, size - 1);
+  nth_i16(buff, len, start);
+  nth_i16(&buff[start], len - start, size - 1);
   return avg_i16(&buff[start], size);
 }
 
@@ -15,6 +15,11 @@
   #define M_PI 3.14159265358979323846
 #endif
 
+#ifndef XMATH_SORT_SMALL
+  // Sort partitions up to this size are finished by insertion sort
+  #define XMATH_SORT_SMALL 16
+#endif
+
 int64_t div_round(int64_t num, int64_t den);
 
 uint32_t ieee754_pack(float nbr);
@@ -25,6 +30,8 @@ float min_f32_NaN(uint16_t count, ...);
 
 //-------------------------------------------------------------------------------------- Median
 
+// Sorts below are introsort: O(n log n) worst case, no heap, O(log n) stack.
+
 /**
  * @brief Sorts `uint16_t` array in ascending order (in-place).
  * @param array Pointer to array to sort.
@@ -81,6 +88,38 @@ void sort_desc_u32(uint32_t *array, uint16_t len);
  */
 void sort_desc_i32(int32_t *array, uint16_t len);
 
+/**
+ * @brief Sorts `uint16_t` array in ascending order with LSD radix sort, O(n).
+ * Arrays shorter than 64 elements are passed to `sort_asc_u16`.
+ * @param[in,out] array Pointer to array to sort.
+ * @param[in] len Number of elements in `array`.
+ * @param[out] temp Scratch buffer of `len` elements (content destroyed).
+ */
+void sort_radix_u16(uint16_t *array, uint16_t len, uint16_t *temp);
+
+/**
+ * @brief Sorts `int16_t` array in ascending order with LSD radix sort, O(n).
+ * @param[in,out] array Pointer to array to sort.
+ * @param[in] len Number of elements in `array`.
+ * @param[out] temp Scratch buffer of `len` elements (content destroyed).
+ */
+void sort_radix_i16(int16_t *array, uint16_t len, int16_t *temp);
+
+/**
+ * @brief Selects `nth` smallest element of `uint16_t` array (introselect, O(n)).
+ * @note Reorders elements in-place. After return, elements before `nth` are `<= array[nth]`
+ *   and elements after `nth` are `>= array[nth]`.
+ *   Median: `nth_u16(array, len, len / 2)`, percentile `p`: `nth_u16(array, len, p * (len - 1) / 100)`.
+ * @param[in,out] array Pointer to array.
+ * @param[in] len Number of elements in `array`.
+ * @param[in] nth Target order index (clamped to `len - 1`).
+ * @return Value of `nth` element or `0` for empty array.
+ */
+uint16_t nth_u16(uint16_t *array, uint16_t len, uint16_t nth);
+int16_t nth_i16(int16_t *array, uint16_t len, uint16_t nth); // Signed counterpart of `nth_u16`.
+uint32_t nth_u32(uint32_t *array, uint16_t len, uint16_t nth); // 32-bit counterpart of `nth_u16`.
+int32_t nth_i32(int32_t *array, uint16_t len, uint16_t nth); // Signed 32-bit counterpart of `nth_u16`.
+
 //-------------------------------------------------------------------------------------- median
 
 float avg_u16(const uint16_t *array, uint16_t len);
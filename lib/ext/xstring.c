@@ -89,18 +89,252 @@ char StrTempMem[64 + 2]; // Enough for 64-bit binary number (64 bits + sign + '\
  */
 char *str_from_int(int64_t nbr, uint8_t base, bool sign, uint8_t fill_zero, uint8_t fill_space)
 {
-  uint8_t len = itoa_encode(nbr, StrTempMem, base, sign, fill_zero, fill_space);
-  char *string = heap_new(len + 1);
+  char number[STR_NUMBER_SIZE];
+  uint8_t len = str_format_int(number, nbr, base, sign, fill_zero);
+  uint8_t pad = fill_space > len ? fill_space - len : 0;
+  char *string = heap_new(pad + len + 1);
   if(!string) return NULL;
-  for(uint8_t i = 0; i < len; i++) {
-    string[i] = StrTempMem[len - 1 - i];
-  }
-  string[len] = '\0';
+  memset(string, ' ', pad);
+  memcpy(&string[pad], number, len);
+  string[pad + len] = '\0';
   return string;
 }
 
 //-------------------------------------------------------------------------------------------------
 
+static const char DigitPairs[] =
+  "0001020304050607080910111213141516171819"
+  "2021222324252627282930313233343536373839"
+  "4041424344454647484950515253545556575859"
+  "6061626364656667686970717273747576777879"
+  "8081828384858687888990919293949596979899";
+
+static const uint64_t Pow10[] = {
+  1ull, 10ull, 100ull, 1000ull, 10000ull, 100000ull, 1000000ull, 10000000ull, 100000000ull,
+  1000000000ull, 10000000000ull, 100000000000ull, 1000000000000ull, 10000000000000ull,
+  100000000000000ull, 1000000000000000ull, 10000000000000000ull, 100000000000000000ull,
+  1000000000000000000ull, 10000000000000000000ull
+};
+
+/**
+ * @brief Helper: write 4 decimal digits of `nbr` (0–9999) as two digit pairs.
+ * Division by 100 is done as `(nbr * 5243) >> 19` (exact below 43699), no divider call.
+ */
+static inline void str_digits4(char *str, uint32_t nbr)
+{
+  uint32_t hi = (nbr * 5243) >> 19;
+  memcpy(str, &DigitPairs[hi * 2], 2);
+  memcpy(&str[2], &DigitPairs[(nbr - hi * 100) * 2], 2);
+}
+
+/**
+ * @brief Helper: write decimal digits of `nbr` backward, last digit just before `end`.
+ * Digits go in groups of 4, so 32-bit number costs at most 2 divisions
+ * and 64-bit division is used only for the part above `UINT32_MAX`.
+ * @param end Position after last digit.
+ * @param nbr Number to write.
+ * @return Number of digits written.
+ */
+static uint8_t str_udec_backward(char *end, uint64_t nbr)
+{
+  char *p = end;
+  while(nbr > UINT32_MAX) {
+    uint64_t q = nbr / 100000000;
+    uint32_t lo = (uint32_t)(nbr - q * 100000000);
+    uint32_t hi = lo / 10000;
+    str_digits4(p -= 4, lo - hi * 10000);
+    str_digits4(p -= 4, hi);
+    nbr = q;
+  }
+  uint32_t n = (uint32_t)nbr;
+  while(n >= 10000) {
+    uint32_t q = n / 10000;
+    str_digits4(p -= 4, n - q * 10000);
+    n = q;
+  }
+  if(n >= 100) {
+    uint32_t q = (n * 5243) >> 19;
+    memcpy(p -= 2, &DigitPairs[(n - q * 100) * 2], 2);
+    n = q;
+  }
+  if(n >= 10) memcpy(p -= 2, &DigitPairs[n * 2], 2);
+  else *--p = (char)('0' + n);
+  return (uint8_t)(end - p);
+}
+
+/**
+ * @brief Helper: number of digits of `nbr` in `base`.
+ * Decimal compares with powers of 10, power-of-two bases count bits, others divide.
+ */
+static uint8_t str_digit_count(uint64_t nbr, uint8_t base)
+{
+  uint8_t count = 1;
+  if(base == 10) {
+    while(count < 20 && nbr >= Pow10[count]) count++;
+  }
+  else if(!(base & (base - 1))) {
+    uint8_t shift = (uint8_t)__builtin_ctz(base);
+    while(nbr >>= shift) count++;
+  }
+  else {
+    while(nbr >= base) {
+      nbr /= base;
+      count++;
+    }
+  }
+  return count;
+}
+
+/**
+ * @brief Format integer into caller buffer, left to right, without heap or shared buffer.
+ * Output is not null-terminated; `STR_NUMBER_SIZE` buffer fits any result with terminator.
+ * Decimal digits are written in pairs from lookup table, base 2/4/8/16/32 uses shifts.
+ * @param str Output buffer.
+ * @param nbr Number to convert.
+ * @param base Numeric base (2–36).
+ * @param sign If true, treat as signed and show sign if negative.
+ * @param fill_zero Minimal length with sign (filled with zeros after sign).
+ * @return Number of chars written (`0` for invalid base).
+ */
+uint8_t str_format_int(char *str, int64_t nbr, uint8_t base, bool sign, uint8_t fill_zero)
+{
+  static const char Digits[] = "0123456789ABCDEFGHIJKLMNOPQRSTUVWXYZ";
+  if(base < 2 || base > 36) return 0;
+  bool negative = sign && nbr < 0;
+  uint64_t unbr = negative ? 0 - (uint64_t)nbr : (uint64_t)nbr;
+  uint8_t count = str_digit_count(unbr, base);
+  uint8_t len = count + negative;
+  if(fill_zero > STR_NUMBER_SIZE - 1) fill_zero = STR_NUMBER_SIZE - 1;
+  if(fill_zero > len) len = fill_zero;
+  char *end = &str[len];
+  if(negative) *str++ = '-';
+  memset(str, '0', (size_t)(end - str) - count);
+  if(base == 10) {
+    str_udec_backward(end, unbr);
+  }
+  else if(!(base & (base - 1))) {
+    uint8_t shift = (uint8_t)__builtin_ctz(base);
+    do {
+      *--end = Digits[unbr & (base - 1)];
+      unbr >>= shift;
+    } while(unbr);
+  }
+  else {
+    do {
+      *--end = Digits[unbr % base];
+      unbr /= base;
+    } while(unbr);
+  }
+  return len;
+}
+
+/**
+ * @brief Helper: write `mantissa * 2^shift` (above 64-bit range) as `d.ddde+NN`.
+ * Mantissa is doubled while it fits in 59 bits, otherwise divided by 10 with exponent up,
+ * so binary exponent turns into decimal one with integer steps only.
+ * @param str Output buffer.
+ * @param mantissa Float mantissa (with hidden bit).
+ * @param shift Binary exponent (positive).
+ * @param accuracy Digits after decimal point (up to `STR_FLOAT_ACCURACY_MAX`).
+ * @return Number of chars written.
+ */
+static uint8_t str_format_exp(char *str, uint64_t mantissa, int16_t shift, uint8_t accuracy)
+{
+  uint16_t exp = 0;
+  while(shift > 0) {
+    if(mantissa < (1ull << 59)) {
+      mantissa <<= 1;
+      shift--;
+    }
+    else {
+      mantissa = (mantissa + 5) / 10;
+      exp++;
+    }
+  }
+  // Round to `accuracy + 1` significant digits (mantissa has at least 17)
+  uint8_t keep = accuracy + 1;
+  uint8_t drop = str_digit_count(mantissa, 10) - keep;
+  mantissa = (mantissa / Pow10[drop - 1] + 5) / 10;
+  exp += drop;
+  if(mantissa >= Pow10[keep]) {
+    mantissa /= 10;
+    exp++;
+  }
+  exp += keep - 1;
+  // Digits go after first char, leading one is moved in front of decimal point
+  str_udec_backward(&str[1 + keep], mantissa);
+  str[0] = str[1];
+  str[1] = '.';
+  char *end = &str[accuracy ? 1 + keep : 1];
+  *end++ = 'e';
+  *end++ = '+';
+  end += str_digit_count(exp, 10);
+  str_udec_backward(end, exp);
+  return (uint8_t)(end - str);
+}
+
+/**
+ * @brief Format float as fixed-point number into caller buffer, without heap or shared buffer.
+ * Mantissa is multiplied by `10^accuracy` in 64-bit integer and shifted by binary exponent
+ * with rounding half away from zero: one exact step, no float multiply loop.
+ * Whole numbers (binary exponent not negative) skip scaling, fraction is zero.
+ * Values above 64-bit integer range are written with exponent (`3.403e+38`).
+ * Output is not null-terminated and is at most 31 chars.
+ * @param str Output buffer.
+ * @param nbr Number to convert.
+ * @param accuracy Digits after decimal point (up to `STR_FLOAT_ACCURACY_MAX`).
+ * @return Number of chars written, `0` for `NaN` or `Inf`.
+ */
+uint8_t str_format_float(char *str, float nbr, uint8_t accuracy)
+{
+  if(accuracy > STR_FLOAT_ACCURACY_MAX) accuracy = STR_FLOAT_ACCURACY_MAX;
+  union { float f; uint32_t u; } bits = { .f = nbr };
+  uint32_t exp = (bits.u >> 23) & 0xFF;
+  if(exp == 0xFF) return 0;
+  uint64_t mantissa = bits.u & 0x7FFFFF;
+  int16_t shift = -149;
+  if(exp) {
+    mantissa |= 0x800000;
+    shift = (int16_t)exp - 150;
+  }
+  char *start = str;
+  uint64_t integer;
+  uint32_t fraction = 0;
+  if(shift >= 0) {
+    if(bits.u >> 31) *str++ = '-';
+    if(shift >= 64 || mantissa > (UINT64_MAX >> shift)) {
+      return (uint8_t)(str - start) + str_format_exp(str, mantissa, shift, accuracy);
+    }
+    integer = mantissa << shift;
+  }
+  else {
+    uint32_t pow = (uint32_t)Pow10[accuracy];
+    uint64_t scaled = mantissa * pow; // |nbr| * 10^accuracy = scaled * 2^shift (below 2^54)
+    if(shift > -64) scaled = (scaled + (1ull << (-shift - 1))) >> -shift;
+    else scaled = 0;
+    if(scaled && (bits.u >> 31)) *str++ = '-';
+    if(scaled <= UINT32_MAX) {
+      integer = (uint32_t)scaled / pow;
+      fraction = (uint32_t)scaled - (uint32_t)integer * pow;
+    }
+    else {
+      integer = scaled / pow;
+      fraction = (uint32_t)(scaled - integer * pow);
+    }
+  }
+  str += str_digit_count(integer, 10);
+  str_udec_backward(str, integer);
+  if(accuracy) {
+    *str++ = '.';
+    memset(str, '0', accuracy);
+    str += accuracy;
+    str_udec_backward(str, fraction);
+  }
+  return (uint8_t)(str - start);
+}
+
+//-------------------------------------------------------------------------------------------------
+
 /**
  * @brief Check if `str` can be parsed as `uint16_t`.
  * Accepts decimal, hexadecimal (`0x` prefix) and binary (`0b` prefix).
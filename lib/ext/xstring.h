@@ -15,6 +15,16 @@
 
 //-------------------------------------------------------------------------------------------------
 
+#ifndef STR_NUMBER_SIZE
+  // Buffer for `str_format_int`/`str_format_float` result (64-bit binary + sign + '\0')
+  #define STR_NUMBER_SIZE 66
+#endif
+
+// Digits after decimal point limit of `str_format_float` (`10^9` fits 32-bit multiplier)
+#define STR_FLOAT_ACCURACY_MAX 9
+
+//-------------------------------------------------------------------------------------------------
+
 extern char StrTempMem[];
 extern const char LowerCase[];
 extern const char UpperCase[];
@@ -26,6 +36,8 @@ uint32_t hash_djb2_ci(const char *str);
 
 uint8_t itoa_encode(int64_t nbr, char *str, uint8_t base, bool sign, uint8_t fill_zero, uint8_t fill_space);
 char *str_from_int(int64_t nbr, uint8_t base, bool sign, uint8_t fill_zero, uint8_t fill_space);
+uint8_t str_format_int(char *str, int64_t nbr, uint8_t base, bool sign, uint8_t fill_zero);
+uint8_t str_format_float(char *str, float nbr, uint8_t accuracy);
 bool str_is_u16(const char *str);
 bool str_is_i16(const char *str);
 bool str_is_u32(const char *str);
@@ -0,0 +1,148 @@
+// lib/pb/pbgen.h
+// Runtime helpers of codecs generated by `pbgen.py`.
+
+#ifndef PBGEN_H_
+#define PBGEN_H_
+
+#include "pb_encode.h"
+#include "pb_decode.h"
+
+//------------------------------------------------------------------------------------------- Size
+
+static inline uint8_t pbgen_varint32_size(uint32_t value)
+{
+  if(value < (1u << 7)) return 1;
+  if(value < (1u << 14)) return 2;
+  if(value < (1u << 21)) return 3;
+  if(value < (1u << 28)) return 4;
+  return 5;
+}
+
+static inline uint8_t pbgen_varint_size(uint64_t value)
+{
+  if(value <= UINT32_MAX) return pbgen_varint32_size((uint32_t)value);
+  uint8_t size = 5;
+  for(value >>= 35; value; value >>= 7) size++;
+  return size;
+}
+
+// Negative `int32` is sent sign-extended to 64 bits
+static inline uint8_t pbgen_int32_size(int32_t value)
+{
+  return value < 0 ? 10 : pbgen_varint32_size((uint32_t)value);
+}
+
+static inline uint32_t pbgen_zigzag32(int32_t value)
+{
+  return ((uint32_t)value << 1) ^ (uint32_t)(value >> 31);
+}
+
+static inline uint64_t pbgen_zigzag64(int64_t value)
+{
+  return ((uint64_t)value << 1) ^ (uint64_t)(value >> 63);
+}
+
+static inline uint32_t pbgen_float_bits(float value)
+{
+  uint32_t bits;
+  memcpy(&bits, &value, 4);
+  return bits;
+}
+
+static inline uint64_t pbgen_double_bits(double value)
+{
+  uint64_t bits;
+  memcpy(&bits, &value, 8);
+  return bits;
+}
+
+//----------------------------------------------------------------------------------------- Encode
+
+static inline uint8_t pbgen_varint32(pb_byte_t *buf, uint32_t value)
+{
+  uint8_t n = 0;
+  while(value >= 0x80) {
+    buf[n++] = (pb_byte_t)(value | 0x80);
+    value >>= 7;
+  }
+  buf[n++] = (pb_byte_t)value;
+  return n;
+}
+
+static inline uint8_t pbgen_varint(pb_byte_t *buf, uint64_t value)
+{
+  if(value <= UINT32_MAX) return pbgen_varint32(buf, (uint32_t)value);
+  uint8_t n = 0;
+  while(value >= 0x80) {
+    buf[n++] = (pb_byte_t)(value | 0x80);
+    value >>= 7;
+  }
+  buf[n++] = (pb_byte_t)value;
+  return n;
+}
+
+// Field key and value go out in one `pb_write` (generic path writes them separately)
+static inline bool pbgen_put_varint32(pb_ostream_t *stream, uint32_t key, uint32_t value)
+{
+  pb_byte_t buf[10];
+  uint8_t n = pbgen_varint32(buf, key);
+  n += pbgen_varint32(&buf[n], value);
+  return pb_write(stream, buf, n);
+}
+
+static inline bool pbgen_put_varint(pb_ostream_t *stream, uint32_t key, uint64_t value)
+{
+  pb_byte_t buf[15];
+  uint8_t n = pbgen_varint32(buf, key);
+  n += pbgen_varint(&buf[n], value);
+  return pb_write(stream, buf, n);
+}
+
+static inline bool pbgen_put_int32(pb_ostream_t *stream, uint32_t key, int32_t value)
+{
+  if(value < 0) return pbgen_put_varint(stream, key, (uint64_t)(int64_t)value);
+  return pbgen_put_varint32(stream, key, (uint32_t)value);
+}
+
+static inline bool pbgen_put_fixed32(pb_ostream_t *stream, uint32_t key, uint32_t value)
+{
+  pb_byte_t buf[9];
+  uint8_t n = pbgen_varint32(buf, key);
+  for(uint8_t i = 0; i < 4; i++, value >>= 8) buf[n++] = (pb_byte_t)value;
+  return pb_write(stream, buf, n);
+}
+
+static inline bool pbgen_put_fixed64(pb_ostream_t *stream, uint32_t key, uint64_t value)
+{
+  pb_byte_t buf[13];
+  uint8_t n = pbgen_varint32(buf, key);
+  for(uint8_t i = 0; i < 8; i++, value >>= 8) buf[n++] = (pb_byte_t)value;
+  return pb_write(stream, buf, n);
+}
+
+static inline bool pbgen_put_bytes(pb_ostream_t *stream, uint32_t key, const void *data, size_t size)
+{
+  return pbgen_put_varint32(stream, key, (uint32_t)size) && pb_write(stream, (const pb_byte_t *)data, size);
+}
+
+//----------------------------------------------------------------------------------------- Decode
+
+static inline bool pbgen_get_string(pb_istream_t *stream, char *dst, size_t max_size)
+{
+  uint32_t size;
+  if(!pb_decode_varint32(stream, &size) || size >= max_size) return false;
+  if(!pb_read(stream, (pb_byte_t *)dst, size)) return false;
+  dst[size] = 0;
+  return true;
+}
+
+static inline bool pbgen_get_bytes(pb_istream_t *stream, pb_byte_t *dst, pb_size_t *size, size_t max_size)
+{
+  uint32_t len;
+  if(!pb_decode_varint32(stream, &len) || len > max_size) return false;
+  *size = (pb_size_t)len;
+  return pb_read(stream, dst, len);
+}
+
+//-------------------------------------------------------------------------------------------------
+#endif
@@ -0,0 +1,521 @@
+# Protobuf codec generator: `<name>.proto` -> `<name>.pb.h` + `<name>.pb.c`
+# Emits nanopb structs and descriptors (generic `pb_encode`/`pb_decode` keep working)
+# and straight-line `<Msg>_Size`, `<Msg>_Encode`, `<Msg>_Decode` without descriptor walk.
+# Unknown fields are skipped by `pb_skip_field` as in generic decoder.
+# Subset of proto3: scalars, enums, `string`/`bytes` with `(nanopb).max_size`,
+# `repeated` with `(nanopb).max_count`, `optional`, messages at top level.
+# Run from Makefile or by hand: `python pbgen.py <file.proto> [<outdir>]`.
+
+import re
+import sys
+from pathlib import Path
+
+HEADER_RULE = 95 # Length of `//---...--- Name` separators
+ROOT = Path(__file__).resolve().parents[2]
+
+# proto type: (C type, nanopb type, wire type, codec)
+SCALARS = {
+  'bool':     ('bool',     'BOOL',     'VARINT', 'bool'),
+  'int32':    ('int32_t',  'INT32',    'VARINT', 'int32'),
+  'uint32':   ('uint32_t', 'UINT32',   'VARINT', 'uint32'),
+  'sint32':   ('int32_t',  'SINT32',   'VARINT', 'sint32'),
+  'int64':    ('int64_t',  'INT64',    'VARINT', 'int64'),
+  'uint64':   ('uint64_t', 'UINT64',   'VARINT', 'uint64'),
+  'sint64':   ('int64_t',  'SINT64',   'VARINT', 'sint64'),
+  'fixed32':  ('uint32_t', 'FIXED32',  '32BIT',  'fixed32'),
+  'sfixed32': ('int32_t',  'SFIXED32', '32BIT',  'fixed32'),
+  'float':    ('float',    'FLOAT',    '32BIT',  'float'),
+  'fixed64':  ('uint64_t', 'FIXED64',  '64BIT',  'fixed64'),
+  'sfixed64': ('int64_t',  'SFIXED64', '64BIT',  'fixed64'),
+  'double':   ('double',   'DOUBLE',   '64BIT',  'double'),
+}
+WIRE = {'VARINT': 0, '64BIT': 1, 'STRING': 2, '32BIT': 5}
+TOKEN = re.compile(r'\(nanopb\)\.\w+|[A-Za-z_][\w.]*|-?\d+|"[^"]*"|[{}\[\];=,]')
+
+#------------------------------------------------------------------------------------------- Parse
+
+class Tokens:
+  def __init__(self, text: str):
+    text = re.sub(r'//[^\n]*|/\*.*?\*/', '', text, flags=re.S)
+    self.items = TOKEN.findall(text)
+    self.pos = 0
+  def more(self) -> bool:
+    return self.pos < len(self.items)
+  def peek(self) -> str:
+    return self.items[self.pos] if self.more() else ''
+  def take(self, expect: str = None) -> str:
+    if not self.more(): sys.exit("Unexpected end of file")
+    token = self.items[self.pos]
+    if expect and token != expect: sys.exit(f"Expected '{expect}', got '{token}'")
+    self.pos += 1
+    return token
+  def skip_statement(self):
+    while self.take() != ';': pass
+
+def parse_enum(tokens: Tokens, name: str) -> dict:
+  tokens.take('{')
+  values = []
+  while tokens.peek() != '}':
+    if tokens.peek() in ('option', 'reserved'):
+      tokens.skip_statement()
+      continue
+    ident = tokens.take()
+    tokens.take('=')
+    values.append((ident, int(tokens.take())))
+    if tokens.peek() == '[':
+      while tokens.take() != ']': pass
+    tokens.take(';')
+  tokens.take('}')
+  return {'name': name, 'values': values}
+
+def parse_options(tokens: Tokens) -> dict:
+  options = {}
+  if tokens.peek() != '[': return options
+  tokens.take('[')
+  while True:
+    key = tokens.take()
+    tokens.take('=')
+    options[key] = tokens.take()
+    if tokens.take() == ']': return options
+
+def parse_message(tokens: Tokens, name: str, enums: dict) -> dict:
+  tokens.take('{')
+  fields = []
+  while tokens.peek() != '}':
+    token = tokens.take()
+    if token in ('option', 'reserved'):
+      tokens.skip_statement()
+      continue
+    if token == 'enum':
+      ident = tokens.take()
+      enums[f"{name}.{ident}"] = parse_enum(tokens, f"{name}_{ident}")
+      continue
+    if token in ('message', 'oneof', 'map', 'extensions', 'group'):
+      sys.exit(f"{name}: '{token}' is not supported (declare messages at top level)")
+    label = 'singular'
+    if token in ('repeated', 'optional'):
+      label, token = token, tokens.take()
+    field = {'label': label, 'type': token, 'name': tokens.take()}
+    tokens.take('=')
+    field['number'] = int(tokens.take())
+    options = parse_options(tokens)
+    tokens.take(';')
+    field['max_size'] = int(options.get('(nanopb).max_size', 0))
+    field['max_count'] = int(options.get('(nanopb).max_count', 0))
+    fields.append(field)
+  tokens.take('}')
+  return {'name': name, 'fields': sorted(fields, key=lambda f: f['number'])}
+
+def parse(text: str) -> tuple[list[dict], list[dict]]:
+  tokens = Tokens(text)
+  messages, enums = [], {}
+  while tokens.more():
+    token = tokens.take()
+    if token in ('syntax', 'package', 'import', 'option'): tokens.skip_statement()
+    elif token == 'enum':
+      ident = tokens.take()
+      enums[ident] = parse_enum(tokens, ident)
+    elif token == 'message': messages.append(parse_message(tokens, tokens.take(), enums))
+    else: sys.exit(f"Unexpected '{token}'")
+  return messages, enums
+
+#----------------------------------------------------------------------------------------- Resolve
+
+def resolve(messages: list[dict], enums: dict) -> list[dict]:
+  """Set `kind` and C type of fields, check limits and sort messages by dependency"""
+  names = {msg['name'] for msg in messages}
+  for msg in messages:
+    for f in msg['fields']:
+      where = f"{msg['name']}.{f['name']}"
+      t = f['type']
+      if t in SCALARS:
+        f['kind'] = 'scalar'
+        f['ctype'], f['ltype'], f['wire'], f['codec'] = SCALARS[t]
+      elif t in ('string', 'bytes'):
+        if not f['max_size']: sys.exit(f"{where}: (nanopb).max_size is required")
+        f['kind'], f['ltype'], f['wire'] = t, t.upper(), 'STRING'
+        f['ctype'] = 'char' if t == 'string' else f"{msg['name']}_{f['name']}_t"
+      elif f"{msg['name']}.{t}" in enums or t in enums:
+        enum = enums.get(f"{msg['name']}.{t}") or enums[t]
+        f['kind'], f['ltype'], f['wire'], f['codec'] = 'scalar', 'ENUM', 'VARINT', 'enum'
+        f['ctype'] = enum['name']
+      elif t in names:
+        f['kind'], f['ltype'], f['wire'], f['ctype'] = 'message', 'MESSAGE', 'STRING', t
+        if f['label'] == 'singular': f['label'] = 'optional' # proto3 submessage has presence
+      else: sys.exit(f"{where}: unknown type '{t}'")
+      if f['label'] == 'repeated' and not f['max_count']: sys.exit(f"{where}: (nanopb).max_count is required")
+      packed = f['label'] == 'repeated' and f['kind'] == 'scalar'
+      f['key'] = (f['number'] << 3) | WIRE['STRING' if packed else f['wire']]
+  ordered, done = [], set()
+  def visit(msg: dict, path: tuple):
+    if msg['name'] in done: return
+    if msg['name'] in path: sys.exit(f"Message cycle: {' -> '.join(path + (msg['name'],))}")
+    for f in msg['fields']:
+      if f['kind'] == 'message': visit(next(m for m in messages if m['name'] == f['ctype']), path + (msg['name'],))
+    done.add(msg['name'])
+    ordered.append(msg)
+  for msg in messages: visit(msg, ())
+  return ordered
+
+#---------------------------------------------------------------------------------------- Snippets
+
+def varint_size(value: int) -> int:
+  return max(1, (value.bit_length() + 6) // 7)
+
+def put(f: dict, value: str) -> str:
+  """Call writing key and value"""
+  key, codec = f['key'], f['codec']
+  return {
+    'bool':    f"pbgen_put_varint32(stream, {key}, {value})",
+    'int32':   f"pbgen_put_int32(stream, {key}, {value})",
+    'enum':    f"pbgen_put_int32(stream, {key}, (int32_t){value})",
+    'uint32':  f"pbgen_put_varint32(stream, {key}, {value})",
+    'sint32':  f"pbgen_put_varint32(stream, {key}, pbgen_zigzag32({value}))",
+    'int64':   f"pbgen_put_varint(stream, {key}, (uint64_t){value})",
+    'uint64':  f"pbgen_put_varint(stream, {key}, {value})",
+    'sint64':  f"pbgen_put_varint(stream, {key}, pbgen_zigzag64({value}))",
+    'fixed32': f"pbgen_put_fixed32(stream, {key}, (uint32_t){value})",
+    'float':   f"pbgen_put_fixed32(stream, {key}, pbgen_float_bits({value}))",
+    'fixed64': f"pbgen_put_fixed64(stream, {key}, (uint64_t){value})",
+    'double':  f"pbgen_put_fixed64(stream, {key}, pbgen_double_bits({value}))",
+  }[codec]
+
+def put_raw(f: dict, value: str) -> str:
+  """Call writing packed element"""
+  codec = f['codec']
+  if codec in ('fixed32', 'float'): return f"pb_encode_fixed32(stream, &{value})"
+  if codec in ('fixed64', 'double'): return f"pb_encode_fixed64(stream, &{value})"
+  return f"pb_encode_varint(stream, {raw_value(f, value)})"
+
+def raw_value(f: dict, value: str) -> str:
+  return {
+    'bool': value, 'uint32': value, 'uint64': value,
+    'int32': f"(uint64_t)(int64_t){value}",
+    'enum': f"(uint64_t)(int64_t){value}",
+    'sint32': f"pbgen_zigzag32({value})",
+    'int64': f"(uint64_t){value}",
+    'sint64': f"pbgen_zigzag64({value})",
+  }[f['codec']]
+
+def value_size(f: dict, value: str) -> str:
+  """Encoded size of value without key"""
+  return {
+    'bool': '1', 'fixed32': '4', 'float': '4', 'fixed64': '8', 'double': '8',
+    'int32': f"pbgen_int32_size({value})",
+    'enum': f"pbgen_int32_size((int32_t){value})",
+    'uint32': f"pbgen_varint32_size({value})",
+    'sint32': f"pbgen_varint32_size(pbgen_zigzag32({value}))",
+    'int64': f"pbgen_varint_size((uint64_t){value})",
+    'uint64': f"pbgen_varint_size({value})",
+    'sint64': f"pbgen_varint_size(pbgen_zigzag64({value}))",
+  }[f['codec']]
+
+def is_set(f: dict, value: str) -> str:
+  """Proto3 default check (same as `pb_check_proto3_default_value`)"""
+  if f['label'] == 'optional': return f"msg->has_{f['name']}"
+  if f['kind'] == 'string': return f"{value}[0]"
+  if f['kind'] == 'bytes': return f"{value}.size"
+  if f['codec'] == 'float': return f"pbgen_float_bits({value})"
+  if f['codec'] == 'double': return f"pbgen_double_bits({value})"
+  return value
+
+def get(f: dict, stream: str, dst: str) -> tuple[str, str]:
+  """Decode of scalar: condition (true on success) and optional assignment"""
+  codec = f['codec']
+  if codec in ('fixed32', 'float'): return f"pb_decode_fixed32({stream}, &{dst})", None
+  if codec in ('fixed64', 'double'): return f"pb_decode_fixed64({stream}, &{dst})", None
+  if codec == 'uint32': return f"pb_decode_varint32({stream}, &{dst})", None
+  if codec == 'uint64': return f"pb_decode_varint({stream}, &{dst})", None
+  if codec == 'sint64': return f"pb_decode_svarint({stream}, &{dst})", None
+  if codec == 'int64': return f"pb_decode_varint({stream}, &u64)", f"{dst} = (int64_t)u64;"
+  return f"pb_decode_varint32({stream}, &u32)", {
+    'bool': f"{dst} = u32 != 0;",
+    'int32': f"{dst} = (int32_t)u32;",
+    'enum': f"{dst} = ({f['ctype']})(int32_t)u32;",
+    'sint32': f"{dst} = (int32_t)((u32 >> 1) ^ (0u - (u32 & 1)));",
+  }[codec]
+
+def struct_bound(msg: dict, messages: list[dict]) -> int:
+  """Upper bound of struct size (every member padded to 8 bytes)"""
+  size = 0
+  for f in msg['fields']:
+    count = f['max_count'] or 1
+    if f['kind'] == 'string': item = f['max_size']
+    elif f['kind'] == 'bytes': item = f['max_size'] + 8
+    elif f['kind'] == 'message': item = struct_bound(next(m for m in messages if m['name'] == f['ctype']), messages)
+    else: item = 8
+    size += -(-item * count // 8) * 8 + (8 if f['label'] != 'singular' else 0)
+  return size
+
+def width(msg: dict, messages: list[dict]) -> str:
+  """Descriptor width of `PB_BIND`, same limits as `PB_FIELDINFO_ASSERT_x`"""
+  tag = max((f['number'] for f in msg['fields']), default=0)
+  bound = struct_bound(msg, messages)
+  count = max((f['max_count'] for f in msg['fields']), default=0)
+  if tag < 64 and bound < 256: return 'AUTO'
+  if tag < 1024 and bound < 4096 and count < 4096: return '2'
+  return '4' if tag < 65536 and bound < 65536 and count < 65536 else '8'
+
+#------------------------------------------------------------------------------------------ Render
+
+def rule(name: str) -> str:
+  return '//' + '-' * (HEADER_RULE - len(name) - 3) + ' ' + name
+
+def shown(path: Path) -> str:
+  try: return path.resolve().relative_to(ROOT).as_posix()
+  except ValueError: return path.name
+
+def render_enum(enum: dict) -> list[str]:
+  out = [f"typedef enum _{enum['name']} {{"]
+  out += [f"  {enum['name']}_{ident} = {value}," for ident, value in enum['values']]
+  out.append(f"}} {enum['name']};")
+  return out
+
+def render_struct(msg: dict) -> list[str]:
+  out = []
+  for f in msg['fields']:
+    if f['kind'] == 'bytes':
+      out.append(f"typedef PB_BYTES_ARRAY_T({f['max_size']}) {f['ctype']};")
+  out.append(f"typedef struct _{msg['name']} {{")
+  for f in msg['fields']:
+    if f['label'] == 'optional': out.append(f"  bool has_{f['name']};")
+    if f['label'] == 'repeated': out.append(f"  pb_size_t {f['name']}_count;")
+    dims = f"[{f['max_count']}]" if f['label'] == 'repeated' else ''
+    if f['kind'] == 'string': dims += f"[{f['max_size']}]"
+    out.append(f"  {f['ctype']} {f['name']}{dims};")
+  if not msg['fields']: out.append('  char dummy_field;')
+  out.append(f"}} {msg['name']};")
+  return out
+
+def render_descriptor(msg: dict) -> list[str]:
+  name = msg['name']
+  rows = [f"X(a, STATIC, {f['label'].upper()}, {f['ltype']}, {f['name']}, {f['number']})" for f in msg['fields']]
+  out = [f"#define {name}_FIELDLIST(X, a)" + (' \\' if rows else '')]
+  out += [row + (' \\' if i < len(rows) - 1 else '') for i, row in enumerate(rows)]
+  out += [f"#define {name}_CALLBACK NULL", f"#define {name}_DEFAULT NULL"]
+  out += [f"#define {name}_{f['name']}_MSGTYPE {f['ctype']}" for f in msg['fields'] if f['kind'] == 'message']
+  out += [f"extern const pb_msgdesc_t {name}_msg;", f"#define {name}_fields &{name}_msg"]
+  return out
+
+def render_api(msg: dict) -> list[str]:
+  name = msg['name']
+  return [
+    '/**',
+    f" * @brief Encoded size of `{name}` (without length prefix).",
+    ' */',
+    f"size_t {name}_Size(const {name} *msg);",
+    '',
+    '/**',
+    f" * @brief Encode `{name}`, same output as `pb_encode(stream, {name}_fields, msg)`.",
+    ' * @return `true` on success, `false` on stream error',
+    ' */',
+    f"bool {name}_Encode(pb_ostream_t *stream, const {name} *msg);",
+    '',
+    '/**',
+    f" * @brief Decode fields of `{name}` into `msg` without clearing it first (merge).",
+    ' * @return `true` on success, `false` on stream error, wrong wire type or array overflow',
+    ' */',
+    f"bool {name}_Merge(pb_istream_t *stream, {name} *msg);",
+    '',
+    '/**',
+    f" * @brief Clear `msg` and decode `{name}`, same result as `pb_decode(stream, {name}_fields, msg)`.",
+    ' * @return `true` on success, `false` on stream error, wrong wire type or array overflow',
+    ' */',
+    f"bool {name}_Decode(pb_istream_t *stream, {name} *msg);",
+  ]
+
+def render_size(msg: dict) -> list[str]:
+  name = msg['name']
+  out = [f"size_t {name}_Size(const {name} *msg)", '{', '  size_t size = 0;']
+  if not msg['fields']: out.append('  (void)msg;')
+  for f in msg['fields']:
+    v, key = f"msg->{f['name']}", varint_size(f['key'])
+    if f['label'] == 'repeated':
+      out.append(f"  for(pb_size_t i = 0; i < {v}_count; i++) {{")
+      item = f"{v}[i]"
+      if f['kind'] == 'string':
+        out += [f"    size_t n = strlen({item});", f"    size += {key} + pbgen_varint32_size(n) + n;"]
+      elif f['kind'] == 'bytes':
+        out.append(f"    size += {key} + pbgen_varint32_size({item}.size) + {item}.size;")
+      elif f['kind'] == 'message':
+        out += [f"    size_t n = {f['ctype']}_Size(&{item});", f"    size += {key} + pbgen_varint32_size(n) + n;"]
+      else:
+        out[-1] = f"  if({v}_count) {{"
+        if not value_size(f, item).isdigit():
+          out += ['    size_t n = 0;', f"    for(pb_size_t i = 0; i < {v}_count; i++) n += {value_size(f, item)};"]
+        else: out.append(f"    size_t n = (size_t){v}_count * {value_size(f, item)};")
+        out.append(f"    size += {key} + pbgen_varint32_size(n) + n;")
+      out.append('  }')
+    elif f['kind'] == 'string':
+      out += [f"  if({is_set(f, v)}) {{", f"    size_t n = strlen({v});",
+        f"    size += {key} + pbgen_varint32_size(n) + n;", '  }']
+    elif f['kind'] == 'bytes':
+      out.append(f"  if({is_set(f, v)}) size += {key} + pbgen_varint32_size({v}.size) + {v}.size;")
+    elif f['kind'] == 'message':
+      out += [f"  if({is_set(f, v)}) {{", f"    size_t n = {f['ctype']}_Size(&{v});",
+        f"    size += {key} + pbgen_varint32_size(n) + n;", '  }']
+    else: out.append(f"  if({is_set(f, v)}) size += {key} + {value_size(f, v)};")
+  out += ['  return size;', '}']
+  return out
+
+def render_encode(msg: dict) -> list[str]:
+  name = msg['name']
+  out = [f"bool {name}_Encode(pb_ostream_t *stream, const {name} *msg)", '{']
+  if not msg['fields']: out.append('  (void)stream;\n  (void)msg;')
+  for f in msg['fields']:
+    v, key = f"msg->{f['name']}", f['key']
+    if f['label'] == 'repeated':
+      item = f"{v}[i]"
+      if f['kind'] == 'scalar':
+        out += [f"  if({v}_count) {{"]
+        if not value_size(f, item).isdigit():
+          out += ['    size_t n = 0;', f"    for(pb_size_t i = 0; i < {v}_count; i++) n += {value_size(f, item)};"]
+        else: out.append(f"    size_t n = (size_t){v}_count * {value_size(f, item)};")
+        out += [f"    if(!pbgen_put_varint32(stream, {key}, (uint32_t)n)) return false;",
+          f"    for(pb_size_t i = 0; i < {v}_count; i++) {{",
+          f"      if(!{put_raw(f, item)}) return false;", '    }', '  }']
+        continue
+      out.append(f"  for(pb_size_t i = 0; i < {v}_count; i++) {{")
+      if f['kind'] == 'string':
+        out.append(f"    if(!pbgen_put_bytes(stream, {key}, {item}, strlen({item}))) return false;")
+      elif f['kind'] == 'bytes':
+        out.append(f"    if(!pbgen_put_bytes(stream, {key}, {item}.bytes, {item}.size)) return false;")
+      else:
+        out += [f"    if(!pbgen_put_varint32(stream, {key}, (uint32_t){f['ctype']}_Size(&{item})) ||",
+          f"      !{f['ctype']}_Encode(stream, &{item})) return false;"]
+      out.append('  }')
+    elif f['kind'] == 'string':
+      out.append(f"  if({is_set(f, v)} && !pbgen_put_bytes(stream, {key}, {v}, strlen({v}))) return false;")
+    elif f['kind'] == 'bytes':
+      out.append(f"  if({is_set(f, v)} && !pbgen_put_bytes(stream, {key}, {v}.bytes, {v}.size)) return false;")
+    elif f['kind'] == 'message':
+      out += [f"  if({is_set(f, v)}) {{",
+        f"    if(!pbgen_put_varint32(stream, {key}, (uint32_t){f['ctype']}_Size(&{v})) ||",
+        f"      !{f['ctype']}_Encode(stream, &{v})) return false;", '  }']
+    else: out.append(f"  if({is_set(f, v)} && !{put(f, v)}) return false;")
+  out += ['  return true;', '}']
+  return out
+
+def render_case(f: dict, used: set) -> list[str]:
+  v, wire = f"msg->{f['name']}", f"PB_WT_{f['wire']}"
+  out = [f"      case {f['number']}: // {f['name']}"]
+  if f['label'] == 'repeated':
+    count, item = f"{v}_count", f"{v}[{v}_count]"
+    full = f"{count} >= {f['max_count']}"
+    if f['kind'] == 'scalar':
+      used.add('sub')
+      cond, assign = get(f, '&sub', item)
+      used.add('u32' if 'u32' in cond else 'u64' if 'u64' in cond else '')
+      out += [f"        if(wire_type == PB_WT_STRING) {{",
+        '          if(!pb_make_string_substream(stream, &sub)) return false;',
+        '          while(sub.bytes_left) {',
+        f"            if({full} || !{cond}) return false;"]
+      if assign: out.append(f"            {assign}")
+      out += [f"            {count}++;", '          }',
+        '          if(!pb_close_string_substream(stream, &sub)) return false;', '          break;', '        }']
+      cond, assign = get(f, 'stream', item)
+      out.append(f"        if(wire_type != {wire} || {full} || !{cond}) return false;")
+      if assign: out.append(f"        {assign}")
+      out.append(f"        {count}++;")
+    elif f['kind'] == 'string':
+      out.append(f"        if(wire_type != {wire} || {full} || !pbgen_get_string(stream, {item}, sizeof({v}[0]))) return false;")
+      out.append(f"        {count}++;")
+    elif f['kind'] == 'bytes':
+      out += [f"        if(wire_type != {wire} || {full}) return false;",
+        f"        if(!pbgen_get_bytes(stream, {item}.bytes, &{item}.size, sizeof({item}.bytes))) return false;",
+        f"        {count}++;"]
+    else:
+      used.add('sub')
+      out += [f"        if(wire_type != {wire} || {full}) return false;",
+        f"        memset(&{item}, 0, sizeof({item}));",
+        '        if(!pb_make_string_substream(stream, &sub)) return false;',
+        f"        if(!{f['ctype']}_Merge(&sub, &{item})) return false;",
+        f"        {count}++;",
+        '        if(!pb_close_string_substream(stream, &sub)) return false;']
+  elif f['kind'] == 'string':
+    out.append(f"        if(wire_type != {wire} || !pbgen_get_string(stream, {v}, sizeof({v}))) return false;")
+  elif f['kind'] == 'bytes':
+    out.append(f"        if(wire_type != {wire} || !pbgen_get_bytes(stream, {v}.bytes, &{v}.size, sizeof({v}.bytes))) return false;")
+  elif f['kind'] == 'message':
+    used.add('sub')
+    out += [f"        if(wire_type != {wire}) return false;",
+      f"        if(!msg->has_{f['name']}) memset(&{v}, 0, sizeof({v}));",
+      '        if(!pb_make_string_substream(stream, &sub)) return false;',
+      f"        if(!{f['ctype']}_Merge(&sub, &{v})) return false;",
+      '        if(!pb_close_string_substream(stream, &sub)) return false;']
+  else:
+    cond, assign = get(f, 'stream', v)
+    used.add('u32' if 'u32' in cond else 'u64' if 'u64' in cond else '')
+    out.append(f"        if(wire_type != {wire} || !{cond}) return false;")
+    if assign: out.append(f"        {assign}")
+  if f['label'] == 'optional': out.append(f"        msg->has_{f['name']} = true;")
+  out.append('        break;')
+  return out
+
+def render_decode(msg: dict) -> list[str]:
+  name, used, cases = msg['name'], set(), []
+  for f in msg['fields']: cases += render_case(f, used)
+  out = [f"bool {name}_Merge(pb_istream_t *stream, {name} *msg)", '{',
+    '  pb_wire_type_t wire_type;', '  uint32_t tag;', '  bool eof;']
+  if not msg['fields']: out.append('  (void)msg;')
+  if 'u32' in used: out.append('  uint32_t u32;')
+  if 'u64' in used: out.append('  uint64_t u64;')
+  if 'sub' in used: out.append('  pb_istream_t sub;')
+  out += ['  while(pb_decode_tag(stream, &wire_type, &tag, &eof)) {', '    switch(tag) {']
+  out += cases
+  out += ['      default: // Unknown field, skipped as by generic decoder',
+    '        if(!pb_skip_field(stream, wire_type)) return false;', '    }', '  }', '  return eof;', '}',
+    '', f"bool {name}_Decode(pb_istream_t *stream, {name} *msg)", '{',
+    '  memset(msg, 0, sizeof(*msg));', f"  return {name}_Merge(stream, msg);", '}']
+  return out
+
+def render_h(messages: list[dict], enums: dict, path: Path, source: Path) -> str:
+  guard = re.sub(r'\W', '_', path.name).upper() + '_'
+  out = [
+    f"// {shown(path)}",
+    f"// Generated by `pbgen.py` from `{source.name}`. Do not edit.",
+    '',
+    f"#ifndef {guard}",
+    f"#define {guard}",
+    '',
+    '#include "pbgen.h"',
+  ]
+  if enums:
+    out += ['', rule('Enums')]
+    for enum in enums.values(): out += [''] + render_enum(enum)
+  out += ['', rule('Types')]
+  for msg in messages: out += [''] + render_struct(msg)
+  out += ['', rule('Descriptors')]
+  for msg in messages: out += [''] + render_descriptor(msg)
+  for msg in messages: out += ['', rule(msg['name']), ''] + render_api(msg)
+  out += ['', '//' + '-' * (HEADER_RULE - 2), '#endif']
+  return '\n'.join(out) + '\n'
+
+def render_c(messages: list[dict], path: Path, header: Path, source: Path) -> str:
+  out = [
+    f"// {shown(path)}",
+    f"// Generated by `pbgen.py` from `{source.name}`. Do not edit.",
+    '',
+    f"#include \"{header.name}\"",
+    '',
+    rule('Descriptors'),
+    '',
+  ]
+  out += [f"PB_BIND({msg['name']}, {msg['name']}, {width(msg, messages)})" for msg in messages]
+  for msg in messages:
+    out += ['', rule(msg['name']), ''] + render_size(msg) + [''] + render_encode(msg) + [''] + render_decode(msg)
+  return '\n'.join(out) + '\n'
+
+def main():
+  if len(sys.argv) < 2: sys.exit("Usage: pbgen.py <file.proto> [<outdir>]")
+  infile = Path(sys.argv[1])
+  outdir = Path(sys.argv[2]) if len(sys.argv) > 2 else infile.parent
+  messages, enums = parse(infile.read_text())
+  messages = resolve(messages, enums)
+  h, c = outdir / (infile.stem + '.pb.h'), outdir / (infile.stem + '.pb.c')
+  h.write_text(render_h(messages, enums, h, infile))
+  c.write_text(render_c(messages, c, h, infile))
+  print(f"Done: {h}, {c}")
+
+if __name__ == '__main__':
+  main()
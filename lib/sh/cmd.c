@@ -77,6 +77,12 @@ void CMD_SetReset(void (*Reset)(void))
   cmd.Reset = Reset;
 }
 
+uint8_t CMD_Lookup(const CMD_Table_t *table, uint32_t hash)
+{
+  const CMD_Key_t *key = &table->keys[(uint32_t)(hash * table->mul) >> table->shift];
+  return key->hash == hash ? key->id : 0;
+}
+
 static inline void CMD_WrongCommand(char *name)
 {
   LOG_Warning("Wrong " ANSI_ORANGE "%s" ANSI_END " command usage", name);
@@ -139,8 +145,8 @@ static void CMD_Mbb(char **argv, uint16_t argc, STREAM_t *stream)
     return;
   }
   if(argc < 2) { CMD_WrongArgc(argv[0], argc); return; }
-  switch(hash_djb2_ci(argv[1])) {
-    case HASH_List: { // mbb list
+  switch(CMD_Lookup(&CmdMbbTable, stream->_hash[1])) {
+    case CMD_MbbVerb_List: { // mbb list
       CMD_Argc(2);
       const char *mbb_names[cmd.mbbs_count];
       for(uint16_t i = 0; i < cmd.mbbs_count; i++) {
@@ -149,8 +155,7 @@ static void CMD_Mbb(char **argv, uint16_t argc, STREAM_t *stream)
       LOG_Bash("MBB list: " ANSI_CREAM "%a %s" ANSI_END, cmd.mbbs_count, mbb_names);
       break;
     }
-    case HASH_Active:
-    case HASH_Select: { // mbb select <name:str>
+    case CMD_MbbVerb_Select: { // mbb select <name:str>
       CMD_Argc(3);
       MBB_t *mbb = CMD_FindMbb(argv[2]);
       if(!mbb) return;
@@ -159,12 +164,12 @@ static void CMD_Mbb(char **argv, uint16_t argc, STREAM_t *stream)
       LOG_Bash("MBB " ANSI_CREAM "%s" ANSI_END " selected", cmd.mbb_active->name);
       break;
     }
-    case HASH_Info: { // mbb info
+    case CMD_MbbVerb_Info: { // mbb info
       CMD_Argc(2);
       LOG_Bash("MBB %o", cmd.mbb_active, &MBB_Print);
       break;
     }
-    case HASH_Clear: { // mbb clear
+    case CMD_MbbVerb_Clear: { // mbb clear
       CMD_Argc(2);
       if(MBB_Clear(cmd.mbb_active)) {
         CMD_AccessDenied(cmd.mbb_active);
@@ -173,7 +178,7 @@ static void CMD_Mbb(char **argv, uint16_t argc, STREAM_t *stream)
       LOG_Bash("MBB %s is empty", cmd.mbb_active->name);
       return;
     }
-    case HASH_Save: { // mbb save <packages:uint16>?
+    case CMD_MbbVerb_Save: { // mbb save <packages:uint16>?
       CMD_Argc(2, 3);
       if(MBB_Clear(cmd.mbb_active)) CMD_AccessDenied(cmd.mbb_active);
       else {
@@ -193,7 +198,7 @@ static void CMD_Mbb(char **argv, uint16_t argc, STREAM_t *stream)
       }
       break;
     }
-    case HASH_Append: { // mbb append <packages:uint16>?
+    case CMD_MbbVerb_Append: { // mbb append <packages:uint16>?
       CMD_Argc(2, 3);
       uint16_t packages = 1;
       if(argc == 3) {
@@ -210,7 +215,7 @@ static void CMD_Mbb(char **argv, uint16_t argc, STREAM_t *stream)
         cmd.mbb_active->name, stream->_packages);
       break;
     }
-    case HASH_Load: { // mbb load <limit:uint16>? <offset:uint16>?
+    case CMD_MbbVerb_Load: { // mbb load <limit:uint16>? <offset:uint16>?
       CMD_Argc(2, 4);
       uint16_t limit = cmd.mbb_active->size;
       uint16_t offset = 0;
@@ -228,13 +233,17 @@ static void CMD_Mbb(char **argv, uint16_t argc, STREAM_t *stream)
         }
         offset = str_to_int(argv[3]);
       }
+      if(MBB_Linearize(cmd.mbb_active)) {
+        LOG_Error("MBB %s load fault", cmd.mbb_active->name);
+        break;
+      }
       if(offset >= cmd.mbb_active->size) offset = 0;
       if(limit + offset > cmd.mbb_active->size) limit = cmd.mbb_active->size - offset;
       DBG_Data(&cmd.mbb_active->buffer[offset], limit);
       DBG_Enter();
       break;
     }
-    case HASH_Flash: { // mbb flash {save|load}
+    case CMD_MbbVerb_Flash: { // mbb flash {save|load}
       CMD_Argc(3);
       switch(hash_djb2_ci(argv[2])) {
         case HASH_Save:
@@ -253,7 +262,7 @@ static void CMD_Mbb(char **argv, uint16_t argc, STREAM_t *stream)
       }
       break;
     }
-    case HASH_Mutex: { // mbb mutex {set|rst}
+    case CMD_MbbVerb_Mutex: { // mbb mutex {set|rst}
       CMD_Argc(3);
       switch(hash_djb2_ci(argv[2])) {
         case HASH_Set: cmd.mbb_active->lock = true; break;
@@ -262,7 +271,7 @@ static void CMD_Mbb(char **argv, uint16_t argc, STREAM_t *stream)
       }
       break;
     }
-    case HASH_Copy: { // mbb copy {from|to} <name:str>
+    case CMD_MbbVerb_Copy: { // mbb copy {from|to} <name:str>
       CMD_Argc(4);
       MBB_t *mbb = CMD_FindMbb(argv[3]);
       if(!mbb) return;
@@ -279,8 +288,12 @@ static void CMD_Mbb(char **argv, uint16_t argc, STREAM_t *stream)
       }
       break;
     }
-    case HASH_Print: { // mbb print
+    case CMD_MbbVerb_Print: { // mbb print
       CMD_Argc(2);
+      if(MBB_Linearize(cmd.mbb_active)) {
+        LOG_Error("MBB %s print fault", cmd.mbb_active->name);
+        break;
+      }
       LOG_Bash("%02a %d", 50, cmd.mbb_active->buffer);
       break;
     }
@@ -481,8 +494,8 @@ static PWR_SleepMode_t PWR_StrSleepMode(const char *str)
 static void CMD_Power(char **argv, uint16_t argc)
 {
   CMD_Argc(2, 4);
-  switch(hash_djb2_ci(argv[1])) {
-    case HASH_Sleep: {
+  switch(CMD_Lookup(&CmdPwrTable, hash_djb2_ci(argv[1]))) {
+    case CMD_PwrVerb_Sleep: {
       CMD_Argc(3, 4);
       PWR_SleepMode_t mode = PWR_StrSleepMode(argv[2]);
       if(mode == PWR_SleepMode_Error) CMD_ArgvExit(2);
@@ -496,9 +509,7 @@ static void CMD_Power(char **argv, uint16_t argc)
       }
       break;
     }
-    case HASH_Reboot:
-    case HASH_Restart:
-    case HASH_Reset: {
+    case CMD_PwrVerb_Reset: {
       CMD_Argc(2, 3);
       if(argc == 2) {
         if(cmd.Reset) cmd.Reset();
@@ -514,6 +525,52 @@ static void CMD_Power(char **argv, uint16_t argc)
   }
 }
 
+//----------------------------------------------------------------------------------------- LOG
+
+static int8_t LOG_StrLevel(const char *str)
+{
+  switch(hash_djb2_ci(str)) {
+    case LOG_Hash_Dbg: case LOG_Hash_Debug: case HASH_0:
+      return LOG_Level_Debug;
+    case LOG_Hash_Inf: case LOG_Hash_Info: case HASH_1:
+      return LOG_Level_Info;
+    case LOG_Hash_Wrn: case LOG_Hash_Warn: case LOG_Hash_Warning: case HASH_2:
+      return LOG_Level_Warning;
+    case LOG_Hash_Err: case LOG_Hash_Error: case HASH_3:
+      return LOG_Level_Error;
+    case LOG_Hash_Crt: case LOG_Hash_Critical: case HASH_4:
+      return LOG_Level_Critical;
+    case LOG_Hash_Nil: case LOG_Hash_None: case LOG_Hash_Off: case HASH_6:
+      return LOG_Level_None;
+    default:
+      return -1;
+  }
+}
+
+static void CMD_Log(char **argv, uint16_t argc)
+{
+  CMD_Argc(1, 3);
+  if(argc == 3) { // log <lib:str> <level:str>
+    int8_t lvl = LOG_StrLevel(argv[2]);
+    if(lvl < 0) CMD_ArgvExit(2);
+    if(LOG_LibSetLevel(argv[1], (LOG_Level_t)lvl)) {
+      LOG_Error("LOG exceeded library limit (max:%u)", LOG_LIB_LIMIT);
+      return;
+    }
+    LOG_Bash("LOG " ANSI_CREAM "%s" ANSI_END " level:%S", argv[1], lvl, LogLevelNames);
+    return;
+  }
+  uint32_t lib_hash = argc == 2 ? hash_djb2_ci(argv[1]) : 0;
+  bool found = false;
+  for(uint8_t i = 0; i < LOG_LibCount(); i++) { // log <lib:str>?
+    const char *name = LOG_LibName(i);
+    if(!name || (argc == 2 && hash_djb2_ci(name) != lib_hash)) continue;
+    LOG_Bash("LOG " ANSI_CREAM "%s" ANSI_END " level:%S", name, LOG_LibLevel(i), LogLevelNames);
+    found = true;
+  }
+  if(argc == 2 && !found) LOG_Warning("LOG library " ANSI_ORANGE "%s" ANSI_END " not logged yet", argv[1]);
+}
+
 //---------------------------------------------------------------------------------------- Addr
 
 #if(STREAM_ADDRESS)
@@ -580,48 +637,55 @@ static void CMD_Trig(char **argv, uint16_t argc)
 
 //---------------------------------------------------------------------------------------- Step
 
-bool CMD_Step(STREAM_t *stream)
+static bool CMD_Dispatch(char **argv, uint16_t argc, STREAM_t *stream)
 {
-  char **argv = NULL;
-  uint16_t argc = STREAM_Read(stream, &argv);
-  if(argc) {
-    if(stream->_data_mode) CMD_Data((uint8_t *)argv[0], argc, stream);
-    else {
-      uint32_t argv0_hash = hash_djb2_ci(argv[0]);
-      switch(argv0_hash) {
-        case HASH_Ping: CMD_Ping(argv, argc); break;
-        case HASH_Trig: CMD_Trig(argv, argc); break;
-        case HASH_Mbb: CMD_Mbb(argv, argc, stream); break;
-        case HASH_Uid: CMD_Uid(argv, argc); break;
-        case HASH_Power: case HASH_Pwr: CMD_Power(argv, argc); break;
-        #ifdef RTC_H_
-          case HASH_Rtc: CMD_Rtc(argv, argc); break;
-          case HASH_Alarm: CMD_Alarm(argv, argc); break;
-        #endif
-        #if(STREAM_ADDRESS)
-          case HASH_Addr: CMD_Addr(argv, argc, stream); break;
-        #endif
-        default: {
-          for(uint8_t i = 0; i < cmd.handlers_count; i++) {
-            if(argv0_hash == cmd.handlers_hash[i]) {
-              cmd.handlers[i](argv, argc);
-              return true;
-            }
-          }
-          if(cmd.handler_default) {
-            cmd.handler_default(argv, argc);
-            return true;
-          }
-          else {
-            LOG_Warning("Command " ANSI_ORANGE "%s" ANSI_END " not found", argv[0]);
-            return false;
-          }
+  uint32_t argv0_hash = stream->_hash[0];
+  switch(CMD_Lookup(&CmdTable, argv0_hash)) {
+    case CMD_Id_Ping: CMD_Ping(argv, argc); break;
+    case CMD_Id_Trig: CMD_Trig(argv, argc); break;
+    case CMD_Id_Mbb: CMD_Mbb(argv, argc, stream); break;
+    case CMD_Id_Uid: CMD_Uid(argv, argc); break;
+    case CMD_Id_Power: CMD_Power(argv, argc); break;
+    case CMD_Id_Log: CMD_Log(argv, argc); break;
+    #ifdef RTC_H_
+      case CMD_Id_Rtc: CMD_Rtc(argv, argc); break;
+      case CMD_Id_Alarm: CMD_Alarm(argv, argc); break;
+    #endif
+    #if(STREAM_ADDRESS)
+      case CMD_Id_Addr: CMD_Addr(argv, argc, stream); break;
+    #endif
+    default: {
+      for(uint8_t i = 0; i < cmd.handlers_count; i++) {
+        if(argv0_hash == cmd.handlers_hash[i]) {
+          cmd.handlers[i](argv, argc);
+          return true;
         }
       }
+      if(cmd.handler_default) {
+        cmd.handler_default(argv, argc);
+        return true;
+      }
+      else {
+        LOG_Warning("Command " ANSI_ORANGE "%s" ANSI_END " not found", argv[0]);
+        return false;
+      }
     }
-    return true;
   }
-  return false;
+  return true;
 }
 
-//---------------------------------------------------------------------------------------------
\ No newline at end of file
+bool CMD_Step(STREAM_t *stream)
+{
+  char **argv = NULL;
+  uint16_t argc = STREAM_Read(stream, &argv);
+  if(!argc) return false;
+  if(stream->_data_mode) {
+    CMD_Data((uint8_t *)argv[0], argc, stream);
+    return true;
+  }
+  bool found = CMD_Dispatch(argv, argc, stream);
+  #if(STREAM_RPC)
+    if(stream->_rpc) STREAM_RpcReply(stream, found ? STREAM_RpcStatus_Ok : STREAM_RpcStatus_NotFound);
+  #endif
+  return found;
+}
\ No newline at end of file
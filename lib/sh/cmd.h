@@ -9,6 +9,7 @@
 #include "pwr.h"
 #include "xdef.h"
 #include "main.h"
+#include "cmdhash.h"
 
 //-------------------------------------------------------------------------------- Configurable
 
@@ -36,117 +37,6 @@
 // Command handler signature: receives `argv` and `argc` from parsed input line
 typedef void (*CMD_Handler_t)(char **argv, uint16_t argc);
 
-//---------------------------------------------------------------------------------------- Hash
-
-/**
- * Shared keyword vocabulary for the entire CMD ecosystem.
- * All hashes computed from lowercase strings (parser uses `hash_djb2_ci`).
- * Each section groups related words; modules switch on these in their handlers.
- */
-typedef enum {
-  // Top-level commands
-  HASH_Ping     = 2090616627,
-  HASH_Trig     = 2090770011,
-  HASH_Mbb      = 193499030,
-  HASH_Uid      = 193507975,
-  HASH_Rtc      = 193505070,
-  HASH_Alarm    = 253177266,
-  HASH_Pwr      = 193503006,
-  HASH_Power    = 271097426,
-  HASH_Addr     = 2090071808,
-  HASH_Flash    = 259106899,
-  HASH_Mutex    = 267752024,
-  // MBB verbs
-  HASH_Save     = 2090715988,
-  HASH_Load     = 2090478981,
-  HASH_Append   = 4065151197,
-  HASH_Clear    = 255552908,
-  HASH_Print    = 271190290,
-  HASH_Copy     = 2090156064,
-  HASH_From     = 2090267097,
-  HASH_To       = 5863848,
-  HASH_List     = 2090473057,
-  HASH_Info     = 2090370257,
-  HASH_Select   = 461431749,
-  HASH_Active   = 4049882593,
-  // Database verbs
-  HASH_Insert   = 81003162,
-  HASH_Delete   = 4169368696,
-  HASH_Asc      = 193486524,
-  HASH_Desc     = 2090181188,
-  HASH_Count    = 255678574,
-  // Power verbs
-  HASH_Sleep    = 274527774,
-  HASH_Reboot   = 421948272,
-  HASH_Restart  = 1059716234,
-  HASH_Reset    = 273105544,
-  HASH_Rst      = 193505054,
-  // State control
-  HASH_Set      = 193505681,
-  HASH_On       = 5863682,
-  HASH_Off      = 193501344,
-  HASH_Start    = 274811347,
-  HASH_Stop     = 2090736459,
-  HASH_Enable   = 4218778540,
-  HASH_Disable  = 314893497,
-  HASH_Tgl      = 193506828,
-  HASH_Toggle   = 512249127,
-  HASH_Sw       = 5863823,
-  HASH_Switch   = 482686839,
-  // Signal generation
-  HASH_Pulse    = 271301518,
-  HASH_Impulse  = 2630979716,
-  HASH_Burst    = 254705173,
-  HASH_Duty     = 2090198667,
-  HASH_Fill     = 2090257196,
-  // Time
-  HASH_Now      = 193500569,
-  // Slot literals
-  HASH_A        = 177670,
-  HASH_B        = 177671,
-  HASH_0        = 177621,
-  HASH_1        = 177622,
-  HASH_2        = 177623,
-  HASH_3        = 177624,
-  HASH_4        = 177625,
-  HASH_5        = 177626,
-  HASH_6        = 177627,
-  HASH_7        = 177628,
-  HASH_8        = 177629,
-  HASH_9        = 177630,
-} HASH_t;
-
-#ifdef RTC_H_
-typedef enum {
-  RTC_Hash_Everyday  = 552618222,
-  RTC_Hash_Monday    = 238549325,
-  RTC_Hash_Tuesday   = 4252182340,
-  RTC_Hash_Wednesday = 1739173961,
-  RTC_Hash_Thursday  = 3899371353,
-  RTC_Hash_Friday    = 4262946948,
-  RTC_Hash_Saturday  = 3744646578,
-  RTC_Hash_Sunday    = 480477209,
-  RTC_Hash_Evd       = 193490980,
-  RTC_Hash_Mon       = 193499471,
-  RTC_Hash_Tue       = 193507283,
-  RTC_Hash_Wed       = 193510021,
-  RTC_Hash_Thu       = 193506870,
-  RTC_Hash_Fri       = 193491942,
-  RTC_Hash_Sat       = 193505549,
-  RTC_Hash_Sun       = 193506203,
-} RTC_Hash_t;
-#endif
-
-typedef enum {
-  PWR_Hash_Stop        = 2090736459,
-  PWR_Hash_Stop0       = 274826459,
-  PWR_Hash_Stop1       = 274826460,
-  PWR_Hash_StandbySram = 950227578,
-  PWR_Hash_Standbysram = 1332813965,
-  PWR_Hash_Standby     = 2916655642,
-  PWR_Hash_Shutdown    = 4232446817,
-} PWR_Hash_t;
-
 //------------------------------------------------------------------------------------- Globals
 
 /**
@@ -222,6 +112,16 @@ void CMD_WrongArgv(char *cmd, char *argv, uint16_t pos);
  */
 bool CMD_Step(STREAM_t *stream);
 
+/**
+ * @brief Find keyword in perfect-hash dispatch table.
+ * Shared keyword vocabulary (`HASH_*` enums) and tables are generated
+ * by `cmdhash.py` from `cmdhash.txt`. All words hash with `hash_djb2_ci`.
+ * @param[in] table Dispatch table (e.g. `CmdTable`, `CmdMbbTable`)
+ * @param[in] hash Keyword hash from `hash_djb2_ci`
+ * @return Keyword id from table enum or `0` if not found
+ */
+uint8_t CMD_Lookup(const CMD_Table_t *table, uint32_t hash);
+
 //------------------------------------------------------------------------------------ Triggers
 
 /**
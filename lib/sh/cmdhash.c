@@ -0,0 +1,63 @@
+// lib/sh/cmdhash.c
+// Generated by `cmdhash.py` from `cmdhash.txt`. Do not edit.
+
+#include "cmdhash.h"
+
+//------------------------------------------------------------------------------------ CmdTable
+
+static const CMD_Key_t cmd_table_keys[16] = {
+  [3] = { 2090770011, CMD_Id_Trig }, // trig
+  [4] = { 253177266, CMD_Id_Alarm }, // alarm
+  [5] = { 193505070, CMD_Id_Rtc }, // rtc
+  [6] = { 193507975, CMD_Id_Uid }, // uid
+  [7] = { 193499030, CMD_Id_Mbb }, // mbb
+  [8] = { 193503006, CMD_Id_Power }, // pwr
+  [11] = { 2090616627, CMD_Id_Ping }, // ping
+  [12] = { 271097426, CMD_Id_Power }, // power
+  [14] = { 193498375, CMD_Id_Log }, // log
+  [15] = { 2090071808, CMD_Id_Addr }, // addr
+};
+
+const CMD_Table_t CmdTable = {
+  .keys = cmd_table_keys,
+  .mul = 0xCCA07C2D,
+  .shift = 28
+};
+
+//--------------------------------------------------------------------------------- CmdMbbTable
+
+static const CMD_Key_t cmd_mbb_table_keys[16] = {
+  [1] = { 2090473057, CMD_MbbVerb_List }, // list
+  [2] = { 259106899, CMD_MbbVerb_Flash }, // flash
+  [3] = { 255552908, CMD_MbbVerb_Clear }, // clear
+  [5] = { 271190290, CMD_MbbVerb_Print }, // print
+  [6] = { 267752024, CMD_MbbVerb_Mutex }, // mutex
+  [7] = { 461431749, CMD_MbbVerb_Select }, // select
+  [8] = { 2090370257, CMD_MbbVerb_Info }, // info
+  [10] = { 2090478981, CMD_MbbVerb_Load }, // load
+  [11] = { 4049882593, CMD_MbbVerb_Select }, // active
+  [12] = { 2090156064, CMD_MbbVerb_Copy }, // copy
+  [14] = { 4065151197, CMD_MbbVerb_Append }, // append
+  [15] = { 2090715988, CMD_MbbVerb_Save }, // save
+};
+
+const CMD_Table_t CmdMbbTable = {
+  .keys = cmd_mbb_table_keys,
+  .mul = 0x8FE262B1,
+  .shift = 28
+};
+
+//--------------------------------------------------------------------------------- CmdPwrTable
+
+static const CMD_Key_t cmd_pwr_table_keys[4] = {
+  [0] = { 274527774, CMD_PwrVerb_Sleep }, // sleep
+  [1] = { 421948272, CMD_PwrVerb_Reset }, // reboot
+  [2] = { 273105544, CMD_PwrVerb_Reset }, // reset
+  [3] = { 1059716234, CMD_PwrVerb_Reset }, // restart
+};
+
+const CMD_Table_t CmdPwrTable = {
+  .keys = cmd_pwr_table_keys,
+  .mul = 0x2F7C8119,
+  .shift = 30
+};
@@ -0,0 +1,188 @@
+// lib/sh/cmdhash.h
+// Generated by `cmdhash.py` from `cmdhash.txt`. Do not edit.
+
+#ifndef CMDHASH_H_
+#define CMDHASH_H_
+
+#include <stdint.h>
+
+//--------------------------------------------------------------------------------------- Types
+
+// Perfect-hash table slot: empty slots have `id = 0`
+typedef struct {
+  uint32_t hash;
+  uint8_t id;
+} CMD_Key_t;
+
+// Slot of keyword is `(hash * mul) >> shift`, see `CMD_Lookup`
+typedef struct {
+  const CMD_Key_t *keys;
+  uint32_t mul;
+  uint8_t shift;
+} CMD_Table_t;
+
+//---------------------------------------------------------------------------------------- Hash
+
+typedef enum {
+  // Top-level commands
+  HASH_Ping    = 2090616627,
+  HASH_Trig    = 2090770011,
+  HASH_Mbb     = 193499030,
+  HASH_Uid     = 193507975,
+  HASH_Rtc     = 193505070,
+  HASH_Alarm   = 253177266,
+  HASH_Pwr     = 193503006,
+  HASH_Power   = 271097426,
+  HASH_Addr    = 2090071808,
+  HASH_Flash   = 259106899,
+  HASH_Mutex   = 267752024,
+  HASH_Log     = 193498375,
+  // MBB verbs
+  HASH_Save    = 2090715988,
+  HASH_Load    = 2090478981,
+  HASH_Append  = 4065151197,
+  HASH_Clear   = 255552908,
+  HASH_Print   = 271190290,
+  HASH_Copy    = 2090156064,
+  HASH_From    = 2090267097,
+  HASH_To      = 5863848,
+  HASH_List    = 2090473057,
+  HASH_Info    = 2090370257,
+  HASH_Select  = 461431749,
+  HASH_Active  = 4049882593,
+  // Database verbs
+  HASH_Insert  = 81003162,
+  HASH_Delete  = 4169368696,
+  HASH_Asc     = 193486524,
+  HASH_Desc    = 2090181188,
+  HASH_Count   = 255678574,
+  // Power verbs
+  HASH_Sleep   = 274527774,
+  HASH_Reboot  = 421948272,
+  HASH_Restart = 1059716234,
+  HASH_Reset   = 273105544,
+  HASH_Rst     = 193505054,
+  // State control
+  HASH_Set     = 193505681,
+  HASH_On      = 5863682,
+  HASH_Off     = 193501344,
+  HASH_Start   = 274811347,
+  HASH_Stop    = 2090736459,
+  HASH_Enable  = 4218778540,
+  HASH_Disable = 314893497,
+  HASH_Tgl     = 193506828,
+  HASH_Toggle  = 512249127,
+  HASH_Sw      = 5863823,
+  HASH_Switch  = 482686839,
+  // Signal generation
+  HASH_Pulse   = 271301518,
+  HASH_Impulse = 2630979716,
+  HASH_Burst   = 254705173,
+  HASH_Duty    = 2090198667,
+  HASH_Fill    = 2090257196,
+  // Time
+  HASH_Now     = 193500569,
+  // Slot literals
+  HASH_A       = 177670,
+  HASH_B       = 177671,
+  HASH_0       = 177621,
+  HASH_1       = 177622,
+  HASH_2       = 177623,
+  HASH_3       = 177624,
+  HASH_4       = 177625,
+  HASH_5       = 177626,
+  HASH_6       = 177627,
+  HASH_7       = 177628,
+  HASH_8       = 177629,
+  HASH_9       = 177630,
+} HASH_t;
+
+#ifdef RTC_H_
+typedef enum {
+  RTC_Hash_Everyday  = 552618222,
+  RTC_Hash_Monday    = 238549325,
+  RTC_Hash_Tuesday   = 4252182340,
+  RTC_Hash_Wednesday = 1739173961,
+  RTC_Hash_Thursday  = 3899371353,
+  RTC_Hash_Friday    = 4262946948,
+  RTC_Hash_Saturday  = 3744646578,
+  RTC_Hash_Sunday    = 480477209,
+  RTC_Hash_Evd       = 193490980,
+  RTC_Hash_Mon       = 193499471,
+  RTC_Hash_Tue       = 193507283,
+  RTC_Hash_Wed       = 193510021,
+  RTC_Hash_Thu       = 193506870,
+  RTC_Hash_Fri       = 193491942,
+  RTC_Hash_Sat       = 193505549,
+  RTC_Hash_Sun       = 193506203,
+} RTC_Hash_t;
+#endif
+
+typedef enum {
+  LOG_Hash_Dbg      = 193489234,
+  LOG_Hash_Debug    = 256484652,
+  LOG_Hash_Inf      = 193495074,
+  LOG_Hash_Info     = 2090370257,
+  LOG_Hash_Wrn      = 193510460,
+  LOG_Hash_Warn     = 2090859613,
+  LOG_Hash_Warning  = 3064154235,
+  LOG_Hash_Err      = 193490862,
+  LOG_Hash_Error    = 258154991,
+  LOG_Hash_Crt      = 193488686,
+  LOG_Hash_Critical = 502510928,
+  LOG_Hash_Nil      = 193500360,
+  LOG_Hash_None     = 2090551285,
+  LOG_Hash_Off      = 193501344,
+} LOG_Hash_t;
+
+typedef enum {
+  PWR_Hash_Stop        = 2090736459,
+  PWR_Hash_Stop0       = 274826459,
+  PWR_Hash_Stop1       = 274826460,
+  PWR_Hash_StandbySram = 950227578,
+  PWR_Hash_Standbysram = 1332813965,
+  PWR_Hash_Standby     = 2916655642,
+  PWR_Hash_Shutdown    = 4232446817,
+} PWR_Hash_t;
+
+//-------------------------------------------------------------------------------------- Tables
+
+typedef enum {
+  CMD_Id_None = 0,
+  CMD_Id_Ping,
+  CMD_Id_Trig,
+  CMD_Id_Mbb,
+  CMD_Id_Uid,
+  CMD_Id_Power,
+  CMD_Id_Log,
+  CMD_Id_Rtc,
+  CMD_Id_Alarm,
+  CMD_Id_Addr,
+} CMD_Id_t;
+extern const CMD_Table_t CmdTable;
+
+typedef enum {
+  CMD_MbbVerb_None = 0,
+  CMD_MbbVerb_List,
+  CMD_MbbVerb_Select,
+  CMD_MbbVerb_Info,
+  CMD_MbbVerb_Clear,
+  CMD_MbbVerb_Save,
+  CMD_MbbVerb_Append,
+  CMD_MbbVerb_Load,
+  CMD_MbbVerb_Flash,
+  CMD_MbbVerb_Mutex,
+  CMD_MbbVerb_Copy,
+  CMD_MbbVerb_Print,
+} CMD_MbbVerb_t;
+extern const CMD_Table_t CmdMbbTable;
+
+typedef enum {
+  CMD_PwrVerb_None = 0,
+  CMD_PwrVerb_Sleep,
+  CMD_PwrVerb_Reset,
+} CMD_PwrVerb_t;
+extern const CMD_Table_t CmdPwrTable;
+
+//---------------------------------------------------------------------------------------------
+#endif
\ No newline at end of file
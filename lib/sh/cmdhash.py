@@ -0,0 +1,172 @@
+# CMD keyword generator: `cmdhash.txt` -> `cmdhash.h` + `cmdhash.c`
+# Emits `hash_djb2_ci` keyword enums and collision-free perfect-hash dispatch tables.
+# Fails if two different words share a hash. Run from Makefile or by hand.
+
+import sys
+from pathlib import Path
+
+HEADER_RULE = 95 # Length of `//---...--- Name` separators
+
+def djb2_ci(word: str) -> int:
+  h = 5381
+  for c in word.lower():
+    h = (h * 33 + ord(c)) & 0xFFFFFFFF
+  return h
+
+def parse(text: str) -> list[dict]:
+  blocks = []
+  for nbr, raw in enumerate(text.split('\n'), 1):
+    if raw.startswith(' ') and raw.strip().startswith('#') and blocks and blocks[-1]['kind'] == 'enum':
+      blocks[-1]['items'].append(('#', raw.strip()[1:].strip())) # Group comment, kept in output
+      continue
+    line = raw.split('#', 1)[0].strip()
+    if not line: continue
+    tokens = line.split()
+    if tokens[0] == 'enum':
+      if len(tokens) not in (3, 4): sys.exit(f"Line {nbr}: enum <type> <prefix> [<guard>]")
+      blocks.append({'kind': 'enum', 'type': tokens[1], 'prefix': tokens[2],
+        'guard': tokens[3] if len(tokens) == 4 else None, 'items': []})
+    elif tokens[0] == 'table':
+      if len(tokens) != 4: sys.exit(f"Line {nbr}: table <type> <prefix> <var>")
+      blocks.append({'kind': 'table', 'type': tokens[1], 'prefix': tokens[2],
+        'var': tokens[3], 'items': []})
+    else:
+      if not blocks: sys.exit(f"Line {nbr}: item outside enum/table")
+      block = blocks[-1]
+      name, words = tokens[0], tokens[1:] or [tokens[0].lower()]
+      if block['kind'] == 'enum' and len(words) != 1: sys.exit(f"Line {nbr}: enum item has one word")
+      block['items'].append((name, words))
+  return blocks
+
+def check_collisions(blocks: list[dict]):
+  seen = {}
+  for block in blocks:
+    for name, words in block['items']:
+      if name == '#': continue
+      for word in words:
+        h = djb2_ci(word)
+        if h in seen and seen[h] != word.lower():
+          sys.exit(f"Hash collision: '{seen[h]}' and '{word}' ({h})")
+        seen[h] = word.lower()
+
+def perfect_hash(hashes: list[int]) -> tuple[int, int]:
+  """Find `mul` and `bits` so that `(h * mul) >> (32 - bits)` is unique for every hash"""
+  bits = max(1, (len(hashes) - 1).bit_length())
+  while bits <= 16:
+    mul = 0x9E3779B1
+    for _ in range(200000):
+      slots = {((h * mul) & 0xFFFFFFFF) >> (32 - bits) for h in hashes}
+      if len(slots) == len(hashes): return mul, bits
+      mul = (mul * 1664525 + 1013904223) & 0xFFFFFFFF | 1
+    bits += 1
+  sys.exit("Perfect hash not found")
+
+def rule(name: str) -> str:
+  return '//' + '-' * (HEADER_RULE - len(name) - 3) + ' ' + name
+
+def snake(var: str) -> str:
+  return ''.join('_' + c.lower() if c.isupper() else c for c in var).lstrip('_')
+
+def render_enum(block: dict) -> list[str]:
+  width = max(len(block['prefix'] + name) for name, _ in block['items'] if name != '#')
+  out = []
+  if block['guard']: out.append(f"#ifdef {block['guard']}")
+  out.append('typedef enum {')
+  for name, words in block['items']:
+    if name == '#':
+      out.append(f"  // {words}")
+      continue
+    out.append(f"  {(block['prefix'] + name).ljust(width)} = {djb2_ci(words[0])},")
+  out.append(f"}} {block['type']};")
+  if block['guard']: out.append('#endif')
+  return out
+
+def render_ids(block: dict) -> list[str]:
+  out = ['typedef enum {', f"  {block['prefix']}None = 0,"]
+  out += [f"  {block['prefix']}{name}," for name, _ in block['items']]
+  out.append(f"}} {block['type']};")
+  out.append(f"extern const CMD_Table_t {block['var']};")
+  return out
+
+def render_table(block: dict) -> list[str]:
+  keys = [(djb2_ci(w), w.lower(), block['prefix'] + name) for name, words in block['items'] for w in words]
+  mul, bits = perfect_hash([h for h, _, _ in keys])
+  slots = {((h * mul) & 0xFFFFFFFF) >> (32 - bits): (h, w, i) for h, w, i in keys}
+  array = snake(block['var']) + '_keys'
+  out = [f"static const CMD_Key_t {array}[{1 << bits}] = {{"]
+  for slot in sorted(slots):
+    h, word, ident = slots[slot]
+    out.append(f"  [{slot}] = {{ {h}, {ident} }}, // {word}")
+  out.append('};')
+  out.append('')
+  out.append(f"const CMD_Table_t {block['var']} = {{")
+  out.append(f"  .keys = {array},")
+  out.append(f"  .mul = 0x{mul:08X},")
+  out.append(f"  .shift = {32 - bits}")
+  out.append('};')
+  return out
+
+def render_h(blocks: list[dict]) -> str:
+  out = [
+    '// lib/sh/cmdhash.h',
+    '// Generated by `cmdhash.py` from `cmdhash.txt`. Do not edit.',
+    '',
+    '#ifndef CMDHASH_H_',
+    '#define CMDHASH_H_',
+    '',
+    '#include <stdint.h>',
+    '',
+    rule('Types'),
+    '',
+    '// Perfect-hash table slot: empty slots have `id = 0`',
+    'typedef struct {',
+    '  uint32_t hash;',
+    '  uint8_t id;',
+    '} CMD_Key_t;',
+    '',
+    '// Slot of keyword is `(hash * mul) >> shift`, see `CMD_Lookup`',
+    'typedef struct {',
+    '  const CMD_Key_t *keys;',
+    '  uint32_t mul;',
+    '  uint8_t shift;',
+    '} CMD_Table_t;',
+    '',
+    rule('Hash'),
+  ]
+  for block in blocks:
+    if block['kind'] != 'enum': continue
+    out.append('')
+    out += render_enum(block)
+  out += ['', rule('Tables')]
+  for block in blocks:
+    if block['kind'] != 'table': continue
+    out.append('')
+    out += render_ids(block)
+  out += ['', '//' + '-' * (HEADER_RULE - 2), '#endif']
+  return '\n'.join(out)
+
+def render_c(blocks: list[dict]) -> str:
+  out = [
+    '// lib/sh/cmdhash.c',
+    '// Generated by `cmdhash.py` from `cmdhash.txt`. Do not edit.',
+    '',
+    '#include "cmdhash.h"',
+  ]
+  for block in blocks:
+    if block['kind'] != 'table': continue
+    out += ['', rule(block['var']), '']
+    out += render_table(block)
+  return '\n'.join(out) + '\n'
+
+def main():
+  base = Path(__file__).parent
+  infile = Path(sys.argv[1]) if len(sys.argv) > 1 else base / 'cmdhash.txt'
+  outdir = Path(sys.argv[2]) if len(sys.argv) > 2 else infile.parent
+  blocks = parse(infile.read_text())
+  check_collisions(blocks)
+  (outdir / 'cmdhash.h').write_text(render_h(blocks))
+  (outdir / 'cmdhash.c').write_text(render_c(blocks))
+  print(f"Done: {outdir / 'cmdhash.h'}, {outdir / 'cmdhash.c'}")
+
+if __name__ == '__main__':
+  main()
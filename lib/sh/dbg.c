@@ -8,23 +8,29 @@
 //------------------------------------------------------------------------------------------------- Basic
 
 static uint8_t dbg_buffer_rx[DBG_RX_SIZE];
-static uint8_t dbg_buffer_tx[DBG_TX_SIZE];
+static uint8_t dbg_buffer_tx[2][DBG_TX_SIZE];
+static uint8_t dbg_tx_active; // Index of TX buffer filled by `DBG_*`, other one may be in DMA
 
 static BUFF_t dbg_buff = {
   .memory = dbg_buffer_rx,
   .size = DBG_RX_SIZE,
-  .console_mode = true
+  .console_mode = true,
+  #if(STREAM_RPC)
+    // RPC request frames bypass console filtering and echo
+    .frame_sync = STREAM_RPC_SYNC
+  #endif
 };
 
 static MBB_t dbg_file = {
   .name = "debug",
-  .buffer = dbg_buffer_tx,
+  .buffer = dbg_buffer_tx[0],
   .limit = DBG_TX_SIZE
 };
 
 UART_t *DbgUart;
 MBB_t *DbgFile = &dbg_file;
 bool DbgEcho = true;
+uint16_t DbgFlushes;
 
 void DBG_SwitchMode(bool data_mode)
 {
@@ -44,7 +50,8 @@ STREAM_t dbg_stream = {
   .name = "debug",
   .modify = STREAM_Modify_Lowercase,
   .Size = DBG_Size,
-  .Read = DBG_ReadString,
+  .Read = DBG_Borrow,
+  .Release = DBG_Release,
   .SwitchMode = DBG_SwitchMode
 };
 
@@ -52,6 +59,9 @@ void DBG_Init(UART_t *uart)
 {
   DbgUart = uart;
   DbgUart->buff = &dbg_buff;
+  #if(STREAM_RPC)
+    dbg_buff.frame_tail = STREAM_RPC_CRC.width / 8;
+  #endif
   UART_Init(DbgUart);
 }
 
@@ -98,25 +108,121 @@ void DBG_Echo(void)
 
 #endif
 
+#if(STREAM_RPC)
+
+// RPC frame that stalls (bytes lost on line) is dropped after `DBG_DATAMODE_TIMEOUT`,
+// so next request is not appended to it
+static void DBG_FrameWatch(void)
+{
+  static uint16_t counter;
+  static uint64_t tick;
+  if(!dbg_buff._frame || dbg_buff._msg_counter != counter) {
+    counter = dbg_buff._msg_counter;
+    tick = tick_keep(DBG_DATAMODE_TIMEOUT);
+    return;
+  }
+  if(tick_over(&tick)) BUFF_FrameExpire(&dbg_buff);
+}
+
+#endif
+
+//------------------------------------------------------------------------------------------------- TX
+
+#if(DBG_SPILL_SIZE)
+
+static struct {
+  uint8_t memory[DBG_SPILL_SIZE];
+  uint16_t head;
+  uint16_t tail;
+  uint16_t size;
+} dbg_spill;
+
+// Move whole `file` content to spill ring. Nothing is moved if it does not fit.
+static bool DBG_SpillPush(MBB_t *file)
+{
+  if(DBG_SPILL_SIZE - dbg_spill.size < file->size) return false;
+  uint16_t part = DBG_SPILL_SIZE - dbg_spill.head;
+  if(part > file->size) part = file->size;
+  memcpy(&dbg_spill.memory[dbg_spill.head], file->buffer, part);
+  memcpy(dbg_spill.memory, &file->buffer[part], file->size - part);
+  dbg_spill.head = (dbg_spill.head + file->size) % DBG_SPILL_SIZE;
+  dbg_spill.size += file->size;
+  file->size = 0;
+  DbgFlushes++;
+  return true;
+}
+
+// Copy oldest spilled data (up to `limit`) to `dst`
+static uint16_t DBG_SpillPop(uint8_t *dst, uint16_t limit)
+{
+  uint16_t size = dbg_spill.size < limit ? dbg_spill.size : limit;
+  uint16_t part = DBG_SPILL_SIZE - dbg_spill.tail;
+  if(part > size) part = size;
+  memcpy(dst, &dbg_spill.memory[dbg_spill.tail], part);
+  memcpy(&dst[part], dbg_spill.memory, size - part);
+  dbg_spill.tail = (dbg_spill.tail + size) % DBG_SPILL_SIZE;
+  dbg_spill.size -= size;
+  return size;
+}
+
+#endif
+
+// Start DMA transmission of pending output. UART must be free.
+static void DBG_Transmit(void)
+{
+  uint8_t *idle = dbg_buffer_tx[!dbg_tx_active];
+  #if(DBG_SPILL_SIZE)
+    if(dbg_spill.size) {
+      DBG_SpillPush(DbgFile);
+      UART_Send(DbgUart, idle, DBG_SpillPop(idle, DBG_TX_SIZE));
+      return;
+    }
+  #endif
+  if(!DbgFile->size) return;
+  if(DbgFile != &dbg_file && MBB_Linearize(DbgFile)) return;
+  DbgFlushes++;
+  if(DbgFile == &dbg_file) {
+    // Swap: filled buffer goes to DMA, idle one takes new output
+    UART_Send(DbgUart, dbg_file.buffer, dbg_file.size);
+    dbg_tx_active = !dbg_tx_active;
+    dbg_file.buffer = idle;
+    dbg_file.size = 0;
+  }
+  else {
+    // Custom file stays owned by caller, send a copy from idle buffer.
+    // Rest that did not fit moves to front and goes out with next transmit.
+    uint16_t size = DbgFile->size < DBG_TX_SIZE ? DbgFile->size : DBG_TX_SIZE;
+    memcpy(idle, DbgFile->buffer, size);
+    UART_Send(DbgUart, idle, size);
+    memmove(DbgFile->buffer, &DbgFile->buffer[size], DbgFile->size - size);
+    DbgFile->size -= size;
+  }
+}
+
 void DBG_Loop(void)
 {
   while(1) {
     #if(DBG_ECHO_MODE)
       DBG_Echo();
     #endif
+    #if(STREAM_RPC)
+      DBG_FrameWatch();
+    #endif
     if(BUFF_EchoIdle(&dbg_buff)) {
       CMD_Step(&dbg_stream);
     }
+    LOG_Flush();
     if(UART_IsFree(DbgUart)) {
       heap_clear();
-      if(DbgFile->size) {
-        uint8_t *buffer = (uint8_t *)heap_new(DbgFile->size);
-        memcpy(buffer, DbgFile->buffer, DbgFile->size);
-        UART_Send(DbgUart, buffer, DbgFile->size);
-        MBB_Clear(DbgFile);
-      }
+      if(DbgFile->size) DBG_Transmit();
+      #if(DBG_SPILL_SIZE)
+        else if(dbg_spill.size) DBG_Transmit();
+      #endif
       else if(DbgReset && UART_SendCompleted(DbgUart)) PWR_Reset();
     }
+    #if(DBG_SPILL_SIZE)
+      else if(DbgFile->size >= DBG_TX_SIZE / 2) DBG_SpillPush(DbgFile);
+    #endif
     let();
   }
 }
@@ -142,6 +248,7 @@ void DBG_Send(uint8_t *array, uint16_t length)
 
 void DBG_SendFile(MBB_t *file)
 {
+  if(MBB_Linearize(file)) return;
   DBG_Send(file->buffer, file->size);
 }
 
@@ -172,6 +279,25 @@ char *DBG_ReadString(void)
   return UART_ReadString(DbgUart);
 }
 
+static bool dbg_borrowed; // Message returned by `DBG_Borrow` is still in `dbg_buff`
+
+char *DBG_Borrow(void)
+{
+  char *str = (char *)BUFF_Borrow(DbgUart->buff);
+  if(str) {
+    dbg_borrowed = true;
+    return str;
+  }
+  return UART_ReadString(DbgUart); // message wraps around end of buffer: heap copy
+}
+
+void DBG_Release(void)
+{
+  if(!dbg_borrowed) return;
+  dbg_borrowed = false;
+  BUFF_Skip(DbgUart->buff);
+}
+
 //------------------------------------------------------------------------------------------------- Add
 
 int32_t DBG_Char(uint8_t data) { return MBB_Char(DbgFile, data); }
@@ -221,6 +347,7 @@ int32_t MBB_Print(MBB_t *mbb)
 
 int32_t MBB_PrintContent(MBB_t *mbb)
 {
+  if(MBB_Linearize(mbb)) return 0;
   int32_t size = 0;
   uint8_t *byte = mbb->buffer;
   uint16_t count = mbb->size;
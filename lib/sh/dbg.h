@@ -18,9 +18,15 @@
 #endif
 
 #ifndef DBG_TX_SIZE
+  // Size of each of two TX buffers (one filled by `DBG_*`, other sent by DMA)
   #define DBG_TX_SIZE 2048
 #endif
 
+#ifndef DBG_SPILL_SIZE
+  // Spill ring for output produced while UART is busy (`0` = disabled)
+  #define DBG_SPILL_SIZE 0
+#endif
+
 #ifndef DBG_DATAMODE_TIMEOUT
   #define DBG_DATAMODE_TIMEOUT 200
 #endif
@@ -31,6 +37,7 @@ extern UART_t *DbgUart;
 extern MBB_t *DbgFile;
 extern volatile bool DbgReset;
 extern bool DbgEcho;
+extern uint16_t DbgFlushes; // Output taken out of `DbgFile` (sent or spilled), counter
 #ifdef HOST
   #define DBG_PrintAndTerminate() (DbgReset = true)
 #endif
@@ -41,7 +48,13 @@ extern bool DbgEcho;
  */
 void DBG_Init(UART_t *uart);
 
-/** @brief Main debug loop (blocking). */
+/**
+ * @brief Main debug loop (blocking).
+ * TX is double-buffered: when UART is free, filled buffer is handed to DMA
+ * as is and `DbgFile` switches to the other one. No copy, no heap.
+ * With `DBG_SPILL_SIZE`, output that piles up while UART is busy is moved
+ * to spill ring and sent before newer output.
+ */
 void DBG_Loop(void);
 
 /** @brief Wait for UART transmission to complete (cooperative). */
@@ -87,6 +100,16 @@ uint16_t DBG_Read(uint8_t *array);
 /** @brief Read string from debug input. */
 char *DBG_ReadString(void);
 
+/**
+ * @brief Access debug input message in place (heap copy only if it wraps around buffer end).
+ * Message stays in receive buffer until `DBG_Release`.
+ * @return Pointer to message or `NULL` if empty
+ */
+char *DBG_Borrow(void);
+
+/** @brief Release message returned by `DBG_Borrow`. */
+void DBG_Release(void);
+
 //-------------------------------------------------------------------------------------------------
 
 int32_t DBG_Char(uint8_t data);
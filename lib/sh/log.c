@@ -16,7 +16,82 @@ static uint8_t print_args_getstrnbr(const char **format)
   return nbr;
 }
 
-void print_args(const char *format, va_list args)
+// Argument source for formatter: live `va_list` or packed deferred record.
+// Packed layout mirrors `log_pack`: words are 4 B, longs/ticks 8 B,
+// blobs (strings, arrays, datetime) are `u32` length + 8 B aligned data.
+typedef struct {
+  va_list args;
+  const uint8_t *raw;
+} print_src_t;
+
+static inline const uint8_t *print_align(const uint8_t *ptr)
+{
+  return (const uint8_t *)(((uintptr_t)ptr + 7) & ~(uintptr_t)7);
+}
+
+static uint32_t print_u32(print_src_t *src)
+{
+  if(!src->raw) return va_arg(src->args, uint32_t);
+  uint32_t value;
+  memcpy(&value, src->raw, sizeof(value));
+  src->raw += sizeof(value);
+  return value;
+}
+
+static uint64_t print_u64(print_src_t *src)
+{
+  if(!src->raw) return va_arg(src->args, uint64_t);
+  uint64_t value;
+  memcpy(&value, src->raw, sizeof(value));
+  src->raw += sizeof(value);
+  return value;
+}
+
+static double print_f64(print_src_t *src)
+{
+  if(!src->raw) return va_arg(src->args, double);
+  float value;
+  memcpy(&value, src->raw, sizeof(value));
+  src->raw += sizeof(value);
+  return (double)value;
+}
+
+static void *print_ptr(print_src_t *src)
+{
+  if(!src->raw) return va_arg(src->args, void *);
+  void *value;
+  memcpy(&value, src->raw, sizeof(value));
+  src->raw += sizeof(value);
+  return value;
+}
+
+// Pointer to data: caller's memory (immediate) or copy inside record (deferred)
+static const void *print_blob(print_src_t *src)
+{
+  if(!src->raw) return va_arg(src->args, const void *);
+  uint32_t size = print_u32(src);
+  const uint8_t *data = print_align(src->raw);
+  src->raw = data + size;
+  return data;
+}
+
+// Time for `%t`/`%T`: read now (immediate) or captured at log call (deferred)
+static bool print_now(print_src_t *src, RTC_Datetime_t *dt, uint64_t *tick)
+{
+  if(!src->raw) {
+    if(RtcInit) *dt = RTC_Datetime();
+    else *tick = tick_keep(0);
+    return RtcInit;
+  }
+  if(print_u32(src)) {
+    memcpy(dt, print_blob(src), sizeof(RTC_Datetime_t));
+    return true;
+  }
+  *tick = print_u64(src);
+  return false;
+}
+
+static void print_src(const char *format, print_src_t *src)
 {
   uint8_t ary_type = 1, ary_space_len = 0, ary_count = 0;
   char ary_space[LOG_ARYSPACE_MAXLEN + 1];
@@ -44,7 +119,7 @@ void print_args(const char *format, va_list args)
       uint8_t fill_zero = flag_zero ? width : (has_precision ? precision : 0);
       switch(*format) {
         case 'a': case 'A': {
-          ary_count = va_arg(args, uint32_t);
+          ary_count = print_u32(src);
           ary_type = precision > width ? precision : width;
           if(!ary_type) ary_type = 1;
           memset(ary_space, 0, LOG_ARYSPACE_MAXLEN + 1);
@@ -53,7 +128,7 @@ void print_args(const char *format, va_list args)
         }
         case 'i': case 'd': {
           if(ary_count) {
-            uint8_t *ary = va_arg(args, uint8_t *);
+            uint8_t *ary = (uint8_t *)print_blob(src);
             while(ary_count) {
               switch(ary_type) {
                 case 8:
@@ -79,15 +154,15 @@ void print_args(const char *format, va_list args)
           }
           else {
             int64_t nbr;
-            if(long_int) nbr = va_arg(args, int64_t);
-            else nbr = va_arg(args, int32_t);
+            if(long_int) nbr = (int64_t)print_u64(src);
+            else nbr = (int32_t)print_u32(src);
             DBG_Int(nbr, 10, true, fill_zero, fill_space);
           }
           break;
         }
         case 'u': {
           if(ary_count) {
-            uint8_t *ary = va_arg(args, uint8_t *);
+            uint8_t *ary = (uint8_t *)print_blob(src);
             while(ary_count) {
               switch(ary_type) {
                 case 8:
@@ -113,8 +188,8 @@ void print_args(const char *format, va_list args)
           }
           else {
             uint64_t nbr;
-            if(long_int) nbr = va_arg(args, uint64_t);
-            else nbr = va_arg(args, uint32_t);
+            if(long_int) nbr = print_u64(src);
+            else nbr = print_u32(src);
             DBG_Int(nbr, 10, false, fill_zero, fill_space);
           }
           break;
@@ -126,7 +201,7 @@ void print_args(const char *format, va_list args)
         case 'F': {
           if(!has_precision && *format == 'F') precision = 2;
           if(ary_count) {
-            float *ary = va_arg(args, float *);
+            float *ary = (float *)print_blob(src);
             while(ary_count) {
               DBG_FloatSpace(*ary, precision, width);
               ary_count--;
@@ -135,14 +210,14 @@ void print_args(const char *format, va_list args)
             }
           }
           else {
-            double nbr = va_arg(args, double);
+            double nbr = print_f64(src);
             DBG_FloatSpace((float)nbr, precision, width);
           }
           break;
         }
         case 'x': case 'X': {
           if(ary_count) {
-            uint8_t *ary = va_arg(args, uint8_t *);
+            uint8_t *ary = (uint8_t *)print_blob(src);
             while(ary_count) {
               switch(ary_type) {
                 case 8:
@@ -168,8 +243,8 @@ void print_args(const char *format, va_list args)
           }
           else {
             uint64_t nbr;
-            if(long_int) nbr = va_arg(args, uint64_t);
-            else nbr = va_arg(args, uint32_t);
+            if(long_int) nbr = print_u64(src);
+            else nbr = print_u32(src);
             DBG_Int(nbr, 16, false, fill_zero, fill_space);
           }
           break;
@@ -177,7 +252,7 @@ void print_args(const char *format, va_list args)
         case 'p': {
           // Pointer: `0x` prefix + hex digits sized to platform pointer width.
           // 32-bit (STM32): 8 digits. 64-bit (host build): 16 digits.
-          void *ptr = va_arg(args, void *);
+          void *ptr = print_ptr(src);
           DBG_String("0x");
           if(sizeof(void *) == 8) {
             DBG_Int((int64_t)(uintptr_t)ptr, 16, false, 16, 16);
@@ -189,7 +264,7 @@ void print_args(const char *format, va_list args)
         }
         case 'c': {
           if(ary_count) {
-            char *ary = va_arg(args, char *);
+            char *ary = (char *)print_blob(src);
             while(ary_count) {
               DBG_Char(*ary);
               ary_count--;
@@ -198,14 +273,14 @@ void print_args(const char *format, va_list args)
             }
           }
           else {
-            char sing = (char)va_arg(args, int);
+            char sing = (char)print_u32(src);
             DBG_Char(sing);
           }
           break;
         }
         case 's': {
           if(ary_count) {
-            char **str = va_arg(args, char **);
+            char **str = (char **)print_ptr(src);
             while(ary_count) {
               DBG_String(*str);
               ary_count--;
@@ -214,15 +289,15 @@ void print_args(const char *format, va_list args)
             }
           }
           else {
-            char *str = va_arg(args, char *);
+            char *str = (char *)print_blob(src);
             DBG_String(str);
           }
           break;
         }
         case 'S': {
           if(ary_count) {
-            uint8_t *ary = va_arg(args, uint8_t *);
-            char **str = va_arg(args, char **);
+            uint8_t *ary = (uint8_t *)print_blob(src);
+            char **str = (char **)print_ptr(src);
             while(ary_count) {
               uint32_t idx;
               switch(ary_type) {
@@ -237,17 +312,17 @@ void print_args(const char *format, va_list args)
             }
           }
           else {
-            uint32_t n = va_arg(args, uint32_t);
-            char **str = va_arg(args, char **);
+            uint32_t n = print_u32(src);
+            char **str = (char **)print_ptr(src);
             DBG_String(str[n]);
           }
           break;
         }
         case 'o': case 'O': {
           if(ary_count) {
-            void *obj = va_arg(args, void *);
-            int32_t (*Print)(void *) = va_arg(args, int32_t (*)(void *));
-            uint32_t size = va_arg(args, uint32_t);
+            void *obj = print_ptr(src);
+            int32_t (*Print)(void *) = va_arg(src->args, int32_t (*)(void *));
+            uint32_t size = print_u32(src);
             while(ary_count) {
               Print(obj);
               ary_count--;
@@ -256,15 +331,15 @@ void print_args(const char *format, va_list args)
             }
           }
           else {
-            void *obj = va_arg(args, void *);
-            int32_t (*Print)(void *) = va_arg(args, int32_t (*)(void *));
+            void *obj = print_ptr(src);
+            int32_t (*Print)(void *) = va_arg(src->args, int32_t (*)(void *));
             Print(obj);
           }
           break;
         }
         case 'b': {
           if(ary_count) {
-            uint8_t *ary = va_arg(args, uint8_t *);
+            uint8_t *ary = (uint8_t *)print_blob(src);
             while(ary_count) {
               DBG_Int(*ary, 2, false, fill_zero, fill_space);
               ary_count--;
@@ -273,14 +348,14 @@ void print_args(const char *format, va_list args)
             }
           }
           else {
-            uint8_t bin = (uint8_t)va_arg(args, int);
+            uint8_t bin = (uint8_t)print_u32(src);
             DBG_Int(bin, 2, false, fill_zero, fill_space);
           }
           break;
         }
         case 'B': {
           if(ary_count) {
-            bool *ary = va_arg(args, bool *);
+            bool *ary = (bool *)print_blob(src);
             while(ary_count) {
               DBG_Bool(*ary);
               ary_count--;
@@ -289,7 +364,7 @@ void print_args(const char *format, va_list args)
             }
           }
           else {
-            bool true_false = (bool)va_arg(args, int);
+            bool true_false = (bool)print_u32(src);
             DBG_Bool(true_false);
           }
           break;
@@ -298,24 +373,26 @@ void print_args(const char *format, va_list args)
           // Current RTC time on demand. No arg consumed.
           // `%t` -> HH:MM:SS, `%lt` -> HH:MM:SS.mmm
           // Falls back to tick value when RTC is not initialized.
-          if(RtcInit) {
-            RTC_Datetime_t dt = RTC_Datetime();
+          RTC_Datetime_t dt;
+          uint64_t tick;
+          if(print_now(src, &dt, &tick)) {
             if(long_int) DBG_TimeMs(&dt);
             else DBG_Time(&dt);
           }
-          else DBG_Int(tick_keep(0), 10, false, 0, 0);
+          else DBG_Int(tick, 10, false, 0, 0);
           break;
         }
         case 'T': {
           // Current RTC datetime on demand. No arg consumed.
           // `%T` -> YYYY-MM-DD HH:MM:SS, `%lT` -> with ms
           // Falls back to tick value when RTC is not initialized.
-          if(RtcInit) {
-            RTC_Datetime_t dt = RTC_Datetime();
+          RTC_Datetime_t dt;
+          uint64_t tick;
+          if(print_now(src, &dt, &tick)) {
             if(long_int) DBG_DatetimeMs(&dt);
             else DBG_Datetime(&dt);
           }
-          else DBG_Int(tick_keep(0), 10, false, 0, 0);
+          else DBG_Int(tick, 10, false, 0, 0);
           break;
         }
         case '%': {
@@ -341,6 +418,14 @@ void print_args(const char *format, va_list args)
   }
 }
 
+void print_args(const char *format, va_list args)
+{
+  print_src_t src = { .raw = NULL };
+  va_copy(src.args, args);
+  print_src(format, &src);
+  va_end(src.args);
+}
+
 void print(const char *template, ...)
 {
   va_list args;
@@ -349,17 +434,265 @@ void print(const char *template, ...)
   va_end(args);
 }
 
+//--------------------------------------------------------------------------------------- Defer
+#if(LOG_DEFER)
+
+_Static_assert(LOG_DEFER_SIZE % 8 == 0, "LOG_DEFER_SIZE must be a multiple of 8");
+
+#define LOG_PACK_SYNC 0xFFFF
+
+// Ring record header. `size` is whole record (8 B aligned), `0` = wrap marker.
+typedef struct {
+  uint16_t size;
+  const char *tag;
+  const char *format;
+} log_record_t;
+
+#define LOG_RECORD_HEAD ((sizeof(log_record_t) + 7) & ~7)
+
+static struct {
+  uint8_t ring[LOG_DEFER_SIZE] __attribute__((aligned(8)));
+  volatile uint16_t head; // Written only by producers (log calls)
+  volatile uint16_t tail; // Written only by consumer (`LOG_Flush`)
+  uint32_t dropped;
+  uint32_t dropped_total;
+} log_defer;
+
+typedef struct {
+  uint8_t *ptr;
+  uint8_t *end;
+  bool fault;
+} log_pack_t;
+
+static void log_pack_data(log_pack_t *pack, const void *data, uint32_t size)
+{
+  if(pack->fault || (uint32_t)(pack->end - pack->ptr) < size) {
+    pack->fault = true;
+    return;
+  }
+  memcpy(pack->ptr, data, size);
+  pack->ptr += size;
+}
+
+static void log_pack_blob(log_pack_t *pack, const void *data, uint32_t size)
+{
+  log_pack_data(pack, &size, sizeof(size));
+  uint8_t *aligned = (uint8_t *)print_align(pack->ptr);
+  if(aligned > pack->end) {
+    pack->fault = true;
+    return;
+  }
+  pack->ptr = aligned;
+  log_pack_data(pack, data, size);
+}
+
+// Walk format the same way as `print_src`, but only copy consumed args into `dst`.
+// Return packed size, `0` if it does not fit, `LOG_PACK_SYNC` if message references
+// caller memory that cannot be copied (`%o`, arrays of strings) and must print now.
+static uint16_t log_pack(uint8_t *dst, uint16_t limit, const char *format, va_list args)
+{
+  log_pack_t pack = { .ptr = dst, .end = dst + limit };
+  uint8_t ary_type = 1, ary_count = 0;
+  while(*format) {
+    if(*format != '%') {
+      format++;
+      continue;
+    }
+    format++;
+    while(*format == '0') format++;
+    uint8_t width = print_args_getstrnbr(&format);
+    uint8_t precision = 0;
+    if(*format == '.') {
+      format++;
+      precision = print_args_getstrnbr(&format);
+    }
+    bool long_int = false;
+    if(*format == 'l') { format++; long_int = true; }
+    if(*format == 'l') { format++; long_int = true; }
+    uint8_t ary_size = (ary_type == 8 || ary_type == 4 || ary_type == 2) ? ary_type : 1;
+    switch(*format) {
+      case 'a': case 'A': {
+        uint32_t count = va_arg(args, uint32_t);
+        log_pack_data(&pack, &count, sizeof(count));
+        ary_count = (uint8_t)count;
+        ary_type = precision > width ? precision : width;
+        if(!ary_type) ary_type = 1;
+        break;
+      }
+      case 'i': case 'd': case 'u': case 'x': case 'X': {
+        if(ary_count) log_pack_blob(&pack, va_arg(args, void *), ary_count * ary_size);
+        else if(long_int) {
+          uint64_t nbr = va_arg(args, uint64_t);
+          log_pack_data(&pack, &nbr, sizeof(nbr));
+        }
+        else {
+          uint32_t nbr = va_arg(args, uint32_t);
+          log_pack_data(&pack, &nbr, sizeof(nbr));
+        }
+        ary_count = 0;
+        break;
+      }
+      case 'f': case 'F': {
+        if(ary_count) log_pack_blob(&pack, va_arg(args, void *), ary_count * sizeof(float));
+        else {
+          float nbr = (float)va_arg(args, double);
+          log_pack_data(&pack, &nbr, sizeof(nbr));
+        }
+        ary_count = 0;
+        break;
+      }
+      case 'c': case 'b': case 'B': {
+        uint32_t ary_bytes = ary_count * (*format == 'B' ? sizeof(bool) : 1);
+        if(ary_count) log_pack_blob(&pack, va_arg(args, void *), ary_bytes);
+        else {
+          uint32_t value = (uint32_t)va_arg(args, int);
+          log_pack_data(&pack, &value, sizeof(value));
+        }
+        ary_count = 0;
+        break;
+      }
+      case 's': {
+        if(ary_count) return LOG_PACK_SYNC;
+        const char *str = va_arg(args, const char *);
+        if(!str) str = "";
+        log_pack_blob(&pack, str, strlen(str) + 1);
+        break;
+      }
+      case 'S': {
+        if(ary_count) return LOG_PACK_SYNC;
+        uint32_t idx = va_arg(args, uint32_t);
+        void *table = va_arg(args, void *);
+        log_pack_data(&pack, &idx, sizeof(idx));
+        log_pack_data(&pack, &table, sizeof(table));
+        break;
+      }
+      case 'o': case 'O': {
+        return LOG_PACK_SYNC;
+      }
+      case 'p': {
+        void *ptr = va_arg(args, void *);
+        log_pack_data(&pack, &ptr, sizeof(ptr));
+        break;
+      }
+      case 't': case 'T': {
+        // Time is captured at log call, not when the record is formatted
+        uint32_t rtc = RtcInit;
+        log_pack_data(&pack, &rtc, sizeof(rtc));
+        if(rtc) {
+          RTC_Datetime_t dt = RTC_Datetime();
+          log_pack_blob(&pack, &dt, sizeof(dt));
+        }
+        else {
+          uint64_t tick = tick_keep(0);
+          log_pack_data(&pack, &tick, sizeof(tick));
+        }
+        break;
+      }
+      case '\0': {
+        format--;
+        break;
+      }
+      default: break;
+    }
+    if(pack.fault) return 0;
+    format++;
+  }
+  return (uint16_t)(pack.ptr - dst);
+}
+
+// Pack record at ring head, wrapping once if the tail part is too short.
+// Return `false` if message must be formatted synchronously by caller.
+static bool log_defer_push(const char *tag, const char *format, va_list args)
+{
+  uint16_t head = log_defer.head;
+  uint16_t tail = log_defer.tail;
+  for(uint8_t pass = 0; pass < 2; pass++) {
+    // Keep one 8 B slot free so that full ring never looks empty (`head == tail`)
+    uint16_t space = head >= tail ? LOG_DEFER_SIZE - head - (tail ? 0 : 8) : tail - head - 8;
+    if(space > LOG_RECORD_HEAD) {
+      va_list copy;
+      va_copy(copy, args);
+      uint16_t size = log_pack(&log_defer.ring[head + LOG_RECORD_HEAD], space - LOG_RECORD_HEAD, format, copy);
+      va_end(copy);
+      if(size == LOG_PACK_SYNC) return false;
+      if(size) {
+        log_record_t *record = (log_record_t *)&log_defer.ring[head];
+        record->size = (LOG_RECORD_HEAD + size + 7) & ~7;
+        record->tag = tag;
+        record->format = format;
+        __DMB();
+        head += record->size;
+        log_defer.head = head >= LOG_DEFER_SIZE ? 0 : head;
+        return true;
+      }
+    }
+    if(pass || head < tail || !tail) break;
+    memset(&log_defer.ring[head], 0, sizeof(uint16_t)); // Wrap marker
+    head = 0;
+  }
+  log_defer.dropped++;
+  log_defer.dropped_total++;
+  return true;
+}
+
+void LOG_Flush(void)
+{
+  while(log_defer.tail != log_defer.head) {
+    if(DbgFile->limit - DbgFile->size < LOG_DEFER_MARGIN) return;
+    log_record_t *record = (log_record_t *)&log_defer.ring[log_defer.tail];
+    if(!record->size) {
+      log_defer.tail = 0;
+      continue;
+    }
+    print_src_t src = { .raw = (const uint8_t *)record + LOG_RECORD_HEAD };
+    DBG_String((char *)record->tag);
+    print_src(record->format, &src);
+    DBG_Enter();
+    uint16_t tail = log_defer.tail + record->size;
+    log_defer.tail = tail >= LOG_DEFER_SIZE ? 0 : tail;
+  }
+  if(log_defer.dropped && DbgFile->limit - DbgFile->size >= LOG_DEFER_MARGIN) {
+    uint32_t dropped = log_defer.dropped;
+    log_defer.dropped = 0;
+    DBG_String(ANSI_YELLOW "WRN " ANSI_END);
+    print("Log dropped " ANSI_LIME "%u" ANSI_END " messages", dropped);
+    DBG_Enter();
+  }
+}
+
+uint32_t LOG_Dropped(void)
+{
+  return log_defer.dropped_total;
+}
+
+#else
+
+void LOG_Flush(void) {}
+uint32_t LOG_Dropped(void) { return 0; }
+
+#endif
 //----------------------------------------------------------------------------------------- Log
 
-// Common emit path: colored tag + formatted message + newline.
+// Synchronous emit: colored tag + formatted message + newline.
 // No automatic timestamp. Use `%t` or `%T` in the format string when needed.
-static void log_emit(const char *color_tag, const char *message, va_list args)
+static void log_print(const char *color_tag, const char *message, va_list args)
 {
   DBG_String((char *)color_tag);
   print_args(message, args);
   DBG_Enter();
 }
 
+// Common emit path for leveled logs. With `LOG_DEFER` only args are captured here,
+// formatting happens in `DBG_Loop`. Uncopyable messages flush the ring first to keep order.
+static void log_emit(const char *color_tag, const char *message, va_list args)
+{
+  #if(LOG_DEFER)
+    if(log_defer_push(color_tag, message, args)) return;
+    LOG_Flush();
+  #endif
+  log_print(color_tag, message, args);
+}
+
 void LOG_Nope(const char *message, ...)
 {
   unused(message);
@@ -369,7 +702,8 @@ void LOG_Bash(const char *message, ...)
 {
   va_list args;
   va_start(args, message);
-  log_emit(ANSI_GREEN "INF " ANSI_END, message, args);
+  LOG_Flush();
+  log_print(ANSI_GREEN "INF " ANSI_END, message, args);
   va_end(args);
 }
 
@@ -430,10 +764,12 @@ void LOG_Critical(const char *message, ...)
   #if(LOG_LEVEL <= LOG_LEVEL_CRT)
     va_list args;
     va_start(args, message);
-    log_emit(ANSI_MAGNTA "CRT " ANSI_END, message, args);
+    LOG_Flush();
+    log_print(ANSI_MAGNTA "CRT " ANSI_END, message, args);
     va_end(args);
     DBG_Send(DbgFile->buffer, DbgFile->size);
     MBB_Clear(DbgFile);
+    DbgFlushes++;
   #else
     unused(message);
   #endif
@@ -444,6 +780,7 @@ void LOG_Critical(const char *message, ...)
 // non-variadic and uses simpler path (raw string only).
 static void log_panic_emit(const char *message, va_list args)
 {
+  LOG_Flush();
   DBG_String(ANSI_MAGNTA "PNC " ANSI_END);
   print_args(message, args);
   DBG_Enter();
@@ -451,11 +788,13 @@ static void log_panic_emit(const char *message, va_list args)
   UART_Send(DbgUart, DbgFile->buffer, DbgFile->size);
   DBG_WaitBlock();
   MBB_Clear(DbgFile);
+  DbgFlushes++;
 }
 
 void LOG_Panic(const char *message)
 {
   #if(LOG_LEVEL <= LOG_LEVEL_PAC)
+    LOG_Flush();
     DBG_String(ANSI_MAGNTA "PNC " ANSI_END);
     DBG_String((char *)message);
     DBG_Enter();
@@ -463,15 +802,14 @@ void LOG_Panic(const char *message)
     UART_Send(DbgUart, DbgFile->buffer, DbgFile->size);
     DBG_WaitBlock();
     MBB_Clear(DbgFile);
+    DbgFlushes++;
   #else
     unused(message);
   #endif
 }
 
-void LOG_Message(LOG_Level_t lvl, char *message, ...)
+static void log_message(LOG_Level_t lvl, const char *message, va_list args)
 {
-  va_list args;
-  va_start(args, message);
   switch(lvl) {
     #if(LOG_LEVEL <= LOG_LEVEL_DBG)
       case LOG_Level_Debug:
@@ -495,18 +833,124 @@ void LOG_Message(LOG_Level_t lvl, char *message, ...)
     #endif
     #if(LOG_LEVEL <= LOG_LEVEL_CRT)
       case LOG_Level_Critical:
-        log_emit(ANSI_MAGNTA "CRT " ANSI_END, message, args);
+        LOG_Flush();
+        log_print(ANSI_MAGNTA "CRT " ANSI_END, message, args);
         DBG_Send(DbgFile->buffer, DbgFile->size);
         MBB_Clear(DbgFile);
+        DbgFlushes++;
         break;
     #endif
     case LOG_Level_Panic: log_panic_emit(message, args); break;
     case LOG_Level_None: break;
     default: break;
   }
+}
+
+void LOG_Message(LOG_Level_t lvl, char *message, ...)
+{
+  va_list args;
+  va_start(args, message);
+  log_message(lvl, message, args);
+  va_end(args);
+}
+
+//------------------------------------------------------------------------------------- Library
+
+const uint8_t LogLibUnresolved = LOG_Level_Debug;
+const char *LogLevelNames[] = { "dbg", "inf", "wrn", "err", "crt", "pnc", "nil" };
+
+// Runtime levels, one slot per library tag. `name` stays `NULL` for tags
+// set from shell before first log call (shell `argv` is not persistent).
+static struct {
+  const char *name[LOG_LIB_LIMIT];
+  uint32_t hash[LOG_LIB_LIMIT];
+  uint8_t level[LOG_LIB_LIMIT];
+  uint8_t count;
+} log_lib;
+
+// Fallback level for call sites that did not fit in library table
+static uint8_t log_lib_default = LOG_LIB_LEVEL;
+
+static int16_t log_lib_find(uint32_t hash)
+{
+  for(uint8_t i = 0; i < log_lib.count; i++) {
+    if(log_lib.hash[i] == hash) return i;
+  }
+  if(log_lib.count >= LOG_LIB_LIMIT) return -1;
+  log_lib.name[log_lib.count] = NULL;
+  log_lib.hash[log_lib.count] = hash;
+  log_lib.level[log_lib.count] = LOG_LIB_LEVEL;
+  return log_lib.count++;
+}
+
+void LOG_LibMessage(LOG_Lib_t *lib, LOG_Level_t lvl, const char *message, ...)
+{
+  if(lib->level == &LogLibUnresolved) {
+    int16_t idx = log_lib_find(hash_djb2_ci(lib->name));
+    if(idx < 0) lib->level = &log_lib_default;
+    else {
+      if(!log_lib.name[idx]) log_lib.name[idx] = lib->name;
+      lib->level = &log_lib.level[idx];
+    }
+    if(lvl < *lib->level) return;
+  }
+  va_list args;
+  va_start(args, message);
+  log_message(lvl, message, args);
   va_end(args);
 }
 
+status_t LOG_LibSetLevel(const char *name, LOG_Level_t lvl)
+{
+  int16_t idx = log_lib_find(hash_djb2_ci(name));
+  if(idx < 0) return ERR;
+  log_lib.level[idx] = lvl;
+  return OK;
+}
+
+uint8_t LOG_LibCount(void)
+{
+  return log_lib.count;
+}
+
+const char *LOG_LibName(uint8_t idx)
+{
+  return idx < log_lib.count ? log_lib.name[idx] : NULL;
+}
+
+LOG_Level_t LOG_LibLevel(uint8_t idx)
+{
+  return idx < log_lib.count ? log_lib.level[idx] : LOG_Level_None;
+}
+
+//---------------------------------------------------------------------------------------- Rate
+
+bool LOG_RateTake(LOG_Rate_t *rate, LOG_Level_t lvl, uint16_t burst, uint32_t period_ms)
+{
+  if(!burst) burst = 1;
+  uint32_t step_ms = period_ms / burst;
+  // Refill: one token per elapsed step since deadline
+  if(rate->used) {
+    int32_t late_ms = tick_diff(rate->tick);
+    if(late_ms >= 0) {
+      uint32_t refill = step_ms ? 1 + (uint32_t)late_ms / step_ms : rate->used;
+      rate->used = refill >= rate->used ? 0 : rate->used - refill;
+      rate->tick = tick_keep(step_ms);
+    }
+  }
+  if(rate->used >= burst) {
+    if(rate->suppressed < UINT16_MAX) rate->suppressed++;
+    return false;
+  }
+  if(!rate->used) rate->tick = tick_keep(step_ms);
+  rate->used++;
+  if(rate->suppressed) {
+    LOG_Message(lvl, "Log suppressed " ANSI_LIME "%u" ANSI_END " repeated messages", rate->suppressed);
+    rate->suppressed = 0;
+  }
+  return true;
+}
+
 //---------------------------------------------------------------------------------------------
 
 void LOG_ErrorParse(const char *value, const char *type)
@@ -13,6 +13,28 @@
   #define LOG_ARYSPACE_MAXLEN 32
 #endif
 
+#ifndef LOG_LIB_LIMIT
+  // Max number of libraries with runtime log level (`LOG_LIB_*` tags)
+  #define LOG_LIB_LIMIT 16
+#endif
+
+#ifndef LOG_DEFER
+  // Deferred mode: log calls only pack format pointer and raw args into a ring,
+  // `DBG_Loop` formats them later. `%s` and `%a` data are copied, `%t`/`%T` time
+  // is captured at call. `%o` and `%a` of strings/objects are formatted immediately.
+  #define LOG_DEFER OFF
+#endif
+
+#ifndef LOG_DEFER_SIZE
+  // Deferred log ring size in bytes (multiple of 8)
+  #define LOG_DEFER_SIZE 1024
+#endif
+
+#ifndef LOG_DEFER_MARGIN
+  // Min free space in `DbgFile` required to format next deferred record
+  #define LOG_DEFER_MARGIN 128
+#endif
+
 #define LOG_LEVEL_DBG 0
 #define LOG_LEVEL_INF 1
 #define LOG_LEVEL_WRN 2
@@ -26,6 +48,11 @@
   #define LOG_LEVEL LOG_LEVEL_INF
 #endif
 
+#ifndef LOG_LIB_LEVEL
+  // Initial runtime level of every library, change with `LOG_LibSetLevel` or `log <lib> <lvl>`
+  #define LOG_LIB_LEVEL LOG_LEVEL
+#endif
+
 typedef enum {
   LOG_Level_Debug = LOG_LEVEL_DBG,
   LOG_Level_Info = LOG_LEVEL_INF,
@@ -76,6 +103,21 @@ extern bool LogPrintFlag;
  */
 void print(const char *template, ...);
 
+/**
+ * @brief Format pending deferred records into `DbgFile` (`LOG_DEFER` mode).
+ * Called from `DBG_Loop` and before every synchronous output to keep order.
+ * Stops when `DbgFile` has less than `LOG_DEFER_MARGIN` bytes free, the rest
+ * waits for next call. Reports messages dropped on full ring as warning.
+ * No-op when `LOG_DEFER` is disabled.
+ */
+void LOG_Flush(void);
+
+/**
+ * @brief Total messages dropped because deferred ring was full.
+ * @return Dropped message count since startup (`0` when `LOG_DEFER` is disabled)
+ */
+uint32_t LOG_Dropped(void);
+
 void LOG_Nope(const char *message, ...);     // No-op log (for disabled levels)
 void LOG_Bash(const char *message, ...);     // Bash response (always visible)
 void LOG_Debug(const char *message, ...);    // Log debug message (DBG)
@@ -104,16 +146,104 @@ void LOG_Message(LOG_Level_t lvl, char *message, ...);
 
 // Library name tag (cream brackets, append at end of message)
 #define LOG_LIB(name) " " ANSI_GREY "[" ANSI_CREAM name ANSI_GREY "]" ANSI_END
+
+/**
+ * @brief Call-site handle of library log (`LOG_LIB_*`).
+ * Starts pointing at `LogLibUnresolved`, so first call always goes through
+ * `LOG_LibMessage`, which binds `level` to runtime level of library `name`.
+ * Later calls cost one compare against that level, no formatting when filtered.
+ * @param name Library tag
+ * @param level Pointer to runtime level of library
+ */
+typedef struct {
+  const char *name;
+  const uint8_t *level;
+} LOG_Lib_t;
+
+extern const uint8_t LogLibUnresolved;
+extern const char *LogLevelNames[];
+
+/**
+ * @brief Library log slow path. Internal, called by `LOG_LIB_MSG` macro.
+ * @param[in,out] lib Call-site handle
+ * @param[in] lvl Message level
+ * @param[in] message Format string (with library tag appended)
+ * @param[in] ... Format arguments
+ */
+void LOG_LibMessage(LOG_Lib_t *lib, LOG_Level_t lvl, const char *message, ...);
+
+/**
+ * @brief Set runtime level of library logs (e.g. shell `log pdb dbg`).
+ * Library does not have to be logged yet, level is applied on its first call.
+ * @param[in] name Library tag (case-insensitive)
+ * @param[in] lvl New level, `LOG_Level_None` mutes library
+ * @return `OK` on success, `ERR` if library table is full
+ */
+status_t LOG_LibSetLevel(const char *name, LOG_Level_t lvl);
+
+// Number of known libraries (logged at least once or set from shell)
+uint8_t LOG_LibCount(void);
+// Library tag by index, `NULL` if only set from shell and not logged yet
+const char *LOG_LibName(uint8_t idx);
+// Runtime level of library by index
+LOG_Level_t LOG_LibLevel(uint8_t idx);
+
+// Log with library tag, filtered by runtime level of library `name`
+#define LOG_LIB_MSG(lvl, name, fmt, ...) do { \
+  static LOG_Lib_t _log_lib = { name, &LogLibUnresolved }; \
+  if((lvl) >= LOG_LEVEL && (lvl) >= *_log_lib.level) { \
+    LOG_LibMessage(&_log_lib, lvl, fmt LOG_LIB(name), ##__VA_ARGS__); \
+  } \
+} while(0)
+
 // Debug log with library tag
-#define LOG_LIB_DBG(name, fmt, ...) LOG_DBG(fmt LOG_LIB(name), ##__VA_ARGS__)
+#define LOG_LIB_DBG(name, fmt, ...) LOG_LIB_MSG(LOG_Level_Debug, name, fmt, ##__VA_ARGS__)
 // Info log with library tag
-#define LOG_LIB_INF(name, fmt, ...) LOG_INF(fmt LOG_LIB(name), ##__VA_ARGS__)
+#define LOG_LIB_INF(name, fmt, ...) LOG_LIB_MSG(LOG_Level_Info, name, fmt, ##__VA_ARGS__)
 // Warning log with library tag
-#define LOG_LIB_WRN(name, fmt, ...) LOG_WRN(fmt LOG_LIB(name), ##__VA_ARGS__)
+#define LOG_LIB_WRN(name, fmt, ...) LOG_LIB_MSG(LOG_Level_Warning, name, fmt, ##__VA_ARGS__)
 // Error log with library tag
-#define LOG_LIB_ERR(name, fmt, ...) LOG_ERR(fmt LOG_LIB(name), ##__VA_ARGS__)
+#define LOG_LIB_ERR(name, fmt, ...) LOG_LIB_MSG(LOG_Level_Error, name, fmt, ##__VA_ARGS__)
 // Critical log with library tag
-#define LOG_LIB_CRT(name, fmt, ...) LOG_CRT(fmt LOG_LIB(name), ##__VA_ARGS__)
+#define LOG_LIB_CRT(name, fmt, ...) LOG_LIB_MSG(LOG_Level_Critical, name, fmt, ##__VA_ARGS__)
+
+/**
+ * @brief Token bucket state of rate-limited call site (`LOG_RATE`) or object (`LOG_RATE_AT`).
+ * @param tick Next token refill deadline
+ * @param used Tokens taken from bucket
+ * @param suppressed Messages dropped since last emitted one
+ */
+typedef struct {
+  uint64_t tick;
+  uint16_t used;
+  uint16_t suppressed;
+} LOG_Rate_t;
+
+/**
+ * @brief Take token for rate-limited call site. Internal, called by `LOG_RATE` and `LOG_RATE_AT`.
+ * Bucket holds `burst` tokens, one token returns every `period_ms / burst`.
+ * When message passes after suppression, a summary with dropped count is logged first.
+ * @param[in,out] rate Call-site bucket
+ * @param[in] lvl Level used for suppressed-count summary
+ * @param[in] burst Max messages in a row
+ * @param[in] period_ms Time to refill whole bucket
+ * @return `true` if message may be logged
+ */
+bool LOG_RateTake(LOG_Rate_t *rate, LOG_Level_t lvl, uint16_t burst, uint32_t period_ms);
+
+// Log with specified level, at most `burst` messages per `period_ms` from this call site
+#define LOG_RATE(lvl, burst, period_ms, fmt, ...) do { \
+  static LOG_Rate_t _log_rate; \
+  LOG_RATE_AT(&_log_rate, lvl, burst, period_ms, fmt, ##__VA_ARGS__); \
+} while(0)
+
+// Log with specified level, at most `burst` messages per `period_ms` from `rate` bucket
+// (one per object, so noisy object does not suppress others logged from same call site)
+#define LOG_RATE_AT(rate, lvl, burst, period_ms, fmt, ...) do { \
+  if((lvl) >= LOG_LEVEL && LOG_RateTake(rate, lvl, burst, period_ms)) { \
+    LOG_Message(lvl, fmt, ##__VA_ARGS__); \
+  } \
+} while(0)
 
 /**
  * @brief Log parse error.
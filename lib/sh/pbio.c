@@ -0,0 +1,165 @@
+// lib/sh/pbio.c
+
+#include "pbio.h"
+
+//------------------------------------------------------------------------------------------------- Writer
+
+// Add sent part to CRC, send it and switch to other half (waits while previous half is sent)
+static status_t PBIO_Flush(PBIO_Writer_t *writer)
+{
+  MBB_t *mbb = writer->mbb;
+  if(mbb->size == writer->_start) return OK;
+  writer->_crc = CRC_Update(&PBIO_CRC, writer->_crc, &mbb->buffer[writer->_from], mbb->size - writer->_from);
+  while(UART_IsBusy(writer->uart)) let();
+  if(UART_Send(writer->uart, &mbb->buffer[writer->_start], mbb->size - writer->_start)) return ERR;
+  uint16_t half = mbb->limit / 2;
+  writer->_start = writer->_start ? 0 : half;
+  writer->_end = writer->_start ? mbb->limit : half;
+  writer->_from = writer->_start;
+  mbb->size = writer->_start;
+  return OK;
+}
+
+static bool PBIO_Put(PBIO_Writer_t *writer, const uint8_t *data, size_t count)
+{
+  MBB_t *mbb = writer->mbb;
+  while(count) {
+    uint16_t space = writer->_end - mbb->size;
+    if(!space) {
+      if(!writer->uart || PBIO_Flush(writer)) return false;
+      continue;
+    }
+    uint16_t n = count < space ? (uint16_t)count : space;
+    memcpy(&mbb->buffer[mbb->size], data, n);
+    mbb->size += n;
+    data += n;
+    count -= n;
+  }
+  return true;
+}
+
+static bool PBIO_Write(pb_ostream_t *stream, const pb_byte_t *buf, size_t count)
+{
+  return PBIO_Put((PBIO_Writer_t *)stream->state, buf, count);
+}
+
+status_t PBIO_Encode(PBIO_Writer_t *writer, const pb_msgdesc_t *fields, const void *msg)
+{
+  MBB_t *mbb = writer->mbb;
+  size_t size;
+  if(mbb->lock || MBB_Linearize(mbb) || !pb_get_encoded_size(&size, fields, msg) || size > 0xFFFF) return ERR;
+  if(writer->uart) {
+    mbb->size = 0;
+    writer->_end = mbb->limit / 2;
+  }
+  else writer->_end = mbb->limit;
+  writer->_start = mbb->size;
+  writer->_crc = CRC_Begin(&PBIO_CRC);
+  uint8_t head[PBIO_HEAD] = { PBIO_SYNC, (uint8_t)size, (uint8_t)(size >> 8) };
+  bool ok = PBIO_Put(writer, head, 1);
+  writer->_from = mbb->size; // CRC starts after sync
+  pb_ostream_t stream = { .callback = PBIO_Write, .state = writer, .max_size = size };
+  ok = ok && PBIO_Put(writer, &head[1], PBIO_HEAD - 1) &&
+    pb_encode(&stream, fields, msg) && stream.bytes_written == size;
+  if(ok) {
+    writer->_crc = CRC_Update(&PBIO_CRC, writer->_crc, &mbb->buffer[writer->_from], mbb->size - writer->_from);
+    uint32_t code = CRC_End(&PBIO_CRC, writer->_crc);
+    uint8_t crc_size = PBIO_CRC.width / 8;
+    uint8_t tail[4];
+    for(uint8_t i = 0; i < crc_size; i++) tail[i] = (uint8_t)(code >> (8 * (crc_size - 1 - i)));
+    // Later flush adds `tail` to `_crc` too, result is already taken
+    ok = PBIO_Put(writer, tail, crc_size);
+  }
+  if(writer->uart) {
+    if(ok && PBIO_Flush(writer)) ok = false;
+    while(UART_IsBusy(writer->uart)) let();
+    mbb->size = 0;
+  }
+  else if(!ok) mbb->size = writer->_start;
+  return ok ? OK : ERR;
+}
+
+//------------------------------------------------------------------------------------------------- Reader
+
+static bool PBIO_Read(pb_istream_t *stream, pb_byte_t *buf, size_t count)
+{
+  PBIO_Reader_t *reader = (PBIO_Reader_t *)stream->state;
+  if(BUFF_PeekAt(reader->buff, reader->_offset, buf, count) != count) return false;
+  reader->_offset += count;
+  return true;
+}
+
+// Frame fills whole message and CRC matches (CRC is fed in parts, message may wrap around)
+static bool PBIO_Check(BUFF_t *buff, uint16_t *size)
+{
+  uint16_t length = BUFF_Size(buff);
+  uint8_t crc_size = PBIO_CRC.width / 8;
+  uint8_t chunk[64];
+  if(BUFF_PeekAt(buff, 0, chunk, PBIO_HEAD) != PBIO_HEAD || chunk[0] != PBIO_SYNC) return false;
+  *size = chunk[1] | ((uint16_t)chunk[2] << 8);
+  if(PBIO_HEAD + *size + crc_size != length) return false;
+  uint32_t crc = CRC_Begin(&PBIO_CRC);
+  uint16_t end = PBIO_HEAD + *size;
+  for(uint16_t offset = 1; offset < end;) {
+    uint16_t n = end - offset;
+    if(n > sizeof(chunk)) n = sizeof(chunk);
+    BUFF_PeekAt(buff, offset, chunk, n);
+    crc = CRC_Update(&PBIO_CRC, crc, chunk, n);
+    offset += n;
+  }
+  uint32_t code = CRC_End(&PBIO_CRC, crc);
+  BUFF_PeekAt(buff, end, chunk, crc_size);
+  for(uint8_t i = 0; i < crc_size; i++) {
+    if(chunk[i] != (uint8_t)(code >> (8 * (crc_size - 1 - i)))) return false;
+  }
+  return true;
+}
+
+status_t PBIO_Open(PBIO_Reader_t *reader, pb_istream_t *stream)
+{
+  if(!BUFF_Size(reader->buff)) return BUSY;
+  uint16_t size;
+  if(!PBIO_Check(reader->buff, &size)) {
+    BUFF_Skip(reader->buff);
+    return ERR;
+  }
+  reader->_offset = PBIO_HEAD;
+  *stream = (pb_istream_t){ .callback = PBIO_Read, .state = reader, .bytes_left = size };
+  return OK;
+}
+
+void PBIO_Close(PBIO_Reader_t *reader)
+{
+  BUFF_Skip(reader->buff);
+}
+
+status_t PBIO_Decode(PBIO_Reader_t *reader, const pb_msgdesc_t *fields, void *msg)
+{
+  pb_istream_t stream;
+  status_t status = PBIO_Open(reader, &stream);
+  if(status) return status;
+  bool ok = pb_decode(&stream, fields, msg);
+  PBIO_Close(reader);
+  return ok ? OK : ERR;
+}
+
+//------------------------------------------------------------------------------------------------- PDB
+
+bool PBIO_EncodePdb(pb_ostream_t *stream, const pb_field_t *field, void * const *arg)
+{
+  PBIO_Pdb_t *source = (PBIO_Pdb_t *)*arg;
+  PDB_Iter_t iter;
+  PDB_IterInit(source->pdb, &iter, &source->query);
+  while(PDB_IterNext(&iter, NULL) == OK) {
+    const void *record = PDB_IterRef(&iter);
+    if(!pb_encode_tag_for_field(stream, field)) return false;
+    if(source->fields) {
+      source->Fill(source->msg, record);
+      if(!pb_encode_submessage(stream, source->fields, source->msg)) return false;
+    }
+    else if(!pb_encode_string(stream, (const pb_byte_t *)record, source->pdb->payload_size)) return false;
+  }
+  return true;
+}
+
+//-------------------------------------------------------------------------------------------------
@@ -0,0 +1,134 @@
+// lib/sh/pbio.h
+
+#ifndef PBIO_H_
+#define PBIO_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "pb_encode.h"
+#include "pb_decode.h"
+#include "mbb.h"
+#include "buff.h"
+#include "uart.h"
+#include "pdb.h"
+#include "crc.h"
+#include "vrts.h"
+#include "main.h"
+
+//-------------------------------------------------------------------------------------- Config
+
+#ifndef PBIO_SYNC
+  // First byte of frame (same as `STREAM_RPC_SYNC`, never present in text commands)
+  #define PBIO_SYNC 0xB5
+#endif
+
+#ifndef PBIO_CRC
+  // CRC of frame, computed over length and payload
+  #define PBIO_CRC crc16_modbus
+#endif
+
+#define PBIO_HEAD 3 // sync + length:u16le
+
+//--------------------------------------------------------------------------------------- Types
+
+/**
+ * @brief Frame writer: protobuf message is encoded straight into `mbb`, no staging buffer.
+ * Frame: `SYNC` | `length:u16le` | `payload` | `CRC(length+payload)` (as `STREAM_RpcReply`).
+ * Without `uart` frame is appended to `mbb` content (encode fails when it does not fit).
+ * With `uart` `mbb` works as two halves: full half is sent by DMA while other one is filled,
+ * so frame size is not limited by `mbb`. Writer yields with `let()` while both halves are busy.
+ * @param[in] mbb Output buffer (with `uart`: dedicated to writer, content is overwritten)
+ * @param[in] uart Flush target or `NULL`
+ * Internal:
+ * @param _crc Running CRC state of frame
+ * @param _from Start of part of `mbb` not added to `_crc` yet
+ * @param _start Start of frame (without `uart`) or of half being filled (with `uart`)
+ * @param _end End of half being filled (`mbb->limit` without `uart`)
+ */
+typedef struct {
+  MBB_t *mbb;
+  UART_t *uart;
+  // internal
+  uint32_t _crc;
+  uint16_t _from;
+  uint16_t _start;
+  uint16_t _end;
+} PBIO_Writer_t;
+
+/**
+ * @brief Frame reader over messages of `BUFF_t` (e.g. `uart->buff`).
+ * Frame must be whole message. It is checked and decoded in place,
+ * also when it wraps around end of buffer memory.
+ * @param[in] buff Receive buffer
+ * Internal:
+ * @param _offset Read position in current message
+ */
+typedef struct {
+  BUFF_t *buff;
+  // internal
+  uint16_t _offset;
+} PBIO_Reader_t;
+
+/**
+ * @brief Source of repeated field encoded by `PBIO_EncodePdb`, records are read
+ * from flash by `PDB_IterRef` one by one (no array in RAM).
+ * @param[in] pdb Database
+ * @param[in] query Query parameters
+ * @param[in] fields Submessage descriptor or `NULL` to encode raw record as `bytes`
+ * @param[in] Fill Convert flash record to submessage struct `msg` (with `fields`)
+ * @param[in] msg One submessage struct, reused for each record (with `fields`)
+ */
+typedef struct {
+  PDB_t *pdb;
+  PDB_Query_t query;
+  const pb_msgdesc_t *fields;
+  void (*Fill)(void *msg, const void *record);
+  void *msg;
+} PBIO_Pdb_t;
+
+//----------------------------------------------------------------------------------------- API
+
+/**
+ * @brief Encode message as one frame. Size is computed first by sizing pass
+ * (callbacks run twice and must give same output).
+ * @param[in,out] writer Frame writer
+ * @param[in] fields Message descriptor
+ * @param[in] msg Message struct
+ * @return `OK`, `ERR` on encode error, payload over 65535 bytes, no space (without `uart`)
+ *   or locked `mbb`
+ */
+status_t PBIO_Encode(PBIO_Writer_t *writer, const pb_msgdesc_t *fields, const void *msg);
+
+/**
+ * @brief Decode frame from current message of `buff`. Message is dropped after decode
+ * (also on error), nothing is copied except decoded fields.
+ * @param[in,out] reader Frame reader
+ * @param[in] fields Message descriptor
+ * @param[out] msg Message struct
+ * @return `OK`, `BUSY` if no message, `ERR` on bad frame or decode error
+ */
+status_t PBIO_Decode(PBIO_Reader_t *reader, const pb_msgdesc_t *fields, void *msg);
+
+/**
+ * @brief Check frame in current message of `buff` and open input stream over its payload.
+ * For manual decode; `PBIO_Close` drops message.
+ * @param[in,out] reader Frame reader
+ * @param[out] stream Input stream (reads from `buff` in place)
+ * @return `OK`, `BUSY` if no message, `ERR` on bad frame (message dropped)
+ */
+status_t PBIO_Open(PBIO_Reader_t *reader, pb_istream_t *stream);
+
+/**
+ * @brief Drop message opened by `PBIO_Open`.
+ * @param[in,out] reader Frame reader
+ */
+void PBIO_Close(PBIO_Reader_t *reader);
+
+/**
+ * @brief Encode callback of repeated field: one element per record of `PBIO_Pdb_t` query.
+ * Set `msg.field.funcs.encode = PBIO_EncodePdb` and `msg.field.arg = &source`.
+ */
+bool PBIO_EncodePdb(pb_ostream_t *stream, const pb_field_t *field, void * const *arg);
+
+//---------------------------------------------------------------------------------------------
+#endif
@@ -0,0 +1,127 @@
+# Host client for binary CMD stream (`STREAM_RPC`)
+# Frame: SYNC | length:u16le | protobuf payload | crc16-modbus(length+payload):u16le
+# Request: uint32 seq = 1; repeated string argv = 2;
+# Response: uint32 seq = 1; uint32 status = 2; bytes output = 3;
+# Usage: python rpc.py <port> [baud] <command...>
+#        python rpc.py <port> [baud] --bench <count> <command...>
+
+import sys
+import time
+import serial # pip install pyserial
+
+SYNC = 0xB5
+STATUS = {0: 'ok', 1: 'not found', 2: 'overflow'}
+
+def crc16_modbus(data: bytes) -> int:
+  crc = 0xFFFF
+  for byte in data:
+    crc ^= byte
+    for _ in range(8):
+      crc = (crc >> 1) ^ 0xA001 if crc & 1 else crc >> 1
+  return crc
+
+def varint(value: int) -> bytes:
+  out = bytearray()
+  while value > 0x7F:
+    out.append((value & 0x7F) | 0x80)
+    value >>= 7
+  out.append(value)
+  return bytes(out)
+
+def read_varint(data: bytes, i: int) -> tuple[int, int]:
+  value, shift = 0, 0
+  while True:
+    byte = data[i]
+    i += 1
+    value |= (byte & 0x7F) << shift
+    if not byte & 0x80: return value, i
+    shift += 7
+
+def encode_request(seq: int, argv: list[str]) -> bytes:
+  payload = b'\x08' + varint(seq)
+  for arg in argv:
+    raw = arg.encode()
+    payload += b'\x12' + varint(len(raw)) + raw
+  head = len(payload).to_bytes(2, 'little') + payload
+  return bytes([SYNC]) + head + crc16_modbus(head).to_bytes(2, 'little')
+
+def decode_response(payload: bytes) -> dict:
+  msg = {'seq': 0, 'status': 0, 'output': b''}
+  i = 0
+  while i < len(payload):
+    key, i = read_varint(payload, i)
+    tag, wire = key >> 3, key & 7
+    if wire == 0:
+      value, i = read_varint(payload, i)
+      if tag == 1: msg['seq'] = value
+      elif tag == 2: msg['status'] = value
+    elif wire == 2:
+      size, i = read_varint(payload, i)
+      if tag == 3: msg['output'] = payload[i:i + size]
+      i += size
+    else: raise ValueError(f"Unsupported wire type {wire}")
+  return msg
+
+class Rpc:
+  def __init__(self, port: str, baud: int = 115200, timeout: float = 1.0):
+    self.serial = serial.Serial(port, baud, timeout=timeout)
+    self.seq = 0
+    self.buffer = bytearray()
+
+  def close(self):
+    self.serial.close()
+
+  def _frame(self) -> bytes | None:
+    """Extract next valid frame payload, text and broken frames in between are skipped"""
+    while True:
+      start = self.buffer.find(SYNC)
+      if start < 0:
+        self.buffer.clear()
+        return None
+      del self.buffer[:start]
+      if len(self.buffer) < 3: return None
+      size = int.from_bytes(self.buffer[1:3], 'little')
+      if len(self.buffer) < size + 5: return None
+      frame = bytes(self.buffer[:size + 5])
+      if crc16_modbus(frame[1:size + 3]) == int.from_bytes(frame[size + 3:], 'little'):
+        del self.buffer[:size + 5]
+        return frame[3:size + 3]
+      del self.buffer[:1]
+
+  def call(self, *argv: str) -> tuple[str, str]:
+    self.seq = (self.seq + 1) & 0xFFFFFFFF
+    self.serial.write(encode_request(self.seq, list(argv)))
+    end = time.monotonic() + self.serial.timeout
+    while time.monotonic() < end:
+      payload = self._frame()
+      if payload is not None:
+        msg = decode_response(payload)
+        if msg['seq'] == self.seq:
+          return STATUS.get(msg['status'], str(msg['status'])), msg['output'].decode(errors='replace')
+        continue
+      self.buffer += self.serial.read(max(1, self.serial.in_waiting))
+    raise TimeoutError(f"No response for {' '.join(argv)}")
+
+def bench(rpc: Rpc, count: int, argv: list[str]):
+  start = time.perf_counter()
+  for _ in range(count): rpc.call(*argv)
+  elapsed = time.perf_counter() - start
+  print(f"{count} requests in {elapsed:.3f}s: {count / elapsed:.1f} req/s, {elapsed / count * 1000:.2f} ms/req")
+
+def main():
+  args = sys.argv[1:]
+  if len(args) < 2:
+    print(f"Usage: {sys.argv[0]} <port> [baud] [--bench <count>] <command...>")
+    sys.exit(1)
+  port = args.pop(0)
+  baud = int(args.pop(0)) if args[0].isdigit() else 115200
+  rpc = Rpc(port, baud)
+  if args[0] == '--bench':
+    bench(rpc, int(args[1]), args[2:])
+  else:
+    status, output = rpc.call(*args)
+    print(f"[{status}] {output}", end='')
+  rpc.close()
+
+if __name__ == '__main__':
+  main()
@@ -1,16 +1,160 @@
 // lib/sh/stream.c
 
 #include "stream.h"
+#if(STREAM_RPC)
+  #include "pb_decode.h"
+  #include "pb_encode.h"
+#endif
+
+//------------------------------------------------------------------------------------------------- RPC
+
+#if(STREAM_RPC)
+
+#define STREAM_RPC_HEAD 3 // sync + length:u16le
+
+// Decode request frame into `_argv`, strings are moved to front of payload in place.
+// Returns `argc`, `0` on bad frame.
+static uint16_t STREAM_RpcRead(STREAM_t *stream, uint8_t *frame, uint16_t length, char ***argv)
+{
+  uint8_t crc_size = STREAM_RPC_CRC.width / 8;
+  if(length < STREAM_RPC_HEAD + crc_size) return 0;
+  uint16_t size = frame[1] | ((uint16_t)frame[2] << 8);
+  if(size + STREAM_RPC_HEAD + crc_size != length) return 0;
+  if(CRC_Error(&STREAM_RPC_CRC, &frame[1], length - 1)) return 0;
+  uint8_t *payload = &frame[STREAM_RPC_HEAD];
+  // String with terminator is shorter than its field (tag + length + string),
+  // so `text` stays behind read position
+  char *text = (char *)payload;
+  uint16_t argc = 0;
+  uint32_t seq = 0;
+  pb_istream_t is = pb_istream_from_buffer(payload, size);
+  pb_wire_type_t wire_type;
+  uint32_t tag;
+  bool eof;
+  while(pb_decode_tag(&is, &wire_type, &tag, &eof)) {
+    if(tag == 1 && wire_type == PB_WT_VARINT) {
+      if(!pb_decode_varint32(&is, &seq)) return 0;
+    }
+    else if(tag == 2 && wire_type == PB_WT_STRING) {
+      uint32_t len;
+      if(!pb_decode_varint32(&is, &len) || len > is.bytes_left || argc >= STREAM_ARGC_LIMIT) return 0;
+      memmove(text, is.state, len);
+      if(!pb_read(&is, NULL, len)) return 0;
+      text[len] = 0;
+      stream->_argv[argc] = text;
+      stream->_hash[argc++] = hash_djb2_ci(text);
+      text += len + 1;
+    }
+    else if(!pb_skip_field(&is, wire_type)) return 0;
+  }
+  if(!eof || !argc) return 0;
+  stream->_rpc = true;
+  stream->_rpc_seq = seq;
+  stream->_rpc_mark = DbgFile->size;
+  stream->_rpc_flushes = DbgFlushes;
+  *argv = stream->_argv;
+  return argc;
+}
+
+void STREAM_RpcReply(STREAM_t *stream, STREAM_RpcStatus_t status)
+{
+  stream->_rpc = false;
+  // `DbgFile` flushed or cleared by handler: output before mark is gone,
+  // handler output written before flush went out as plain text
+  if(DbgFlushes != stream->_rpc_flushes || DbgFile->size < stream->_rpc_mark) {
+    stream->_rpc_mark = 0;
+    status = STREAM_RpcStatus_Overflow;
+  }
+  uint8_t crc_size = STREAM_RPC_CRC.width / 8;
+  uint8_t *start = &DbgFile->buffer[stream->_rpc_mark];
+  uint16_t output = DbgFile->size - stream->_rpc_mark;
+  uint8_t head[STREAM_RPC_HEAD + 18];
+  uint16_t space = DbgFile->limit - DbgFile->size;
+  pb_ostream_t os;
+  while(1) {
+    os = pb_ostream_from_buffer(&head[STREAM_RPC_HEAD], sizeof(head) - STREAM_RPC_HEAD);
+    pb_encode_tag(&os, PB_WT_VARINT, 1);
+    pb_encode_varint(&os, stream->_rpc_seq);
+    pb_encode_tag(&os, PB_WT_VARINT, 2);
+    pb_encode_varint(&os, status);
+    pb_encode_tag(&os, PB_WT_STRING, 3);
+    pb_encode_varint(&os, output);
+    if(STREAM_RPC_HEAD + os.bytes_written + crc_size <= space) break;
+    // Not enough space in `DbgFile`: cut output, keep response valid
+    uint16_t over = STREAM_RPC_HEAD + os.bytes_written + crc_size - space;
+    if(over > output) {
+      // Empty response must still go out (client waits for it): drop output,
+      // then, if even that does not fit, earlier pending output before mark
+      if(output) DbgFile->size = stream->_rpc_mark;
+      else {
+        stream->_rpc_mark = 0;
+        start = DbgFile->buffer;
+        DbgFile->size = 0;
+      }
+      output = 0;
+      space = DbgFile->limit - DbgFile->size;
+      status = STREAM_RpcStatus_Overflow;
+      continue;
+    }
+    output -= over;
+    space += over;
+    DbgFile->size -= over;
+    status = STREAM_RpcStatus_Overflow;
+  }
+  uint16_t size = os.bytes_written + output;
+  head[0] = STREAM_RPC_SYNC;
+  head[1] = (uint8_t)size;
+  head[2] = (uint8_t)(size >> 8);
+  uint16_t head_size = STREAM_RPC_HEAD + os.bytes_written;
+  memmove(&start[head_size], start, output);
+  memcpy(start, head, head_size);
+  DbgFile->size = stream->_rpc_mark + CRC_Append(&STREAM_RPC_CRC, &start[1], head_size - 1 + output) + 1;
+}
+
+#endif
 
 //-------------------------------------------------------------------------------------------------
 
+// Split `line` into `_argv` in place: separators and closing quotes become terminators,
+// letters are case-modified and arguments hashed (as `hash_djb2_ci`) in the same pass.
+// When last argument reaches `end`, its terminator goes to `line[length]` (see `STREAM_Read`).
+static uint16_t STREAM_Split(STREAM_t *stream, char *line, uint16_t length)
+{
+  char *end = line + length;
+  uint16_t argc = 0;
+  while(argc < STREAM_ARGC_LIMIT) {
+    while(line < end && (uint8_t)*line <= ' ') line++;
+    if(line >= end) break;
+    char quote = 0;
+    if(*line == '"' || *line == '\'') quote = *line++;
+    char *arg = line;
+    uint32_t hash = 5381;
+    while(line < end) {
+      uint8_t c = (uint8_t)*line;
+      if(quote ? (c == (uint8_t)quote || c < ' ') : c <= ' ') break;
+      if(!quote) {
+        if(stream->modify == STREAM_Modify_Lowercase) *line = LowerCase[c];
+        else if(stream->modify == STREAM_Modify_Uppercase) *line = UpperCase[c];
+      }
+      hash = ((hash << 5) + hash) + (uint8_t)LowerCase[c];
+      line++;
+    }
+    *line++ = 0;
+    stream->_argv[argc] = arg;
+    stream->_hash[argc++] = hash;
+  }
+  return argc;
+}
+
 uint16_t STREAM_Read(STREAM_t *stream, char ***argv)
 {
+  if(stream->Release) stream->Release();
   if(stream->file) DBG_SetFile(stream->file);
   else DBG_DefaultFile();
   uint16_t length = stream->Size();
   if(length) {
     char *buffer = stream->Read();
+    if(!buffer) return 0;
     #if(STREAM_ADDRESS)
     uint8_t address = *buffer;
     if(address != stream->address) return 0;
@@ -21,26 +165,26 @@ uint16_t STREAM_Read(STREAM_t *stream, char ***argv)
       if(CRC_Error(stream->crc, buffer, length)) return 0;
       length -= stream->crc->width / 8;
     #endif
+    *argv = stream->_argv;
     if(stream->_data_mode) {
-      char **file;
-      char *loc;
-      file = heap_new(sizeof(char *) + (length * sizeof(char)));
-      loc = (char *)file + sizeof(char *);
-      memcpy(loc, buffer, length);
-      file[0] = loc;
-      *argv = file;
+      stream->_argv[0] = buffer;
       return length;
     }
     else {
-      buffer = str_trim(buffer);
-      int argc = str_explode(argv, buffer, ' ');
-      if(stream->modify == STREAM_Modify_Lowercase || stream->modify == STREAM_Modify_Uppercase) {
-        for(int i = 0; i < argc; i++) {
-          if(stream->modify == STREAM_Modify_Lowercase) str_lower_this((*argv)[i]);
-          else if(stream->modify == STREAM_Modify_Uppercase) str_upper_this((*argv)[i]);
+      #if(STREAM_RPC)
+        if((uint8_t)*buffer == STREAM_RPC_SYNC) return STREAM_RpcRead(stream, (uint8_t *)buffer, length, argv);
+      #endif
+      #if(!STREAM_CRC)
+        // Terminator byte after `length` is outside message: line without trailing
+        // whitespace (console line ends with `\n`) is split on copy with one spare byte
+        if(length && (uint8_t)buffer[length - 1] > ' ') {
+          char *line = heap_new(length + 1);
+          if(!line) return 0;
+          memcpy(line, buffer, length);
+          buffer = line;
         }
-      }
-      return (uint8_t)argc;
+      #endif
+      return STREAM_Split(stream, buffer, length);
     }
   }
   return 0;
@@ -14,6 +14,26 @@
   #define STREAM_CRC OFF
 #endif
 
+#ifndef STREAM_ARGC_LIMIT
+  // Max arguments in command line (further words are ignored)
+  #define STREAM_ARGC_LIMIT 16
+#endif
+
+#ifndef STREAM_RPC
+  // Binary protobuf request/response frames next to text commands
+  #define STREAM_RPC OFF
+#endif
+
+#ifndef STREAM_RPC_SYNC
+  // First byte of RPC frame (never present in text commands)
+  #define STREAM_RPC_SYNC 0xB5
+#endif
+
+#ifndef STREAM_RPC_CRC
+  // CRC of RPC frame, computed over length and payload
+  #define STREAM_RPC_CRC crc16_modbus
+#endif
+
 //-------------------------------------------------------------------------------------------------
 
 typedef enum {
@@ -26,7 +46,9 @@ typedef enum {
  * @brief Stream interface for command processing.
  * @param[in] name Stream identifier
  * @param[in] modify Case modification mode
- * @param[in] Read Read string from stream
+ * @param[in] Read Read message from stream (split in place when it ends with whitespace,
+ *   as console line ending with `\n`, or with CRC)
+ * @param[in] Release Release message returned by `Read` (`NULL` = `Read` gives copy)
  * @param[in] Size Get available data size
  * @param[in] Send Send data callback
  * @param[in] SwitchMode Switch between data/args mode
@@ -34,11 +56,21 @@ typedef enum {
  * @param[in] address Stream address (when `STREAM_ADDRESS` enabled)
  * @param[in] Readdress Address change callback
  * @param[in] crc CRC configuration (when `STREAM_CRC` enabled)
+ * Internal:
+ * @param _data_mode Data mode: message is passed as single binary argument
+ * @param _packages Data packages left in data mode
+ * @param _argv Arguments of last message (point into message)
+ * @param _hash Case-insensitive hash of each argument (`hash_djb2_ci`)
+ * @param _rpc Last message was RPC request, response is pending
+ * @param _rpc_seq Sequence number of RPC request
+ * @param _rpc_mark `DbgFile` size before handler output
+ * @param _rpc_flushes `DbgFlushes` when `_rpc_mark` was set
  */
 typedef struct {
   const char *name;
   STREAM_Modify_t modify;
   char *(*Read)(void);
+  void (*Release)(void);
   uint16_t (*Size)(void);
   void (*Send)(uint8_t *, uint16_t);
   void (*SwitchMode)(bool);
@@ -53,18 +85,55 @@ typedef struct {
   // internal
   bool _data_mode;
   uint16_t _packages;
+  char *_argv[STREAM_ARGC_LIMIT];
+  uint32_t _hash[STREAM_ARGC_LIMIT];
+  #if(STREAM_RPC)
+    bool _rpc;
+    uint32_t _rpc_seq;
+    uint16_t _rpc_mark;
+    uint16_t _rpc_flushes;
+  #endif
 } STREAM_t;
 
+#if(STREAM_RPC)
+typedef enum {
+  STREAM_RpcStatus_Ok = 0,
+  STREAM_RpcStatus_NotFound = 1,
+  STREAM_RpcStatus_Overflow = 2
+} STREAM_RpcStatus_t;
+#endif
+
 //-------------------------------------------------------------------------------------------------
 
 /**
  * @brief Read and parse data from stream.
+ * Message is split into `_argv` in place in one pass: whitespace separates arguments,
+ * `"` or `'` quotes keep spaces and letter case, case modification and `_hash` are done
+ * on the way. Arguments stay valid until next `STREAM_Read`. Nothing is allocated,
+ * except copy of line that ends without whitespace (no byte for last terminator).
+ * With `STREAM_RPC`, message starting with `STREAM_RPC_SYNC` is decoded
+ * as binary request (see `STREAM_RpcReply`) and `_rpc` flag is set.
  * @param[in,out] stream Stream instance
  * @param[out] argv Pointer to argument array
- * @return Argument count or data length in data mode
+ * @return Argument count or data length in data mode (`argv[0]` points to data)
  */
 uint16_t STREAM_Read(STREAM_t *stream, char ***argv);
 
+#if(STREAM_RPC)
+/**
+ * @brief Wrap handler output as RPC response frame.
+ * Call after handler when `_rpc` is set. Everything written to `DbgFile`
+ * since `STREAM_Read` becomes `output` of the response. Response is always sent:
+ * output cut to fit `DbgFile` (or partly flushed by handler) gives `STREAM_RpcStatus_Overflow`.
+ * Frame: `SYNC` | `length:u16le` | `payload` | `CRC(length+payload)`
+ * Request payload: `uint32 seq = 1; repeated string argv = 2;`
+ * Response payload: `uint32 seq = 1; uint32 status = 2; bytes output = 3;`
+ * @param[in,out] stream Stream instance
+ * @param[in] status Response status
+ */
+void STREAM_RpcReply(STREAM_t *stream, STREAM_RpcStatus_t status);
+#endif
+
 /**
  * @brief Switch stream to binary data mode.
  * @param[in,out] stream Stream instance
@@ -0,0 +1,126 @@
+// lib/sys/cycle.c
+
+#include "cycle.h"
+#include "cmd.h"
+
+//-------------------------------------------------------------------------------------- Internal
+
+static CYCLE_t *cycle_focus;
+
+// Wait for start of cycle slot, yields to other threads
+static void CYCLE_Wait(CYCLE_t *cycle)
+{
+  #ifndef HOST
+    if(cycle->tim) {
+      while(!TIM_Event(cycle->tim)) let();
+      return;
+    }
+  #endif
+  if(!cycle->period_ms) {
+    let();
+    return;
+  }
+  while((int32_t)(tick_us() - cycle->_deadline) < 0) let();
+  cycle->_deadline += cycle->_period_us;
+}
+
+// Next slot already due when phases finish
+static bool CYCLE_Overrun(CYCLE_t *cycle)
+{
+  #ifndef HOST
+    if(cycle->tim) return cycle->tim->_event_cnt > 0;
+  #endif
+  if(!cycle->period_ms) return false;
+  uint32_t now = tick_us();
+  // Overrun when next slot is already due, then skip to next slot on grid
+  if((int32_t)(now - cycle->_deadline) <= 0) return false;
+  while((int32_t)(now - cycle->_deadline) > 0) cycle->_deadline += cycle->_period_us;
+  return true;
+}
+
+static void CYCLE_Stats(CYCLE_t *cycle, uint32_t start, uint32_t end)
+{
+  uint32_t time_us = end - start;
+  if(cycle->_count && cycle->_period_us && !cycle->_resync) {
+    uint32_t interval = start - cycle->_start;
+    uint32_t jitter = interval > cycle->_period_us ? interval - cycle->_period_us : cycle->_period_us - interval;
+    if(jitter > cycle->_jitter_us) cycle->_jitter_us = jitter;
+  }
+  if(!cycle->_count) cycle->_sum_us = time_us << CYCLE_AVERAGE_SHIFT;
+  else cycle->_sum_us += time_us - CYCLE_Average(cycle);
+  if(time_us < cycle->_min_us) cycle->_min_us = time_us;
+  if(time_us > cycle->_max_us) cycle->_max_us = time_us;
+  cycle->_last_us = time_us;
+  cycle->_start = start;
+  cycle->_count++;
+}
+
+//------------------------------------------------------------------------------------------ API
+
+void CYCLE_Reset(CYCLE_t *cycle)
+{
+  cycle->_last_us = 0;
+  cycle->_min_us = UINT32_MAX;
+  cycle->_max_us = 0;
+  cycle->_sum_us = 0;
+  cycle->_jitter_us = 0;
+  cycle->_count = 0;
+  cycle->_overrun = 0;
+  cycle->_resync = false;
+}
+
+void CYCLE_Init(CYCLE_t *cycle)
+{
+  CYCLE_Reset(cycle);
+  cycle->_deadline = tick_us();
+  cycle->_period_us = (uint32_t)cycle->period_ms * 1000;
+  #ifndef HOST
+    if(cycle->tim) {
+      TIM_t *tim = cycle->tim;
+      cycle->_period_us = (uint32_t)((uint64_t)tim->prescaler * (tim->auto_reload + 1) * 1000000 / SystemCoreClock);
+      TIM_Event(tim);
+    }
+  #endif
+  cycle_focus = cycle;
+}
+
+bool CYCLE_Run(CYCLE_t *cycle)
+{
+  CYCLE_Wait(cycle);
+  uint32_t start = tick_us();
+  if(cycle->Input) cycle->Input(cycle->arg);
+  if(cycle->Logic) cycle->Logic(cycle->arg);
+  if(cycle->Output) cycle->Output(cycle->arg);
+  CYCLE_Stats(cycle, start, tick_us());
+  cycle->_resync = CYCLE_Overrun(cycle);
+  if(cycle->_resync) cycle->_overrun++;
+  return cycle->_resync;
+}
+
+void CYCLE_Loop(CYCLE_t *cycle)
+{
+  while(1) CYCLE_Run(cycle);
+}
+
+//----------------------------------------------------------------------------------------- Bash
+
+void CYCLE_Print(CYCLE_t *cycle)
+{
+  LOG_Bash("CYCLE period:%uus count:%u last:%uus min:%uus avg:%uus max:%uus jitter:%uus overrun:%u",
+    cycle->_period_us, cycle->_count, cycle->_last_us, cycle->_count ? cycle->_min_us : 0,
+    CYCLE_Average(cycle), cycle->_max_us, cycle->_jitter_us, cycle->_overrun);
+}
+
+void CYCLE_Bash(char **argv, uint16_t argc)
+{
+  CMD_Argc(1, 2);
+  if(!cycle_focus) return;
+  if(argc == 2) {
+    uint32_t hash = hash_djb2_ci(argv[1]);
+    if(hash != HASH_Reset && hash != HASH_Rst) CMD_ArgvExit(1);
+    CYCLE_Reset(cycle_focus);
+  }
+  CYCLE_Print(cycle_focus);
+}
+
+//-------------------------------------------------------------------------------------------------
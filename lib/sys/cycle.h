@@ -0,0 +1,120 @@
+// lib/sys/cycle.h
+
+#ifndef CYCLE_H_
+#define CYCLE_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "vrts.h"
+#include "log.h"
+#include "main.h"
+#ifndef HOST
+  #include "tim.h"
+#endif
+
+//-------------------------------------------------------------------------------------------------
+
+#ifndef CYCLE_AVERAGE_SHIFT
+  // Smoothing of average cycle time: `avg += (time - avg) / 2^shift` (`4` = ~16 cycles)
+  #define CYCLE_AVERAGE_SHIFT 4
+#endif
+
+/**
+ * @brief Cyclic executor (IEC 61131-3 style scan): `Input` latches process image,
+ * `Logic` works on latched image, `Output` writes whole output image at once.
+ * Cycle starts on fixed grid, not after previous cycle, so period does not drift.
+ * Thread yields only while waiting for next cycle, phases run without `let()` in between.
+ * @param[in] period_ms Scan period `[ms]` (`0` = free-running, one `let()` per cycle).
+ * @param[in] tim Hardware timebase: cycle starts on its update event (overrides `period_ms`).
+ *   Timer must have `enable_interrupt` set.
+ * @param[in] Input Latch inputs into process image.
+ * @param[in] Logic Application logic (may be `NULL`).
+ * @param[in] Output Write output image.
+ * @param[in] arg User data passed to all phases.
+ * Internal:
+ * @param _deadline Start of next cycle `[us]` (`tick_us` timebase, compared by subtraction).
+ * @param _period_us Nominal period (`0` = free-running, no jitter tracking).
+ * @param _start Start of current cycle `[us]`.
+ * @param _last_us Execution time of last cycle.
+ * @param _min_us Shortest execution time.
+ * @param _max_us Longest execution time.
+ * @param _sum_us Average accumulator (`avg << CYCLE_AVERAGE_SHIFT`).
+ * @param _jitter_us Largest deviation of start-to-start interval from period.
+ * @param _count Cycles since last reset.
+ * @param _overrun Cycles that did not finish before next cycle start.
+ * @param _resync Previous cycle overran, next interval is not measured.
+ */
+typedef struct {
+  uint16_t period_ms;
+  #ifndef HOST
+    TIM_t *tim;
+  #endif
+  void (*Input)(void *);
+  void (*Logic)(void *);
+  void (*Output)(void *);
+  void *arg;
+  uint32_t _deadline;
+  uint32_t _period_us;
+  uint32_t _start;
+  uint32_t _last_us;
+  uint32_t _min_us;
+  uint32_t _max_us;
+  uint32_t _sum_us;
+  uint32_t _jitter_us;
+  uint32_t _count;
+  uint32_t _overrun;
+  bool _resync;
+} CYCLE_t;
+
+//-------------------------------------------------------------------------------------------------
+
+/**
+ * @brief Initialize executor, reset statistics and align first cycle to now.
+ * Last initialized executor is reported by `CYCLE_Bash`.
+ * @param[in,out] cycle Executor.
+ */
+void CYCLE_Init(CYCLE_t *cycle);
+
+/**
+ * @brief Wait for next cycle start, then run `Input`, `Logic` and `Output`.
+ * @param[in,out] cycle Executor.
+ * @return `true` if this cycle overran the period.
+ */
+bool CYCLE_Run(CYCLE_t *cycle);
+
+/**
+ * @brief Run executor forever (thread body).
+ * @param[in,out] cycle Executor.
+ */
+void CYCLE_Loop(CYCLE_t *cycle);
+
+/**
+ * @brief Reset cycle time statistics.
+ * @param[in,out] cycle Executor.
+ */
+void CYCLE_Reset(CYCLE_t *cycle);
+
+/**
+ * @brief Average execution time.
+ * @param[in] cycle Executor.
+ * @return Average `[us]`.
+ */
+static inline uint32_t CYCLE_Average(CYCLE_t *cycle)
+{
+  return cycle->_sum_us >> CYCLE_AVERAGE_SHIFT;
+}
+
+/**
+ * @brief Log cycle statistics.
+ * @param[in] cycle Executor.
+ */
+void CYCLE_Print(CYCLE_t *cycle);
+
+/**
+ * @brief Command handler: `cycle` prints statistics, `cycle reset` clears them.
+ * Register with `CMD_AddCommand("cycle", &CYCLE_Bash)`.
+ */
+void CYCLE_Bash(char **argv, uint16_t argc);
+
+//-------------------------------------------------------------------------------------------------
+#endif
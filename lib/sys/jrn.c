@@ -54,6 +54,7 @@ status_t JRN_Delete(void)
 uint32_t JRN_Select(const PDB_Query_t *query, MBB_t *mbb)
 {
   mbb->size = 0;
+  mbb->_head = 0;
   if(!mbb->limit) return 0;
   uint32_t max = mbb->limit / sizeof(JRN_t);
   uint32_t count = PDB_Select(jrn, query, mbb->buffer, max);
@@ -65,6 +66,7 @@ uint32_t JRN_Select(const PDB_Query_t *query, MBB_t *mbb)
 uint32_t JRN_SelectCode(const PDB_Query_t *query, uint16_t code, MBB_t *mbb)
 {
   mbb->size = 0;
+  mbb->_head = 0;
   if(!mbb->limit) return 0;
   PDB_Query_t q = *query;
   uint16_t code_local = code;
@@ -84,6 +86,7 @@ uint32_t JRN_Count(const PDB_Query_t *query)
 
 void JRN_GetTimestamp(MBB_t *mbb)
 {
+  if(MBB_Linearize(mbb)) return;
   JRN_t *record = (JRN_t *)mbb->buffer;
   uint32_t *ts = (uint32_t *)mbb->buffer;
   uint16_t count = mbb->size / sizeof(JRN_t);
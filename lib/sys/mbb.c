@@ -9,6 +9,7 @@ status_t MBB_Clear(MBB_t *mbb)
 {
   if(mbb->lock) return ERR;
   mbb->size = 0;
+  mbb->_head = 0;
   return OK;
 }
 
@@ -16,8 +17,10 @@ status_t MBB_Copy(MBB_t *dst, MBB_t *src)
 {
   if(dst->lock) return ERR;
   if(src->size > dst->limit) return ERR;
+  if(MBB_Linearize(src)) return ERR;
   memcpy(dst->buffer, src->buffer, src->size);
   dst->size = src->size;
+  dst->_head = 0;
   return OK;
 }
 
@@ -27,6 +30,7 @@ status_t MBB_Save(MBB_t *mbb, const uint8_t *data, uint16_t size)
   if(size > mbb->limit) return ERR;
   memcpy(mbb->buffer, data, size);
   mbb->size = size;
+  mbb->_head = 0;
   return OK;
 }
 
@@ -59,11 +63,35 @@ status_t MBB_Lock2(MBB_t *primary, MBB_t *secondary)
   return OK;
 }
 
+static void MBB_Reverse(uint8_t *data, uint16_t size)
+{
+  for(uint16_t i = 0, j = size - 1; i < j; i++, j--) {
+    uint8_t c = data[i];
+    data[i] = data[j];
+    data[j] = c;
+  }
+}
+
+// Move ring data to start of buffer (rotation by three reversals when it wraps, no extra memory)
+status_t MBB_Linearize(MBB_t *mbb)
+{
+  if(!mbb->_head) return OK;
+  if(mbb->lock) return ERR;
+  if(mbb->_head + mbb->size <= mbb->limit) memmove(mbb->buffer, &mbb->buffer[mbb->_head], mbb->size);
+  else {
+    MBB_Reverse(mbb->buffer, mbb->_head);
+    MBB_Reverse(&mbb->buffer[mbb->_head], mbb->limit - mbb->_head);
+    MBB_Reverse(mbb->buffer, mbb->limit);
+  }
+  mbb->_head = 0;
+  return OK;
+}
+
 //------------------------------------------------------------------------------------------------- str
 
 int32_t MBB_Char(MBB_t *mbb, uint8_t data)
 {
-  if(mbb->lock) return 0;
+  if(mbb->lock || MBB_Linearize(mbb)) return 0;
   if(mbb->size + 1 > mbb->limit) return 0;
   mbb->buffer[mbb->size++] = data;
   return 1;
@@ -98,7 +126,7 @@ int32_t MBB_Char64(MBB_t *mbb, uint64_t data)
 
 int32_t MBB_Data(MBB_t *mbb, const uint8_t *data, uint16_t len)
 {
-  if(mbb->lock) return 0;
+  if(mbb->lock || MBB_Linearize(mbb)) return 0;
   if(mbb->size + len > mbb->limit) return 0;
   memcpy(&mbb->buffer[mbb->size], data, len);
   mbb->size += len;
@@ -107,7 +135,7 @@ int32_t MBB_Data(MBB_t *mbb, const uint8_t *data, uint16_t len)
 
 int32_t MBB_String(MBB_t *mbb, const char *str)
 {
-  if(mbb->lock || !str) return 0;
+  if(mbb->lock || !str || MBB_Linearize(mbb)) return 0;
   uint16_t len = 0;
   while(str[len]) len++;
   if(mbb->size + len > mbb->limit) return 0;
@@ -127,7 +155,7 @@ int32_t MBB_Enter(MBB_t *mbb)
 
 int32_t MBB_DropLastLine(MBB_t *mbb)
 {
-  if(mbb->lock || mbb->size == 0) return 0;
+  if(mbb->lock || mbb->size == 0 || MBB_Linearize(mbb)) return 0;
   int32_t len = 0;
   bool found = false;
   for(int32_t i = mbb->size - 1; i >= 0; i--) {
@@ -152,54 +180,40 @@ int32_t MBB_Bool(MBB_t *mbb, bool value)
 
 //------------------------------------------------------------------------------------------------- nbr
 
+// Formatted number with left space padding, written only if all of it fits
+static int32_t MBB_Number(MBB_t *mbb, const char *str, uint8_t len, uint8_t fill_space)
+{
+  if(MBB_Linearize(mbb)) return 0;
+  uint8_t pad = fill_space > len ? fill_space - len : 0;
+  if(mbb->size + pad + len > mbb->limit) return 0;
+  memset(&mbb->buffer[mbb->size], ' ', pad);
+  memcpy(&mbb->buffer[mbb->size + pad], str, len);
+  mbb->size += pad + len;
+  return pad + len;
+}
+
 int32_t MBB_Int(MBB_t *mbb, int64_t nbr, uint8_t base, bool sign, uint8_t fill_zero, uint8_t fill_space)
 {
   if(mbb->lock) return 0;
-  int32_t len = (int32_t)itoa_encode(nbr, StrTempMem, base, sign, fill_zero, fill_space);
-  if(mbb->size + len > mbb->limit) return 0;
-  int32_t n = len;
-  while(n) {
-    n--;
-    mbb->buffer[mbb->size++] = StrTempMem[n];
-  }
-  return len;
+  char str[STR_NUMBER_SIZE];
+  uint8_t len = str_format_int(str, nbr, base, sign, fill_zero);
+  if(!len) return 0;
+  return MBB_Number(mbb, str, len, fill_space);
 }
 
 int32_t MBB_Float(MBB_t *mbb, float nbr, uint8_t accuracy, uint8_t fill_space)
 {
   if(mbb->lock) return 0;
+  char str[STR_NUMBER_SIZE];
+  uint8_t len = str_format_float(str, nbr, accuracy);
+  if(len) return MBB_Number(mbb, str, len, fill_space);
+  // NaN or Inf
   #if(MBB_PRINT_NAN_INF)
-    if(isnan(nbr)) {
-      const char *txt = "NaN";
-      uint8_t len = 3;
-      while(fill_space > len) { MBB_Char(mbb, ' '); fill_space--; }
-      return MBB_String(mbb, txt);
-    }
-    else if(isinf(nbr)) {
-      const char *txt = signbit(nbr) ? "-Inf" : "Inf";
-      uint8_t len = signbit(nbr) ? 4 : 3;
-      while(fill_space > len) { MBB_Char(mbb, ' '); fill_space--; }
-      return MBB_String(mbb, txt);
-    }
+    if(isnan(nbr)) return MBB_Number(mbb, "NaN", 3, fill_space);
+    return signbit(nbr) ? MBB_Number(mbb, "-Inf", 4, fill_space) : MBB_Number(mbb, "Inf", 3, fill_space);
   #else
-    if(isnan(nbr) || isinf(nbr)) {
-      uint8_t len = fill_space > 1 ? fill_space : 1;
-      while(len > 1) { MBB_Char(mbb, ' '); len--; }
-      return MBB_Char(mbb, '-');
-    }
+    return MBB_Number(mbb, "-", 1, fill_space);
   #endif
-  for(uint16_t i = 0; i < accuracy; i++) nbr *= 10;
-  if(!fill_space) fill_space = 1;
-  int32_t length = (int32_t)itoa_encode((int32_t)nbr, StrTempMem, 10, true, nbr < 0 ? accuracy + 2 : accuracy + 1, fill_space - 1);
-  int32_t n = length + (accuracy ? 1 : 0);
-  if(mbb->size + n > mbb->limit) return 0;
-  while(length) {
-    if(accuracy && length == accuracy) {
-      mbb->buffer[mbb->size++] = '.';
-    }
-    mbb->buffer[mbb->size++] = StrTempMem[--length];
-  }
-  return n;
 }
 
 int32_t MBB_Dec(MBB_t *mbb, int64_t nbr)
@@ -239,11 +253,18 @@ int32_t MBB_Nbr(MBB_t *mbb, float nbr)
 
 //------------------------------------------------------------------------------------------------- struct
 
+// Position of data byte in buffer (wraps around `limit` in ring mode)
+static inline uint16_t MBB_Pos(const MBB_t *mbb, uint32_t offset)
+{
+  offset += mbb->_head;
+  return offset >= mbb->limit ? offset - mbb->limit : offset;
+}
+
 int32_t MBB_StructAdd(MBB_t *mbb, const uint8_t *object)
 {
   if(mbb->lock) return 0;
   if(mbb->size + mbb->struct_size > mbb->limit) return 0;
-  memcpy(&mbb->buffer[mbb->size], object, mbb->struct_size);
+  memcpy(&mbb->buffer[MBB_Pos(mbb, mbb->size)], object, mbb->struct_size);
   mbb->size += mbb->struct_size;
   return mbb->struct_size;
 }
@@ -265,12 +286,14 @@ int32_t MBB_StructShift(MBB_t *mbb, uint16_t count)
   int32_t shift_bytes = mbb->struct_size * count;
   int32_t remaining = (int32_t)mbb->size - shift_bytes;
   if(remaining > 0) {
-    memcpy(mbb->buffer, &mbb->buffer[shift_bytes], (size_t)remaining);
+    if(mbb->ring) mbb->_head = MBB_Pos(mbb, shift_bytes);
+    else memmove(mbb->buffer, &mbb->buffer[shift_bytes], (size_t)remaining);
     mbb->size = remaining;
     return -shift_bytes;
   }
   int32_t dropped = mbb->size;
   mbb->size = 0;
+  mbb->_head = 0;
   return -(int32_t)dropped;
 }
 
@@ -279,9 +302,10 @@ int32_t MBB_StructDrop(MBB_t *mbb, uint16_t count)
   if(mbb->lock) return 0;
   if(!count) return 0;
   int32_t size = mbb->struct_size * count;
-  if(size > mbb->size) {
+  if(size >= mbb->size) {
     size = mbb->size;
     mbb->size = 0;
+    mbb->_head = 0;
   }
   else {
     mbb->size -= size;
@@ -293,7 +317,7 @@ int32_t MBB_StructGet(const MBB_t *mbb, uint16_t index, uint8_t *dst)
 {
   uint32_t pos = index * mbb->struct_size;
   if(pos + mbb->struct_size > mbb->size) return 0;
-  memcpy(dst, &mbb->buffer[pos], mbb->struct_size);
+  memcpy(dst, &mbb->buffer[MBB_Pos(mbb, pos)], mbb->struct_size);
   return mbb->struct_size;
 }
 
@@ -301,7 +325,20 @@ const uint8_t *MBB_StructPeek(const MBB_t *mbb, uint16_t index)
 {
   uint32_t pos = index * mbb->struct_size;
   if(pos + mbb->struct_size > mbb->size) return NULL;
-  return &mbb->buffer[pos];
+  return &mbb->buffer[MBB_Pos(mbb, pos)];
+}
+
+// Contiguous structs from `index` (up to end of data or ring wrap), at most two spans cover all:
+// `for(uint16_t i = 0, n; (n = MBB_StructSpan(mbb, i, &data)); i += n) { ... }`
+uint16_t MBB_StructSpan(const MBB_t *mbb, uint16_t index, const uint8_t **data)
+{
+  uint32_t pos = index * mbb->struct_size;
+  if(pos + mbb->struct_size > mbb->size) return 0;
+  uint16_t start = MBB_Pos(mbb, pos);
+  uint32_t bytes = mbb->size - pos;
+  if(start + bytes > mbb->limit) bytes = mbb->limit - start;
+  *data = &mbb->buffer[start];
+  return bytes / mbb->struct_size;
 }
 
 //------------------------------------------------------------------------------------------------- offset
@@ -319,7 +356,7 @@ status_t MBB_OffsetRst(MBB_t *mbb)
 
 status_t MBB_OffsetSet(MBB_t *mbb, uint16_t offset)
 {
-  if(MBB_OffsetRst(mbb)) return ERR;
+  if(mbb->ring || MBB_OffsetRst(mbb)) return ERR;
   if(offset > mbb->limit) return ERR;
   mbb->buffer = mbb->_base + offset;
   mbb->limit -= offset;
@@ -333,7 +370,7 @@ status_t MBB_OffsetSet(MBB_t *mbb, uint16_t offset)
 
 status_t MBB_FlashSave(MBB_t *mbb)
 {
-  if(!mbb->flash_page) return ERR;
+  if(!mbb->flash_page || MBB_Linearize(mbb)) return ERR;
   if(FLASH_Compare(mbb->flash_page, mbb->buffer, mbb->size)) {
     return OK;
   }
@@ -348,6 +385,7 @@ status_t MBB_FlashLoad(MBB_t *mbb)
   if(mbb->lock) return ERR;
   if(!mbb->flash_page) return ERR;
   mbb->size = FLASH_Load(mbb->flash_page, mbb->buffer);
+  mbb->_head = 0;
   return mbb->size ? OK : ERR;
 }
 
@@ -444,6 +482,7 @@ int32_t MBB_Alarm(MBB_t *mbb, const RTC_AlarmCfg_t *alarm)
 
 int32_t MBB_CrcAppend(MBB_t *mbb, const CRC_t *crc)
 {
+  if(MBB_Linearize(mbb)) return 0;
   if(mbb->limit - mbb->size < crc->width / 8) return 0;
   mbb->size = CRC_Append(crc, mbb->buffer, mbb->size);
   return crc->width / 8;
@@ -451,6 +490,7 @@ int32_t MBB_CrcAppend(MBB_t *mbb, const CRC_t *crc)
 
 bool MBB_CrcError(MBB_t *mbb, const CRC_t *crc)
 {
+  if(MBB_Linearize(mbb)) return true;
   if(mbb->size < crc->width / 8) return true;
   if(CRC_Error(crc, mbb->buffer, mbb->size)) return true;
   mbb->size -= crc->width / 8;
@@ -470,11 +510,13 @@ bool MBB_FileLoad(const char *name, MBB_t *mbb)
   memcpy(mbb->buffer, bytes, size);
   free(bytes);
   mbb->size = size;
+  mbb->_head = 0;
   return true;
 }
 
 bool MBB_FileSave(const char *name, MBB_t *mbb)
 {
+  if(MBB_Linearize(mbb)) return false;
   return file_save(name, mbb->buffer, mbb->size);
 }
 
@@ -23,67 +23,89 @@
 
 //-------------------------------------------------------------------------------------------------
 
-#define MBB_Init2(name, size) \
-  static uint8_t name##_buffer[size]; \
-  MBB_t name = { \
-    .name = #name, \
-    .buffer = name##_buffer, \
+#define MBB_Init2(var, size) \
+  static uint8_t var##_buffer[size]; \
+  MBB_t var = { \
+    .name = #var, \
+    .buffer = var##_buffer, \
     .limit = (size), \
-    ._base = name##_buffer \
+    ._base = var##_buffer \
   }
 
-#define MBB_Init3(name, size, flash_page) \
-  static uint8_t name##_buffer[size]; \
-  MBB_t name = { \
-    .name = #name, \
-    .buffer = name##_buffer, \
+#define MBB_Init3(var, size, page) \
+  static uint8_t var##_buffer[size]; \
+  MBB_t var = { \
+    .name = #var, \
+    .buffer = var##_buffer, \
     .limit = (size), \
-    .flash_page = (flash_page), \
-    ._base = name##_buffer \
+    .flash_page = (page), \
+    ._base = var##_buffer \
   }
 
-#define MBB_Init4(name, size, struct_size, StructPrint) \
-  static uint8_t name##_buffer[size]; \
-  MBB_t name = { \
-    .name = #name, \
-    .buffer = name##_buffer, \
+#define MBB_Init4(var, size, ssize, Print) \
+  static uint8_t var##_buffer[size]; \
+  MBB_t var = { \
+    .name = #var, \
+    .buffer = var##_buffer, \
     .limit = (size), \
-    .struct_size = (struct_size), \
-    .StructPrint = (StructPrint), \
-    ._base = name##_buffer \
+    .struct_size = (ssize), \
+    .StructPrint = (Print), \
+    ._base = var##_buffer \
   }
 
-#define MBB_Init5(name, size, flash_page, struct_size, StructPrint) \
-  static uint8_t name##_buffer[size]; \
-  MBB_t name = { \
-    .name = #name, \
-    .buffer = name##_buffer, \
+#define MBB_Init5(var, size, page, ssize, Print) \
+  static uint8_t var##_buffer[size]; \
+  MBB_t var = { \
+    .name = #var, \
+    .buffer = var##_buffer, \
     .limit = (size), \
-    .flash_page = (flash_page), \
-    .struct_size = (struct_size), \
-    .StructPrint = (StructPrint), \
-    ._base = name##_buffer \
+    .flash_page = (page), \
+    .struct_size = (ssize), \
+    .StructPrint = (Print), \
+    ._base = var##_buffer \
+  }
+
+// Ring mode limit is cut to whole structs, so struct never wraps around buffer end
+#define MBB_Init6(var, size, page, ssize, Print, is_ring) \
+  static uint8_t var##_buffer[size]; \
+  MBB_t var = { \
+    .name = #var, \
+    .buffer = var##_buffer, \
+    .limit = (is_ring) ? (size) - (size) % (ssize) : (size), \
+    .flash_page = (page), \
+    .struct_size = (ssize), \
+    .StructPrint = (Print), \
+    .ring = (is_ring), \
+    ._base = var##_buffer \
   }
 
 /**
  * @brief Statically define MBB_t with internal buffer.
- * @param name Variable name (also used as MBB_t::name)
+ * @param var Variable name (also used as MBB_t::name)
  * @param size Buffer capacity in bytes
- * @param ... Optional: flash_page, struct_size, StructPrint
+ * @param ... Optional: flash_page, struct_size, StructPrint, ring
+ * Example: `MBB_Init(telemetry, 2048, 0, sizeof(Sample_t), NULL, true);` (struct FIFO)
  */
 #define MBB_Init(...) \
-  _args5(__VA_ARGS__, MBB_Init5, MBB_Init4, MBB_Init3, MBB_Init2)(__VA_ARGS__)
+  _args6(__VA_ARGS__, MBB_Init6, MBB_Init5, MBB_Init4, MBB_Init3, MBB_Init2)(__VA_ARGS__)
 
 /**
  * @brief Memory byte buffer control structure.
  * @param name Logical name (for shell/debug)
  * @param buffer Pointer to RAM buffer
  * @param size Current data size
- * @param limit Max buffer capacity
+ * @param limit Max buffer capacity (ring mode: multiple of `struct_size`)
  * @param flash_page Flash page for persistence (0 = disabled)
  * @param struct_size Size of stored struct (0 = raw mode)
  * @param StructPrint Print callback for struct display
  * @param lock Mutex flag
+ * @param ring Ring mode of struct FIFO: `MBB_StructShift` only advances `_head`, structs stay
+ *   in place. Data starts at `buffer + _head` and may wrap around `limit`. Byte functions and
+ *   save functions call `MBB_Linearize` first, direct use of `buffer` needs it too.
+ * Internal:
+ * @param _base Buffer start (without `MBB_OffsetSet` offset)
+ * @param _offset Offset set by `MBB_OffsetSet`
+ * @param _head Start of data in `buffer` (ring mode, always 0 in linear mode)
  */
 typedef struct {
   const char *name;
@@ -94,8 +116,11 @@ typedef struct {
   uint16_t struct_size;
   int32_t (*StructPrint)(void *);
   bool lock;
+  bool ring;
+  // internal
   uint8_t *_base;
   uint16_t _offset;
+  uint16_t _head;
 } MBB_t;
 
 //-------------------------------------------------------------------------------------------------
@@ -107,6 +132,7 @@ status_t MBB_Append(MBB_t *mbb, const uint8_t *data, uint16_t size);
 status_t MBB_Lock(MBB_t *mbb);
 void MBB_Unlock(MBB_t *mbb);
 status_t MBB_Lock2(MBB_t *primary, MBB_t *secondary);
+status_t MBB_Linearize(MBB_t *mbb);
 
 int32_t MBB_Char(MBB_t *mbb, uint8_t data);
 int32_t MBB_Char16(MBB_t *mbb, uint16_t data);
@@ -135,6 +161,7 @@ int32_t MBB_StructShift(MBB_t *mbb, uint16_t count);
 int32_t MBB_StructDrop(MBB_t *mbb, uint16_t count);
 int32_t MBB_StructGet(const MBB_t *mbb, uint16_t index, uint8_t *dst);
 const uint8_t *MBB_StructPeek(const MBB_t *mbb, uint16_t index);
+uint16_t MBB_StructSpan(const MBB_t *mbb, uint16_t index, const uint8_t **data);
 
 status_t MBB_OffsetSet(MBB_t *mbb, uint16_t offset);
 status_t MBB_OffsetRst(MBB_t *mbb);
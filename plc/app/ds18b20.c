@@ -0,0 +1,97 @@
+// plc/app/ds18b20.c
+
+#include "ds18b20.h"
+#include "crc.h"
+
+//-------------------------------------------------------------------------------------------------
+
+static status_t DS18B20_Scan(DS18B20_t *ds18b20)
+{
+  uint8_t rom[8];
+  ds18b20->count = 0;
+  WIRE_SearchReset(ds18b20->wire);
+  while(ds18b20->count < ds18b20->limit && WIRE_Search(ds18b20->wire, rom)) {
+    if(rom[0] != DS18B20_FAMILY) continue;
+    if((uint8_t)CRC_Run(&crc8_maxim, rom, 7) != rom[7]) continue;
+    DS18B20_Sensor_t *sensor = &ds18b20->sensors[ds18b20->count++];
+    memcpy(sensor->rom, rom, 8);
+    sensor->temperature = NaN;
+    sensor->_errors = 0;
+  }
+  ds18b20->_rescan = false;
+  return ds18b20->count ? OK : ERR;
+}
+
+static bool DS18B20_Convert(DS18B20_t *ds18b20)
+{
+  if(ds18b20->parasite) {
+    uint8_t cmd = ONEWIRE_CMD_SKIP_ROM;
+    if(!WIRE_Transfer(ds18b20->wire, true, &cmd, 1, NULL, 0)) return false;
+    WIRE_WriteParasitePower(ds18b20->wire, DS18B20_CMD_CONVERT);
+    return true;
+  }
+  uint8_t tx[] = { ONEWIRE_CMD_SKIP_ROM, DS18B20_CMD_CONVERT };
+  return WIRE_Transfer(ds18b20->wire, true, tx, sizeof(tx), NULL, 0);
+}
+
+static void DS18B20_Read(DS18B20_t *ds18b20, DS18B20_Sensor_t *sensor)
+{
+  uint8_t tx[10] = { ONEWIRE_CMD_MATCH_ROM };
+  uint8_t rx[9];
+  memcpy(&tx[1], sensor->rom, 8);
+  tx[9] = DS18B20_CMD_READ_SCRATCHPAD;
+  if(WIRE_Transfer(ds18b20->wire, true, tx, sizeof(tx), rx, sizeof(rx)) &&
+    (uint8_t)CRC_Run(&crc8_maxim, rx, 8) == rx[8]) {
+    sensor->temperature = (float)(int16_t)((uint16_t)rx[1] << 8 | rx[0]) / 16;
+    sensor->_errors = 0;
+    return;
+  }
+  if(sensor->_errors < DS18B20_ERRORS) sensor->_errors++;
+  if(sensor->_errors >= DS18B20_ERRORS) {
+    sensor->temperature = NaN;
+    ds18b20->_rescan = true;
+  }
+}
+
+//-------------------------------------------------------------------------------------------------
+
+status_t DS18B20_Loop(DS18B20_t *ds18b20)
+{
+  switch(ds18b20->_state) {
+    case DS18B20_State_Scan:
+      if(tick_away(&ds18b20->_tick)) return BUSY;
+      if(DS18B20_Scan(ds18b20)) {
+        ds18b20->_tick = tick_keep(ds18b20->interval_ms);
+        return ERR;
+      }
+      ds18b20->_state = DS18B20_State_Convert;
+      // fall through
+    case DS18B20_State_Convert:
+      if(tick_away(&ds18b20->_tick)) return BUSY;
+      if(ds18b20->_rescan || !DS18B20_Convert(ds18b20)) {
+        ds18b20->_state = DS18B20_State_Scan;
+        return BUSY;
+      }
+      ds18b20->_tick = tick_keep(DS18B20_CONVERT_ms);
+      ds18b20->_state = DS18B20_State_Wait;
+      // fall through
+    case DS18B20_State_Wait:
+      if(tick_away(&ds18b20->_tick)) return BUSY;
+      ds18b20->_state = DS18B20_State_Read;
+      // fall through
+    case DS18B20_State_Read:
+      for(uint8_t i = 0; i < ds18b20->count; i++) DS18B20_Read(ds18b20, &ds18b20->sensors[i]);
+      ds18b20->_tick = tick_keep(ds18b20->interval_ms);
+      ds18b20->_state = DS18B20_State_Convert;
+      return OK;
+  }
+  return ERR;
+}
+
+float DS18B20_Temperature_C(DS18B20_t *ds18b20, uint8_t index)
+{
+  if(index >= ds18b20->count) return NaN;
+  return ds18b20->sensors[index].temperature;
+}
+
+//-------------------------------------------------------------------------------------------------
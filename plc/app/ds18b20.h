@@ -0,0 +1,84 @@
+// plc/app/ds18b20.h
+
+#ifndef DS18B20_H_
+#define DS18B20_H_
+
+#include <stdint.h>
+#include <string.h>
+#include <xmath.h>
+#include "one_wire.h"
+
+//-------------------------------------------------------------------------------------------------
+
+#ifndef DS18B20_CONVERT_ms
+  // Conversion time at 12-bit resolution (power-on default)
+  #define DS18B20_CONVERT_ms 750
+#endif
+
+#ifndef DS18B20_ERRORS
+  // Failed reads in row after which sensor reports `NaN` and bus is scanned again
+  #define DS18B20_ERRORS 3
+#endif
+
+#define DS18B20_FAMILY 0x28
+#define DS18B20_CMD_CONVERT 0x44
+#define DS18B20_CMD_READ_SCRATCHPAD 0xBE
+
+typedef enum {
+  DS18B20_State_Scan = 0,
+  DS18B20_State_Convert = 1,
+  DS18B20_State_Wait = 2,
+  DS18B20_State_Read = 3
+} DS18B20_State_t;
+
+typedef struct {
+  uint8_t rom[8];       // ROM code found by scan
+  float temperature;    // Last valid temperature [°C] or `NaN`
+  uint8_t _errors;      // Failed reads in row
+} DS18B20_Sensor_t;
+
+/**
+ * @brief Scheduler of DS18B20 sensors on one 1-Wire bus: search ROMs, start conversion
+ * on all sensors at once (skip ROM), wait without blocking, then read each scratchpad (match ROM).
+ * @param[in] wire 1-Wire bus
+ * @param[in] sensors Sensor table filled by scan
+ * @param[in] limit Size of `sensors`
+ * @param[in] interval_ms Time between conversion starts (`0` = back-to-back)
+ * @param[in] parasite Sensors powered from data line: strong pull-up during conversion
+ * @param[out] count Sensors found by last scan
+ * Internal:
+ * @param _state Scheduler state
+ * @param _rescan Sensor lost, scan bus before next conversion
+ * @param _tick Conversion end or next conversion start
+ */
+typedef struct {
+  WIRE_t *wire;
+  DS18B20_Sensor_t *sensors;
+  uint8_t limit;
+  uint16_t interval_ms;
+  bool parasite;
+  uint8_t count;
+  DS18B20_State_t _state;
+  bool _rescan;
+  uint64_t _tick;
+} DS18B20_t;
+
+//-------------------------------------------------------------------------------------------------
+
+/**
+ * @brief Run scheduler (call in loop). Bus transactions yield with `let()`.
+ * @param[in,out] ds18b20 Scheduler instance
+ * @return `OK` when all sensors were read, `BUSY` while waiting, `ERR` if no sensor answers
+ */
+status_t DS18B20_Loop(DS18B20_t *ds18b20);
+
+/**
+ * @brief Temperature of sensor found by scan.
+ * @param[in] ds18b20 Scheduler instance
+ * @param[in] index Sensor index (`0` to `count - 1`)
+ * @return Temperature [°C] or `NaN`
+ */
+float DS18B20_Temperature_C(DS18B20_t *ds18b20, uint8_t index);
+
+//-------------------------------------------------------------------------------------------------
+#endif
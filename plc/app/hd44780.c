@@ -12,19 +12,30 @@ static bool HD44780_ExpanderWrite(HD44780_t *hd, uint8_t data)
 
 static bool HD44780_Set4Bits(HD44780_t *hd, uint8_t value)
 {
-  if(!HD44780_ExpanderWrite(hd, value & ~HD44780_EN)) return false;
-  if(!HD44780_ExpanderWrite(hd,value | HD44780_EN)) return false;
-  if(!HD44780_ExpanderWrite(hd, value & ~HD44780_EN)) return false;
-  return true;
+  value |= hd->_backlight;
+  uint8_t buff[3] = { value & ~HD44780_EN, value | HD44780_EN, value & ~HD44780_EN };
+  return TWI_Write(hd->address, buff, sizeof(buff));
+}
+
+// Expander bytes of one display byte: each nibble is latched on falling edge of `EN`.
+// Data may change with rising edge, only `RS` needs setup byte before first nibble.
+static uint8_t *HD44780_Pack(HD44780_t *hd, uint8_t *buff, uint8_t value, uint8_t mode)
+{
+  uint8_t high = (value & 0xF0) | mode | hd->_backlight;
+  uint8_t low = ((value << 4) & 0xF0) | mode | hd->_backlight;
+  *buff++ = high | HD44780_EN;
+  *buff++ = high;
+  *buff++ = low | HD44780_EN;
+  *buff++ = low;
+  return buff;
 }
 
 static bool HD44780_Send(HD44780_t *hd, uint8_t value, uint8_t mode)
 {
-  uint8_t high = value & 0xF0;
-  uint8_t low = (value << 4) & 0xF0;
-  if(!HD44780_Set4Bits(hd, high | mode)) return false;
-  if(!HD44780_Set4Bits(hd, low | mode)) return false;
-  return true;
+  uint8_t buff[5];
+  buff[0] = mode | hd->_backlight;
+  HD44780_Pack(hd, &buff[1], value, mode);
+  return TWI_Write(hd->address, buff, sizeof(buff));
 }
 
 //-------------------------------------------------------------------------------------------------
@@ -76,6 +87,7 @@ bool HD44780_CreateChar(HD44780_t *hd, uint8_t loc, uint8_t *charmap)
 bool HD44780_Clear(HD44780_t *hd)
 {
   if(!HD44780_Command(hd, HD44780_CMD_ClearDisplay)) return false;
+  memset(hd->_shown, ' ', sizeof(hd->_shown));
   delay(2);
   return true;
 }
@@ -143,6 +155,7 @@ bool HD44780_Init(HD44780_t *hd)
   hd->_row_offsets[2] = 0x00 + hd->columns;
   hd->_row_offsets[3] = 0x40 + hd->columns;
   hd->_backlight = HD44780_Backlight_On;
+  memset(hd->frame, ' ', sizeof(hd->frame));
   if(!HD44780_Set4Bits(hd, 0x03 << 4)) return false;
   delay(4);
   if(!HD44780_Set4Bits(hd, 0x03 << 4)) return false;
@@ -239,3 +252,61 @@ bool HD44780_ExtraChars(HD44780_t *hd)
 }
 
 //-------------------------------------------------------------------------------------------------
+
+void HD44780_Print(HD44780_t *hd, const char *str, uint8_t x, uint8_t y)
+{
+  if(y >= HD44780_ROWS_MAX) return;
+  while(*str && x < HD44780_COLUMNS_MAX) hd->frame[y][x++] = *str++;
+}
+
+void HD44780_Put(HD44780_t *hd, char value, uint8_t x, uint8_t y)
+{
+  if(y >= HD44780_ROWS_MAX || x >= HD44780_COLUMNS_MAX) return;
+  hd->frame[y][x] = value;
+}
+
+void HD44780_Erase(HD44780_t *hd)
+{
+  memset(hd->frame, ' ', sizeof(hd->frame));
+}
+
+// Write framebuffer columns `start` to `end - 1` of row `y`: address command and characters in one I2C transfer
+static bool HD44780_Flush(HD44780_t *hd, uint8_t start, uint8_t end, uint8_t y)
+{
+  uint8_t buff[6 + 4 * HD44780_COLUMNS_MAX];
+  uint8_t *p = buff;
+  *p++ = hd->_backlight;
+  p = HD44780_Pack(hd, p, HD44780_CMD_SetAddrDDRAM | (start + hd->_row_offsets[y]), 0);
+  *p++ = HD44780_RS | hd->_backlight;
+  for(uint8_t x = start; x < end; x++) p = HD44780_Pack(hd, p, hd->frame[y][x], HD44780_RS);
+  if(!TWI_Write(hd->address, buff, p - buff)) return false;
+  memcpy(&hd->_shown[y][start], &hd->frame[y][start], end - start);
+  return true;
+}
+
+status_t HD44780_Loop(HD44780_t *hd)
+{
+  if(tick_away(&hd->_tick)) return BUSY;
+  hd->_tick = tick_keep(hd->refresh_ms ? hd->refresh_ms : HD44780_REFRESH_ms);
+  uint8_t rows = hd->rows < HD44780_ROWS_MAX ? hd->rows : HD44780_ROWS_MAX;
+  uint8_t columns = hd->columns < HD44780_COLUMNS_MAX ? hd->columns : HD44780_COLUMNS_MAX;
+  for(uint8_t y = 0; y < rows; y++) {
+    uint8_t x = 0;
+    while(x < columns) {
+      if(hd->frame[y][x] == hd->_shown[y][x]) {
+        x++;
+        continue;
+      }
+      // Unchanged character between two changes is resent: 4 bytes against 6 of new run
+      uint8_t end = x + 1;
+      for(uint8_t i = end; i < columns && i <= end + 1; i++) {
+        if(hd->frame[y][i] != hd->_shown[y][i]) end = i + 1;
+      }
+      if(!HD44780_Flush(hd, x, end, y)) return ERR;
+      x = end;
+    }
+  }
+  return OK;
+}
+
+//-------------------------------------------------------------------------------------------------
@@ -4,10 +4,26 @@
 #define HD44780_H_
 
 #include <stdint.h>
+#include <string.h>
 #include "twi.h"
 
 //-------------------------------------------------------------------------------------------------
 
+#ifndef HD44780_COLUMNS_MAX
+  // Framebuffer width (widest supported display, up to 40)
+  #define HD44780_COLUMNS_MAX 20
+#endif
+
+#ifndef HD44780_ROWS_MAX
+  // Framebuffer height
+  #define HD44780_ROWS_MAX 4
+#endif
+
+#ifndef HD44780_REFRESH_ms
+  // Default minimum time between framebuffer refreshes
+  #define HD44780_REFRESH_ms 100
+#endif
+
 #define HD44780_EN 0b0100
 #define HD44780_RW 0b0010
 #define HD44780_RS 0b0001
@@ -96,6 +112,10 @@ typedef struct {
   uint8_t columns;
   uint8_t rows;
   bool size5x10;
+  uint16_t refresh_ms; // Minimum time between framebuffer refreshes (`0` = `HD44780_REFRESH_ms`)
+  char frame[HD44780_ROWS_MAX][HD44780_COLUMNS_MAX]; // Framebuffer written by application
+  char _shown[HD44780_ROWS_MAX][HD44780_COLUMNS_MAX]; // Content last sent to display
+  uint64_t _tick;
   uint8_t _row_offsets[4];
   uint8_t _backlight;
   uint8_t _display;
@@ -116,5 +136,21 @@ bool HD44780_Exec(HD44780_t *hd, HD44780_Exec_t exec);
 bool HD44780_Init(HD44780_t *hd);
 bool HD44780_ExtraChars(HD44780_t *hd);
 
+/**
+ * @brief Framebuffer API: text is written to RAM and sent by `HD44780_Loop`,
+ * which compares it with content on display and writes only changed runs, each in one I2C transfer.
+ * Do not mix with direct writes (`HD44780_Str`, `HD44780_Char`) on the same area.
+ */
+void HD44780_Print(HD44780_t *hd, const char *str, uint8_t x, uint8_t y);
+void HD44780_Put(HD44780_t *hd, char value, uint8_t x, uint8_t y);
+void HD44780_Erase(HD44780_t *hd);
+
+/**
+ * @brief Send framebuffer changes, at most once per `refresh_ms` (call in loop).
+ * @param[in,out] hd Display instance
+ * @return `OK` when display matches framebuffer, `BUSY` before refresh time, `ERR` on I2C error
+ */
+status_t HD44780_Loop(HD44780_t *hd);
+
 //-------------------------------------------------------------------------------------------------
 #endif
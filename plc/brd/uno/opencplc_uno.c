@@ -15,12 +15,19 @@
   EEPROM_t eeprom_io = { .page_start = 246, .page_count = 4 };
 #endif
 
+//------------------------------------------------------------------------------------------------- SCAN
+
+// Port-wide I/O scan: one input snapshot and one output write per port and cycle
+GPIO_Scan_t scan_gpioa = { .port = GPIOA };
+GPIO_Scan_t scan_gpiob = { .port = GPIOB };
+GPIO_Scan_t scan_gpioc = { .port = GPIOC };
+
 //------------------------------------------------------------------------------------------------- DOUT-RO
 
-DOUT_t RO1 = { .name = "RO1", .relay = true, .gpio = { .port = GPIOB, .pin = 7 }, .eeprom = &eeprom_relay, .save = true };
-DOUT_t RO2 = { .name = "RO2", .relay = true, .gpio = { .port = GPIOB, .pin = 6 }, .eeprom = &eeprom_relay, .save = true };
-DOUT_t RO3 = { .name = "RO3", .relay = true, .gpio = { .port = GPIOB, .pin = 5 }, .eeprom = &eeprom_relay, .save = true };
-DOUT_t RO4 = { .name = "RO4", .relay = true, .gpio = { .port = GPIOB, .pin = 4 }, .eeprom = &eeprom_relay, .save = true };
+DOUT_t RO1 = { .name = "RO1", .relay = true, .gpio = { .port = GPIOB, .pin = 7 }, .scan = &scan_gpiob, .eeprom = &eeprom_relay, .save = true };
+DOUT_t RO2 = { .name = "RO2", .relay = true, .gpio = { .port = GPIOB, .pin = 6 }, .scan = &scan_gpiob, .eeprom = &eeprom_relay, .save = true };
+DOUT_t RO3 = { .name = "RO3", .relay = true, .gpio = { .port = GPIOB, .pin = 5 }, .scan = &scan_gpiob, .eeprom = &eeprom_relay, .save = true };
+DOUT_t RO4 = { .name = "RO4", .relay = true, .gpio = { .port = GPIOB, .pin = 4 }, .scan = &scan_gpiob, .eeprom = &eeprom_relay, .save = true };
 
 //------------------------------------------------------------------------------------------------- DOUT-TO
 
@@ -80,24 +87,56 @@ PWMI_t din_pwmi = {
   .trig4 = &din_trig4
 };
 
-DIN_t DI1 = { .name = "DI1", .pwmi = &din_pwmi, .channel = TIM_CH1, .gpif = { .gpio = { .port = GPIOA, .pin = 6, .reverse = true } }, .eeprom = &eeprom_io };
-DIN_t DI2 = { .name = "DI2", .pwmi = &din_pwmi, .channel = TIM_CH2, .gpif = { .gpio = { .port = GPIOA, .pin = 7, .reverse = true } }, .eeprom = &eeprom_io };
-DIN_t DI3 = { .name = "DI3", .pwmi = &din_pwmi, .channel = TIM_CH3, .gpif = { .gpio = { .port = GPIOB, .pin = 0, .reverse = true } }, .eeprom = &eeprom_io };
-DIN_t DI4 = { .name = "DI4", .pwmi = &din_pwmi, .channel = TIM_CH4, .gpif = { .gpio = { .port = GPIOB, .pin = 1, .reverse = true } }, .eeprom = &eeprom_io };
+DIN_t DI1 = { .name = "DI1", .pwmi = &din_pwmi, .channel = TIM_CH1, .gpif = { .gpio = { .port = GPIOA, .pin = 6, .reverse = true }, .scan = &scan_gpioa }, .eeprom = &eeprom_io };
+DIN_t DI2 = { .name = "DI2", .pwmi = &din_pwmi, .channel = TIM_CH2, .gpif = { .gpio = { .port = GPIOA, .pin = 7, .reverse = true }, .scan = &scan_gpioa }, .eeprom = &eeprom_io };
+DIN_t DI3 = { .name = "DI3", .pwmi = &din_pwmi, .channel = TIM_CH3, .gpif = { .gpio = { .port = GPIOB, .pin = 0, .reverse = true }, .scan = &scan_gpiob }, .eeprom = &eeprom_io };
+DIN_t DI4 = { .name = "DI4", .pwmi = &din_pwmi, .channel = TIM_CH4, .gpif = { .gpio = { .port = GPIOB, .pin = 1, .reverse = true }, .scan = &scan_gpiob }, .eeprom = &eeprom_io };
 
 bool din_pwmi_init = false;
 
+#if(PLC_DI_COUNTER)
+  // Inputs are inverted (`reverse`): falling pin edge is rising edge on terminal
+  CNT_t din_cnt = {
+    .reg = TIM3,
+    .mode = PLC_DI_COUNTER == 2 ? CNT_Mode_Encoder : CNT_Mode_Clock,
+    .channel[TIM_CH1] = TIM3_CH1_PA6,
+    .channel[TIM_CH2] = PLC_DI_COUNTER == 2 ? TIM3_CH2_PA7 : TIM_CHx_None,
+    .channel[TIM_CH3] = TIM3_CH3_PB0,
+    .falling = PLC_DI_COUNTER == 1,
+    .latch_falling = true,
+    .filter = TIM_Filter_FCLK_N8,
+    .irq_priority = IRQ_Priority_High
+  };
+#endif
+
 //------------------------------------------------------------------------------------------------- AIN
 
 uint8_t ain_channels[] = {
   ADC_IN_PA0, ADC_IN_PA1, ADC_IN_PA5, ADC_IN_PB10
 };
 
-#define AIN_BUFFER_SIZE adc_record_buffer_size(AIN_AVERAGE_TIME_ms, 160, 64, sizeof(ain_channels))
-#define AIN_SAMPLES (AIN_BUFFER_SIZE / sizeof(ain_channels))
+// Sequence (4 channels, 64x oversampling, 173 cycles at 16MHz) takes ~2.8ms, so 250Hz fits
+#define AIN_RATE_Hz 250
+#define AIN_SAMPLES (AIN_AVERAGE_TIME_ms * AIN_RATE_Hz / 1000)
+// Samples per channel in DMA half-buffer (20ms)
+#define AIN_BLOCK 5
 
-uint16_t ain_buffer[AIN_BUFFER_SIZE];
+uint16_t ain_buffer[2 * AIN_BLOCK * sizeof(ain_channels)];
 uint16_t ain_data[sizeof(ain_channels)][AIN_SAMPLES];
+// Streaming filter windows (arrival order and sorted), fed from DMA half-buffers
+uint16_t ain_window[sizeof(ain_channels)][AIN_SAMPLES];
+uint16_t ain_sorted[sizeof(ain_channels)][AIN_SAMPLES];
+
+TIM_t ain_tim = {
+  .reg = TIM15,
+  .prescaler = SYS_CLOCK_FREQ / 1000000,
+  .auto_reload = 1000000 / AIN_RATE_Hz - 1
+};
+
+ADC_Pipe_t ain_pipe = { .ring = &ain_data[0][0], .ring_len = AIN_SAMPLES };
+
+static void PLC_AinHalf(void *arg);
+static void PLC_AinComplete(void *arg);
 
 ADC_t ain_adc = {
   .irq_priority = IRQ_Priority_Low,
@@ -111,15 +150,37 @@ ADC_t ain_adc = {
     .oversampling.enable = true,
     .oversampling.ratio = ADC_OversamplingRatio_64,
     .oversampling.shift = 2,
+    .continuous_mode = true,
+    .ext_select = ADC_ExtTrig_TIM15,
+    .tim = &ain_tim,
+    .pipe = &ain_pipe,
     .buff = ain_buffer,
-    .buff_len = AIN_BUFFER_SIZE
+    .buff_len = sizeof(ain_buffer) / sizeof(uint16_t),
+    .HalfCallback = PLC_AinHalf,
+    .CompleteCallback = PLC_AinComplete
   }
 };
 
-AIN_t AI1 = { .name = "AI1", .data = ain_data[0], .count = AIN_SAMPLES };
-AIN_t AI2 = { .name = "AI2", .data = ain_data[1], .count = AIN_SAMPLES };
-AIN_t POT = { .name = "POT", .data = ain_data[3], .count = AIN_SAMPLES };
-AIN_t VCC = { .name = "VCC", .data = ain_data[2], .count = AIN_SAMPLES };
+AIN_t AI1 = { .name = "AI1", .data = ain_window[0], .sorted = ain_sorted[0], .count = AIN_SAMPLES };
+AIN_t AI2 = { .name = "AI2", .data = ain_window[1], .sorted = ain_sorted[1], .count = AIN_SAMPLES };
+AIN_t POT = { .name = "POT", .data = ain_window[3], .sorted = ain_sorted[3], .count = AIN_SAMPLES };
+AIN_t VCC = { .name = "VCC", .data = ain_window[2], .sorted = ain_sorted[2], .count = AIN_SAMPLES };
+
+// Analog inputs in `ain_channels` order
+AIN_t *ain_inputs[sizeof(ain_channels)] = { &AI1, &AI2, &VCC, &POT };
+
+// DMA interrupt (after pipeline): new half-buffer goes into streaming filters, `AIN_Raw` only reads result
+static void PLC_AinHalf(void *arg)
+{
+  unused(arg);
+  AIN_Feed(ain_buffer, sizeof(ain_channels), AIN_BLOCK, ain_inputs);
+}
+
+static void PLC_AinComplete(void *arg)
+{
+  unused(arg);
+  AIN_Feed(&ain_buffer[AIN_BLOCK * sizeof(ain_channels)], sizeof(ain_channels), AIN_BLOCK, ain_inputs);
+}
 
 float VCC_Voltage_V(void)
 {
@@ -170,14 +231,12 @@ I2C_Master_t i2c_master = {
 };
 
 GPIO_t onewire_gpio = { .port = GPIOA, .pin = 10 };
-TIM_t sleep_us_tim = { .reg = TIM7 };
+WIRE_t onewire = { .gpio = &onewire_gpio, .tim = TIM7, .irq_priority = IRQ_Priority_VeryHigh };
 
-void ONEWIRE_Active(void)
+bool ONEWIRE_Active(void)
 {
-  sleep_us_init(&sleep_us_tim);
   I2C_Master_Disable(&i2c_master);
-  // WIRE_Init(&onewire);
-  return;
+  return WIRE_Init(&onewire);
 }
 
 //------------------------------------------------------------------------------------------------- RGB+BTN
@@ -187,7 +246,7 @@ GPIO_t rgb_gpio_green = { .port = GPIOA, .pin = 11 };
 GPIO_t rgb_gpio_blue = { .port = GPIOA, .pin = 12 };
 
 RGB_t RGB = { .red = &rgb_gpio_red, .green = &rgb_gpio_green, .blue = &rgb_gpio_blue };
-DIN_t BTN = { .gpif = { .gpio = { .port = GPIOC, .pin = 12, .reverse = true } } };
+DIN_t BTN = { .gpif = { .gpio = { .port = GPIOC, .pin = 12, .reverse = true }, .scan = &scan_gpioc } };
 
 //------------------------------------------------------------------------------------------------- DBG+Bash
 
@@ -208,6 +267,57 @@ UART_t dbg_uart = {
 uint8_t cache_file_buffer[2048];
 MBB_t cache_file = { .name = "cache", .buffer = cache_file_buffer, .limit = sizeof(cache_file_buffer) };
 
+//------------------------------------------------------------------------------------------------- Cycle
+
+// Input phase: latch process image, application sees it unchanged until next cycle
+static void PLC_Input(void *arg)
+{
+  unused(arg);
+  // Port scan inputs: digital inputs (DI) and button (BTN)
+  GPIO_ScanInputs(&scan_gpioa);
+  GPIO_ScanInputs(&scan_gpiob);
+  GPIO_ScanInputs(&scan_gpioc);
+  // Digital inputs (DI) in fast counter mode
+  if(din_pwmi_init && PWMI_Loop(&din_pwmi)) {
+    // PWMI_Print(&din_pwmi);
+  }
+  #if(PLC_DI_COUNTER)
+    CNT_Loop(&din_cnt);
+  #endif
+  // Analog inputs (AI)
+  // Pipeline fills `ain_data` rings and streaming filters from DMA interrupt, restart only after overrun
+  if(ADC_IsFree(&ain_adc)) {
+    LOG_Debug("ADC overrun");
+    ain_adc._overrun = 0;
+    ADC_Record(&ain_adc);
+  }
+}
+
+// Output phase: apply output image, relays go out in one port write
+static void PLC_Output(void *arg)
+{
+  unused(arg);
+  // Dioda LED
+  RGB_Loop(&RGB);
+  // Relay outputs (RO)
+  DOUT_Loop(&RO1);
+  DOUT_Loop(&RO2);
+  DOUT_Loop(&RO3);
+  DOUT_Loop(&RO4);
+  // Transistor outputs (TO)
+  DOUT_Loop(&TO1);
+  DOUT_Loop(&TO2);
+  DOUT_Loop(&TO3);
+  DOUT_Loop(&TO4);
+  // Triac outputs (XO)
+  DOUT_Loop(&XO1);
+  DOUT_Loop(&XO2);
+  // Port scan outputs: relays (RO)
+  GPIO_ScanOutputs(&scan_gpiob);
+}
+
+CYCLE_t plc_cycle = { .period_ms = PLC_CYCLE_ms, .Input = &PLC_Input, .Output = &PLC_Output };
+
 //------------------------------------------------------------------------------------------------- Functions PLC
 
 void PLC_Init(void)
@@ -261,69 +371,51 @@ void PLC_Init(void)
 
   PWM_Init(&xo_pwm);
   // Digital inputs (DI)
-  if(!DIN_Init(&DI1)) {
-    din_pwmi.channel[TIM_CH1] = TIM3_CH1_PA6;
-    din_pwmi_init = true;
-  }
-  if(!DIN_Init(&DI2)) {
-    din_pwmi.channel[TIM_CH2] = TIM3_CH2_PA7;
-    din_pwmi_init = true;
-  }
-  if(!DIN_Init(&DI3)) {
-    din_pwmi.channel[TIM_CH3] = TIM3_CH3_PB0;
-    din_pwmi_init = true;
-  }
-  if(!DIN_Init(&DI4)) {
-    din_pwmi.channel[TIM_CH4] = TIM3_CH4_PB1;
-    din_pwmi_init = true;
-  }
-  if(din_pwmi_init) PWMI_Init(&din_pwmi);
+  #if(PLC_DI_COUNTER)
+    DIN_Init(&DI1);
+    DIN_Init(&DI2);
+    DIN_Init(&DI3);
+    DIN_Init(&DI4);
+    DI1.cnt = &din_cnt;
+    if(PLC_DI_COUNTER == 2) DI2.cnt = &din_cnt;
+    CNT_Init(&din_cnt);
+  #else
+    if(!DIN_Init(&DI1)) {
+      din_pwmi.channel[TIM_CH1] = TIM3_CH1_PA6;
+      din_pwmi_init = true;
+    }
+    if(!DIN_Init(&DI2)) {
+      din_pwmi.channel[TIM_CH2] = TIM3_CH2_PA7;
+      din_pwmi_init = true;
+    }
+    if(!DIN_Init(&DI3)) {
+      din_pwmi.channel[TIM_CH3] = TIM3_CH3_PB0;
+      din_pwmi_init = true;
+    }
+    if(!DIN_Init(&DI4)) {
+      din_pwmi.channel[TIM_CH4] = TIM3_CH4_PB1;
+      din_pwmi_init = true;
+    }
+    if(din_pwmi_init) PWMI_Init(&din_pwmi);
+  #endif
   // Analog inputs (AI)
+  TIM_Init(&ain_tim);
   ADC_Init(&ain_adc);
   ADC_Record(&ain_adc);
-  ADC_Wait(&ain_adc);
+  while(ADC_PipeHead(&ain_adc) < AIN_SAMPLES) let();
   // Interfejsy RS485
   UART_Init(&RS1);
   UART_Init(&RS2);
+  // Scan cycle
+  CYCLE_Init(&plc_cycle);
+  CMD_AddCommand("cycle", &CYCLE_Bash);
   // LOG_Init(PLC_GREETING, PRO_VERSION);
   vrts_unlock();
 }
 
 void PLC_Loop(void)
 {
-  while(1) {
-    // Dioda LED i przycisk (BTN)
-    RGB_Loop(&RGB);
-    DIN_Loop(&BTN);
-    // Relay outputs (RO)
-    DOUT_Loop(&RO1);
-    DOUT_Loop(&RO2);
-    DOUT_Loop(&RO3);
-    DOUT_Loop(&RO4);
-    // Transistor outputs (TO)
-    DOUT_Loop(&TO1);
-    DOUT_Loop(&TO2);
-    DOUT_Loop(&TO3);
-    DOUT_Loop(&TO4);
-    // Triac outputs (XO)
-    DOUT_Loop(&XO1);
-    DOUT_Loop(&XO2);
-    // Digital inputs (DI)
-    DIN_Loop(&DI1);
-    DIN_Loop(&DI2);
-    DIN_Loop(&DI3);
-    DIN_Loop(&DI4);
-    if(din_pwmi_init && PWMI_Loop(&din_pwmi)) {
-      // PWMI_Print(&din_pwmi);
-    }
-    // Analog inputs (AI)
-    if(ADC_IsFree(&ain_adc)) {
-      if(ain_adc._overrun) LOG_Debug("ADC overrun"), ain_adc._overrun = 0;
-      else AIN_Sort(ain_buffer, sizeof(ain_channels), AIN_SAMPLES, ain_data);
-      ADC_Record(&ain_adc);
-    }
-    let();
-  }
+  CYCLE_Loop(&plc_cycle);
 }
 
 void PLC_Main(void)
@@ -12,6 +12,7 @@
 #include "rgb.h"
 #include "one_wire.h"
 #include "twi.h"
+#include "cycle.h"
 #include "vrts.h"
 #include "sys.h"
 #include "main.h"
@@ -32,6 +33,17 @@
   #define PLC_BASETIME 1
 #endif
 
+#ifndef PLC_CYCLE_ms
+  // Scan period of `PLC_Main` [ms] (`0` = free-running, one cycle per `let()`)
+  #define PLC_CYCLE_ms 1
+#endif
+
+#ifndef PLC_DI_COUNTER
+  // DI hardware counting on TIM3 (replaces PWMI): 0 = off, 1 = DI1 pulse counter, 2 = DI1/DI2 A/B encoder.
+  // DI3 edge latches count in both modes (`DIN_CountLatched`).
+  #define PLC_DI_COUNTER 0
+#endif
+
 #ifndef PLC_BOR_LEVEL
   // Brown-out reset level: 4 (~2.8V) for 3V3 automation; `BOR_Level_1V7` = power-down only
   #define PLC_BOR_LEVEL BOR_Level_2V8
@@ -77,8 +89,9 @@ float VCC_Voltage_V(void);
 extern UART_t RS1;
 extern UART_t RS2;
 
-// 1WIRE
-// void _1WIRE_Active(void);
+// 1WIRE (shares PA10 with I2C, `ONEWIRE_Active` switches pin to 1-Wire)
+extern WIRE_t onewire;
+bool ONEWIRE_Active(void);
 
 // Dioda RGB i przycisk BTN
 extern RGB_t RGB;
@@ -86,6 +99,9 @@ extern RGB_t RGB;
 extern DIN_t BTN;
 #define BTN1 BTN
 
+// Scan cycle: inputs latched, `plc_cycle.Logic` (set before `PLC_Main` starts), outputs written
+extern CYCLE_t plc_cycle;
+
 // Functions
 void PLC_Init(void);
 void PLC_Loop(void);
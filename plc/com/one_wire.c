@@ -2,159 +2,298 @@
 
 #include "one_wire.h"
 
+//------------------------------------------------------------------------------------------------- Timing
+
+// Standard speed slot timing [us]
+#define WIRE_RESET_LOW_us       480
+#define WIRE_RESET_SAMPLE_us    70
+#define WIRE_RESET_RECOVERY_us  410
+#define WIRE_WRITE1_LOW_us      2
+#define WIRE_WRITE0_LOW_us      60
+#define WIRE_WRITE0_RECOVERY_us 10
+#define WIRE_READ_SAMPLE_us     8  // Sample ~10us after falling edge (+ ISR latency), device holds line for 15us
+#define WIRE_READ_RECOVERY_us   55
+
+//------------------------------------------------------------------------------------------------- Internal
+
+static inline void WIRE_Low(WIRE_t *onewire) { onewire->gpio->port->BRR = (1u << onewire->gpio->pin); }
+static inline void WIRE_Release(WIRE_t *onewire) { onewire->gpio->port->BSRR = (1u << onewire->gpio->pin); }
+static inline bool WIRE_Line(WIRE_t *onewire) { return (onewire->gpio->port->IDR >> onewire->gpio->pin) & 1; }
+
+static void WIRE_Next(WIRE_t *onewire, WIRE_Stage_t stage)
+{
+  onewire->_stage = stage;
+  onewire->_phase = 0;
+  onewire->_bit = 0;
+}
+
+// Phases of reset slot, `0` when slot is complete
+static uint16_t WIRE_ResetSlot(WIRE_t *onewire)
+{
+  switch(onewire->_phase++) {
+    case 0: WIRE_Low(onewire); return WIRE_RESET_LOW_us;
+    case 1: WIRE_Release(onewire); return WIRE_RESET_SAMPLE_us;
+    case 2: onewire->_presence = !WIRE_Line(onewire); return WIRE_RESET_RECOVERY_us;
+  }
+  onewire->_phase = 0;
+  return 0;
+}
+
+// Phases of bit slot: writes `_value`, read slot is write `1` slot with `_value` sampled back
+static uint16_t WIRE_BitSlot(WIRE_t *onewire)
+{
+  switch(onewire->_phase++) {
+    case 0: WIRE_Low(onewire); return onewire->_value ? WIRE_WRITE1_LOW_us : WIRE_WRITE0_LOW_us;
+    case 1: WIRE_Release(onewire); return onewire->_value ? WIRE_READ_SAMPLE_us : WIRE_WRITE0_RECOVERY_us;
+    case 2:
+      if(!onewire->_value) break;
+      onewire->_value = WIRE_Line(onewire);
+      return WIRE_READ_RECOVERY_us;
+  }
+  onewire->_phase = 0;
+  return 0;
+}
+
+// Search direction from two read bits, `false` if no device answered
+static bool WIRE_Direction(WIRE_t *onewire)
+{
+  bool a = onewire->_triplet & 1;
+  bool b = (onewire->_triplet >> 1) & 1;
+  if(a && b) return false;
+  bool dir = (a != b) ? a : (onewire->_triplet >> 2) & 1;
+  onewire->_triplet = (onewire->_triplet & 3) | (dir << 2);
+  onewire->_value = dir;
+  return true;
+}
+
+// Run transaction until next timed phase, return its duration `[us]` (`0` = transaction done)
+static uint16_t WIRE_Step(WIRE_t *onewire)
+{
+  while(1) {
+    bool start = !onewire->_phase;
+    uint16_t delay_us;
+    switch(onewire->_stage) {
+      case WIRE_Stage_Reset:
+        if(onewire->_reset && (delay_us = WIRE_ResetSlot(onewire))) return delay_us;
+        WIRE_Next(onewire, WIRE_Stage_Write);
+        break;
+      case WIRE_Stage_Write:
+        if(onewire->_bit >= onewire->_tx_bits) {
+          WIRE_Next(onewire, WIRE_Stage_Read);
+          break;
+        }
+        if(start) onewire->_value = (onewire->_tx[onewire->_bit >> 3] >> (onewire->_bit & 7)) & 1;
+        if((delay_us = WIRE_BitSlot(onewire))) return delay_us;
+        onewire->_bit++;
+        break;
+      case WIRE_Stage_Read:
+        if(onewire->_bit >= onewire->_rx_bits) {
+          WIRE_Next(onewire, WIRE_Stage_Done);
+          break;
+        }
+        if(start) onewire->_value = true;
+        if((delay_us = WIRE_BitSlot(onewire))) return delay_us;
+        uint8_t mask = (uint8_t)(1u << (onewire->_bit & 7));
+        if(onewire->_value) onewire->_rx[onewire->_bit >> 3] |= mask;
+        else onewire->_rx[onewire->_bit >> 3] &= (uint8_t)~mask;
+        onewire->_bit++;
+        break;
+      case WIRE_Stage_Triplet:
+        if(start) {
+          // Two read slots (bit and its complement), then write of chosen direction
+          if(onewire->_bit == 2 && !WIRE_Direction(onewire)) onewire->_bit = 3;
+          if(onewire->_bit == 3) {
+            WIRE_Next(onewire, WIRE_Stage_Done);
+            break;
+          }
+          if(onewire->_bit < 2) onewire->_value = true;
+        }
+        if((delay_us = WIRE_BitSlot(onewire))) return delay_us;
+        if(onewire->_bit < 2 && onewire->_value) onewire->_triplet |= (uint8_t)(1u << onewire->_bit);
+        onewire->_bit++;
+        break;
+      default:
+        // Strong pull-up: push-pull high keeps parasite powered devices running
+        if(onewire->_power) onewire->gpio->port->OTYPER &= ~(1u << onewire->gpio->pin);
+        onewire->_busy = false;
+        return 0;
+    }
+  }
+}
+
+static void WIRE_Schedule(WIRE_t *onewire, uint16_t delay_us)
+{
+  if(!delay_us) return;
+  // One-pulse mode: counter stops at update, next phase starts from `CNT = 0`
+  onewire->tim->ARR = delay_us - 1;
+  onewire->tim->CR1 |= TIM_CR1_CEN;
+}
+
+static void WIRE_Interrupt(WIRE_t *onewire)
+{
+  onewire->tim->SR = ~TIM_SR_UIF;
+  WIRE_Schedule(onewire, WIRE_Step(onewire));
+}
+
+// Start transaction from `stage` and yield until timer interrupt finishes it
+static void WIRE_Run(WIRE_t *onewire, WIRE_Stage_t stage)
+{
+  WIRE_Next(onewire, stage);
+  uint32_t primask = __get_PRIMASK();
+  __disable_irq();
+  // First phase starts here, interrupts must not stretch it
+  WIRE_Schedule(onewire, WIRE_Step(onewire));
+  __set_PRIMASK(primask);
+  while(onewire->_busy) let();
+}
+
+// Wait for bus and end strong pull-up of previous transaction
+static void WIRE_Take(WIRE_t *onewire)
+{
+  while(onewire->_busy) let();
+  if(onewire->_power) {
+    onewire->gpio->port->OTYPER |= (1u << onewire->gpio->pin);
+    onewire->_power = false;
+  }
+  onewire->_busy = true;
+}
+
+// Search triplet: returns `_triplet` (bits `0`-`1` read, bit `2` direction written)
+static uint8_t WIRE_Triplet(WIRE_t *onewire, bool dir)
+{
+  WIRE_Take(onewire);
+  onewire->_triplet = (uint8_t)(dir << 2);
+  WIRE_Run(onewire, WIRE_Stage_Triplet);
+  return onewire->_triplet;
+}
+
+static bool WIRE_Exchange(WIRE_t *onewire, bool reset, const uint8_t *tx, uint16_t tx_len, uint8_t *rx, uint16_t rx_len, bool power)
+{
+  WIRE_Take(onewire);
+  onewire->_reset = reset;
+  onewire->_presence = false;
+  onewire->_power = power;
+  onewire->_tx = tx;
+  onewire->_tx_bits = tx_len * 8;
+  onewire->_rx = rx;
+  onewire->_rx_bits = rx_len * 8;
+  WIRE_Run(onewire, WIRE_Stage_Reset);
+  return reset ? onewire->_presence : true;
+}
+
+//------------------------------------------------------------------------------------------------- API
+
 bool WIRE_Init(WIRE_t *onewire)
 {
   onewire->gpio->out_type = GPIO_OutType_OpenDrain;
   onewire->gpio->speed = GPIO_Speed_VeryHigh;
-  onewire->gpio->mode = GPIO_Mode_Input;
+  onewire->gpio->mode = GPIO_Mode_Output;
   onewire->gpio->set = true;
   GPIO_Init(onewire->gpio);
+  onewire->_busy = false;
+  onewire->_power = false;
+  TIM_TypeDef *tim = onewire->tim;
+  RCC_EnableTIM(tim);
+  tim->CR1 = 0;
+  tim->PSC = SystemCoreClock / 1000000 - 1;
+  tim->ARR = 0xFFFF;
+  // URS: `UG` loads prescaler without update interrupt
+  tim->CR1 = TIM_CR1_OPM | TIM_CR1_URS;
+  tim->EGR = TIM_EGR_UG;
+  tim->CNT = 0;
+  tim->SR = 0;
+  IRQ_EnableTIM(tim, onewire->irq_priority, (void (*)(void *))&WIRE_Interrupt, onewire);
+  tim->DIER = TIM_DIER_UIE;
   if(timeout(250, WAIT_&GPIO_In, (void *)onewire->gpio)) {
     return false;
   }
   return true;
 }
 
-bool WIRE_Reset(WIRE_t *onewire)
+bool WIRE_Transfer(WIRE_t *onewire, bool reset, const uint8_t *tx, uint16_t tx_len, uint8_t *rx, uint16_t rx_len)
 {
-  GPIO_Mode(onewire->gpio, GPIO_Mode_Input);
-  GPIO_Init(onewire->gpio);
-  if(timeout(250, WAIT_&GPIO_In, (void *)onewire->gpio)) {
-    return false;
-  }
-  GPIO_Rst(onewire->gpio);
-  GPIO_Mode(onewire->gpio, GPIO_Mode_Output);
-  sleep_us(480);
-  GPIO_Set(onewire->gpio);
-  GPIO_Mode(onewire->gpio, GPIO_Mode_Input);
-  sleep_us(70);
-  bool value = !GPIO_In(onewire->gpio);
-  sleep_us(470);
-  return value;
+  return WIRE_Exchange(onewire, reset, tx, tx_len, rx, rx_len, false);
 }
 
-static void WIRE_WriteBit(WIRE_t *onewire, bool value)
+bool WIRE_Reset(WIRE_t *onewire)
 {
-  GPIO_Rst(onewire->gpio);
-  GPIO_Mode(onewire->gpio, GPIO_Mode_Output);
-  if(value) {
-    sleep_us(10);
-    GPIO_Set(onewire->gpio);
-    sleep_us(55);
-  }
-  else {
-    sleep_us(65);
-    GPIO_Set(onewire->gpio);
-    sleep_us(5);
+  if(timeout(250, WAIT_&GPIO_In, (void *)onewire->gpio)) {
+    return false;
   }
-}
-
-static bool WIRE_ReadBit(WIRE_t *onewire)
-{
-  GPIO_Rst(onewire->gpio);
-  GPIO_Mode(onewire->gpio, GPIO_Mode_Output);
-  sleep_us(3);
-  GPIO_Mode(onewire->gpio, GPIO_Mode_Input);
-  sleep_us(10);
-  bool value = GPIO_In(onewire->gpio);
-  sleep_us(53);
-  return value;
+  return WIRE_Transfer(onewire, true, NULL, 0, NULL, 0);
 }
 
 void WIRE_Write(WIRE_t *onewire, uint8_t value)
 {
-  for(uint8_t mask = 0x01; mask; mask <<= 1) {
-    WIRE_WriteBit(onewire, mask & value ? true: false);
-  }
-  GPIO_Mode(onewire->gpio, GPIO_Mode_Input);
-  GPIO_Rst(onewire->gpio);
+  WIRE_Transfer(onewire, false, &value, 1, NULL, 0);
 }
 
 void WIRE_WriteParasitePower(WIRE_t *onewire, uint8_t value)
 {
-  for(uint8_t mask = 0x01; mask; mask <<= 1) {
-    WIRE_WriteBit(onewire, mask & value ? true: false);
-  }
+  WIRE_Exchange(onewire, false, &value, 1, NULL, 0, true);
 }
 
 uint8_t WIRE_Read(WIRE_t *onewire)
 {
   uint8_t value = 0;
-  for(uint8_t mask = 0x01; mask; mask <<= 1) {
-    if(WIRE_ReadBit(onewire)) value |= mask;
-  }
+  WIRE_Transfer(onewire, false, NULL, 0, &value, 1);
   return value;
 }
 
 void WIRE_Select(WIRE_t *onewire, uint8_t *addr)
 {
-  WIRE_Write(onewire, ONEWIRE_CMD_MATCH_ROM);
-  for(uint8_t i = 0; i < 8; i++) WIRE_Write(onewire, addr[i]);
+  uint8_t tx[9] = { ONEWIRE_CMD_MATCH_ROM };
+  for(uint8_t i = 0; i < 8; i++) tx[i + 1] = addr[i];
+  WIRE_Transfer(onewire, false, tx, sizeof(tx), NULL, 0);
 }
 
 void WIRE_Skip(WIRE_t *onewire)
 {
-  WIRE_Write(onewire, ONEWIRE_CMD_SKIP_ROM);      
+  WIRE_Write(onewire, ONEWIRE_CMD_SKIP_ROM);
+}
+
+void WIRE_SearchReset(WIRE_t *onewire)
+{
+  onewire->_last = 0;
+  onewire->_last_dev_flag = false;
+  onewire->_last_family = 0;
 }
 
 bool WIRE_Search(WIRE_t *onewire, uint8_t *addr)
 {
-  uint8_t id_bit_i = 1, id_bit, id_bit_comp;
-  uint8_t rom_i = 0, last_zero = 0;
+  uint8_t last_zero = 0;
   bool res = false; // Search result
-  uint8_t mask = 1; // ROM byte mask
-  uint8_t dir; // Search direction
   if(!onewire->_last_dev_flag) {
-    if(!WIRE_Reset(onewire)) {
-      onewire->_last = 0;
-      onewire->_last_dev_flag = false;
-      onewire->_last_family = 0;
+    uint8_t cmd = ONEWIRE_CMD_SEARCH_ROM; // Normal search
+    if(!WIRE_Transfer(onewire, true, &cmd, 1, NULL, 0)) {
+      WIRE_SearchReset(onewire);
       return false;
     }
-    WIRE_Write(onewire, ONEWIRE_CMD_SEARCH_ROM); // Normal search
-    do {
-      id_bit = WIRE_ReadBit(onewire);
-      id_bit_comp = WIRE_ReadBit(onewire);
-      if(id_bit == 1 && id_bit_comp == 1) break;
-      else {
-        if(id_bit != id_bit_comp) dir = id_bit;
-        else {
-          if(id_bit_i < onewire->_last) {
-            dir = ((onewire->_rom[rom_i] & mask) > 0);
-          }
-          else {
-            dir = (id_bit_i == onewire->_last);
-          }
-          if(dir == 0) {
-            last_zero = id_bit_i;
-            if(last_zero < 9) onewire->_last_family = last_zero;
-          }
-        }
-        if(dir == 1) onewire->_rom[rom_i] |= mask;
-        else onewire->_rom[rom_i] &= ~mask;
-        WIRE_Write(onewire, dir);
-        id_bit_i++;
-        mask <<= 1;
-        if(mask == 0) {
-          rom_i++;
-          mask = 1;
-        }
+    for(uint8_t id_bit_i = 1; id_bit_i <= 64; id_bit_i++) {
+      uint8_t rom_i = (id_bit_i - 1) >> 3;
+      uint8_t mask = (uint8_t)(1u << ((id_bit_i - 1) & 7));
+      // Direction taken if devices differ at this bit (discrepancy)
+      bool dir = (id_bit_i < onewire->_last) ? (onewire->_rom[rom_i] & mask) != 0 : (id_bit_i == onewire->_last);
+      uint8_t triplet = WIRE_Triplet(onewire, dir);
+      if((triplet & 3) == 3) break;
+      dir = (triplet >> 2) & 1;
+      if(!(triplet & 3) && !dir) {
+        last_zero = id_bit_i;
+        if(last_zero < 9) onewire->_last_family = last_zero;
       }
+      if(dir) onewire->_rom[rom_i] |= mask;
+      else onewire->_rom[rom_i] &= (uint8_t)~mask;
+      if(id_bit_i == 64) res = true;
     }
-    while(rom_i < 8);
-
-    if(id_bit_i >= 65) {
+    if(res) {
       onewire->_last = last_zero;
       if(onewire->_last == 0) {
         onewire->_last_dev_flag = true;
       }
-      res = true;
     }
   }
   if(!res || !onewire->_rom[0]) {
-    onewire->_last = 0;
-    onewire->_last_dev_flag = false;
-    onewire->_last_family = 0;
+    WIRE_SearchReset(onewire);
     res = false;
   }
   else {
@@ -162,3 +301,5 @@ bool WIRE_Search(WIRE_t *onewire, uint8_t *addr)
   }
   return res;
 }
+
+//-------------------------------------------------------------------------------------------------
@@ -4,6 +4,8 @@
 #define ONE_WIRE_H_
 
 #include "gpio.h"
+#include "tim.h"
+#include "vrts.h"
 #include "sys.h"
 
 #define ONEWIRE_CMD_SKIP_ROM 0xCC
@@ -11,21 +13,98 @@
 #define ONEWIRE_CMD_SEARCH_ROM 0xF0
 #define ONEWIRE_CMD_MATCH_ROM 0x55
 
+//------------------------------------------------------------------------------------------------- Types
+
+typedef enum {
+  WIRE_Stage_Reset = 0,
+  WIRE_Stage_Write = 1,
+  WIRE_Stage_Read = 2,
+  WIRE_Stage_Triplet = 3,
+  WIRE_Stage_Done = 4
+} WIRE_Stage_t;
+
+/**
+ * @brief 1-Wire master. Slots are generated by timer interrupt (one-pulse mode, 1us tick),
+ * so whole transaction (reset, command, data) runs without CPU and calling thread yields
+ * with `let()` until it is done. Pin works as open-drain output, line is read from `IDR`.
+ * @param[in] gpio Bus pin (open-drain, external pull-up)
+ * @param[in] tim Timer used only by this bus (TIM6, TIM7, ...)
+ * @param[in] irq_priority Timer interrupt priority (slot timing depends on its latency)
+ * Internal:
+ * @param _rom Search: ROM code of last device found
+ * @param _last Search: bit position of last discrepancy
+ * @param _last_family Search: last discrepancy in family code
+ * @param _last_dev_flag Search: last device was found
+ * @param _stage Current transaction stage
+ * @param _phase Phase of current slot
+ * @param _reset Transaction starts with reset pulse
+ * @param _tx Bytes to write
+ * @param _tx_bits Bits to write
+ * @param _rx Buffer for read bytes
+ * @param _rx_bits Bits to read
+ * @param _bit Bit index in current stage
+ * @param _value Level of bit in current slot
+ * @param _triplet Search triplet: two read bits (`0b0000_00BA`) and chosen direction (`0b0000_0D00`)
+ * @param _presence Device answered reset pulse
+ * @param _power Line is driven high (strong pull-up) after last write
+ * @param _busy Transaction is running
+ */
 typedef struct {
   GPIO_t *gpio;
+  TIM_TypeDef *tim;
+  IRQ_Priority_t irq_priority;
+  // internal
   uint8_t _rom[8];
   uint8_t _last;
   uint8_t _last_family;
   bool _last_dev_flag;
+  WIRE_Stage_t _stage;
+  uint8_t _phase;
+  bool _reset;
+  const uint8_t *_tx;
+  uint16_t _tx_bits;
+  uint8_t *_rx;
+  uint16_t _rx_bits;
+  uint16_t _bit;
+  bool _value;
+  uint8_t _triplet;
+  bool _presence;
+  bool _power;
+  volatile bool _busy;
 } WIRE_t;
 
+//------------------------------------------------------------------------------------------------- API
+
+/**
+ * @brief Initialize bus pin and slot timer.
+ * @param[in,out] onewire 1-Wire instance
+ * @return `true` if line is released (high) within 250ms
+ */
 bool WIRE_Init(WIRE_t *onewire);
+
+/**
+ * @brief Run transaction: optional reset, write `tx_len` bytes, then read `rx_len` bytes.
+ * Thread yields until transaction finishes, other transaction on same bus is waited for.
+ * @param[in,out] onewire 1-Wire instance
+ * @param[in] reset Start with reset pulse
+ * @param[in] tx Bytes to write (LSB first)
+ * @param[in] tx_len Number of bytes to write
+ * @param[out] rx Buffer for read bytes
+ * @param[in] rx_len Number of bytes to read
+ * @return `true` if device answered reset (always `true` without `reset`)
+ */
+bool WIRE_Transfer(WIRE_t *onewire, bool reset, const uint8_t *tx, uint16_t tx_len, uint8_t *rx, uint16_t rx_len);
+
 bool WIRE_Reset(WIRE_t *onewire);
 void WIRE_Write(WIRE_t *onewire, uint8_t value);
+// Write byte, then drive line high (strong pull-up) until next transaction
 void WIRE_WriteParasitePower(WIRE_t *onewire, uint8_t value);
 uint8_t WIRE_Read(WIRE_t *onewire);
 void WIRE_Select(WIRE_t *onewire, uint8_t *addr);
 void WIRE_Skip(WIRE_t *onewire);
+// Start next `WIRE_Search` from first device (also after search stopped early)
+void WIRE_SearchReset(WIRE_t *onewire);
 bool WIRE_Search(WIRE_t *onewire, uint8_t *addr);
 
+//-------------------------------------------------------------------------------------------------
 #endif
@@ -4,6 +4,22 @@
 
 I2C_Master_t *twi_interface;
 
+// Transfer on shared bus, thread yields while transfer waits in queue and runs
+static bool TWI_Run(uint8_t addr, uint8_t *head, uint8_t head_len, uint8_t *tx, uint16_t tx_len, uint8_t *rx, uint16_t rx_len)
+{
+  I2C_Transfer_t transfer = {
+    .addr = addr,
+    .head_len = head_len,
+    .tx = tx,
+    .tx_len = tx_len,
+    .rx = rx,
+    .rx_len = rx_len
+  };
+  if(head_len) memcpy(transfer.head, head, head_len);
+  uint32_t timeout_ms = 21 + head_len + tx_len + rx_len;
+  return I2C_Master_Run(twi_interface, &transfer, timeout_ms) == OK;
+}
+
 void TWI_Init(I2C_Master_t *i2c)
 {
   twi_interface = i2c;
@@ -22,36 +38,30 @@ bool TWI_IsFree(void)
 
 bool TWI_Read(uint8_t addr, uint8_t *ary, uint16_t n)
 {
-  I2C_Master_Read(twi_interface, addr, ary, n);
-  if(timeout(21 + n, WAIT_&I2C_Master_IsFree, twi_interface)) {
-    return false;
-  }
-  return true;
+  return TWI_Run(addr, NULL, 0, NULL, 0, ary, n);
 }
 
 bool TWI_Write(uint8_t addr, uint8_t *ary, uint16_t n)
 {
-  I2C_Master_Write(twi_interface, addr, ary, n);
-  if(timeout(21 + n, WAIT_&I2C_Master_IsFree, twi_interface)) {
-    return false;
-  }
-  return true;
+  return TWI_Run(addr, NULL, 0, ary, n, NULL, 0);
 }
 
 bool TWI_ReadReg(uint8_t addr, uint8_t reg, uint8_t *ary, uint16_t n)
 {
-  I2C_Master_ReadReg(twi_interface, addr, reg, ary, n);
-  if(timeout(23 + n, WAIT_&I2C_Master_IsFree, twi_interface)) {
-    return false;
-  }
-  return true;
+  return TWI_Run(addr, &reg, 1, NULL, 0, ary, n);
 }
 
 bool TWI_WriteReg(uint8_t addr, uint8_t reg, uint8_t *ary, uint16_t n)
 {
-  I2C_Master_WriteReg(twi_interface, addr, reg, ary, n);
-  if(timeout(22 + n, WAIT_&I2C_Master_IsFree, twi_interface)) {
-    return false;
-  }
-  return true;
-}
\ No newline at end of file
+  return TWI_Run(addr, &reg, 1, ary, n, NULL, 0);
+}
+
+bool TWI_WriteRead(uint8_t addr, uint8_t *tx, uint16_t tx_len, uint8_t *rx, uint16_t rx_len)
+{
+  return TWI_Run(addr, NULL, 0, tx, tx_len, rx, rx_len);
+}
+
+status_t TWI_Submit(I2C_Transfer_t *transfer)
+{
+  return I2C_Master_Submit(twi_interface, transfer);
+}
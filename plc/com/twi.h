@@ -13,5 +13,7 @@ bool TWI_Read(uint8_t addr, uint8_t *ary, uint16_t n);
 bool TWI_Write(uint8_t addr, uint8_t *ary, uint16_t n);
 bool TWI_ReadReg(uint8_t addr, uint8_t reg, uint8_t *ary, uint16_t n);
 bool TWI_WriteReg(uint8_t addr, uint8_t reg, uint8_t *ary, uint16_t n);
+bool TWI_WriteRead(uint8_t addr, uint8_t *tx, uint16_t tx_len, uint8_t *rx, uint16_t rx_len);
+status_t TWI_Submit(I2C_Transfer_t *transfer);
 
-#endif
\ No newline at end of file
+#endif
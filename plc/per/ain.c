@@ -18,6 +18,87 @@ void AIN_Sort(uint16_t *buff, uint16_t channels, uint16_t samples, uint16_t data
   }
 }
 
+//------------------------------------------------------------------------------------------------- Stream
+
+// First index in `array` with value `>= key` (`upper`: `> key`)
+static uint16_t AIN_Bound(const uint16_t *array, uint16_t len, uint16_t key, bool upper)
+{
+  uint16_t left = 0;
+  while(len) {
+    uint16_t half = len / 2;
+    uint16_t value = array[left + half];
+    if(value < key || (upper && value == key)) {
+      left += half + 1;
+      len -= half + 1;
+    }
+    else len = half;
+  }
+  return left;
+}
+
+/**
+ * @brief Add one sample to streaming trimmed-mean filter.
+ * Window of last `count` samples is kept in `data` (arrival order) and in `sorted`.
+ * Oldest sample is replaced, sum of middle third is updated in O(1) after
+ * binary search of both positions, so `AIN_Raw` costs O(1).
+ * Result equals middle-third mean of `AIN_Raw` block mode over the same samples.
+ * Safe to call from ADC DMA `HalfCallback`/`CompleteCallback`.
+ * @param ain Pointer to `AIN_t` with `sorted` buffer set.
+ * @param sample New ADC sample.
+ */
+void AIN_Push(AIN_t *ain, uint16_t sample)
+{
+  uint16_t n = ain->count;
+  uint16_t *s = ain->sorted;
+  uint16_t a = n / 3;
+  uint16_t m = n >= 3 ? n / 3 : n;
+  bool inner = a + m < n; // Middle window does not reach top of `sorted`
+  if(!ain->_primed) {
+    // Start with window full of first sample, result converges within `count` samples
+    for(uint16_t i = 0; i < n; i++) ain->data[i] = s[i] = sample;
+    ain->_head = 0;
+    ain->_sum = (uint32_t)sample * m;
+    ain->_primed = true;
+    return;
+  }
+  uint32_t sum = ain->_sum;
+  uint16_t old = ain->data[ain->_head];
+  ain->data[ain->_head] = sample;
+  if(++ain->_head >= n) ain->_head = 0;
+  // Remove `old`: `s` shrinks to `n - 1`
+  uint16_t p = AIN_Bound(s, n, old, false);
+  if(p < a) sum -= s[a];
+  else if(p < a + m) sum -= s[p];
+  if(p < a + m && inner) sum += s[a + m];
+  memmove(&s[p], &s[p + 1], (n - 1 - p) * sizeof(uint16_t));
+  // Insert `sample`: `s` grows back to `n`
+  uint16_t q = AIN_Bound(s, n - 1, sample, true);
+  if(q < a) sum += s[a - 1];
+  else if(q < a + m) sum += sample;
+  if(q < a + m && inner) sum -= s[a + m - 1];
+  memmove(&s[q + 1], &s[q], (n - 1 - q) * sizeof(uint16_t));
+  s[q] = sample;
+  ain->_sum = sum;
+}
+
+/**
+ * @brief Feed interleaved ADC buffer into streaming filters (counterpart of `AIN_Sort`).
+ * @param buff Pointer to ADC buffer part (e.g. half given by DMA callback).
+ * @param channels Number of ADC channels.
+ * @param samples Number of samples per channel in `buff`.
+ * @param ains Analog inputs in channel order (`NULL` = channel not used).
+ */
+void AIN_Feed(uint16_t *buff, uint16_t channels, uint16_t samples, AIN_t *ains[channels])
+{
+  for(uint16_t n = 0; n < samples; n++) {
+    for(uint8_t cha = 0; cha < channels; cha++) {
+      if(ains[cha]) AIN_Push(ains[cha], buff[(n * channels) + cha]);
+    }
+  }
+}
+
+//-------------------------------------------------------------------------------------------------
+
 /**
  * @brief Set lower and upper threshold for analog input.
  * @param ain Pointer to `AIN_t` structure.
@@ -33,15 +114,23 @@ void AIN_Threshold(AIN_t *ain, float low, float high, AIN_Thresh_t scale)
 
 /**
  * @brief Get filtered ADC value without unit conversion.
+ * With `sorted` buffer set, returns streaming filter result (see `AIN_Push`).
+ * Otherwise computes middle-third mean of `data` block (on stack copy, `data` stays unchanged).
  * @param ain Pointer to `AIN_t` structure representing analog input.
  * @return Filtered 16-bit ADC value as `float`.
  */
 float AIN_Raw(AIN_t *ain)
 {
+  if(ain->sorted) {
+    uint16_t m = ain->count >= 3 ? ain->count / 3 : ain->count;
+    if(ain->_primed) ain->value = (float)ain->_sum / m;
+    return ain->value;
+  }
   if(tick_over(&ain->tick)) return ain->value;
-  uint16_t size = ain->count / 3;
-  sort_asc_u16(ain->data, ain->count);
-  ain->value = avg_u16(&(ain->data[size]), size);
+  // `data` may be live ring filled from interrupt (ADC pipe), select on copy
+  uint16_t scratch[ain->count];
+  memcpy(scratch, ain->data, sizeof(scratch));
+  ain->value = mid_mean_u16(scratch, ain->count);
   ain->tick = tick_keep(AIN_AVERAGE_TIME_ms / 2);
   LOG_Debug("Analog input %s raw-value: %F", ain->name, ain->value);
   return ain->value;
@@ -63,19 +152,20 @@ static float AIN_Volts(AIN_t *ain)
 
 /**
  * @brief Print error message for analog input if value is out of range.
+ * Rate limited to `AIN_LOG_BURST` messages per `AIN_LOG_PERIOD_ms` for each input,
+ * suppressed messages are summarized when logging resumes.
  * @param ain Pointer to `AIN_t`.
  * @param value Result from `AIN_Volts()`.
  * @param subject Error context string (e.g. "voltage", "current").
  */
 static void AIN_LogError(AIN_t *ain, float value, const char *subject)
 {
-  if(isInf(value)) {
-    if(value > 0.0f) LOG_Message(AIN_LOG_LEVEL, "Analog input %s over-%s", ain->name, subject);
-    else LOG_Message(AIN_LOG_LEVEL, "Analog input %s under-%s", ain->name, subject);
-  }
-  else if(isNaN(value)) {
-    LOG_Message(AIN_LOG_LEVEL, "Analog input %s invalid %s", ain->name, subject);
-  }
+  const char *state;
+  if(isInf(value)) state = value > 0.0f ? "over-" : "under-";
+  else if(isNaN(value)) state = "invalid ";
+  else return;
+  LOG_RATE_AT(&ain->_log_rate, AIN_LOG_LEVEL, AIN_LOG_BURST, AIN_LOG_PERIOD_ms,
+    "Analog input %s %s%s", ain->name, state, subject);
 }
 
 /**
@@ -86,9 +176,8 @@ static void AIN_LogError(AIN_t *ain, float value, const char *subject)
 float AIN_Voltage_V(AIN_t *ain)
 {
   float volts = AIN_Volts(ain);
-  if(AIN_IsError(volts)) return volts;
   AIN_LogError(ain, volts, "voltage");
-  return volts;  
+  return volts;
 }
 
 /**
@@ -99,8 +188,8 @@ float AIN_Voltage_V(AIN_t *ain)
 float AIN_Current_mA(AIN_t *ain)
 {
   float volts = AIN_Volts(ain);
-  if(AIN_IsError(volts)) return volts;
   AIN_LogError(ain, volts, "current");
+  if(AIN_IsError(volts)) return volts;
   return volts * 2.0f;
 }
 
@@ -112,8 +201,8 @@ float AIN_Current_mA(AIN_t *ain)
 float AIN_Percent(AIN_t *ain)
 {
   float volts = AIN_Volts(ain);
-  if(AIN_IsError(volts)) return volts;
   AIN_LogError(ain, volts, "value");
+  if(AIN_IsError(volts)) return volts;
   float percent = volts * 10.0f;
   if(ain->mode_4_20mA) {
     percent = (percent - 20.0f) * 5.0f / 4.0f;
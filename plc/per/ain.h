@@ -21,6 +21,16 @@
   #define AIN_LOG_LEVEL LOG_LEVEL_ERR
 #endif
 
+// Rate limit for range error logs: max messages in a row
+#ifndef AIN_LOG_BURST
+  #define AIN_LOG_BURST 3
+#endif
+
+// Rate limit for range error logs: time to refill whole burst
+#ifndef AIN_LOG_PERIOD_ms
+  #define AIN_LOG_PERIOD_ms 10000
+#endif
+
 // Upper resistor (near VCC) in measurement branch, can be adjusted in custom designs
 #ifndef AIN_RESISTOR_UP
   #define AIN_RESISTOR_UP 340
@@ -54,6 +64,12 @@ typedef enum {
  * @param threshold_high Upper threshold limit.
  * @param threshold_low Lower threshold limit.
  * @param tick Timestamp for sampling / filtering.
+ * @param sorted Optional buffer (`count` samples) enabling streaming filter, see `AIN_Push`.
+ * Internal:
+ * @param _head Oldest sample index in `data` ring (streaming filter).
+ * @param _sum Sum of middle third of `sorted` window (streaming filter).
+ * @param _primed Streaming window filled.
+ * @param _log_rate Rate limit of range error logs of this input.
  */
 typedef struct {
   const char *name;
@@ -64,9 +80,16 @@ typedef struct {
   float threshold_high;
   float threshold_low;
   uint64_t tick;
+  uint16_t *sorted;
+  uint16_t _head;
+  volatile uint32_t _sum;
+  bool _primed;
+  LOG_Rate_t _log_rate;
 } AIN_t;
 
 void AIN_Sort(uint16_t *buff, uint16_t channels, uint16_t samples, uint16_t data[channels][samples]);
+void AIN_Push(AIN_t *ain, uint16_t sample);
+void AIN_Feed(uint16_t *buff, uint16_t channels, uint16_t samples, AIN_t *ains[channels]);
 void AIN_Threshold(AIN_t *ain, float down, float up, AIN_Thresh_t scale);
 float AIN_Raw(AIN_t *ain);
 float AIN_Voltage_V(AIN_t *ain);
@@ -149,6 +149,7 @@ uint32_t DIN_SetTon(DIN_t *din, uint32_t ton_ms)
       if(EEPROM_Save(din->eeprom, &din->gpif.ton_ms)) din->gpif.ton_ms = ton_backup;
     }
   }
+  GPIF_Timing(&din->gpif);
   return din->gpif.ton_ms;
 }
 
@@ -170,6 +171,7 @@ uint32_t DIN_SetToff(DIN_t *din, uint32_t toff_ms)
       if(EEPROM_Save(din->eeprom, &din->gpif.toff_ms)) din->gpif.toff_ms = toff_backup;
     }
   }
+  GPIF_Timing(&din->gpif);
   return din->gpif.toff_ms;
 }
 
@@ -267,3 +269,49 @@ float DIN_Frequency_Hz(DIN_t *din)
 }
 
 //-------------------------------------------------------------------------------------------------
+
+/**
+ * @brief Get hardware count of digital input (DI) in counter or encoder mode.
+ * @param din Pointer to DI
+ * @return 64-bit count (encoder: position), `0` if no counter attached
+ */
+int64_t DIN_Count(DIN_t *din)
+{
+  if(!din->cnt) return 0;
+  return CNT_Value(din->cnt);
+}
+
+/**
+ * @brief Clear hardware count of digital input (DI).
+ * @param din Pointer to DI
+ */
+void DIN_CountReset(DIN_t *din)
+{
+  if(din->cnt) CNT_Reset(din->cnt);
+}
+
+/**
+ * @brief Take count latched in hardware by trigger input edge.
+ * @param din Pointer to DI
+ * @param value Latched count (may be `NULL`)
+ * @return `true` if new latch since last call
+ */
+bool DIN_CountLatched(DIN_t *din, int64_t *value)
+{
+  if(!din->cnt) return false;
+  return CNT_Latched(din->cnt, value);
+}
+
+/**
+ * @brief Get count rate of digital input (DI) in counter or encoder mode.
+ * Period method at low frequency, count per window at high, chosen automatically.
+ * @param din Pointer to DI
+ * @return Rate [Hz] (encoder: signed), or `NaN` if no counter attached
+ */
+float DIN_Rate_Hz(DIN_t *din)
+{
+  if(!din->cnt) return NaN;
+  return din->cnt->rate;
+}
+
+//-------------------------------------------------------------------------------------------------
@@ -8,6 +8,7 @@
 #include "eeprom.h"
 #include "gpio.h"
 #include "pwmi.h"
+#include "cnt.h"
 #include "vrts.h"
 
 //-------------------------------------------------------------------------------------------------
@@ -18,11 +19,14 @@
 /**
  * @brief Digital input configuration.
  * @param[in] name Name used in bash queries
- * @param[in] gpif Input filter instance `GPIF_t` with `gpio.port` and `gpio.pin`
+ * @param[in] gpif Input filter instance `GPIF_t` with `gpio.port` and `gpio.pin`,
+ *   optional `gpif.scan` makes input a view onto port scan (no `DIN_Loop` needed)
  * @param[in] eeprom Pointer to `EEPROM_t` for non-volatile storage
  * @param[in] fast_counter Enable fast counter mode
  * @param[in] pwmi Pointer to `PWMI_t` controller for fast counter
  * @param[in] channel Channel of `PWMI_t` controller
+ * @param[in] cnt Optional hardware counter/encoder (`CNT_t`) fed by this input, initialized by board.
+ *   Input keeps working as filtered DI, pin data register is readable in alternate mode.
  */
 typedef struct {
   const char *name;
@@ -31,6 +35,7 @@ typedef struct {
   bool fast_counter;
   PWMI_t *pwmi;
   TIM_Channel_t channel;
+  CNT_t *cnt;
 } DIN_t;
 
 bool DIN_Init(DIN_t *din);
@@ -55,5 +60,10 @@ uint32_t DIN_SetToggle(DIN_t *din, uint32_t toggle_ms);
 float DIN_Duty_Percent(DIN_t *din);
 float DIN_Frequency_Hz(DIN_t *din);
 
+int64_t DIN_Count(DIN_t *din);
+void DIN_CountReset(DIN_t *din);
+bool DIN_CountLatched(DIN_t *din, int64_t *value);
+float DIN_Rate_Hz(DIN_t *din);
+
 //-------------------------------------------------------------------------------------------------
 #endif
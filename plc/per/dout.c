@@ -182,44 +182,78 @@ void DOUT_Preset(DOUT_t *dout, bool value)
 }
 
 /**
- * @brief Generate one or more pulses on digital output.
+ * @brief Generate one or more pulses on digital output with freeze after last pulse.
+ * PWM-backed outputs (TO, XO) use hardware pulse train of `PWM_t` (exact timing, no CPU per edge),
+ * GPIO outputs (RO) toggle in `DOUT_Loop` with scan-rate resolution.
  * @param[in,out] dout Pointer to `DOUT_t` output descriptor.
  * @param[in] count Number of pulses to generate.
  * @param[in] ton_ms Pulse ON time in milliseconds.
  * @param[in] toff_ms Pulse OFF time in milliseconds.
+ * @param[in] freeze_ms Extra OFF time added after last pulse.
  * @return `true` if pulse sequence started, otherwise `false`.
  */
-bool DOUT_Pulse(DOUT_t *dout, uint8_t count, uint16_t ton_ms, uint16_t toff_ms)
+bool DOUT_PulseFreeze(DOUT_t *dout, uint32_t count, uint16_t ton_ms, uint16_t toff_ms, uint16_t freeze_ms)
 {
-  if(dout->pulse) return false;
+  if(DOUT_IsPulse(dout)) return false;
+  if(dout->pwm) {
+    if(!PWM_Train(dout->pwm, dout->channel, count, (uint32_t)ton_ms * 1000, (uint32_t)toff_ms * 1000)) return false;
+    dout->train = true;
+    dout->last_ms = freeze_ms;
+    return true;
+  }
   if(dout->relay && (ton_ms >= DOUT_RELAY_STUN_ms || toff_ms >= DOUT_RELAY_STUN_ms)) return false;
+  if(!count || count > UINT32_MAX / 2) return false;
   dout->pulse = (count * 2u);
   dout->ton_ms = ton_ms;
   dout->toff_ms = toff_ms;
-  dout->last_ms = toff_ms;
+  dout->last_ms = toff_ms + freeze_ms;
   return true;
 }
 
 /**
- * @brief Generate one or more pulses on digital output with freeze after last pulse.
+ * @brief Generate one or more pulses on digital output.
  * @param[in,out] dout Pointer to `DOUT_t` output descriptor.
  * @param[in] count Number of pulses to generate.
  * @param[in] ton_ms Pulse ON time in milliseconds.
  * @param[in] toff_ms Pulse OFF time in milliseconds.
- * @param[in] freeze_ms Extra OFF time added after last pulse.
  * @return `true` if pulse sequence started, otherwise `false`.
  */
-bool DOUT_PulseFreeze(DOUT_t *dout, uint8_t count, uint16_t ton_ms, uint16_t toff_ms, uint16_t freeze_ms)
+bool DOUT_Pulse(DOUT_t *dout, uint32_t count, uint16_t ton_ms, uint16_t toff_ms)
 {
-  if(dout->pulse) return false;
-  if(dout->relay && (ton_ms >= DOUT_RELAY_STUN_ms || toff_ms >= DOUT_RELAY_STUN_ms)) return false;
-  dout->pulse = (count * 2u);
-  dout->ton_ms = ton_ms;
-  dout->toff_ms = toff_ms;
-  dout->last_ms = toff_ms + freeze_ms;
+  return DOUT_PulseFreeze(dout, count, ton_ms, toff_ms, 0);
+}
+
+/**
+ * @brief Generate microsecond pulse train on PWM-backed output (TO, XO).
+ * Train takes whole `PWM_t` timer for its duration, outputs sharing it follow train period.
+ * @param[in,out] dout Pointer to `DOUT_t` output descriptor.
+ * @param[in] count Number of pulses (up to `2^32 - 1`).
+ * @param[in] ton_us Pulse ON time in microseconds.
+ * @param[in] toff_us Pulse OFF time in microseconds.
+ * @return `true` if train started, `false` for GPIO output, busy timer or timing out of range.
+ */
+bool DOUT_PulseTrain(DOUT_t *dout, uint32_t count, uint32_t ton_us, uint32_t toff_us)
+{
+  if(!dout->pwm || DOUT_IsPulse(dout)) return false;
+  if(!PWM_Train(dout->pwm, dout->channel, count, ton_us, toff_us)) return false;
+  dout->train = true;
+  dout->last_ms = 0;
   return true;
 }
 
+/**
+ * @brief Abort pulse sequence, output returns to its set value.
+ * @param[in,out] dout Pointer to `DOUT_t` output descriptor.
+ */
+void DOUT_PulseStop(DOUT_t *dout)
+{
+  if(dout->train) {
+    PWM_TrainStop(dout->pwm);
+    dout->train = false;
+  }
+  // Loop-driven sequence: `DOUT_Loop` brings output back to `value`
+  dout->pulse = 0;
+}
 
 /**
  * @brief Get current digital output state.
@@ -239,7 +273,7 @@ bool DOUT_State(const DOUT_t *dout)
  */
 bool DOUT_IsPulse(DOUT_t *dout)
 {
-  return dout->pulse ? true : false;
+  return dout->pulse || dout->train;
 }
 
 //-------------------------------------------------------------------------------------------------
@@ -263,6 +297,18 @@ void DOUT_Init(DOUT_t *dout)
   }
 }
 
+/**
+ * @brief Write GPIO output directly or queue it in port scan.
+ * @param[in,out] dout Pointer to `DOUT_t` output descriptor.
+ * @param[in] value Output state.
+ */
+static inline void DOUT_Write(DOUT_t *dout, bool value)
+{
+  if(dout->scan) GPIO_ScanWrite(dout->scan, &dout->gpio, value);
+  else if(value) GPIO_Set(&dout->gpio);
+  else GPIO_Rst(&dout->gpio);
+}
+
 /**
  * @brief Increment relay switch counter and store in EEPROM.
  * @param[in,out] dout Pointer to `DOUT_t` output descriptor.
@@ -276,20 +322,20 @@ static inline void DOUT_RelayCyclesInc(DOUT_t *dout)
 /**
  * @brief Digital output service loop.
  * Call every main loop; pulse timing uses even/odd `pulse` to select TON/TOFF.
+ * Hardware pulse train is only watched here, freeze starts when it ends.
  * @param[in,out] dout Pointer to DOUT_t.
  */
 void DOUT_Loop(DOUT_t *dout)
 {
+  if(dout->train) {
+    if(PWM_IsTrain(dout->pwm)) return;
+    dout->train = false;
+    if(dout->last_ms) dout->stun = tick_keep(dout->last_ms);
+  }
   if(tick_away(&dout->stun)) return;
   if(dout->pulse) {
     if(dout->relay && !DOUT_State(dout)) DOUT_RelayCyclesInc(dout);
-    if(dout->pwm) {
-      uint32_t value = dout->value ? 0 : dout->pwm->auto_reload;
-      PWM_SetValue(dout->pwm, dout->channel, value);
-    }
-    else {
-      GPIO_Tgl(&dout->gpio);
-    }
+    DOUT_Write(dout, !dout->gpio.set);
     dout->stun = (dout->pulse == 1) ?
       tick_keep(dout->last_ms) :
       tick_keep(dout->pulse % 2 ? dout->toff_ms : dout->ton_ms);
@@ -300,11 +346,11 @@ void DOUT_Loop(DOUT_t *dout)
     if(dout->pwm) PWM_SetValue(dout->pwm, dout->channel, dout->value);
     else {
       if(dout->value) {
-        GPIO_Set(&dout->gpio);
+        DOUT_Write(dout, true);
         if(dout->relay) DOUT_RelayCyclesInc(dout);
       }
       else {
-        GPIO_Rst(&dout->gpio);
+        DOUT_Write(dout, false);
         dout->value = false;
       }
     }
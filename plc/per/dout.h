@@ -26,6 +26,7 @@
  * @param[in] relay Specifies if the output is relay-type (RO)
  * @param[in] name Display name used in `bash` queries
  * @param[in] gpio Reference to `GPIO_t`; fields `port` and `pin` must be configured
+ * @param[in] scan Optional port scan of `gpio.port`, changes are written by `GPIO_ScanOutputs`
  * @param[in] pwm Pointer to `PWM_t` controller
  * @param[in] channel Channel of the `PWM_t` controller assigned to this output
  * @param[in] eeprom Pointer to `EEPROM_t` for non-volatile storage of the output value
@@ -35,12 +36,15 @@
  * @param stun Internal timestamp guard that temporarily freezes output activity
  * @param ton_ms Internal storage of TON (on-time) used by `DOUT_Pulse`
  * @param toff_ms Internal storage of TOFF (off-time) used by `DOUT_Pulse`
- * @param pulse Internal counter of remaining pulses in a pulse sequence
+ * @param last_ms Internal OFF time after last pulse (TOFF + freeze)
+ * @param pulse Internal counter of remaining edges in a loop-driven pulse sequence
+ * @param train Internal flag of hardware pulse train running on `pwm`
  */
 typedef struct {
   bool relay;
   char *name;
   GPIO_t gpio;
+  GPIO_Scan_t *scan;
   PWM_t *pwm;
   TIM_Channel_t channel;
   EEPROM_t *eeprom;
@@ -51,7 +55,8 @@ typedef struct {
   uint16_t ton_ms;
   uint16_t toff_ms;
   uint16_t last_ms;
-  uint8_t pulse;
+  uint32_t pulse;
+  bool train;
 } DOUT_t;
 
 void DOUT_Init(DOUT_t *dout);
@@ -67,8 +72,10 @@ void DOUT_Set(DOUT_t *dout);
 void DOUT_Rst(DOUT_t *dout);
 void DOUT_Tgl(DOUT_t *dout);
 void DOUT_Preset(DOUT_t *dout, bool value);
-bool DOUT_Pulse(DOUT_t *dout, uint8_t count, uint16_t ton_ms, uint16_t toff_ms);
-bool DOUT_PulseFreeze(DOUT_t *dout, uint8_t count, uint16_t ton_ms, uint16_t toff_ms, uint16_t freeze_ms);
+bool DOUT_Pulse(DOUT_t *dout, uint32_t count, uint16_t ton_ms, uint16_t toff_ms);
+bool DOUT_PulseFreeze(DOUT_t *dout, uint32_t count, uint16_t ton_ms, uint16_t toff_ms, uint16_t freeze_ms);
+bool DOUT_PulseTrain(DOUT_t *dout, uint32_t count, uint32_t ton_us, uint32_t toff_us);
+void DOUT_PulseStop(DOUT_t *dout);
 bool DOUT_State(const DOUT_t *dout);
 bool DOUT_IsPulse(DOUT_t *dout);
 void DOUT_SaveValue(DOUT_t *dout, bool save);
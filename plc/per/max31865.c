@@ -4,6 +4,56 @@
 
 //-------------------------------------------------------------------------------------------------
 
+// Conversion period in automatic mode (with margin)
+#define MAX31865_PERIOD_ms(reject) ((reject) == RTD_Reject_50Hz ? 21 : 17)
+
+static void MAX31865_Done(SPI_Transfer_t *transfer)
+{
+  MAX31865_t *rtd = transfer->arg;
+  if(transfer->status) return;
+  // LSB of RTD register is fault flag
+  if(rtd->buff[2] & 1) {
+    rtd->_fault = true;
+    return;
+  }
+  rtd->raw = ((uint16_t)rtd->buff[1] << 7) | (rtd->buff[2] >> 1);
+  rtd->_sum += rtd->raw;
+  rtd->_count++;
+  rtd->samples++;
+}
+
+// Start conversion read unless previous one is still running (EXTI handler or loop)
+static void MAX31865_Sample(MAX31865_t *rtd)
+{
+  uint32_t primask = __get_PRIMASK();
+  __disable_irq();
+  if(rtd->_state == MAX31865_State_Run && rtd->_read.status != BUSY) {
+    SPI_Master_Submit(rtd->spi, &rtd->_read);
+  }
+  __set_PRIMASK(primask);
+}
+
+static status_t MAX31865_SetConfig(MAX31865_t *rtd, uint8_t config)
+{
+  rtd->_cfg[0] = MAX31865_Reg_Write_Configuration;
+  rtd->_cfg[1] = config;
+  rtd->_write.tx = rtd->_cfg;
+  rtd->_write.rx = NULL;
+  rtd->_write.len = 2;
+  return SPI_Master_Run(rtd->spi, &rtd->_write, 50);
+}
+
+static status_t MAX31865_GetFault(MAX31865_t *rtd, uint8_t *fault)
+{
+  rtd->_write.tx = NULL;
+  rtd->_write.fill = MAX31865_Reg_Read_FaultStatus;
+  rtd->_write.rx = rtd->_cfg;
+  rtd->_write.len = 2;
+  if(SPI_Master_Run(rtd->spi, &rtd->_write, 50)) return ERR;
+  *fault = rtd->_cfg[1];
+  return OK;
+}
+
 /**
  * @brief Initialize the MAX31865 module for RTD sensor operation.
  * @param[in,out] rtd Pointer to MAX31865 instance
@@ -14,77 +64,131 @@ void MAX31865_Init(MAX31865_t *rtd)
     rtd->cs->mode = GPIO_Mode_Output;
     GPIO_Init(rtd->cs);
   }
-  rtd->ready->mode = GPIO_Mode_Input;
-  GPIO_Init(rtd->ready);
+  rtd->_device = (SPI_Device_t){
+    .cs = rtd->cs ? rtd->cs : rtd->spi->cs, .cs_delay = rtd->spi->cs_delay, .prescaler = rtd->spi->prescaler,
+    .lsb = rtd->spi->lsb, .cpol = rtd->spi->cpol, .cpha = rtd->spi->cpha
+  };
+  rtd->_read = (SPI_Transfer_t){
+    .device = &rtd->_device, .fill = MAX31865_Reg_Read_RTD_MSB, .rx = rtd->buff, .len = 3,
+    .Done = MAX31865_Done, .arg = rtd
+  };
+  rtd->_write.device = &rtd->_device;
+  if(rtd->ready) {
+    if(rtd->ready_irq) {
+      EXTI_t *exti = &rtd->_exti;
+      exti->port = rtd->ready->port;
+      exti->pin = rtd->ready->pin;
+      exti->mode = GPIO_Mode_Input;
+      exti->pull = rtd->ready->pull;
+      // DATA-READY is active low on `reverse` pin
+      if(rtd->ready->reverse) {
+        exti->fall_detect = true;
+        exti->FallHandler = (EXTI_Handler_t)MAX31865_Sample;
+        exti->fall_arg = rtd;
+      }
+      else {
+        exti->rise_detect = true;
+        exti->RiseHandler = (EXTI_Handler_t)MAX31865_Sample;
+        exti->rise_arg = rtd;
+      }
+      exti->irq_enable = true;
+      exti->irq_priority = rtd->spi->irq_priority;
+      EXTI_Init(exti);
+    }
+    rtd->ready->mode = GPIO_Mode_Input;
+    GPIO_Init(rtd->ready);
+  }
   if(!rtd->nominal_ohms) rtd->nominal_ohms = RTD_Type_PT100;
   if(!rtd->reference_ohms) rtd->reference_ohms = 4 * rtd->nominal_ohms;
+  if(!rtd->expiry_ms) rtd->expiry_ms = 1000;
+  rtd->_scale = rtd->reference_ohms / rtd->nominal_ohms / 32768 * MAX31865_LUT_STEPS;
+  rtd->_state = MAX31865_State_Bias;
   rtd->raw_float = NaN;
+  rtd->temperature = NaN;
 }
 
-static status_t MAX31865_GetData(MAX31865_t *rtd)
+// Expiry counts from end of collection window (`interval_ms` or `oversampling` conversions),
+// so measurement that is still collecting never expires
+static uint64_t MAX31865_Expiry(MAX31865_t *rtd)
 {
-  if(timeout(100, WAIT_&GPIO_In, rtd->ready)) return ERR;
-  SPI_Master_Read(rtd->spi, MAX31865_Reg_Read_RTD_MSB, rtd->buff, 3);
-  if(timeout(50, WAIT_&SPI_Master_IsFree, rtd->spi)) return ERR;
-  rtd->raw = ((uint16_t)rtd->buff[1] << 7) | (rtd->buff[2] >> 1);
-  return OK;
-}
-
-static status_t MAX31865_SetConfig(MAX31865_t *rtd, uint8_t config)
-{
-  rtd->buff[0] = MAX31865_Reg_Write_Configuration;
-  rtd->buff[1] = config;
-  SPI_Master_Write(rtd->spi, rtd->buff, 2);
-  if(timeout(50, WAIT_&SPI_Master_IsFree, rtd->spi)) return ERR;
-  return OK;
+  uint32_t window_ms = (uint32_t)rtd->oversampling * MAX31865_PERIOD_ms(rtd->reject);
+  if(window_ms < rtd->interval_ms) window_ms = rtd->interval_ms;
+  return tick_keep(window_ms + MAX31865_PERIOD_ms(rtd->reject) + rtd->expiry_ms);
 }
 
 /**
- * @brief Main measurement loop for the RTD sensor.
- * Runs configuration, performs measurement, computes temperature.
+ * @brief Measurement scheduler for the RTD sensor (non-blocking).
+ * Chip stays in automatic conversion mode, conversions are read on DATA-READY (EXTI or polling)
+ * or every conversion period and averaged without buffer until `oversampling` and `interval_ms` are met.
+ * Bus transfers are queued with chip's own CS, so many sensors on one SPI read in one burst.
  * @param[in,out] rtd Pointer to MAX31865 instance
- * @return `OK` on success, `ERR` on SPI / timeout failure, `BUSY` if SPI not free
+ * @return `OK` when new measurement is ready, `BUSY` while collecting, `ERR` on SPI / timeout failure
  */
 status_t MAX31865_Loop(MAX31865_t *rtd)
 {
-  if(tick_away(&rtd->interval_tick)) return OK;
-  if(tick_over(&rtd->expiry_tick)) {
-    rtd->raw_float = NaN;
-  }
-  if(rtd->cs) rtd->spi->cs = rtd->cs;
   uint8_t cfg = (rtd->wire << 4) | rtd->reject;
-  if(SPI_Master_IsBusy(rtd->spi)) return BUSY;
-  if(MAX31865_SetConfig(rtd, MAX31865_CFG_BIAS | cfg)) return ERR;
-  delay(10);
-  if(rtd->oversampling) {
-    if(MAX31865_SetConfig(rtd, MAX31865_CFG_BIAS | MAX31865_CFG_AUTO | cfg)) return ERR;
-    float value = 0;
-    for(uint16_t n = 0; n < rtd->oversampling; n++) {
-      if(MAX31865_GetData(rtd)) return ERR;
-      value += (float)rtd->raw;
-    }
-    rtd->raw_float = value / rtd->oversampling;
+  switch(rtd->_state) {
+    case MAX31865_State_Bias:
+      if(MAX31865_SetConfig(rtd, MAX31865_CFG_BIAS | MAX31865_CFG_FSCLR | cfg)) return ERR;
+      rtd->_tick = tick_keep(MAX31865_BIAS_ms);
+      rtd->_state = MAX31865_State_Auto;
+      return BUSY;
+    case MAX31865_State_Auto:
+      if(tick_away(&rtd->_tick)) return BUSY;
+      if(MAX31865_SetConfig(rtd, MAX31865_CFG_BIAS | MAX31865_CFG_AUTO | cfg)) return ERR;
+      rtd->_sum = 0;
+      rtd->_count = 0;
+      rtd->_fault = false;
+      rtd->expiry_tick = MAX31865_Expiry(rtd);
+      rtd->interval_tick = tick_keep(rtd->interval_ms);
+      rtd->_tick = tick_keep(MAX31865_PERIOD_ms(rtd->reject));
+      rtd->_state = MAX31865_State_Run;
+      return BUSY;
+    case MAX31865_State_Run:
+      break;
   }
-  else {
-    if(MAX31865_SetConfig(rtd, MAX31865_CFG_BIAS | MAX31865_CFG_SHOT | cfg)) return ERR;
-    if(MAX31865_GetData(rtd)) return ERR;
-    rtd->raw_float = (float)rtd->raw;
+  // Polling also catches DATA-READY edge missed while previous read was running
+  if(rtd->ready) {
+    if(GPIO_In(rtd->ready)) MAX31865_Sample(rtd);
   }
-  // Read Errors
-  if(MAX31865_SetConfig(rtd, MAX31865_CFG_FSCLR | cfg)) return ERR;
-  LOG_Debug("MAX31865 %s raw value: %.2f", rtd->name, rtd->raw_float);
-  rtd->expiry_tick = tick_keep(rtd->expiry_ms);
-  rtd->interval_tick = tick_keep(rtd->interval_ms);
-  return OK;
+  else if(tick_over(&rtd->_tick)) {
+    rtd->_tick = tick_keep(MAX31865_PERIOD_ms(rtd->reject));
+    MAX31865_Sample(rtd);
+  }
+  if(rtd->_fault) {
+    uint8_t fault;
+    if(MAX31865_GetFault(rtd, &fault)) return ERR;
+    LOG_Warning("MAX31865 %s fault: 0x%02X", rtd->name, fault);
+    rtd->faults++;
+    rtd->_fault = false;
+    if(MAX31865_SetConfig(rtd, MAX31865_CFG_BIAS | MAX31865_CFG_AUTO | MAX31865_CFG_FSCLR | cfg)) return ERR;
+  }
+  if(rtd->_count && rtd->_count >= rtd->oversampling && !tick_away(&rtd->interval_tick)) {
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    uint32_t sum = rtd->_sum;
+    uint16_t count = rtd->_count;
+    rtd->_sum = 0;
+    rtd->_count = 0;
+    __set_PRIMASK(primask);
+    rtd->raw_float = (float)sum / count;
+    rtd->temperature = RTD_Temperature_C(rtd);
+    LOG_Debug("MAX31865 %s raw value: %.2f", rtd->name, rtd->raw_float);
+    rtd->expiry_tick = MAX31865_Expiry(rtd);
+    rtd->interval_tick = tick_keep(rtd->interval_ms);
+    return OK;
+  }
+  if(tick_over(&rtd->expiry_tick)) {
+    rtd->raw_float = NaN;
+    rtd->temperature = NaN;
+    rtd->_state = MAX31865_State_Bias;
+    return ERR;
+  }
+  return BUSY;
 }
 
 //-------------------------------------------------------------------------------------------------
 
-#define MAX31865_A 3.9083e-3
-#define MAX31865_B -5.775e-7
-#define MAX31865_Z1 (-MAX31865_A)
-#define MAX31865_Z2 (MAX31865_A * MAX31865_A - (4 * MAX31865_B))
-
 /**
  * @brief Compute RTD resistance in Ω from the raw measurement.
  * @param[in] rtd Pointer to MAX31865 instance
@@ -96,34 +200,39 @@ float RTD_Resistance_Ohm(MAX31865_t *rtd)
   return rtd->raw_float * rtd->reference_ohms / 32768;
 }
 
+// Temperature [°C] for resistance ratio `R/R0` from `0.125` in steps of `1/32` (Callendar-Van Dusen, IEC 60751).
+// Linear interpolation error is below 0.006°C from -200°C to 850°C.
+static const float max31865_lut[MAX31865_LUT_SIZE] = {
+  -213.841f, -206.677f, -199.468f, -192.215f, -184.918f, -177.580f, -170.201f, -162.783f,
+  -155.327f, -147.834f, -140.305f, -132.742f, -125.146f, -117.519f, -109.860f, -102.172f,
+  -94.456f, -86.713f, -78.943f, -71.148f, -63.329f, -55.487f, -47.623f, -39.736f,
+  -31.829f, -23.901f, -15.953f, -7.986f, -0.000f, 8.005f, 16.030f, 24.073f,
+  32.136f, 40.218f, 48.320f, 56.441f, 64.583f, 72.744f, 80.926f, 89.128f,
+  97.350f, 105.593f, 113.857f, 122.141f, 130.447f, 138.774f, 147.123f, 155.493f,
+  163.885f, 172.298f, 180.734f, 189.192f, 197.673f, 206.176f, 214.702f, 223.251f,
+  231.824f, 240.419f, 249.038f, 257.681f, 266.348f, 275.039f, 283.755f, 292.495f,
+  301.259f, 310.049f, 318.864f, 327.705f, 336.571f, 345.463f, 354.381f, 363.325f,
+  372.296f, 381.294f, 390.318f, 399.370f, 408.450f, 417.557f, 426.693f, 435.857f,
+  445.049f, 454.270f, 463.520f, 472.800f, 482.109f, 491.449f, 500.818f, 510.218f,
+  519.649f, 529.111f, 538.605f, 548.130f, 557.688f, 567.278f, 576.900f, 586.556f,
+  596.245f, 605.969f, 615.726f, 625.517f, 635.344f, 645.206f, 655.103f, 665.037f,
+  675.007f, 685.013f, 695.057f, 705.139f, 715.259f, 725.417f, 735.614f, 745.851f,
+  756.128f, 766.444f, 776.802f, 787.201f, 797.642f, 808.125f, 818.651f, 829.221f,
+  839.834f, 850.492f, 861.194f, 871.943f
+};
+
 /**
- * @brief Compute temperature in °C from RTD resistance (Callendar-Van Dusen).
+ * @brief Compute temperature in °C from RTD resistance (Callendar-Van Dusen table).
  * @param[in] rtd Pointer to MAX31865 instance
- * @return Temperature in °C, `NaN` if no valid measurement
+ * @return Temperature in °C, `NaN` if no valid measurement or resistance out of range
  */
 float RTD_Temperature_C(MAX31865_t *rtd)
 {
   if(isNaN(rtd->raw_float)) return NaN;
-  float ohms = RTD_Resistance_Ohm(rtd);
-  float z3 = (4 * MAX31865_B) / rtd->nominal_ohms;
-  float z4 = 2 * MAX31865_B;
-  float temp = MAX31865_Z2 + (z3 * ohms);
-  temp = (sqrt(temp) + MAX31865_Z1) / z4;
-  if(temp >= 0) return temp;
-  ohms /= rtd->nominal_ohms;
-  ohms *= 100;
-  float x = ohms;
-  temp = -242.02;
-  temp += 2.2228 * x;
-  x *= ohms;
-  temp += 2.5859e-3 * x;
-  x *= ohms;
-  temp -= 4.8260e-6 * x;
-  x *= ohms;
-  temp -= 2.8183e-8 * x;
-  x *= ohms;
-  temp += 1.5243e-10 * x;
-  return temp;
+  float x = rtd->raw_float * rtd->_scale - MAX31865_LUT_OFFSET;
+  if(x < 0 || x >= MAX31865_LUT_SIZE - 1) return NaN;
+  uint16_t i = (uint16_t)x;
+  return max31865_lut[i] + (max31865_lut[i + 1] - max31865_lut[i]) * (x - i);
 }
 
 //-------------------------------------------------------------------------------------------------
@@ -47,28 +47,59 @@ typedef enum {
   RTD_Reject_50Hz = 1
 } RTD_Reject_t;
 
+#ifndef MAX31865_BIAS_ms
+  // Bias voltage settling before automatic conversion starts
+  #define MAX31865_BIAS_ms 10
+#endif
+
+// Temperature table: resistance ratio `R/R0 = (index + OFFSET) / STEPS`
+#define MAX31865_LUT_STEPS 32
+#define MAX31865_LUT_OFFSET 4
+#define MAX31865_LUT_SIZE 124
+
+typedef enum {
+  MAX31865_State_Bias = 0,
+  MAX31865_State_Auto = 1,
+  MAX31865_State_Run = 2
+} MAX31865_State_t;
+
 typedef struct {
   const char *name;
   SPI_Master_t *spi;       // SPI interface
   GPIO_t *cs;              // CS (chip select) pin
-  GPIO_t *ready;           // DATA-READY pin, signals conversion complete
+  GPIO_t *ready;           // DATA-READY pin, signals conversion complete (`NULL` = read every conversion period)
+  bool ready_irq;          // Read on DATA-READY edge from EXTI (`false` = poll `ready` in loop)
   float nominal_ohms;      // Nominal sensor resistance in Ω, e.g. `RTD_Type_PT100`
   float reference_ohms;    // Reference resistor value
   RTD_Wire_t wire;         // Wiring: 2-, 3-, or 4-wire
   RTD_Reject_t reject;     // Mains noise rejection: 50Hz or 60Hz
-  uint16_t oversampling;   // Number of samples for software oversampling
-  uint16_t expiry_ms;      // Timeout after which no sensor response sets `NaN`
-  uint16_t interval_ms;    // Interval between measurements (>= 200ms shorter than `expiry_ms`)
-  uint16_t raw;
-  float raw_float;
+  uint16_t oversampling;   // Number of conversions averaged into one measurement
+  uint16_t expiry_ms;      // No measurement for this time after `interval_ms` (or `oversampling` conversions) sets `NaN` and configures chip again
+  uint16_t interval_ms;    // Minimum time between measurements, conversions in between are averaged too
+  uint16_t raw;            // Last conversion
+  float raw_float;         // Last measurement (average of conversions)
   volatile float temperature;
   uint8_t buff[3];
   uint64_t expiry_tick;
   uint64_t interval_tick;
+  uint32_t samples;        // Conversions read
+  uint32_t faults;         // Conversions with fault flag
+  // internal
+  MAX31865_State_t _state;
+  uint64_t _tick;          // Bias settling end or next scheduled read
+  float _scale;            // `raw` to interpolation table index
+  volatile uint32_t _sum;  // Streaming average: sum and number of conversions since last measurement
+  volatile uint16_t _count;
+  volatile bool _fault;    // Conversion with fault flag was read
+  uint8_t _cfg[2];
+  EXTI_t _exti;
+  SPI_Device_t _device;    // CS and clock settings of this chip on shared bus
+  SPI_Transfer_t _read;    // Conversion read, started from EXTI or loop, completes in DMA interrupt
+  SPI_Transfer_t _write;   // Configuration and fault status access from loop
 } MAX31865_t;
 
 void MAX31865_Init(MAX31865_t *rtd);        // Initialize the MAX31865 module
-status_t MAX31865_Loop(MAX31865_t *rtd);    // Main measurement loop
+status_t MAX31865_Loop(MAX31865_t *rtd);    // Measurement scheduler (non-blocking)
 float RTD_Resistance_Ohm(MAX31865_t *rtd);  // Compute RTD resistance in Ω
 float RTD_Temperature_C(MAX31865_t *rtd);   // Compute temperature in °C (PT100/PT1000)
 